@@ -0,0 +1,192 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Batch environment benchmark: steps many games in lockstep with a random bot
+
+#include "headers.h"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-batch-bench [OPTIONS]
+
+Plays a batch of games in lockstep through the observation API, as a bot
+training on them would, giving each a random command every step, and prints
+one CSV record: the games, steps, seconds, game steps a second, the games
+that ended (each restarted from the next seed), and the observation bytes.
+Before that, it checks that commands which would exit the program, given
+to a batch, end no more than their own game, exiting with status 1 if not.
+
+Options:
+    -s NUMBER    First game seed (default: 1)
+    -c NUMBER    Number of games in the batch (default: 64)
+    -n NUMBER    Number of steps (default: 1000)
+    -l HxW       Dungeon level size in tiles (default: 66x198)
+
+    -h           Display this message
+)";
+
+static int bench_level_height = MAX_HEIGHT;
+static int bench_level_width = MAX_WIDTH;
+
+// Run on each game's thread, before it is played
+static void batchBenchSetup() {
+    (void) dungeonSetSize(bench_level_height, bench_level_width);
+}
+
+// Rogue-form commands which can not end the process, as the sim's agent
+// uses, with the keys their prompts read.
+typedef struct {
+    char command;
+    const char *arguments;
+} BenchCommand_t;
+
+static BenchCommand_t bench_commands[] = {
+    {'h', ""}, {'j', ""}, {'k', ""}, {'l', ""}, {'y', ""}, {'u', ""}, {'b', ""}, {'n', ""},
+    {'H', ""}, {'J', ""}, {'K', ""}, {'L', ""}, {'Y', ""}, {'U', ""}, {'B', ""}, {'N', ""},
+    {'R', "&\r"}, {'s', ""}, {'<', ""}, {'>', ""}, {'E', "a"}, {'q', "a"}, {'r', "a"},
+};
+constexpr int BENCH_COMMAND_COUNT = sizeof(bench_commands) / sizeof(bench_commands[0]);
+
+// xorshift32, kept apart from the game RNG
+static uint32_t bench_random_state = 2463534242u;
+
+static uint32_t benchRandom() {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 17;
+    bench_random_state ^= bench_random_state << 5;
+    return bench_random_state;
+}
+
+static std::atomic<bool> checking_ending_commands{false};
+
+// A game exiting the program during the check fails it, rather than the
+// bench ending with nothing printed and a status of 0.
+static void batchBenchEndedByCommand() {
+    if (checking_ending_commands) {
+        fprintf(stderr, "A command given to the batch ended the program\n");
+        _exit(1);
+    }
+}
+
+// Gives a batch the commands which would end the program in a game of its
+// own: saving (^X) must be ignored, and quitting (Q) must end only its game.
+static bool batchBenchCheckEndingCommands(uint32_t first_seed) {
+    checking_ending_commands = true;
+    (void) atexit(batchBenchEndedByCommand);
+
+    BenchCommand_t const ending_commands[] = {{CTRL_KEY('X'), ""}, {'Q', "y"}, {CTRL_KEY('K'), ""}};
+    bool const game_over[] = {false, true, false};
+    constexpr int count = sizeof(ending_commands) / sizeof(ending_commands[0]);
+
+    ObservationBatch_t *batch = observationBatchStart(count, first_seed, batchBenchSetup);
+
+    ObservationCommand_t commands[count];
+    for (int id = 0; id < count; id++) {
+        commands[id] = ObservationCommand_t{};
+        commands[id].command = ending_commands[id].command;
+        (void) strncpy(commands[id].arguments, ending_commands[id].arguments, OBSERVATION_COMMAND_ARGUMENTS);
+    }
+
+    observationBatchStep(*batch, commands);
+
+    bool ok = true;
+    for (int id = 0; id < count; id++) {
+        if (observationBatchGameOver(*batch, id) != game_over[id]) {
+            fprintf(stderr, "The game given command %d is %s\n", ending_commands[id].command, game_over[id] ? "still being played" : "over");
+            ok = false;
+        }
+    }
+
+    observationBatchEnd(batch);
+    checking_ending_commands = false;
+
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int first_seed = 1;
+    int game_count = 64;
+    int step_count = 1000;
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 's':
+                ok = toolOptionNumber(options, first_seed);
+                break;
+            case 'c':
+                ok = toolOptionNumber(options, game_count);
+                break;
+            case 'n':
+                ok = toolOptionNumber(options, step_count);
+                break;
+            case 'l':
+                // Validated here, as each game thread sets its own size
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToDimensions(value, bench_level_height, bench_level_width) && dungeonSetSize(bench_level_height, bench_level_width);
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    if (!batchBenchCheckEndingCommands((uint32_t) first_seed)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    ObservationBatch_t *batch = observationBatchStart(game_count, (uint32_t) first_seed, batchBenchSetup);
+    auto next_seed = (uint32_t) (first_seed + game_count);
+
+    std::vector<ObservationCommand_t> commands((size_t) game_count);
+    int games_over = 0;
+    uint64_t observation_bytes = 0;
+
+    for (int step = 0; step < step_count; step++) {
+        for (auto &command : commands) {
+            BenchCommand_t const &picked = bench_commands[benchRandom() % BENCH_COMMAND_COUNT];
+
+            command = ObservationCommand_t{};
+            command.command = picked.command;
+            (void) strncpy(command.arguments, picked.arguments, OBSERVATION_COMMAND_ARGUMENTS);
+        }
+
+        observationBatchStep(*batch, commands.data());
+
+        for (int id = 0; id < game_count; id++) {
+            observation_bytes += observationBatchObservation(*batch, id).size();
+
+            if (observationBatchGameOver(*batch, id)) {
+                games_over++;
+                (void) observationBatchRestart(*batch, id, next_seed++);
+            }
+        }
+    }
+
+    observationBatchEnd(batch);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double game_steps = (double) game_count * step_count;
+
+    printf("games,steps,seconds,steps_per_second,games_over,observation_bytes\n");
+    printf("%d,%d,%.3f,%.0f,%d,%llu\n", game_count, step_count, seconds, seconds > 0 ? game_steps / seconds : 0.0, games_over, (unsigned long long) observation_bytes);
+
+    return 0;
+}
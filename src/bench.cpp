@@ -0,0 +1,838 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Benchmarks: times seeded runs of the main game subsystems without a terminal
+
+#include "headers.h"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-bench [OPTIONS]
+
+Runs seeded microbenchmarks of the game subsystems and prints one CSV
+record per benchmark: name, operations, ns/op, allocations and bytes/op.
+Before they are timed, monsterDirections is checked against the classic
+directions for every offset, updateMonstersCoarse against the classic
+spread of the monsters' moves, and autosave for replaying the checkpoints
+made after a crash tore the journal, exiting with status 1 when they fail.
+
+Options:
+    -s NUMBER    Game seed (default: 1)
+    -x NUMBER    Multiply the operations of each benchmark by NUMBER (default: 1)
+    -b NAME      Only run the benchmark NAME
+    -f FILE      Save file used by the save/load/autosave benchmarks (default: bench.sav)
+    -l           List the benchmarks
+
+    -h           Display this message
+)";
+
+// Heap allocations made through operator new, counted for the whole process
+static std::atomic<uint64_t> allocation_count{0};
+static std::atomic<uint64_t> allocation_bytes{0};
+
+void *operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    free(memory);
+}
+
+// Options of the benchmarks
+static uint32_t bench_seed = 1;
+static int bench_scale = 1;
+static std::string bench_save_file = "bench.sav";
+
+// Character creation keys, as used by umoria-sim, then an escape for
+// every other prompt (e.g. the end of a monster recall, a -more-).
+static const char *character_creation_keys = "am\033aBenchmark\r ";
+static thread_local const char *pending_keys = nullptr;
+
+static int benchmarkKeySource() {
+    if (pending_keys != nullptr && *pending_keys != '\0') {
+        return *pending_keys++;
+    }
+    return ESCAPE;
+}
+
+// Per benchmark state, set up (untimed) before its operations are run
+typedef struct {
+    int dungeon_level; // Level to generate before the benchmark starts, 0 for the town
+    int operations;    // Operations per run, before scaling
+} BenchSetup_t;
+
+static thread_local uint32_t bench_random_state = 0;
+
+// xorshift32, for benchmark inputs, so the game RNG is only used by the game
+static uint32_t benchRandom(uint32_t range) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 17;
+    bench_random_state ^= bench_random_state << 5;
+    return bench_random_state % range;
+}
+
+static Coord_t benchRandomFloorTile() {
+    return Coord_t{1 + (int) benchRandom((uint32_t)(dg.height - 2)), 1 + (int) benchRandom((uint32_t)(dg.width - 2))};
+}
+
+static void benchGenerateCave(int) {
+    generateCave();
+}
+
+static void benchLos(int) {
+    Coord_t from = benchRandomFloorTile();
+    Coord_t to = Coord_t{from.y + (int) benchRandom(21) - 10, from.x + (int) benchRandom(41) - 20};
+
+    if (coordInBounds(to)) {
+        (void) los(from, to);
+    }
+}
+
+static void benchUpdateMonsters(int) {
+    // Keep the player alive, and the monsters coming
+    py.misc.current_hp = 30000;
+    game.character_is_dead = false;
+
+    updateMonsters(true);
+}
+
+// As updateMonsters, with the monsters out of sight moving in batches of
+// turns (the -e option). The turn goes on, for each batch to come round.
+static void benchUpdateMonstersCoarse(int) {
+    py.misc.current_hp = 30000;
+    game.character_is_dead = false;
+    game.coarse_distant_monsters = true;
+
+    dg.game_turn++;
+    updateMonsters(true);
+}
+
+// Checks that the coarse mode spreads out the moves of the monsters as the
+// classic one does. Over a span of turns a whole number of batches and of
+// every slow speed's period long, a monster must make as many moves at
+// each speed, whatever its ID, and on each turn of a batch as many of the
+// monsters must move as on any other, give or take one.
+static bool benchCheckDistantMovementRates() {
+    int batch = config::monsters::MON_DISTANT_BATCH_TURNS;
+    int32_t span = 27720 * batch; // 27720 is a multiple of each period, 2 to 12 turns
+
+    for (int16_t speed = -10; speed <= 10; speed++) {
+        for (int id = 0; id < batch; id++) {
+            int32_t classic_moves = 0;
+            int32_t coarse_moves = 0;
+
+            for (int32_t turn = 1; turn <= span; turn++) {
+                classic_moves += monsterMovementRate(speed, turn);
+                coarse_moves += monsterDistantMovementRate(id, speed, turn);
+            }
+
+            if (coarse_moves != classic_moves) {
+                fprintf(stderr, "Coarse monster %d at speed %d made %d moves in %d turns, not %d\n", id, speed, coarse_moves, span, classic_moves);
+                return false;
+            }
+        }
+    }
+
+    int monster_count = MON_TOTAL_ALLOCATIONS - config::monsters::MON_MIN_INDEX_ID;
+
+    for (int32_t turn = 1; turn <= batch; turn++) {
+        int moving = 0;
+        for (int id = config::monsters::MON_MIN_INDEX_ID; id < MON_TOTAL_ALLOCATIONS; id++) {
+            moving += (int) (monsterDistantMovementRate(id, 1, turn) > 0);
+        }
+
+        if (moving < monster_count / batch || moving > (monster_count + batch - 1) / batch) {
+            fprintf(stderr, "%d of %d coarse monsters move on turn %d of a batch of %d\n", moving, monster_count, turn, batch);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// A round of melee, a magic missile and the monsters' turn, next to a
+// monster put on a tile beside the player whenever the last one died.
+static void benchCombat(int) {
+    py.misc.current_hp = 30000;
+    game.character_is_dead = false;
+
+    static const int directions[3][3] = {{7, 8, 9}, {4, 5, 6}, {1, 2, 3}};
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            Coord_t coord = Coord_t{py.pos.y + dy, py.pos.x + dx};
+            if ((dy == 0 && dx == 0) || dg.floor[coord.y][coord.x].feature_id >= MIN_CLOSED_SPACE) {
+                continue;
+            }
+
+            if (dg.floor[coord.y][coord.x].creature_id <= 1) {
+                (void) monsterPlaceNew(coord, (int) benchRandom(monster_levels[10]), false);
+            }
+
+            playerAttackPosition(coord);
+            spellFireBolt(py.pos, directions[dy + 1][dx + 1], 5, MagicSpellFlags::MagicMissile, spell_names[0]);
+            updateMonsters(true);
+            return;
+        }
+    }
+}
+
+// The directions a monster tries, from a random spot of the level
+static void benchMoveDirections(int) {
+    int directions[5];
+    monsterDirectionsTowards((int) benchRandom((uint32_t) dg.height) - py.pos.y, (int) benchRandom((uint32_t) dg.width) - py.pos.x, directions);
+}
+
+// The switch monsterDirectionsTowards() replaced, kept to check its table against
+static void monsterDirectionsClassic(int y, int x, int *directions) {
+    int ay, ax, movement;
+
+    if (y < 0) {
+        movement = 8;
+        ay = -y;
+    } else {
+        movement = 0;
+        ay = y;
+    }
+    if (x > 0) {
+        movement += 4;
+        ax = x;
+    } else {
+        ax = -x;
+    }
+
+    // this has the advantage of preventing the diamond maneuver, also faster
+    if (ay > (ax << 1)) {
+        movement += 2;
+    } else if (ax > (ay << 1)) {
+        movement++;
+    }
+
+    switch (movement) {
+        case 0:
+            directions[0] = 9;
+            if (ay > ax) {
+                directions[1] = 8;
+                directions[2] = 6;
+                directions[3] = 7;
+                directions[4] = 3;
+            } else {
+                directions[1] = 6;
+                directions[2] = 8;
+                directions[3] = 3;
+                directions[4] = 7;
+            }
+            break;
+        case 1:
+        case 9:
+            directions[0] = 6;
+            if (y < 0) {
+                directions[1] = 3;
+
+                directions[2] = 9;
+                directions[3] = 2;
+                directions[4] = 8;
+            } else {
+                directions[1] = 9;
+                directions[2] = 3;
+                directions[3] = 8;
+                directions[4] = 2;
+            }
+            break;
+        case 2:
+        case 6:
+            directions[0] = 8;
+            if (x < 0) {
+                directions[1] = 9;
+                directions[2] = 7;
+                directions[3] = 6;
+                directions[4] = 4;
+            } else {
+                directions[1] = 7;
+                directions[2] = 9;
+                directions[3] = 4;
+                directions[4] = 6;
+            }
+            break;
+        case 4:
+            directions[0] = 7;
+            if (ay > ax) {
+                directions[1] = 8;
+                directions[2] = 4;
+                directions[3] = 9;
+                directions[4] = 1;
+            } else {
+                directions[1] = 4;
+                directions[2] = 8;
+                directions[3] = 1;
+                directions[4] = 9;
+            }
+            break;
+        case 5:
+        case 13:
+            directions[0] = 4;
+            if (y < 0) {
+                directions[1] = 1;
+                directions[2] = 7;
+                directions[3] = 2;
+                directions[4] = 8;
+            } else {
+                directions[1] = 7;
+                directions[2] = 1;
+                directions[3] = 8;
+                directions[4] = 2;
+            }
+            break;
+        case 8:
+            directions[0] = 3;
+            if (ay > ax) {
+                directions[1] = 2;
+                directions[2] = 6;
+                directions[3] = 1;
+                directions[4] = 9;
+            } else {
+                directions[1] = 6;
+                directions[2] = 2;
+                directions[3] = 9;
+                directions[4] = 1;
+            }
+            break;
+        case 10:
+        case 14:
+            directions[0] = 2;
+            if (x < 0) {
+                directions[1] = 3;
+                directions[2] = 1;
+                directions[3] = 6;
+                directions[4] = 4;
+            } else {
+                directions[1] = 1;
+                directions[2] = 3;
+                directions[3] = 4;
+                directions[4] = 6;
+            }
+            break;
+        case 12:
+            directions[0] = 1;
+            if (ay > ax) {
+                directions[1] = 2;
+                directions[2] = 4;
+                directions[3] = 3;
+                directions[4] = 7;
+            } else {
+                directions[1] = 4;
+                directions[2] = 2;
+                directions[3] = 7;
+                directions[4] = 3;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Checks monsterDirectionsTowards() against the switch it replaced, for
+// every offset between two tiles of the largest level, before it is timed.
+static bool benchCheckMoveDirections() {
+    for (int y = -(LEVEL_MAX_HEIGHT - 1); y <= LEVEL_MAX_HEIGHT - 1; y++) {
+        for (int x = -(LEVEL_MAX_WIDTH - 1); x <= LEVEL_MAX_WIDTH - 1; x++) {
+            int expected[5] = {0, 0, 0, 0, 0};
+            int directions[5] = {0, 0, 0, 0, 0};
+
+            monsterDirectionsClassic(y, x, expected);
+            monsterDirectionsTowards(y, x, directions);
+
+            if (!std::equal(std::begin(expected), std::end(expected), std::begin(directions))) {
+                fprintf(stderr, "monsterDirectionsTowards(%d, %d) differs from the classic directions\n", y, x);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A turn of the monsters with a swarm of breeders around the player, kept
+// breeding (their limit per level is lifted) until the monster list is full.
+static void benchBreeders(int) {
+    py.misc.current_hp = 30000;
+    game.character_is_dead = false;
+    monster_multiply_total = 0;
+
+    static thread_local int breeder_id = -1;
+    if (breeder_id < 0) {
+        for (int id = 0; id < MON_MAX_CREATURES; id++) {
+            if ((creatures_list[id].movement & config::monsters::move::CM_MULTIPLY) != 0u) {
+                breeder_id = id;
+                break;
+            }
+        }
+    }
+
+    Coord_t coord = Coord_t{py.pos.y + (int) benchRandom(11) - 5, py.pos.x + (int) benchRandom(11) - 5};
+    if (coordInBounds(coord) && dg.floor[coord.y][coord.x].feature_id <= MAX_OPEN_SPACE && dg.floor[coord.y][coord.x].creature_id == 0) {
+        (void) monsterPlaceNew(coord, breeder_id, false);
+    }
+
+    dg.game_turn++;
+    updateMonsters(true);
+}
+
+// A step of the player's light to a neighbouring tile, as on a run: keeping
+// to a direction until the way is blocked, then taking a random new one.
+static void benchMoveLight(int) {
+    py.carrying_light = true;
+
+    static thread_local Coord_t direction = Coord_t{0, 1};
+
+    Coord_t coord = Coord_t{py.pos.y + direction.y, py.pos.x + direction.x};
+    if (!coordInBounds(coord) || dg.floor[coord.y][coord.x].feature_id > MAX_OPEN_SPACE || dg.floor[coord.y][coord.x].creature_id > 1) {
+        do {
+            direction = Coord_t{(int) benchRandom(3) - 1, (int) benchRandom(3) - 1};
+        } while (direction.y == 0 && direction.x == 0);
+        return;
+    }
+
+    dungeonMoveCreatureRecord(py.pos, coord);
+    dungeonMoveCharacterLight(py.pos, coord);
+    py.pos = coord;
+}
+
+// Lights the room blocks of random tiles, as walking into rooms does
+static void benchLightRoom(int) {
+    dungeonLightRoom(benchRandomFloorTile());
+}
+
+// A step of a corridor run. Whenever the last run stopped, the player is put
+// on a random corridor tile and runs off in a direction open from there.
+// Only the player moves, the monsters don't get a turn.
+static void benchRun(int) {
+    py.misc.current_hp = 30000;
+    game.character_is_dead = false;
+    py.carrying_light = true;
+
+    if (py.running_tracker != 0) {
+        playerRunAndFind();
+        return;
+    }
+
+    Coord_t coord = benchRandomFloorTile();
+    Coord_t next = coord;
+    int direction = 1 + (int) benchRandom(9);
+
+    if (direction == 5 || dg.floor[coord.y][coord.x].feature_id != TILE_CORR_FLOOR || dg.floor[coord.y][coord.x].creature_id != 0 || !playerMovePosition(direction, next) || dg.floor[next.y][next.x].feature_id != TILE_CORR_FLOOR) {
+        return;
+    }
+
+    dungeonMoveCreatureRecord(py.pos, coord);
+    py.pos = coord;
+    playerFindInitialize(direction);
+}
+
+// Trap and door detection over the player's panel
+static void benchDetect(int operation) {
+    if (operation == 0) {
+        (void) coordOutsidePanel(py.pos, true);
+    }
+    (void) spellDetectTrapsWithinVicinity();
+    (void) spellDetectSecretDoorssWithinVicinity();
+}
+
+static thread_local int bench_treasure_id = 0;
+
+static void benchMagicalAbility(int) {
+    int object_id = itemGetRandomObjectId(dg.current_level, false);
+    inventoryItemCopyTo(sorted_objects[object_id], game.treasure.list[bench_treasure_id]);
+
+    magicTreasureMagicalAbility(bench_treasure_id, dg.current_level);
+}
+
+static void benchItemDescription(int operation) {
+    Inventory_t item{};
+    inventoryItemCopyTo(sorted_objects[operation % MAX_DUNGEON_OBJECTS], item);
+
+    obj_desc_t description = {'\0'};
+    itemDescription(description, item, true);
+}
+
+// As the inventory screen does, describing the same page of items again and again
+static void benchItemDescriptionRedraw(int operation) {
+    Inventory_t item{};
+    inventoryItemCopyTo(sorted_objects[operation % PlayerEquipment::Wield], item);
+
+    obj_desc_t description = {'\0'};
+    itemDescription(description, item, true);
+}
+
+// Picks up random objects until the pack is full, then throws random ones
+// away until it is empty, moving the rest of the pack up or down each time.
+static thread_local bool bench_pack_filling = true;
+
+static void benchInventory(int) {
+    if (py.pack.unique_items == 0) {
+        bench_pack_filling = true;
+    } else if (py.pack.unique_items >= PlayerEquipment::Wield - 1) {
+        bench_pack_filling = false;
+    }
+
+    if (bench_pack_filling) {
+        Inventory_t item{};
+        inventoryItemCopyTo(sorted_objects[itemGetRandomObjectId(dg.current_level, false)], item);
+        (void) inventoryCarryItem(item);
+    } else {
+        inventoryDestroyItem((int) benchRandom((uint32_t) py.pack.unique_items));
+    }
+}
+
+static void benchRecalculateBonuses(int) {
+    playerRecalculateBonuses();
+}
+
+static void benchStoreMaintenance(int) {
+    storeMaintenance();
+}
+
+static void benchSaveGame(int) {
+    // Every operation writes a new save file, of a character still
+    // alive (saving ends the game, by setting the turn to -1).
+    game.character_saved = false;
+    dg.game_turn = 1;
+    (void) unlink(bench_save_file.c_str());
+
+    (void) saveGame();
+}
+
+static void benchLoadGame(int) {
+    bool generate = false;
+
+    dg.game_turn = -1;
+    (void) loadGame(generate);
+}
+
+// A checkpoint of a game which has changed since the last one, mostly
+// as a journal record, sometimes folding the journal into a new save file.
+static void benchAutosave(int) {
+    py.misc.au++;
+    dg.game_turn++;
+
+    autosaveGame();
+}
+
+// The autosave journal check, each step on a new thread of its own, as a
+// new process would be after a crash. The writer finishes when it ends.
+static bool bench_journal_ok = true;
+
+static void benchJournalStart() {
+    pending_keys = character_creation_keys;
+    (void) terminalInitializeHeadless(benchmarkKeySource);
+    config::files::save_game = bench_save_file;
+    setupSimulatedGame(bench_seed);
+}
+
+static void benchJournalNewGame() {
+    benchJournalStart();
+
+    dg.game_turn = 1; // a game under way, the save isn't only the monster memory
+    autosaveGame(); // the whole save file
+    py.misc.au = 1111;
+    autosaveGame(); // a journal record
+}
+
+static void benchJournalLoad(int32_t gold, int32_t new_gold) {
+    benchJournalStart();
+
+    bool generate = false;
+    dg.game_turn = -1;
+    if (!loadGame(generate) || py.misc.au != gold) {
+        fprintf(stderr, "The autosave journal gave %d gold, not %d\n", py.misc.au, gold);
+        bench_journal_ok = false;
+        return;
+    }
+
+    if (new_gold != 0) {
+        py.misc.au = new_gold;
+        autosaveGame();
+    }
+}
+
+// Checks that the checkpoints autosaved after a crash, which left a torn
+// record at the end of the journal, are replayed on the next load.
+static bool benchCheckAutosaveJournal() {
+    std::string journal_filename = bench_save_file + ".journal";
+    (void) unlink(bench_save_file.c_str());
+    (void) unlink(journal_filename.c_str());
+
+    toolRunOnNewThread(benchJournalNewGame);
+
+    // The start of a record the crash cut short
+    FILE *journal = fopen(journal_filename.c_str(), "ab");
+    if (journal != nullptr) {
+        (void) fwrite("\x00\x10\x00\x00torn", 1, 8, journal);
+        (void) fclose(journal);
+    }
+
+    toolRunOnNewThread([]() { benchJournalLoad(1111, 2222); });
+    if (bench_journal_ok) {
+        toolRunOnNewThread([]() { benchJournalLoad(2222, 0); });
+    }
+
+    (void) unlink(bench_save_file.c_str());
+    (void) unlink(journal_filename.c_str());
+
+    return bench_journal_ok;
+}
+
+// Takes a snapshot of the game and goes back to it, as an undo would
+static void benchSnapshot(int) {
+    gameSnapshotTake();
+    (void) gameSnapshotRestore();
+}
+
+static void benchStateHash(int) {
+    (void) gameHashState();
+}
+
+static void benchObservation(int) {
+    static thread_local std::vector<uint8_t> buffer;
+    observationBuild(buffer);
+}
+
+// A breath's worth of damage rolls, as the two dice modes roll them
+constexpr int BENCH_DICE_ROLLS = 64;
+static Dice_t const bench_dice = Dice_t{4, 8};
+
+static void benchDiceRoll(int) {
+    static thread_local int rolls[BENCH_DICE_ROLLS];
+    for (auto &roll : rolls) {
+        roll = diceRoll(bench_dice);
+    }
+}
+
+static void benchDiceRollBatched(int) {
+    static thread_local int rolls[BENCH_DICE_ROLLS];
+    diceRollMany(bench_dice, rolls, BENCH_DICE_ROLLS);
+}
+
+static void benchNormalDistribution(int) {
+    (void) randomNumberNormalDistribution(100, 25);
+}
+
+static void benchMemoryRecall(int operation) {
+    (void) memoryRecall(operation % MON_MAX_CREATURES);
+}
+
+typedef struct {
+    const char *name;
+    BenchSetup_t setup;
+    void (*operation)(int operation);
+} Benchmark_t;
+
+static Benchmark_t benchmarks[] = {
+    {"generateCave", {10, 200}, benchGenerateCave},
+    {"los", {10, 1000000}, benchLos},
+    {"updateMonsters", {20, 5000}, benchUpdateMonsters},
+    {"updateMonstersCoarse", {20, 5000}, benchUpdateMonstersCoarse},
+    {"combat", {10, 20000}, benchCombat},
+    {"breeders", {10, 5000}, benchBreeders},
+    {"monsterDirections", {10, 5000000}, benchMoveDirections},
+    {"moveLight", {10, 1000000}, benchMoveLight},
+    {"lightRoom", {10, 1000000}, benchLightRoom},
+    {"run", {10, 1000000}, benchRun},
+    {"detect", {10, 200000}, benchDetect},
+    {"magicTreasureMagicalAbility", {20, 200000}, benchMagicalAbility},
+    {"itemDescription", {0, 200000}, benchItemDescription},
+    {"itemDescriptionRedraw", {0, 200000}, benchItemDescriptionRedraw},
+    {"inventory", {10, 1000000}, benchInventory},
+    {"playerRecalculateBonuses", {0, 1000000}, benchRecalculateBonuses},
+    {"storeMaintenance", {0, 5000}, benchStoreMaintenance},
+    {"saveGame", {10, 500}, benchSaveGame},
+    {"loadGame", {10, 500}, benchLoadGame},
+    {"autosave", {10, 5000}, benchAutosave},
+    {"snapshot", {10, 20000}, benchSnapshot},
+    {"stateHash", {10, 20000}, benchStateHash},
+    {"observation", {10, 20000}, benchObservation},
+    {"memoryRecall", {0, 20000}, benchMemoryRecall},
+    {"diceRoll", {0, 200000}, benchDiceRoll},
+    {"normalDistribution", {0, 5000000}, benchNormalDistribution},
+    {"diceRollBatched", {0, 200000}, benchDiceRollBatched},
+};
+constexpr int BENCHMARK_COUNT = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+// Result of a single benchmark
+typedef struct {
+    int operations;
+    double ns_per_op;
+    double allocations_per_op;
+    double bytes_per_op;
+} BenchResult_t;
+
+// Runs one benchmark, on a new thread of its own
+static void runBenchmark(Benchmark_t const &benchmark, BenchResult_t &result) {
+    pending_keys = character_creation_keys;
+    bench_random_state = bench_seed * 2654435761u + 1;
+
+    (void) terminalInitializeHeadless(benchmarkKeySource);
+    config::files::save_game = bench_save_file;
+
+    setupSimulatedGame(bench_seed);
+
+    if (benchmark.setup.dungeon_level > 0) {
+        dg.current_level = (int16_t) benchmark.setup.dungeon_level;
+        generateCave();
+    }
+
+    bench_treasure_id = popt();
+
+    // The autosaves start from a whole save file of their own
+    if (benchmark.operation == benchAutosave) {
+        dg.game_turn = 1;
+        (void) unlink(bench_save_file.c_str());
+        (void) unlink((bench_save_file + ".journal").c_str());
+    }
+
+    // The load benchmark needs something to load
+    if (benchmark.operation == benchLoadGame) {
+        dg.game_turn = 1;
+        (void) unlink(bench_save_file.c_str());
+        (void) saveGame();
+    }
+
+    if (benchmark.operation == benchDiceRollBatched) {
+        setRandomMode(RandomMode::Counter);
+        setDiceMode(DiceMode::Batched);
+    }
+
+    result.operations = benchmark.setup.operations * bench_scale;
+
+    uint64_t allocations = allocation_count.load();
+    uint64_t bytes = allocation_bytes.load();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < result.operations; i++) {
+        benchmark.operation(i);
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    result.ns_per_op = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / result.operations;
+    result.allocations_per_op = (double) (allocation_count.load() - allocations) / result.operations;
+    result.bytes_per_op = (double) (allocation_bytes.load() - bytes) / result.operations;
+}
+
+int main(int argc, char *argv[]) {
+    std::string only_benchmark;
+    int seed = 1;
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 'l':
+                for (auto const &benchmark : benchmarks) {
+                    printf("%s\n", benchmark.name);
+                }
+                return 0;
+            case 's':
+                ok = toolOptionNumber(options, seed);
+                break;
+            case 'x':
+                ok = toolOptionNumber(options, bench_scale);
+                break;
+            case 'b':
+                value = toolOptionValue(options);
+                ok = value != nullptr;
+                if (ok) {
+                    only_benchmark = value;
+                }
+                break;
+            case 'f':
+                value = toolOptionValue(options);
+                ok = value != nullptr;
+                if (ok) {
+                    bench_save_file = value;
+                }
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    bench_seed = (uint32_t) seed;
+
+    printf("benchmark,seed,operations,ns_per_op,allocations_per_op,bytes_per_op\n");
+
+    bool found = false;
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        Benchmark_t const &benchmark = benchmarks[i];
+        if (!only_benchmark.empty() && only_benchmark != benchmark.name) {
+            continue;
+        }
+        found = true;
+
+        if (benchmark.operation == benchMoveDirections && !benchCheckMoveDirections()) {
+            return 1;
+        }
+        if (benchmark.operation == benchUpdateMonstersCoarse && !benchCheckDistantMovementRates()) {
+            return 1;
+        }
+        if (benchmark.operation == benchAutosave && !benchCheckAutosaveJournal()) {
+            return 1;
+        }
+
+        BenchResult_t result{};
+        toolRunOnNewThread([&]() { runBenchmark(benchmark, result); });
+
+        // Once the thread has ended, and with it any autosave being written
+        if (benchmark.operation == benchSaveGame || benchmark.operation == benchLoadGame || benchmark.operation == benchAutosave) {
+            (void) unlink(bench_save_file.c_str());
+            (void) unlink((bench_save_file + ".journal").c_str());
+        }
+
+        printf("%s,%u,%d,%.1f,%.2f,%.1f\n", benchmark.name, bench_seed, result.operations, result.ns_per_op, result.allocations_per_op, result.bytes_per_op);
+        (void) fflush(stdout);
+    }
+
+    if (!found) {
+        fprintf(stderr, "Unknown benchmark '%s', use -l to list them\n", only_benchmark.c_str());
+        return 1;
+    }
+
+    return 0;
+}
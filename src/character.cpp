@@ -137,6 +137,12 @@ static void characterChooseRace() {
         moveCursor(Coord_t{20, 30});
         const char key = getKeyInput();
 
+        // A headless game whose input ran out takes the first race
+        if (eof_flag != 0) {
+            id = 0;
+            break;
+        }
+
         id = key - 97; // ASCII `a`, setting id between 0 and 7
         if (id >= 0 && id < PLAYER_MAX_RACES) {
             break;
@@ -277,7 +283,7 @@ static void characterSetGender() {
             playerSetGender(false);
             putString("Female", Coord_t{4, 15});
             break;
-        } else if (key == 'm' || key == 'M') {
+        } else if (key == 'm' || key == 'M' || eof_flag != 0) { // Also when a headless game's input ran out
             playerSetGender(true);
             putString("Male", Coord_t{4, 15});
             break;
@@ -423,7 +429,8 @@ static void characterGetClass() {
         moveCursor(Coord_t{20, 31});
         const char key = getKeyInput();
 
-        int id = key - 97; // ASCII `a`, setting id to 0-5
+        // A headless game whose input ran out takes the first class
+        int id = eof_flag != 0 ? 0 : key - 97; // ASCII `a`, setting id to 0-5
         if (id >= 0 && id < class_count) {
             generateCharacterClass(class_list[id]);
             break;
@@ -511,7 +518,11 @@ void characterCreate() {
 
     putStringClearToEOL("[ press any key to continue, or Q to exit ]", Coord_t{23, 17});
     if (getKeyInput() == 'Q') {
-        exitProgram();
+        // A game sharing the process quits as though its input had run out
+        if (terminalMayExitProgram()) {
+            exitProgram();
+        }
+        eof_flag++;
     }
     eraseLine(Coord_t{23, 0});
 }
@@ -0,0 +1,139 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Melee duels of the player against a creature, without any UI
+
+#include "headers.h"
+
+// The hit points the player loses to an attack of `attack_type` doing
+// `damage`, as in executeAttackOnPlayer() and the damage functions it calls.
+// The armour an acid attack spends itself on instead isn't played out.
+static int combatAttackDamage(int attack_type, int damage) {
+    switch (attack_type) {
+        case 1: // Normal attack
+            return damage - ((py.misc.ac + py.misc.magical_ac) * damage) / 200;
+        case 5: // Fire attack
+            if (py.flags.resistant_to_fire) {
+                damage = damage / 3;
+            }
+            if (py.flags.heat_resistance > 0) {
+                damage = damage / 3;
+            }
+            return damage;
+        case 6: // Acid attack
+            return py.flags.resistant_to_acid ? damage / 3 : damage;
+        case 7: // Cold attack
+            if (py.flags.resistant_to_cold) {
+                damage = damage / 3;
+            }
+            if (py.flags.cold_resistance > 0) {
+                damage = damage / 3;
+            }
+            return damage;
+        case 8: // Lightning attack
+            return py.flags.resistant_to_light ? damage / 3 : damage;
+        case 2:  // Lose Strength
+        case 3:  // Confusion attack
+        case 4:  // Fear attack
+        case 9:  // Corrosion attack
+        case 10: // Blindness attack
+        case 11: // Paralysis attack
+        case 14: // Poison
+        case 15: // Lose dexterity
+        case 16: // Lose constitution
+        case 17: // Lose intelligence
+        case 18: // Lose wisdom
+            return damage;
+        default:
+            return 0;
+    }
+}
+
+typedef struct {
+    int paralysis;
+    int afraid;
+} CombatPlayerState_t;
+
+// The paralysis and fear of an attack which hit, as executeAttackOnPlayer() rolls them
+static void combatAttackEffects(int attack_type, uint8_t creature_level, CombatPlayerState_t &state) {
+    if (attack_type == 4) {
+        if (!playerSavingThrow()) {
+            state.afraid += state.afraid < 1 ? 3 + randomNumber((int) creature_level) : 3;
+        }
+    } else if (attack_type == 11) {
+        if (!playerSavingThrow() && state.paralysis < 1 && !py.flags.free_action) {
+            state.paralysis = randomNumber((int) creature_level) + 3;
+        }
+    }
+}
+
+// Fights a duel of the player, at full health, against a new creature of
+// `creature_id`, lit and awake next to them, for at most `max_turns` turns.
+// The player strikes first, with all their blows a turn, then the creature
+// makes its attacks as many times a turn as its speed gives it moves.
+CombatDuel_t combatDuel(int creature_id, int32_t max_turns) {
+    Creature_t const &creature = creatures_list[creature_id];
+    Inventory_t const &weapon = py.inventory[PlayerEquipment::Wield];
+
+    int blows, total_to_hit;
+    playerCalculateToHitBlows(weapon.category_id, weapon.weight, blows, total_to_hit);
+    int base_to_hit = playerCalculateBaseToHit(true, total_to_hit);
+
+    // As monsterPlaceNew() has it, relative to the player's speed
+    auto speed = (int16_t) (creature.speed - 10 + py.flags.speed);
+
+    CombatDuel_t duel{};
+    duel.player_hp = py.misc.max_hp;
+    duel.creature_hp = monsterRollHitPoints(creature_id);
+
+    CombatPlayerState_t state{};
+
+    for (duel.turns = 1; duel.turns <= max_turns; duel.turns++) {
+        if (state.paralysis > 0 || state.afraid > 0) {
+            state.paralysis = std::max(state.paralysis - 1, 0);
+            state.afraid = std::max(state.afraid - 1, 0);
+        } else {
+            for (int blow = 0; blow < blows; blow++) {
+                if (!playerRollToHit(base_to_hit, (int) py.misc.level, total_to_hit, (int) creature.ac, PlayerClassLevelAdj::BTH)) {
+                    continue;
+                }
+
+                int critical;
+                duel.creature_hp -= playerRollBlowDamage(weapon, total_to_hit, creature_id, critical);
+
+                // As monsterTakeHit() has it
+                if (duel.creature_hp < 0) {
+                    duel.player_won = true;
+                    return duel;
+                }
+            }
+        }
+
+        for (int moves = monsterMovementRate(speed, duel.turns); moves > 0; moves--) {
+            for (auto damage_type_id : creature.damage) {
+                if (damage_type_id == 0) {
+                    break;
+                }
+
+                MonsterAttack_t const &attack = monster_attacks[damage_type_id];
+                if (!playerRollAttackHits(attack.type_id, creature.level)) {
+                    continue;
+                }
+
+                duel.player_hp -= combatAttackDamage(attack.type_id, diceRoll(attack.dice));
+                combatAttackEffects(attack.type_id, creature.level, state);
+
+                // As playerTakesHit() has it
+                if (duel.player_hp < 0) {
+                    duel.player_died = true;
+                    return duel;
+                }
+            }
+        }
+    }
+
+    duel.turns = max_turns;
+    return duel;
+}
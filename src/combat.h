@@ -0,0 +1,28 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+// Combat kernel: a melee duel to the death of the player, as this thread's
+// game has them (their level, weapon and armour), against a new creature,
+// for balance estimates. The blows and attacks are rolled with the game's own
+// formulas (playerRollToHit(), playerRollBlowDamage(), playerRollAttackHits()
+// and the damage of executeAttackOnPlayer()), but nothing is printed, and
+// neither the player nor the dungeon is changed, so it can be run millions
+// of times over.
+//
+// Only the hit points lost to each attack are played out, and the turns the
+// player loses to paralysis and fear. Other side effects, such as drained
+// stats, stolen gold or the player's belongings being damaged, are not.
+
+typedef struct {
+    bool player_won;     // The creature was slain
+    bool player_died;    // Neither, when the duel ran out of turns
+    int32_t turns;       // Game turns fought
+    int16_t player_hp;   // Left at the end, from the player's maximum
+    int16_t creature_hp; // Left at the end
+} CombatDuel_t;
+
+CombatDuel_t combatDuel(int creature_id, int32_t max_turns);
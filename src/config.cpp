@@ -21,22 +21,22 @@ namespace config {
         const std::string death_tomb = "data/death_tomb.txt";
         const std::string death_royal = "data/death_royal.txt";
         const std::string scores = "scores.dat";
-        std::string save_game = "game.sav";
+        thread_local std::string save_game = "game.sav";
     } // namespace files
 
     // Game options as set on startup and with `=` set options command -CJS-
     namespace options {
-        bool display_counts = true;          // Display rest/repeat counts
-        bool find_bound = false;             // Print yourself on a run (slower)
-        bool run_cut_corners = true;         // Cut corners while running
-        bool run_examine_corners = true;     // Check corners while running
-        bool run_ignore_doors = false;       // Run through open doors
-        bool run_print_self = false;         // Stop running when the map shifts
-        bool highlight_seams = false;        // Highlight magma and quartz veins
-        bool prompt_to_pickup = false;       // Prompt to pick something up
-        bool use_roguelike_keys = false;     // Use classic Roguelike keys
-        bool show_inventory_weights = false; // Display weights in inventory
-        bool error_beep_sound = true;        // Beep for invalid characters
+        thread_local bool display_counts = true;          // Display rest/repeat counts
+        thread_local bool find_bound = false;             // Print yourself on a run (slower)
+        thread_local bool run_cut_corners = true;         // Cut corners while running
+        thread_local bool run_examine_corners = true;     // Check corners while running
+        thread_local bool run_ignore_doors = false;       // Run through open doors
+        thread_local bool run_print_self = false;         // Stop running when the map shifts
+        thread_local bool highlight_seams = false;        // Highlight magma and quartz veins
+        thread_local bool prompt_to_pickup = false;       // Prompt to pick something up
+        thread_local bool use_roguelike_keys = false;     // Use classic Roguelike keys
+        thread_local bool show_inventory_weights = false; // Display weights in inventory
+        thread_local bool error_beep_sound = true;        // Beep for invalid characters
     } // namespace options
 
     // Dungeon generation values
@@ -155,6 +155,7 @@ namespace config {
     namespace monsters {
         const uint8_t MON_CHANCE_OF_NEW = 160;            // 1/x chance of new monster each round
         const uint8_t MON_MAX_SIGHT = 20;                 // Maximum dis a creature can be seen
+        const uint8_t MON_DISTANT_BATCH_TURNS = 4;        // Turns moved at once by creatures out of sight (-e option)
         const uint8_t MON_MAX_SPELL_CAST_DISTANCE = 20;   // Maximum dis creature spell can be cast
         const uint8_t MON_MAX_MULTIPLY_PER_LEVEL = 75;    // Maximum reproductions on a level
         const uint8_t MON_MULTIPLY_ADJUST = 7;            // High value slows multiplication
@@ -20,21 +20,21 @@ namespace config {
         extern const std::string death_tomb;
         extern const std::string death_royal;
         extern const std::string scores;
-        extern std::string save_game;
+        extern thread_local std::string save_game;
     }
 
     namespace options {
-        extern bool display_counts;
-        extern bool find_bound;
-        extern bool run_cut_corners;
-        extern bool run_examine_corners;
-        extern bool run_ignore_doors;
-        extern bool run_print_self;
-        extern bool highlight_seams;
-        extern bool prompt_to_pickup;
-        extern bool use_roguelike_keys;
-        extern bool show_inventory_weights;
-        extern bool error_beep_sound;
+        extern thread_local bool display_counts;
+        extern thread_local bool find_bound;
+        extern thread_local bool run_cut_corners;
+        extern thread_local bool run_examine_corners;
+        extern thread_local bool run_ignore_doors;
+        extern thread_local bool run_print_self;
+        extern thread_local bool highlight_seams;
+        extern thread_local bool prompt_to_pickup;
+        extern thread_local bool use_roguelike_keys;
+        extern thread_local bool show_inventory_weights;
+        extern thread_local bool error_beep_sound;
     }
 
     namespace dungeon {
@@ -145,6 +145,7 @@ namespace config {
     namespace monsters {
         extern const uint8_t MON_CHANCE_OF_NEW;
         extern const uint8_t MON_MAX_SIGHT;
+        extern const uint8_t MON_DISTANT_BATCH_TURNS;
         extern const uint8_t MON_MAX_SPELL_CAST_DISTANCE;
         extern const uint8_t MON_MAX_MULTIPLY_PER_LEVEL;
         extern const uint8_t MON_MULTIPLY_ADJUST;
@@ -142,7 +142,7 @@
 //  Area of affect (area_affect_radius) :  Max range that creature is able to
 //                          "notice" the player.
 
-Creature_t creatures_list[MON_MAX_CREATURES] = {
+constexpr Creature_t creatures_list[MON_MAX_CREATURES] = {
     {"Filthy Street Urchin",      0x0012000AL, 0x00000000L, 0x2034,     0,  40,  4,   1, 11, 'p', {  1,  4}, { 72, 148,   0,   0},   0},
     {"Blubbering Idiot",          0x0012000AL, 0x00000000L, 0x2030,     0,   0,  6,   1, 11, 'p', {  1,  2}, { 79,   0,   0,   0},   0},
     {"Pitiful-Looking Beggar",    0x0012000AL, 0x00000000L, 0x2030,     0,  40, 10,   1, 11, 'p', {  1,  4}, { 72,   0,   0,   0},   0},
@@ -434,7 +434,7 @@ Creature_t creatures_list[MON_MAX_CREATURES] = {
 };
 
 // ERROR: attack #35 is no longer used
-MonsterAttack_t monster_attacks[MON_ATTACK_TYPES] = {
+const MonsterAttack_t monster_attacks[MON_ATTACK_TYPES] = {
     // 0
     {0, 0, {0, 0}},
     {1, 1, {1, 2}},
@@ -663,3 +663,45 @@ MonsterAttack_t monster_attacks[MON_ATTACK_TYPES] = {
     {23, 5, {1, 3}},
     {24, 5, {0, 0}},
 };
+
+// clang-format on
+
+// The endgame creatures must come last, as they are left out of
+// `monster_levels` by their position in the list.
+static constexpr bool endgameCreaturesLast() {
+    bool endgame = false;
+    for (auto const &creature : creatures_list) {
+        if (creature.level > MON_MAX_LEVELS) {
+            endgame = true;
+        } else if (endgame) {
+            return false;
+        }
+    }
+    return endgame;
+}
+static_assert(endgameCreaturesLast(), "the endgame creatures must be at the end of creatures_list");
+
+typedef struct {
+    int16_t levels[MON_MAX_LEVELS + 1];
+} MonsterLevels_t;
+
+// Number of creatures of each level and below, the endgame creatures
+// aside, built from creatures_list at compile time.
+static constexpr MonsterLevels_t monsterLevels() {
+    MonsterLevels_t table{};
+
+    for (auto const &creature : creatures_list) {
+        if (creature.level <= MON_MAX_LEVELS) {
+            table.levels[creature.level]++;
+        }
+    }
+
+    for (int i = 1; i <= MON_MAX_LEVELS; i++) {
+        table.levels[i] += table.levels[i - 1];
+    }
+
+    return table;
+}
+
+static constexpr MonsterLevels_t monster_levels_table = monsterLevels();
+const int16_t (&monster_levels)[MON_MAX_LEVELS + 1] = monster_levels_table.levels;
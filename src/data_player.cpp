@@ -9,7 +9,7 @@
 #include "headers.h"
 
 // Class rank titles for different levels
-ClassRankTitle_t class_rank_titles[PLAYER_MAX_CLASSES][PLAYER_MAX_LEVEL] = {
+const ClassRankTitle_t class_rank_titles[PLAYER_MAX_CLASSES][PLAYER_MAX_LEVEL] = {
     // Warrior
     {"Rookie",       "Private",      "Soldier",      "Mercenary",
      "Veteran(1st)", "Veteran(2nd)", "Veteran(3rd)", "Warrior(1st)",
@@ -83,7 +83,7 @@ ClassRankTitle_t class_rank_titles[PLAYER_MAX_CLASSES][PLAYER_MAX_LEVEL] = {
 // Racial Bases for:
 //   dis, chance_in_search, stealth_factor, fos, bth, bth_with_bows, saving_throw_base,
 //   hit_die, infra, exp base, choice-classes
-Race_t character_races[PLAYER_MAX_RACES] = {
+const Race_t character_races[PLAYER_MAX_RACES] = {
     {
         "Human", 0,  0,  0,  0,  0,  0,
         14,  6, 72,  6,180, 25, 66,  4,150, 20,
@@ -127,7 +127,7 @@ Race_t character_races[PLAYER_MAX_RACES] = {
 };
 
 // Background information
-Background_t character_backgrounds[PLAYER_MAX_BACKGROUNDS] = {
+const Background_t character_backgrounds[PLAYER_MAX_BACKGROUNDS] = {
     {"You are the illegitimate and unacknowledged child ",   10,  1,  2,  25},
     {"You are the illegitimate but acknowledged child ",     20,  1,  2,  35},
     {"You are one of several children ",                     95,  1,  2,  45},
@@ -259,7 +259,7 @@ Background_t character_backgrounds[PLAYER_MAX_BACKGROUNDS] = {
 };
 
 // Classes.
-Class_t classes[PLAYER_MAX_CLASSES] = {
+const Class_t classes[PLAYER_MAX_CLASSES] = {
     // class   hp dis src stl fos bth btb sve  s   i   w   d  co  ch  spell             exp  spl
     {"Warrior", 9, 25, 14, 1, 38, 70, 55, 18,  5, -2, -2,  2,  2, -1, config::spells::SPELL_TYPE_NONE,    0, 0},
     {"Mage",    0, 30, 16, 2, 20, 34, 20, 36, -5,  3,  0,  1, -2,  1, config::spells::SPELL_TYPE_MAGE,   30, 1},
@@ -274,7 +274,7 @@ Class_t classes[PLAYER_MAX_CLASSES] = {
 // CLASS_MISC_HIT is identical to py_class_level_adj::CLASS_SAVE, which takes advantage of
 // the fact that the save values are independent of the class.
 // Columns: bth, bth_with_bows, device, disarm, save/misc hit
-int16_t class_level_adj[PLAYER_MAX_CLASSES][CLASS_MAX_LEVEL_ADJUST] = {
+const int16_t class_level_adj[PLAYER_MAX_CLASSES][CLASS_MAX_LEVEL_ADJUST] = {
     { 4, 4, 2, 2, 3 }, // Warrior
     { 2, 2, 4, 3, 3 }, // Mage
     { 2, 2, 4, 3, 3 }, // Priest
@@ -286,7 +286,7 @@ int16_t class_level_adj[PLAYER_MAX_CLASSES][CLASS_MAX_LEVEL_ADJUST] = {
 // Warriors don't have spells, so there is no entry for them.
 // Note that this means you must always subtract one from the
 // py.misc.class_id before indexing into magic_spells[].
-Spell_t magic_spells[PLAYER_MAX_CLASSES - 1][31] = {
+const Spell_t magic_spells[PLAYER_MAX_CLASSES - 1][31] = {
     {
         // Mage
         {  1,  1, 22,   1},
@@ -459,7 +459,7 @@ Spell_t magic_spells[PLAYER_MAX_CLASSES - 1][31] = {
     }
 };
 
-const char *spell_names[62] = {
+const char *const spell_names[62] = {
     // Mage Spells
     "Magic Missile", "Detect Monsters", "Phase Door", "Light Area",
     "Cure Light Wounds", "Find Hidden Traps/Doors", "Stinking Cloud",
@@ -491,7 +491,7 @@ const char *spell_names[62] = {
 //      103 = Soft Leather Armor
 //       30 = Stiletto
 //      322 = Beginners Handbook
-uint16_t class_base_provisions[PLAYER_MAX_CLASSES][5] = {
+const uint16_t class_base_provisions[PLAYER_MAX_CLASSES][5] = {
     {344, 365, 123, 30, 103}, // Warrior
     {344, 365, 123, 30, 318}, // Mage
     {344, 365, 123, 30, 322}, // Priest
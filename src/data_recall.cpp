@@ -5,7 +5,9 @@
 
 // Player's memory: monster descriptions
 
-const char *recall_description_attack_type[25] = {
+#include "headers.h"
+
+const char *const recall_description_attack_type[25] = {
     "do something undefined",
     "attack",
     "weaken",
@@ -33,7 +35,7 @@ const char *recall_description_attack_type[25] = {
     "absorb charges",
 };
 
-const char *recall_description_attack_method[20] = {
+const char *const recall_description_attack_method[20] = {
     "make an undefined advance",
     "hit",
     "bite",
@@ -56,15 +58,15 @@ const char *recall_description_attack_method[20] = {
     "insult",
 };
 
-const char *recall_description_how_much[8] = {
+const char *const recall_description_how_much[8] = {
     " not at all", " a bit", "", " quite", " very", " most", " highly", " extremely",
 };
 
-const char *recall_description_move[6] = {
+const char *const recall_description_move[6] = {
     "move invisibly", "open doors", "pass through walls", "kill weaker creatures", "pick up objects", "breed explosively",
 };
 
-const char *recall_description_spell[15] = {
+const char *const recall_description_spell[15] = {
     "teleport short distances",
     "teleport long distances",
     "teleport its prey",
@@ -82,10 +84,10 @@ const char *recall_description_spell[15] = {
     "unknown 2",
 };
 
-const char *recall_description_breath[5] = {
+const char *const recall_description_breath[5] = {
     "lightning", "poison gases", "acid", "frost", "fire",
 };
 
-const char *recall_description_weakness[6] = {
+const char *const recall_description_weakness[6] = {
     "frost", "fire", "poison", "acid", "bright light", "rock remover",
 };
@@ -10,7 +10,7 @@
 
 // Store owners have different characteristics for pricing and haggling
 // Note: Store owners should be added in groups, one for each store
-Owner_t store_owners[MAX_OWNERS] = {
+const Owner_t store_owners[MAX_OWNERS] = {
     {"Erick the Honest       (Human)      General Store",   250, 175, 108, 4, 0, 12},
     {"Mauglin the Grumpy     (Dwarf)      Armory",        32000, 200, 112, 4, 5,  5},
     {"Arndal Beast-Slayer    (Half-Elf)   Weaponsmith",   10000, 185, 110, 5, 1,  8},
@@ -31,7 +31,7 @@ Owner_t store_owners[MAX_OWNERS] = {
     {"Inglorian the Mage     (Human?)     Magic Shop",    32000, 200, 110, 7, 0, 10},
 };
 
-const char *speech_sale_accepted[14] = {
+const char *const speech_sale_accepted[14] = {
     "Done!",
     "Accepted!",
     "Fine.",
@@ -48,13 +48,13 @@ const char *speech_sale_accepted[14] = {
     "My spouse will skin me, but accepted.",
 };
 
-const char *speech_selling_haggle_final[3] = {
+const char *const speech_selling_haggle_final[3] = {
     "%A2 is my final offer; take it or leave it.",
     "I'll give you no more than %A2.",
     "My patience grows thin.  %A2 is final.",
 };
 
-const char *speech_selling_haggle[16] = {
+const char *const speech_selling_haggle[16] = {
     "%A1 for such a fine item?  HA!  No less than %A2.",
     "%A1 is an insult!  Try %A2 gold pieces.",
     "%A1?!?  You would rob my poor starving children?",
@@ -73,13 +73,13 @@ const char *speech_selling_haggle[16] = {
     "Your mother was a Troll!  %A2 or I'll tell.",
 };
 
-const char *speech_buying_haggle_final[3] = {
+const char *const speech_buying_haggle_final[3] = {
     "I'll pay no more than %A1; take it or leave it.",
     "You'll get no more than %A1 from me.",
     "%A1 and that's final.",
 };
 
-const char *speech_buying_haggle[15] = {
+const char *const speech_buying_haggle[15] = {
     "%A2 for that piece of junk?  No more than %A1.",
     "For %A2 I could own ten of those.  Try %A1.",
     "%A2?  NEVER!  %A1 is more like it.",
@@ -97,7 +97,7 @@ const char *speech_buying_haggle[15] = {
     "%A2 is too much, let us say %A1 gold.",
 };
 
-const char *speech_insulted_haggling_done[5] = {
+const char *const speech_insulted_haggling_done[5] = {
     "ENOUGH!  You have abused me once too often!",
     "THAT DOES IT!  You shall waste my time no more!",
     "This is getting nowhere.  I'm going home!",
@@ -105,13 +105,13 @@ const char *speech_insulted_haggling_done[5] = {
     "Begone!  I have had enough abuse for one day.",
 };
 
-const char *speech_get_out_of_my_store[5] = {
+const char *const speech_get_out_of_my_store[5] = {
     "Out of my place!", "out... Out... OUT!!!",
     "Come back tomorrow.", "Leave my place.  Begone!",
     "Come back when thou art richer.",
 };
 
-const char *speech_haggling_try_again[10] = {
+const char *const speech_haggling_try_again[10] = {
     "You will have to do better than that!",
     "That's an insult!",
     "Do you wish to do business or not?",
@@ -124,7 +124,7 @@ const char *speech_haggling_try_again[10] = {
     "Hmmm, nice weather we're having.",
 };
 
-const char *speech_sorry[5] = {
+const char *const speech_sorry[5] = {
     "I must have heard you wrong.", "What was that?",
     "I'm sorry, say that again.", "What did you say?",
     "Sorry, what was that again?",
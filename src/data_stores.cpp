@@ -9,7 +9,7 @@
 #include "headers.h"
 
 // Buying and selling adjustments for character race VS store owner race
-uint8_t race_gold_adjustments[PLAYER_MAX_RACES][PLAYER_MAX_RACES] = {
+const uint8_t race_gold_adjustments[PLAYER_MAX_RACES][PLAYER_MAX_RACES] = {
     //Hum, HfE, Elf, Hal, Gno, Dwa, HfO, HfT
     { 100, 105, 105, 110, 113, 115, 120, 125 }, // Human
     { 110, 100, 100, 105, 110, 120, 125, 130 }, // Half-Elf
@@ -22,7 +22,7 @@ uint8_t race_gold_adjustments[PLAYER_MAX_RACES][PLAYER_MAX_RACES] = {
 };
 
 // game_objects[] index of objects that may appear in the store
-uint16_t store_choices[MAX_STORES][STORE_MAX_ITEM_TYPES] = {
+const uint16_t store_choices[MAX_STORES][STORE_MAX_ITEM_TYPES] = {
     // General Store
     {
         366, 365, 364,  84,  84, 365, 123, 366, 365, 350, 349, 348, 347,
@@ -9,7 +9,7 @@
 #include "headers.h"
 
 // Following are arrays for descriptive pieces
-const char *colors[MAX_COLORS] = {
+const char *const colors[MAX_COLORS] = {
     // Do not move the first three
     "Icky Green",  "Light Brown",  "Clear",
     "Azure", "Blue", "Blue Speckled", "Black", "Brown", "Brown Speckled", "Bubbling",
@@ -22,27 +22,27 @@ const char *colors[MAX_COLORS] = {
     "Tangerine", "Violet", "Vermilion", "White", "Yellow",
 };
 
-const char *mushrooms[MAX_MUSHROOMS] = {
+const char *const mushrooms[MAX_MUSHROOMS] = {
     "Blue", "Black", "Black Spotted", "Brown", "Dark Blue", "Dark Green", "Dark Red",
     "Ecru", "Furry", "Green", "Grey", "Light Blue", "Light Green", "Plaid", "Red",
     "Slimy", "Tan", "White", "White Spotted", "Wooden", "Wrinkled", "Yellow",
 };
 
-const char *woods[MAX_WOODS] = {
+const char *const woods[MAX_WOODS] = {
     "Aspen", "Balsa", "Banyan", "Birch", "Cedar", "Cottonwood", "Cypress", "Dogwood",
     "Elm", "Eucalyptus", "Hemlock", "Hickory", "Ironwood", "Locust", "Mahogany",
     "Maple", "Mulberry", "Oak", "Pine", "Redwood", "Rosewood", "Spruce", "Sycamore",
     "Teak", "Walnut",
 };
 
-const char *metals[MAX_METALS] = {
+const char *const metals[MAX_METALS] = {
     "Aluminum", "Cast Iron", "Chromium", "Copper", "Gold", "Iron", "Magnesium",
     "Molybdenum", "Nickel", "Rusty", "Silver", "Steel", "Tin", "Titanium", "Tungsten",
     "Zirconium", "Zinc", "Aluminum-Plated", "Copper-Plated", "Gold-Plated",
     "Nickel-Plated", "Silver-Plated", "Steel-Plated", "Tin-Plated", "Zinc-Plated",
 };
 
-const char *rocks[MAX_ROCKS] = {
+const char *const rocks[MAX_ROCKS] = {
     "Alexandrite", "Amethyst", "Aquamarine", "Azurite", "Beryl", "Bloodstone",
     "Calcite", "Carnelian", "Corundum", "Diamond", "Emerald", "Fluorite", "Garnet",
     "Granite", "Jade", "Jasper", "Lapis Lazuli", "Malachite", "Marble", "Moonstone",
@@ -50,12 +50,12 @@ const char *rocks[MAX_ROCKS] = {
     "Tiger Eye", "Topaz", "Turquoise", "Zircon",
 };
 
-const char *amulets[MAX_AMULETS] = {
+const char *const amulets[MAX_AMULETS] = {
     "Amber", "Driftwood", "Coral", "Agate", "Ivory", "Obsidian",
     "Bone", "Brass", "Bronze", "Pewter", "Tortoise Shell",
 };
 
-const char *syllables[MAX_SYLLABLES] = {
+const char *const syllables[MAX_SYLLABLES] = {
     "a",    "ab",   "ag",   "aks",  "ala",  "an",  "ankh", "app", "arg",
     "arze", "ash",  "aus",  "ban",  "bar",  "bat", "bek",  "bie", "bin",
     "bit",  "bjor", "blu",  "bot",  "bu",   "byt", "comp", "con", "cos",
@@ -76,7 +76,7 @@ const char *syllables[MAX_SYLLABLES] = {
 };
 
 // used to calculate the number of blows the player gets in combat
-uint8_t blows_table[7][6] = {
+const uint8_t blows_table[7][6] = {
     // STR/W:   9  18  67  107 117 118  : DEX
     { 1,  1,  1,  1,  1,  1 }, // <2
     { 1,  1,  1,  1,  2,  2 }, // <3
@@ -90,7 +90,7 @@ uint8_t blows_table[7][6] = {
 // this table is used to generate a pseudo-normal distribution.  See
 // the function randomNumberNormalDistribution() in misc1.c, this is much faster than calling
 // transcendental function to calculate a true normal distribution.
-uint16_t normal_table[NORMAL_TABLE_SIZE] = {
+const uint16_t normal_table[NORMAL_TABLE_SIZE] = {
     206,     613,    1022,    1430,    1838,    2245,    2652,    3058,
     3463,    3867,    4271,    4673,    5075,    5475,    5874,    6271,
     6667,    7061,    7454,    7845,    8234,    8621,    9006,    9389,
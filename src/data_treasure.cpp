@@ -61,7 +61,7 @@
 // Object list (All objects must be defined here)
 
 // Dungeon items from 0 to MAX_DUNGEON_OBJECTS
-DungeonObject_t game_objects[MAX_OBJECTS_IN_GAME] = {
+constexpr DungeonObject_t game_objects[MAX_OBJECTS_IN_GAME] = {
     {"Poison",                          0x00000001L, TV_FOOD,        ',', 500,  0,    64,  1, 1,    0,  0, 0,   0, {0, 0}, 7}, // 0
     {"Blindness",                       0x00000002L, TV_FOOD,        ',', 500,  0,    65,  1, 1,    0,  0, 0,   0, {0, 0}, 9}, // 1
     {"Paranoia",                        0x00000004L, TV_FOOD,        ',', 500,  0,    66,  1, 1,    0,  0, 0,   0, {0, 0}, 9}, // 2
@@ -521,7 +521,7 @@ DungeonObject_t game_objects[MAX_OBJECTS_IN_GAME] = {
     {"",                              0x00000000L, TV_NOTHING,  ' ', 0, 0, 0, 0,   0, 0, 0, 0, 0, {0, 0}, 0}, // 419
 };
 
-const char *special_item_names[SpecialNameIds::SN_ARRAY_SIZE] = {
+const char *const special_item_names[SpecialNameIds::SN_ARRAY_SIZE] = {
     CNIL,                "(R)",              "(RA)",
     "(RF)",              "(RC)",             "(RL)",
     "(HA)",              "(DF)",             "(SA)",
@@ -542,3 +542,45 @@ const char *special_item_names[SpecialNameIds::SN_ARRAY_SIZE] = {
     "(Summoning Runes)", "(Multiple Traps)", "(Disarmed)",
     "(Unlocked)",        "of Slay Animal",
 };
+
+// clang-format on
+
+typedef struct {
+    int16_t levels[TREASURE_MAX_LEVELS + 1];
+    int16_t sorted_objects[MAX_DUNGEON_OBJECTS];
+} TreasureLevels_t;
+
+// Number of dungeon objects of each level and below, and the object IDs
+// sorted by level, built from game_objects at compile time.
+static constexpr TreasureLevels_t treasureLevels() {
+    TreasureLevels_t table{};
+
+    for (int i = 0; i < MAX_DUNGEON_OBJECTS; i++) {
+        table.levels[game_objects[i].depth_first_found]++;
+    }
+
+    for (int i = 1; i <= TREASURE_MAX_LEVELS; i++) {
+        table.levels[i] += table.levels[i - 1];
+    }
+
+    // An O(n) sort by level, using the counts. It is not a stable sort,
+    // the objects of each level end up in the reverse of their order in
+    // game_objects, as they always have.
+    int indexes[TREASURE_MAX_LEVELS + 1] = {};
+    for (auto &i : indexes) {
+        i = 1;
+    }
+
+    for (int i = 0; i < MAX_DUNGEON_OBJECTS; i++) {
+        int level = game_objects[i].depth_first_found;
+
+        table.sorted_objects[table.levels[level] - indexes[level]] = (int16_t) i;
+        indexes[level]++;
+    }
+
+    return table;
+}
+
+static constexpr TreasureLevels_t treasure_levels_table = treasureLevels();
+const int16_t (&treasure_levels)[TREASURE_MAX_LEVELS + 1] = treasure_levels_table.levels;
+const int16_t (&sorted_objects)[MAX_DUNGEON_OBJECTS] = treasure_levels_table.sorted_objects;
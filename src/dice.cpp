@@ -5,8 +5,103 @@
 
 #include "headers.h"
 
+// Stream values drawn at once by batched dice, enough for the biggest
+// Dice_t there is, so a roll never spans two blocks.
+constexpr int DICE_BLOCK_VALUES = 256;
+
+static thread_local DiceMode dice_mode = DiceMode::Classic;
+
+DiceMode getDiceMode() {
+    return dice_mode;
+}
+
+void setDiceMode(DiceMode mode) {
+    dice_mode = mode;
+}
+
+static bool diceBatched() {
+    return dice_mode == DiceMode::Batched && getRandomMode() == RandomMode::Counter;
+}
+
+// Brings each of the 32 bit `values` to a face of 1 to `sides`, as the
+// high half of value * sides (Lemire's method). The few products landing
+// in the low end, which would favour some faces, are drawn again.
+static void diceFaces(RandomStream_t &stream, uint32_t const *values, int *faces, int count, uint32_t sides) {
+    bool maybe_biased = false;
+
+    // No branches and no loop carried state, so the compiler is free to vectorize this.
+    for (int i = 0; i < count; i++) {
+        uint64_t product = (uint64_t) values[i] * sides;
+        faces[i] = (int) (product >> 32) + 1;
+        maybe_biased |= (uint32_t) product < sides;
+    }
+
+    if (!maybe_biased) {
+        return;
+    }
+
+    // The one division, only needed once in a (2^32 / sides) values
+    uint32_t threshold = (0u - sides) % sides;
+
+    for (int i = 0; i < count; i++) {
+        uint64_t product = (uint64_t) values[i] * sides;
+        while ((uint32_t) product < threshold) {
+            product = (uint64_t) randomStreamNext(stream) * sides;
+        }
+        faces[i] = (int) (product >> 32) + 1;
+    }
+}
+
+// Fills `rolls` with `count` rolls of the dice. Classic dice roll exactly
+// as `count` calls of diceRoll() would.
+void diceRollMany(Dice_t const &dice, int *rolls, int count) {
+    if (!diceBatched()) {
+        for (int i = 0; i < count; i++) {
+            rolls[i] = diceRoll(dice);
+        }
+        return;
+    }
+
+    if (dice.dice == 0 || dice.sides == 0) {
+        for (int i = 0; i < count; i++) {
+            rolls[i] = 0;
+        }
+        return;
+    }
+
+    uint32_t values[DICE_BLOCK_VALUES];
+    int faces[DICE_BLOCK_VALUES];
+
+    int rolls_per_block = DICE_BLOCK_VALUES / dice.dice;
+    RandomStream_t stream = getRandomStream();
+
+    for (int first = 0; first < count; first += rolls_per_block) {
+        int block_rolls = std::min(rolls_per_block, count - first);
+        int block_values = block_rolls * dice.dice;
+
+        fillRandom(stream, values, block_values);
+        diceFaces(stream, values, faces, block_values, dice.sides);
+
+        for (int i = 0; i < block_rolls; i++) {
+            auto sum = 0;
+            for (auto die = 0; die < dice.dice; die++) {
+                sum += faces[i * dice.dice + die];
+            }
+            rolls[first + i] = sum;
+        }
+    }
+
+    setRandomStream(stream);
+}
+
 // generates damage for 2d6 style dice rolls
 int diceRoll(Dice_t const &dice) {
+    if (diceBatched()) {
+        int sum;
+        diceRollMany(dice, &sum, 1);
+        return sum;
+    }
+
     auto sum = 0;
     for (auto i = 0; i < dice.dice; i++) {
         sum += randomNumber(dice.sides);
@@ -10,5 +10,18 @@ typedef struct {
     uint8_t sides;
 } Dice_t;
 
+// How dice are rolled. Classic dice take a randomNumber() each, as they
+// always have, so replays keep their rolls. Batched dice, while rnd() draws
+// from the counter generator, take a block of raw stream values at once,
+// each brought to a face with a multiply instead of a division.
+enum class DiceMode {
+    Classic,
+    Batched,
+};
+
+DiceMode getDiceMode();
+void setDiceMode(DiceMode mode);
+
 int diceRoll(Dice_t const &dice);
+void diceRollMany(Dice_t const &dice, int *rolls, int count);
 int maxDiceRoll(Dice_t const &dice);
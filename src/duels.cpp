@@ -0,0 +1,300 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Duel sweep: fights a character against creatures many times over, in
+// parallel without a terminal, for the odds of winning each fight.
+
+#include "headers.h"
+
+#include <atomic>
+#include <chrono>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-duels [OPTIONS]
+
+Fights melee duels to the death of a new character against creatures, with
+the game's own combat rolls (see src/combat.h), and prints one CSV record per
+creature: the duels won, lost and drawn (out of turns), the mean turns, and
+the mean hit points the player had left when they won. The same seed gives
+the same records, whatever the number of threads.
+
+The character is created from the seed, as the race and class given, then
+raised to the level given, and wears the starting kit of the class or the
+objects given instead.
+
+Options:
+    -m NUMBER    Fight only this creature, by its number in the monster list
+                 (default: every creature up to the level given by -M)
+    -M NUMBER    Highest creature level fought, without -m (default: 100)
+    -n NUMBER    Duels against each creature (default: 10000)
+    -r LETTER    Race, its letter in the character creation menu (default: a)
+    -c LETTER    Class, its letter in the character creation menu (default: a)
+    -L NUMBER    Character level (default: 1)
+    -e LIST      Objects worn, as comma separated numbers of the object list
+                 (default: the starting kit)
+    -t NUMBER    Most game turns a duel lasts, before it is a draw (default: 1000)
+    -s NUMBER    Seed (default: 1)
+    -j NUMBER    Number of worker threads (default: all cores)
+    -b           Roll the dice in batches (see src/dice.h), giving other
+                 records than the classic rolls
+
+    -h           Display this message
+)";
+
+// The duels against a creature are fought in chunks, each from an RNG
+// stream of its own, so the records don't depend on which thread fought them.
+constexpr int DUEL_CHUNK_DUELS = 1024;
+
+typedef struct {
+    uint64_t won;
+    uint64_t died;
+    uint64_t turns;
+    uint64_t hp_left; // When won
+} DuelTally_t;
+
+// Options of the duels
+static int duels_player_level = 1;
+static int32_t duels_max_turns = 1000;
+static bool duels_batched_dice = false;
+static std::vector<int> duels_equipment;
+
+// Character creation: race, male, accept stats, class, name, then continue
+// past the "press any key" prompt.
+static char character_creation_keys[] = "am\033aDuelist\r ";
+constexpr int RACE_KEY_POSITION = 0;
+constexpr int CLASS_KEY_POSITION = 3;
+static thread_local const char *pending_keys = nullptr;
+
+static int duelsKeySource() {
+    if (pending_keys != nullptr && *pending_keys != '\0') {
+        return *pending_keys++;
+    }
+    return ESCAPE;
+}
+
+// Raises the character to the level, as gaining the experience would
+static void duelsRaiseLevel() {
+    if (duels_player_level > 1) {
+        py.misc.exp = (int32_t) (py.base_exp_levels[duels_player_level - 2] * py.misc.experience_factor / 100);
+        displayCharacterExperience();
+    }
+    py.misc.current_hp = py.misc.max_hp;
+}
+
+// Wears the objects, each in the slot the wear command would put it in
+static void duelsWearEquipment() {
+    std::vector<int> objects = duels_equipment;
+    if (objects.empty()) {
+        for (auto object_id : class_base_provisions[py.misc.class_id]) {
+            objects.push_back(object_id);
+        }
+    }
+
+    for (auto object_id : objects) {
+        uint8_t category_id = game_objects[object_id].category_id;
+        if (category_id < TV_MIN_WEAR || category_id > TV_MAX_WEAR) {
+            continue;
+        }
+
+        // Only two rings are worn, as the wear command would ask for the hand of a third
+        if (category_id == TV_RING && !playerRightHandRingEmpty() && !playerLeftHandRingEmpty()) {
+            continue;
+        }
+
+        int slot = inventoryGetSlotToWearEquipment(category_id);
+        if (slot == -1 || py.inventory[slot].category_id != TV_NOTHING) {
+            continue;
+        }
+
+        Inventory_t &item = py.inventory[slot];
+        inventoryItemCopyTo(object_id, item);
+        itemIdentifyAsStoreBought(item);
+
+        py.equipment_count++;
+        playerAdjustBonusesForItem(item, 1);
+    }
+
+    playerRecalculateBonuses();
+    playerStrength();
+}
+
+// A comma separated list of object numbers
+static bool parseObjects(const char *str, std::vector<int> &objects) {
+    if (str == nullptr) {
+        return false;
+    }
+
+    std::string list = str;
+    size_t start = 0;
+
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+
+        int object_id;
+        if (!stringToNumber(list.substr(start, end - start).c_str(), object_id) || object_id < 0 || object_id >= MAX_OBJECTS_IN_GAME) {
+            return false;
+        }
+        objects.push_back(object_id);
+
+        start = end + 1;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int creature_id = -1;
+    int max_creature_level = 100;
+    int duel_count = 10000;
+    int seed = 1;
+    int thread_count = toolThreadCount();
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 'b':
+                duels_batched_dice = true;
+                break;
+            case 'm':
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToNumber(value, creature_id) && creature_id >= 0 && creature_id < MON_MAX_CREATURES;
+                break;
+            case 'M':
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToNumber(value, max_creature_level) && max_creature_level >= 0;
+                break;
+            case 'n':
+                ok = toolOptionNumber(options, duel_count);
+                break;
+            case 'r':
+                value = toolOptionValue(options);
+                ok = value != nullptr && value[0] >= 'a' && value[0] < 'a' + PLAYER_MAX_RACES && value[1] == '\0';
+                if (ok) {
+                    character_creation_keys[RACE_KEY_POSITION] = value[0];
+                }
+                break;
+            case 'c':
+                value = toolOptionValue(options);
+                ok = value != nullptr && value[0] >= 'a' && value[0] < 'a' + PLAYER_MAX_CLASSES && value[1] == '\0';
+                if (ok) {
+                    character_creation_keys[CLASS_KEY_POSITION] = value[0];
+                }
+                break;
+            case 'L':
+                ok = toolOptionNumber(options, duels_player_level) && duels_player_level <= PLAYER_MAX_LEVEL;
+                break;
+            case 'e':
+                ok = parseObjects(toolOptionValue(options), duels_equipment);
+                break;
+            case 't':
+                ok = toolOptionNumber(options, duels_max_turns);
+                break;
+            case 's':
+                ok = toolOptionNumber(options, seed);
+                break;
+            case 'j':
+                ok = toolOptionNumber(options, thread_count);
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    std::vector<int> creatures;
+    for (int id = 0; id < MON_MAX_CREATURES; id++) {
+        if (creature_id == id || (creature_id < 0 && creatures_list[id].level <= max_creature_level)) {
+            creatures.push_back(id);
+        }
+    }
+
+    int chunks_per_creature = (duel_count + DUEL_CHUNK_DUELS - 1) / DUEL_CHUNK_DUELS;
+    int chunk_count = chunks_per_creature * (int) creatures.size();
+    std::atomic<int> next_chunk{0};
+
+    RandomStream_t duels_stream = randomStreamCreate((uint64_t) seed, RNG_STREAM_MONSTERS);
+
+    // Each worker is a game of its own, with the same character, keeping its own tallies
+    std::vector<std::vector<DuelTally_t>> worker_tallies((size_t) thread_count, std::vector<DuelTally_t>(creatures.size()));
+
+    auto worker = [&](int worker_id) {
+        std::vector<DuelTally_t> &tallies = worker_tallies[worker_id];
+
+        pending_keys = character_creation_keys;
+        (void) terminalInitializeHeadless(duelsKeySource);
+
+        setupSimulatedGame((uint32_t) seed);
+        duelsRaiseLevel();
+        duelsWearEquipment();
+
+        setRandomMode(RandomMode::Counter);
+        if (duels_batched_dice) {
+            setDiceMode(DiceMode::Batched);
+        }
+
+        int chunk;
+        while ((chunk = next_chunk++) < chunk_count) {
+            int creature = chunk / chunks_per_creature;
+            int first_duel = chunk % chunks_per_creature * DUEL_CHUNK_DUELS;
+
+            RandomStream_t parent = duels_stream;
+            parent.counter = (uint64_t) chunk;
+            setRandomStream(randomStreamSplit(parent));
+
+            DuelTally_t &tally = tallies[creature];
+
+            for (int i = first_duel; i < std::min(first_duel + DUEL_CHUNK_DUELS, duel_count); i++) {
+                CombatDuel_t duel = combatDuel(creatures[creature], duels_max_turns);
+
+                tally.turns += (uint64_t) duel.turns;
+                if (duel.player_won) {
+                    tally.won++;
+                    tally.hp_left += (uint64_t) duel.player_hp;
+                } else if (duel.player_died) {
+                    tally.died++;
+                }
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    toolRunWorkers(thread_count, worker);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("creature_id,level,duels,won,lost,drawn,win_rate,mean_turns,mean_hp_left,name\n");
+    for (size_t i = 0; i < creatures.size(); i++) {
+        DuelTally_t total{};
+        for (auto const &tallies : worker_tallies) {
+            total.won += tallies[i].won;
+            total.died += tallies[i].died;
+            total.turns += tallies[i].turns;
+            total.hp_left += tallies[i].hp_left;
+        }
+
+        Creature_t const &creature = creatures_list[creatures[i]];
+
+        printf("%d,%u,%d,%llu,%llu,%llu,%.4f,%.2f,%.2f,\"%s\"\n", creatures[i], creature.level, duel_count, (unsigned long long) total.won, (unsigned long long) total.died, (unsigned long long) (duel_count - total.won - total.died),
+               (double) total.won / duel_count, (double) total.turns / duel_count, total.won > 0 ? (double) total.hp_left / total.won : 0.0, creature.name);
+    }
+
+    fprintf(stderr, "%llu duels in %lld ms\n", (unsigned long long) duel_count * creatures.size(), (long long) elapsed);
+
+    return 0;
+}
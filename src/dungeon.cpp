@@ -9,15 +9,81 @@
 
 // The Dungeon global
 // Yup, this initialization is ugly, we'll fix...eventually! -MRC-
-Dungeon_t dg = Dungeon_t{0, 0, {}, -1, 0, true, {}};
+thread_local Dungeon_t dg = Dungeon_t{0, 0, {}, -1, 0, true, {}};
 
-// dungeonDisplayMap shrinks the dungeon to a single screen
-void dungeonDisplayMap() {
-    // Save the game screen
-    terminalSaveScreen();
-    clearScreen();
+thread_local uint32_t tile_feature_changes = 0;
+
+// Size of the dungeon levels (but not the town), as set with dungeonSetSize()
+static thread_local int16_t level_height = MAX_HEIGHT;
+static thread_local int16_t level_width = MAX_WIDTH;
+
+// Sets the size of the dungeon levels generated from now on. Both must be
+// a whole number of screens, and at least the classic dungeon size.
+bool dungeonSetSize(int height, int width) {
+    if (height < MAX_HEIGHT || height > LEVEL_MAX_HEIGHT || height % SCREEN_HEIGHT != 0) {
+        return false;
+    }
+    if (width < MAX_WIDTH || width > LEVEL_MAX_WIDTH || width % SCREEN_WIDTH != 0) {
+        return false;
+    }
+
+    level_height = (int16_t) height;
+    level_width = (int16_t) width;
+
+    return true;
+}
 
-    int16_t priority[256] = {0};
+void dungeonGetSize(int &height, int &width) {
+    height = level_height;
+    width = level_width;
+}
+
+// Makes sure the floor can hold a level of the current dungeon size.
+void dungeonAllocateFloor() {
+    if (dg.floor.rows != level_height || dg.floor.columns != level_width) {
+        dg.floor.resize(level_height, level_width);
+    }
+}
+
+thread_local LevelArena_t level_arena;
+
+constexpr size_t LEVEL_ARENA_BLOCK_SIZE = 16 * 1024;
+
+void *LevelArena_t::allocate(size_t bytes, size_t alignment) {
+    size_t offset = (used + alignment - 1) & ~(alignment - 1);
+
+    if (blocks.empty() || offset + bytes > blocks.back().size()) {
+        size_t size = blocks.empty() ? LEVEL_ARENA_BLOCK_SIZE : blocks.back().size() * 2;
+        blocks.emplace_back(std::max(size, bytes));
+        offset = 0;
+    }
+
+    used = offset + bytes;
+    return blocks.back().data() + offset;
+}
+
+// Takes back everything handed out. When the level needed more than one
+// block they are replaced by one as large as all of them, which every
+// level after fits in.
+void LevelArena_t::reset() {
+    if (blocks.size() > 1) {
+        size_t size = 0;
+        for (auto const &block : blocks) {
+            size += block.size();
+        }
+
+        blocks.clear();
+        blocks.emplace_back(size);
+    }
+
+    used = 0;
+}
+
+// Map symbol priorities, the highest priority symbol of each block is shown
+static void mapSymbolPriorities(int8_t (&priority)[256]) {
+    for (auto &p : priority) {
+        p = 0;
+    }
     priority[60] = 5;   // char '<'
     priority[62] = 5;   // char '>'
     priority[64] = 10;  // char '@'
@@ -25,68 +91,110 @@ void dungeonDisplayMap() {
     priority[46] = -10; // char '.'
     priority[92] = -3;  // char '\'
     priority[32] = -15; // char ' '
+}
 
-    // Display highest priority object in the RATIO, by RATIO area
-    uint8_t panel_width = MAX_WIDTH / RATIO;
-    uint8_t panel_height = MAX_HEIGHT / RATIO;
-
-    char map[MAX_WIDTH / RATIO + 1] = {'\0'};
-    char line_buffer[80];
+// Shrinks one row of tile symbols into the map blocks, keeping the first
+// symbol with the highest priority in each block of `ratio` tiles.
+static void mapShrinkRow(char const *symbols, int8_t const (&priority)[256], int columns, int ratio, char *row_symbols, int8_t *row_priorities) {
+    for (int col = 0, x = 0; x < columns; col++) {
+        char symbol = ' ';
+        int8_t best = priority[(uint8_t) ' '];
+
+        for (int end = std::min(x + ratio, columns); x < end; x++) {
+            int8_t p = priority[(uint8_t) symbols[x]];
+            if (best < p) {
+                best = p;
+                symbol = symbols[x];
+            }
+        }
 
-    // Add screen border
-    addChar('+', Coord_t{0, 0});
-    addChar('+', Coord_t{0, panel_width + 1});
-    for (uint8_t i = 0; i < panel_width; i++) {
-        addChar('-', Coord_t{0, i + 1});
-        addChar('-', Coord_t{panel_height + 1, i + 1});
+        row_symbols[col] = symbol;
+        row_priorities[col] = best;
     }
-    for (uint8_t i = 0; i < panel_height; i++) {
-        addChar('|', Coord_t{i + 1, 0});
-        addChar('|', Coord_t{i + 1, panel_width + 1});
-    }
-    addChar('+', Coord_t{panel_height + 1, 0});
-    addChar('+', Coord_t{panel_height + 1, panel_width + 1});
-    putString("Hit any key to continue", Coord_t{23, 23});
+}
 
-    int player_y = 0;
-    int player_x = 0;
-    int line = -1;
-
-    // Shrink the dungeon!
-    for (uint8_t y = 0; y < MAX_HEIGHT; y++) {
-        uint8_t row = y / RATIO;
-        if (row != line) {
-            if (line >= 0) {
-                sprintf(line_buffer, "|%s|", map);
-                putString(line_buffer, Coord_t{line + 1, 0});
+// Shrinks the dungeon to fit on a single screen. Each map block shows the
+// highest priority symbol of its ratio by ratio area of the dungeon.
+void dungeonBuildMap(DungeonMap_t &map) {
+    int8_t priority[256];
+    mapSymbolPriorities(priority);
+
+    // Levels larger than the classic dungeon are shrunk further to fit the screen.
+    map.ratio = RATIO;
+    map.ratio = std::max(map.ratio, (dg.floor.rows + MAX_HEIGHT / RATIO - 1) / (MAX_HEIGHT / RATIO));
+    map.ratio = std::max(map.ratio, (dg.floor.columns + MAX_WIDTH / RATIO - 1) / (MAX_WIDTH / RATIO));
+
+    map.rows = (dg.floor.rows + map.ratio - 1) / map.ratio;
+    map.columns = (dg.floor.columns + map.ratio - 1) / map.ratio;
+    map.symbols.assign((size_t) map.rows * map.columns, ' ');
+    map.player = Coord_t{-1, -1};
+
+    std::vector<char> tile_symbols((size_t) dg.floor.columns);
+    std::vector<char> row_symbols((size_t) map.columns);
+    std::vector<int8_t> row_priorities((size_t) map.columns);
+    std::vector<int8_t> block_priorities((size_t) map.columns);
+
+    for (int row = 0; row < map.rows; row++) {
+        char *block_symbols = &map.symbols[(size_t) row * map.columns];
+        std::fill(block_priorities.begin(), block_priorities.end(), priority[(uint8_t) ' ']);
+
+        // Shrink each tile row across, then keep the best of the block rows
+        // so the first highest priority symbol, reading in rows, still wins.
+        for (int y = row * map.ratio; y < std::min((row + 1) * map.ratio, (int) dg.floor.rows); y++) {
+            for (int x = 0; x < dg.floor.columns; x++) {
+                tile_symbols[x] = caveGetTileSymbol(Coord_t{y, x});
             }
-            for (uint8_t j = 0; j < panel_width; j++) {
-                map[j] = ' ';
+
+            mapShrinkRow(tile_symbols.data(), priority, dg.floor.columns, map.ratio, row_symbols.data(), row_priorities.data());
+
+            for (int col = 0; col < map.columns; col++) {
+                bool higher = block_priorities[col] < row_priorities[col];
+                block_priorities[col] = higher ? row_priorities[col] : block_priorities[col];
+                block_symbols[col] = higher ? row_symbols[col] : block_symbols[col];
             }
-            line = row;
         }
 
-        for (uint8_t x = 0; x < MAX_WIDTH; x++) {
-            uint8_t col = x / RATIO;
-            char cave_char = caveGetTileSymbol(Coord_t{y, x});
-            if (priority[(uint8_t) map[col]] < priority[(uint8_t) cave_char]) {
-                map[col] = cave_char;
-            }
-            if (map[col] == '@') {
-                // +1 to account for border
-                player_x = col + 1;
-                player_y = row + 1;
+        for (int col = 0; col < map.columns; col++) {
+            if (block_symbols[col] == '@') {
+                map.player = Coord_t{row, col};
             }
         }
     }
+}
 
-    if (line >= 0) {
-        sprintf(line_buffer, "|%s|", map);
-        putString(line_buffer, Coord_t{line + 1, 0});
+// dungeonDisplayMap shrinks the dungeon to a single screen
+void dungeonDisplayMap() {
+    // Save the game screen
+    terminalSaveScreen();
+    clearScreen();
+
+    DungeonMap_t map;
+    dungeonBuildMap(map);
+
+    char line_buffer[80];
+
+    // Add screen border
+    addChar('+', Coord_t{0, 0});
+    addChar('+', Coord_t{0, map.columns + 1});
+    for (int i = 0; i < map.columns; i++) {
+        addChar('-', Coord_t{0, i + 1});
+        addChar('-', Coord_t{map.rows + 1, i + 1});
     }
+    for (int i = 0; i < map.rows; i++) {
+        addChar('|', Coord_t{i + 1, 0});
+        addChar('|', Coord_t{i + 1, map.columns + 1});
+    }
+    addChar('+', Coord_t{map.rows + 1, 0});
+    addChar('+', Coord_t{map.rows + 1, map.columns + 1});
+    putString("Hit any key to continue", Coord_t{23, 23});
 
-    // Move cursor onto player character
-    moveCursor(Coord_t{player_y, player_x});
+    for (int row = 0; row < map.rows; row++) {
+        sprintf(line_buffer, "|%.*s|", map.columns, &map.symbols[(size_t) row * map.columns]);
+        putString(line_buffer, Coord_t{row + 1, 0});
+    }
+
+    // Move cursor onto player character, +1 to account for border
+    moveCursor(Coord_t{map.player.y + 1, map.player.x + 1});
 
     // wait for any keypress
     (void) getKeyInput();
@@ -103,24 +211,6 @@ bool coordInBounds(Coord_t const &coord) {
     return y && x;
 }
 
-// Distance between two points -RAK-
-int coordDistanceBetween(Coord_t const &from, Coord_t const &to) {
-    int dy = from.y - to.y;
-    if (dy < 0) {
-        dy = -dy;
-    }
-
-    int dx = from.x - to.x;
-    if (dx < 0) {
-        dx = -dx;
-    }
-
-    int a = (dy + dx) << 1;
-    int b = dy > dx ? dx : dy;
-
-    return ((a - b) >> 1);
-}
-
 // Checks points north, south, east, and west for a wall -RAK-
 // note that y,x is always coordInBounds(), i.e. 0 < y < dg.height-1,
 // and 0 < x < dg.width-1
@@ -168,10 +258,12 @@ int coordCorridorWallsNextTo(Coord_t const &coord) {
 }
 
 // Returns symbol for given row, column -RAK-
-char caveGetTileSymbol(Coord_t const &coord) {
-    Tile_t const &tile = dg.floor[coord.y][coord.x];
+static char caveTileSymbol(Coord_t const &coord, bool hallucinations) {
+    DungeonFloor_t const &floor = dg.floor;
+    size_t tile = (size_t) coord.y * floor.columns + coord.x;
+    uint8_t creature_id = floor.creatures[tile];
 
-    if (tile.creature_id == 1 && ((py.running_tracker == 0) || config::options::run_print_self)) {
+    if (creature_id == 1 && ((py.running_tracker == 0) || config::options::run_print_self)) {
         return '@';
     }
 
@@ -179,27 +271,30 @@ char caveGetTileSymbol(Coord_t const &coord) {
         return ' ';
     }
 
-    if (py.flags.image > 0 && randomNumber(12) == 1) {
+    if (hallucinations && py.flags.image > 0 && randomNumber(12) == 1) {
         return (uint8_t)(randomNumber(95) + 31);
     }
 
-    if (tile.creature_id > 1 && monsters[tile.creature_id].lit) {
-        return creatures_list[monsters[tile.creature_id].creature_id].sprite;
+    if (creature_id > 1 && monsters[creature_id].lit) {
+        return creatures_list[monsters[creature_id].creature_id].sprite;
     }
 
-    if (!tile.permanent_light && !tile.temporary_light && !tile.field_mark) {
+    size_t word = floor.wordIndex(coord.y, coord.x);
+    if (((floor.permanent_lights[word] | floor.temporary_lights[word] | floor.field_marks[word]) & DungeonFloor_t::bitMask(coord.x)) == 0) {
         return ' ';
     }
 
-    if (tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id != TV_INVIS_TRAP) {
-        return game.treasure.list[tile.treasure_id].sprite;
+    uint8_t treasure_id = floor.treasures[tile];
+    if (treasure_id != 0 && game.treasure.list[treasure_id].category_id != TV_INVIS_TRAP) {
+        return game.treasure.list[treasure_id].sprite;
     }
 
-    if (tile.feature_id <= MAX_CAVE_FLOOR) {
+    uint8_t feature_id = floor.features[tile];
+    if (feature_id <= MAX_CAVE_FLOOR) {
         return '.';
     }
 
-    if (tile.feature_id == TILE_GRANITE_WALL || tile.feature_id == TILE_BOUNDARY_WALL || !config::options::highlight_seams) {
+    if (feature_id == TILE_GRANITE_WALL || feature_id == TILE_BOUNDARY_WALL || !config::options::highlight_seams) {
         return '#';
     }
 
@@ -208,15 +303,28 @@ char caveGetTileSymbol(Coord_t const &coord) {
     return '%';
 }
 
+char caveGetTileSymbol(Coord_t const &coord) {
+    return caveTileSymbol(coord, true);
+}
+
+// The symbol the tile has when the player isn't hallucinating, which
+// draws no random numbers, so the game plays on the same for looking.
+char caveGetSteadyTileSymbol(Coord_t const &coord) {
+    return caveTileSymbol(coord, false);
+}
+
 // Tests a spot for light or field mark status -RAK-
 bool caveTileVisible(Coord_t const &coord) {
-    return dg.floor[coord.y][coord.x].permanent_light || dg.floor[coord.y][coord.x].temporary_light || dg.floor[coord.y][coord.x].field_mark;
+    size_t word = dg.floor.wordIndex(coord.y, coord.x);
+    uint64_t visible = dg.floor.permanent_lights[word] | dg.floor.temporary_lights[word] | dg.floor.field_marks[word];
+
+    return (visible & DungeonFloor_t::bitMask(coord.x)) != 0;
 }
 
 // Places a particular trap at location y, x -RAK-
 void dungeonSetTrap(Coord_t const &coord, int sub_type_id) {
     int free_treasure_id = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_TRAP_LIST + sub_type_id, game.treasure.list[free_treasure_id]);
 }
 
@@ -245,7 +353,7 @@ void trapChangeVisibility(Coord_t const &coord) {
 // Places rubble at location y, x -RAK-
 void dungeonPlaceRubble(Coord_t const &coord) {
     int free_treasure_id = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
     inventoryItemCopyTo(config::dungeon::objects::OBJ_RUBBLE, game.treasure.list[free_treasure_id]);
 }
@@ -264,7 +372,7 @@ void dungeonPlaceGold(Coord_t const &coord) {
         gold_type_id = config::dungeon::objects::MAX_GOLD_TYPES - 1;
     }
 
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_GOLD_LIST + gold_type_id, game.treasure.list[free_treasure_id]);
     game.treasure.list[free_treasure_id].cost += (8L * (int32_t) randomNumber((int) game.treasure.list[free_treasure_id].cost)) + randomNumber(8);
 
@@ -277,7 +385,7 @@ void dungeonPlaceGold(Coord_t const &coord) {
 void dungeonPlaceRandomObjectAt(Coord_t const &coord, bool must_be_small) {
     int free_treasure_id = popt();
 
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
 
     int object_id = itemGetRandomObjectId(dg.current_level, must_be_small);
     inventoryItemCopyTo(sorted_objects[object_id], game.treasure.list[free_treasure_id]);
@@ -352,6 +460,10 @@ void dungeonMoveCreatureRecord(Coord_t const &from, Coord_t const &to) {
     int id = dg.floor[from.y][from.x].creature_id;
     dg.floor[from.y][from.x].creature_id = 0;
     dg.floor[to.y][to.x].creature_id = (uint8_t) id;
+
+    if (id >= config::monsters::MON_MIN_INDEX_ID) {
+        monsterIndexMove(id, from, to);
+    }
 }
 
 // Room is lit, make it appear -RAK-
@@ -364,13 +476,28 @@ void dungeonLightRoom(Coord_t const &coord) {
     int bottom = top + height_middle - 1;
     int right = left + width_middle - 1;
 
+    DungeonFloor_t &floor = dg.floor;
+
+    // A custom level size doesn't have to be a whole number of blocks
+    bottom = std::min(bottom, floor.rows - 1);
+    right = std::min(right, floor.columns - 1);
+
     Coord_t location = Coord_t{0, 0};
 
     for (location.y = top; location.y <= bottom; location.y++) {
-        for (location.x = left; location.x <= right; location.x++) {
-            Tile_t &tile = dg.floor[location.y][location.x];
+        for (int w = left >> 6; w <= right >> 6; w++) {
+            int first = std::max(left - (w << 6), 0);
+            int last = std::min(right - (w << 6), 63);
+            size_t word = floor.wordIndex(location.y, w << 6);
+
+            // Room tiles of the block, in this word of the row, still to be lit
+            uint64_t unlit = floor.room_lights[word] & ~floor.permanent_lights[word] & (~(uint64_t) 0 >> (63 - last)) & (~(uint64_t) 0 << first);
+
+            int bit;
+            while ((bit = getAndClearFirstBit(unlit)) >= 0) {
+                location.x = (w << 6) + bit;
+                Tile_t tile = dg.floor[location.y][location.x];
 
-            if (tile.perma_lit_room && !tile.permanent_light) {
                 tile.permanent_light = true;
 
                 if (tile.feature_id == TILE_DARK_FLOOR) {
@@ -398,16 +525,53 @@ void dungeonLiteSpot(Coord_t const &coord) {
     panelPutTile(symbol, coord);
 }
 
+// The tiles a step of the player's light to a neighbouring tile changes,
+// for each direction of the step, as bits (4 to a row) of the rectangle
+// around both positions. The light has a radius of 1.
+typedef struct {
+    uint16_t leaving[3][3]; // Tiles only the old light was on
+    uint16_t redraw[3][3];  // Tiles entering or leaving the light, and the player's old and new tiles
+} LightStepTiles_t;
+
+static constexpr LightStepTiles_t lightStepTiles() {
+    LightStepTiles_t tiles{};
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int from_y = dy < 0 ? 2 : 1;
+            int from_x = dx < 0 ? 2 : 1;
+            int to_y = from_y + dy;
+            int to_x = from_x + dx;
+
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    bool in_old = y - from_y <= 1 && from_y - y <= 1 && x - from_x <= 1 && from_x - x <= 1;
+                    bool in_new = y - to_y <= 1 && to_y - y <= 1 && x - to_x <= 1 && to_x - x <= 1;
+                    bool player = (y == from_y && x == from_x) || (y == to_y && x == to_x);
+                    auto bit = (uint16_t)(1u << (y * 4 + x));
+
+                    if (in_old && !in_new) {
+                        tiles.leaving[dy + 1][dx + 1] |= bit;
+                    }
+                    if (in_old != in_new || player) {
+                        tiles.redraw[dy + 1][dx + 1] |= bit;
+                    }
+                }
+            }
+        }
+    }
+
+    return tiles;
+}
+
+static constexpr LightStepTiles_t light_step_tiles = lightStepTiles();
+
 // Normal movement
 // When FIND_FLAG,  light only permanent features
 static void sub1MoveLight(Coord_t const &from, Coord_t const &to) {
+    bool lamp_was_on = py.temporary_light_only;
+
     if (py.temporary_light_only) {
-        // Turn off lamp light
-        for (int y = from.y - 1; y <= from.y + 1; y++) {
-            for (int x = from.x - 1; x <= from.x + 1; x++) {
-                dg.floor[y][x].temporary_light = false;
-            }
-        }
         if ((py.running_tracker != 0) && !config::options::run_print_self) {
             py.temporary_light_only = false;
         }
@@ -415,27 +579,86 @@ static void sub1MoveLight(Coord_t const &from, Coord_t const &to) {
         py.temporary_light_only = true;
     }
 
+    bool lamp_on = py.temporary_light_only;
+
+    // A step to a neighbouring tile, with the lamp staying as it was, only
+    // touches the tiles which enter or leave the light, redrawn with the
+    // player's old and new tiles and those that the light makes visible.
+    // Every other tile keeps its symbol. Hallucination draws them all, as
+    // each symbol drawn rolls the RNG, and so does a move onto the same
+    // tile, which is used to refresh the light.
+    bool step = py.flags.image == 0 && lamp_on == lamp_was_on && (from.y != to.y || from.x != to.x) && abs(from.y - to.y) <= 1 && abs(from.x - to.x) <= 1;
+
+    int corner_y = std::min(from.y, to.y) - 1;
+    int corner_x = std::min(from.x, to.x) - 1;
+    uint32_t redraw = 0;
+
+    DungeonFloor_t &floor = dg.floor;
+
+    if (step) {
+        redraw = light_step_tiles.redraw[to.y - from.y + 1][to.x - from.x + 1];
+    }
+
+    if (lamp_was_on) {
+        // Turn off lamp light, the tiles it stays on for are lit again below
+        if (step) {
+            uint32_t leaving = light_step_tiles.leaving[to.y - from.y + 1][to.x - from.x + 1];
+
+            while (leaving != 0) {
+                int bit = getAndClearFirstBit(leaving);
+                int x = corner_x + (bit & 3);
+                floor.temporary_lights[floor.wordIndex(corner_y + (bit >> 2), x)] &= ~DungeonFloor_t::bitMask(x);
+            }
+        } else {
+            for (int y = from.y - 1; y <= from.y + 1; y++) {
+                for (int x = from.x - 1; x <= from.x + 1; x++) {
+                    floor.temporary_lights[floor.wordIndex(y, x)] &= ~DungeonFloor_t::bitMask(x);
+                }
+            }
+        }
+    }
+
     for (int y = to.y - 1; y <= to.y + 1; y++) {
+        uint8_t const *treasures = floor.treasures.data() + (size_t) y * floor.columns;
+
         for (int x = to.x - 1; x <= to.x + 1; x++) {
-            Tile_t &tile = dg.floor[y][x];
+            size_t word = floor.wordIndex(y, x);
+            uint64_t mask = DungeonFloor_t::bitMask(x);
+            bool was_visible = ((floor.permanent_lights[word] | floor.temporary_lights[word] | floor.field_marks[word]) & mask) != 0;
 
             // only light up if normal movement
-            if (py.temporary_light_only) {
-                tile.temporary_light = true;
+            if (lamp_on) {
+                floor.temporary_lights[word] |= mask;
             }
 
-            if (tile.feature_id >= MIN_CAVE_WALL) {
-                tile.permanent_light = true;
-            } else if (!tile.field_mark && tile.treasure_id != 0) {
-                int tval = game.treasure.list[tile.treasure_id].category_id;
+            if ((floor.walls[word] & mask) != 0) {
+                floor.permanent_lights[word] |= mask;
+            } else if ((floor.field_marks[word] & mask) == 0 && treasures[x] != 0) {
+                int tval = game.treasure.list[treasures[x]].category_id;
 
                 if (tval >= TV_MIN_VISIBLE && tval <= TV_MAX_VISIBLE) {
-                    tile.field_mark = true;
+                    floor.field_marks[word] |= mask;
                 }
             }
+
+            if (step && !was_visible && ((floor.permanent_lights[word] | floor.temporary_lights[word] | floor.field_marks[word]) & mask) != 0) {
+                redraw |= 1u << ((y - corner_y) * 4 + (x - corner_x));
+            }
         }
     }
 
+    Coord_t coord = Coord_t{0, 0};
+
+    if (step) {
+        while (redraw != 0) {
+            int bit = getAndClearFirstBit(redraw);
+            coord.y = corner_y + (bit >> 2);
+            coord.x = corner_x + (bit & 3);
+            panelPutTile(caveGetTileSymbol(coord), coord);
+        }
+        return;
+    }
+
     // From uppermost to bottom most lines player was on.
     int top, left, bottom, right;
 
@@ -454,7 +677,6 @@ static void sub1MoveLight(Coord_t const &from, Coord_t const &to) {
         right = from.x + 1;
     }
 
-    Coord_t coord = Coord_t{0, 0};
     for (coord.y = top; coord.y <= bottom; coord.y++) {
         // Leftmost to rightmost do
         for (coord.x = left; coord.x <= right; coord.x++) {
@@ -535,9 +757,13 @@ void dungeonDeleteMonsterRecord(int id) {
     int last_id = next_free_monster_id - 1;
     Monster_t &monster = monsters[last_id];
 
+    monsterIndexRemove(id);
+
     if (id != last_id) {
+        monsterIndexRemove(last_id);
         dg.floor[monster.pos.y][monster.pos.x].creature_id = (uint8_t) id;
         monsters[id] = monsters[last_id];
+        monsterIndexAdd(id);
     }
 
     monsters[last_id] = blank_monster;
@@ -599,7 +825,7 @@ int dungeonSummonObject(Coord_t coord, int amount, int object_type) {
 
 // Deletes object from given location -RAK-
 bool dungeonDeleteObject(Coord_t const &coord) {
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     if (tile.feature_id == TILE_BLOCKED_FLOOR) {
         tile.feature_id = TILE_CORR_FLOOR;
@@ -14,6 +14,93 @@ constexpr uint8_t SCREEN_WIDTH = 66;
 constexpr uint8_t QUART_HEIGHT = (SCREEN_HEIGHT / 4);
 constexpr uint8_t QUART_WIDTH = (SCREEN_WIDTH / 4);
 
+// MAX_HEIGHT by MAX_WIDTH is the classic dungeon level size, larger
+// levels, up to these limits, can be requested with dungeonSetSize().
+constexpr int16_t LEVEL_MAX_HEIGHT = 50 * SCREEN_HEIGHT;
+constexpr int16_t LEVEL_MAX_WIDTH = 50 * SCREEN_WIDTH;
+
+struct DungeonFloor_t;
+
+// TileRow_t is a single row of the floor, it gives `dg.floor[y][x]`
+// indexing the same form it had when the floor was a fixed array.
+class TileRow_t {
+public:
+    TileRow_t(DungeonFloor_t &floor, int y) : floor(floor), y(y) {}
+
+    Tile_t operator[](int x) const;
+
+private:
+    DungeonFloor_t &floor;
+    int y;
+};
+
+// The floor tiles of a level, stored as one plane for each Tile_t field.
+// Byte planes are stored row by row, bit planes use `row_words` words
+// for each row so that every row starts on a word boundary.
+struct DungeonFloor_t {
+    std::vector<uint8_t> creatures;
+    std::vector<uint8_t> treasures;
+    std::vector<uint8_t> features;
+
+    std::vector<uint64_t> walls; // Set when feature_id >= MIN_CAVE_WALL
+    std::vector<uint64_t> room_lights;
+    std::vector<uint64_t> field_marks;
+    std::vector<uint64_t> permanent_lights;
+    std::vector<uint64_t> temporary_lights;
+
+    int16_t rows;
+    int16_t columns;
+    int row_words;
+
+    TileRow_t operator[](int y) { return TileRow_t(*this, y); }
+
+    size_t size() const { return features.size(); }
+
+    // Position of tile y, x in the bit planes
+    size_t wordIndex(int y, int x) const { return (size_t) y * row_words + (x >> 6); }
+    static uint64_t bitMask(int x) { return (uint64_t) 1 << (x & 63); }
+
+    Tile_t tile(int y, int x) {
+        size_t i = (size_t) y * columns + x;
+        size_t word = wordIndex(y, x);
+        uint64_t mask = bitMask(x);
+
+        return Tile_t{
+            creatures.data()[i],
+            treasures.data()[i],
+            TileFeature_t(features.data() + i, walls.data() + word, mask),
+            TileFlag_t(room_lights.data() + word, mask),
+            TileFlag_t(field_marks.data() + word, mask),
+            TileFlag_t(permanent_lights.data() + word, mask),
+            TileFlag_t(temporary_lights.data() + word, mask),
+        };
+    }
+
+    void resize(int height, int width) {
+        rows = (int16_t) height;
+        columns = (int16_t) width;
+        row_words = (width + 63) / 64;
+
+        size_t tiles = (size_t) height * width;
+        size_t words = (size_t) height * row_words;
+
+        creatures.assign(tiles, 0);
+        treasures.assign(tiles, 0);
+        features.assign(tiles, 0);
+        tile_feature_changes++;
+
+        for (auto *plane : {&walls, &room_lights, &field_marks, &permanent_lights, &temporary_lights}) {
+            plane->assign(words, 0);
+        }
+    }
+
+    void clear() { resize(rows, columns); }
+};
+
+inline Tile_t TileRow_t::operator[](int x) const {
+    return floor.tile(y, x);
+}
+
 // DungeonObject_t is a base data object.
 // This holds data for any non-living object in the game such as
 // stairs, rubble, doors, gold, potions, weapons, wands, etc.
@@ -51,20 +138,43 @@ typedef struct {
     // A `true` value means a new level will be generated on next loop iteration
     bool generate_new_level;
 
-    // Floor definitions
-    Tile_t floor[MAX_HEIGHT][MAX_WIDTH];
+    // Floor definitions, sized for the largest level (never smaller than the town)
+    DungeonFloor_t floor;
 } Dungeon_t;
 
-extern Dungeon_t dg;
-extern DungeonObject_t game_objects[MAX_OBJECTS_IN_GAME];
+extern thread_local Dungeon_t dg;
+extern const DungeonObject_t game_objects[MAX_OBJECTS_IN_GAME];
 
+// DungeonMap_t is the dungeon level shrunk to fit on a single screen
+typedef struct {
+    int ratio;           // Dungeon tiles across (and down) each map symbol
+    int rows;
+    int columns;
+    std::string symbols; // Map symbols, row by row
+    Coord_t player;      // Map position of the player, or -1, -1 when not shown
+} DungeonMap_t;
+
+void dungeonBuildMap(DungeonMap_t &map);
 void dungeonDisplayMap();
+bool dungeonSetSize(int height, int width);
+void dungeonGetSize(int &height, int &width);
+void dungeonAllocateFloor();
 
 bool coordInBounds(Coord_t const &coord);
-int coordDistanceBetween(Coord_t const &from, Coord_t const &to);
+
+// Distance between two points -RAK-
+// Called for every monster on every turn, so it is kept inline here and
+// free of branches; a lookup table is no cheaper than the few adds.
+inline int coordDistanceBetween(Coord_t const &from, Coord_t const &to) {
+    int dy = std::abs(from.y - to.y);
+    int dx = std::abs(from.x - to.x);
+
+    return ((dy + dx) * 2 - std::min(dy, dx)) >> 1;
+}
 int coordWallsNextTo(Coord_t const &coord);
 int coordCorridorWallsNextTo(Coord_t const &coord);
 char caveGetTileSymbol(Coord_t const &coord);
+char caveGetSteadyTileSymbol(Coord_t const &coord);
 bool caveTileVisible(Coord_t const &coord);
 
 void dungeonSetTrap(Coord_t const &coord, int sub_type_id);
@@ -88,9 +198,84 @@ void dungeonDeleteMonsterRecord(int id);
 int dungeonSummonObject(Coord_t coord, int amount, int object_type);
 bool dungeonDeleteObject(Coord_t const &coord);
 
+// Scratch memory for the level being generated, handed out by bumping an
+// offset and all taken back with one reset when the next level is. Arrays
+// of any size live as long as their level, and once a few levels have been
+// built the arena has grown to fit and no level allocates from the heap.
+class LevelArena_t {
+  public:
+    void *allocate(size_t bytes, size_t alignment);
+    void reset();
+
+    // `count` value initialized items, never destroyed
+    template <typename T>
+    T *allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Level arena items are never destroyed");
+
+        auto *items = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; i++) {
+            new (&items[i]) T();
+        }
+        return items;
+    }
+
+  private:
+    std::vector<std::vector<uint8_t>> blocks;
+    size_t used = 0; // Bytes handed out of the last block
+};
+
+extern thread_local LevelArena_t level_arena;
+
 // generate the dungeon
 void generateCave();
+void generateCaveFromSeed(uint32_t seed);
+
+// What went into the last level generated, for umoria-levels
+typedef struct {
+    int rooms;         // Rooms of any shape
+    int unusual_rooms; // Overlapping, inner room or cross shaped rooms
+    int vaults;        // Treasure vaults, of inner room and cross shaped rooms
+    int tunnels;
+    int tunnel_length;        // Corridor tiles dug by the tunnelers, not counting doorways
+    int tunnel_steps;         // Steps taken by all the tunnelers
+    int max_tunnel_steps;     // Steps taken by the longest running tunneler
+    int tunnels_out_of_steps; // Tunnelers which gave up before reaching their end
+} DungeonGenerationStats_t;
+
+extern thread_local DungeonGenerationStats_t generation_stats;
+
+// How tunnels between rooms are dug. Classic tunnels wander at random for
+// up to 2000 steps, directed tunnels head for their end and give up after
+// a budget of steps based on its distance. Classic remains the default, as
+// the directed tunneler builds different levels from the same seed.
+enum class TunnelMode {
+    Classic,
+    Directed,
+};
+
+TunnelMode getTunnelMode();
+void setTunnelMode(TunnelMode mode);
+
+// The number of threads building the rooms of each level, each room from
+// an RNG stream of its own. 0, the default, builds them the classic way.
+int getRoomBuildThreads();
+void setRoomBuildThreads(int threads);
+
+// The straight line of tiles a bolt, beam or thrown object flies along,
+// traced ahead of it in one go. tiles[d] is the tile d steps away, with
+// tiles[0] the start (the player's tile, in every caller).
+constexpr int PROJECTILE_PATH_MAX_TILES = 32; // More than the range of any bolt or throw
+
+typedef struct {
+    Coord_t tiles[PROJECTILE_PATH_MAX_TILES];
+    int length;   // The furthest tile listed: the range, unless the line leaves the level first
+    int blocked;  // The first tile which isn't open space, or length + 1
+    int creature; // The first tile with a monster on it short of `blocked`, or length + 1
+} ProjectilePath_t;
+
+void projectilePathTrace(Coord_t from, int direction, int range, ProjectilePath_t &path);
 
 // Line of Sight
 bool los(Coord_t from, Coord_t to);
+bool losFromPlayer(Coord_t to);
 void look();
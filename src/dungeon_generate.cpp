@@ -7,8 +7,23 @@
 
 #include "headers.h"
 
-static Coord_t doors_tk[100];
-static int door_index;
+#include <memory>
+#include <thread>
+
+thread_local DungeonGenerationStats_t generation_stats = DungeonGenerationStats_t{};
+
+static thread_local TunnelMode tunnel_mode = TunnelMode::Classic;
+
+TunnelMode getTunnelMode() {
+    return tunnel_mode;
+}
+
+void setTunnelMode(TunnelMode mode) {
+    tunnel_mode = mode;
+}
+
+static thread_local Coord_t doors_tk[100];
+static thread_local int door_index;
 
 // Returns a Dark/Light floor tile based on dg.current_level, and random number
 static uint8_t dungeonFloorTileForLevel() {
@@ -60,7 +75,7 @@ static void chanceOfRandomDirection(int &vertical, int &horizontal) {
 
 // Blanks out entire cave -RAK-
 static void dungeonBlankEntireCave() {
-    memset((char *) &dg.floor[0][0], 0, sizeof(dg.floor));
+    dg.floor.clear();
 }
 
 // Fills in empty spots with desired rock -RAK-
@@ -79,46 +94,18 @@ static void dungeonFillEmptyTilesWith(uint8_t rock_type) {
     }
 }
 
-#ifdef DEBUG
-#include <assert.h>
-#endif
-
 // Places indestructible rock around edges of dungeon -RAK-
 static void dungeonPlaceBoundaryWalls() {
-    Tile_t(*left_ptr)[MAX_WIDTH];
-    Tile_t(*right_ptr)[MAX_WIDTH];
-
     // put permanent wall on leftmost row and rightmost row
-    left_ptr = (Tile_t(*)[MAX_WIDTH]) & dg.floor[0][0];
-    right_ptr = (Tile_t(*)[MAX_WIDTH]) & dg.floor[0][dg.width - 1];
-
-    for (int i = 0; i < dg.height; i++) {
-#ifdef DEBUG
-        assert((Tile_t *) left_ptr == &floor[i][0]);
-        assert((Tile_t *) right_ptr == &floor[i][dg.width - 1]);
-#endif
-
-        ((Tile_t *) left_ptr)->feature_id = TILE_BOUNDARY_WALL;
-        left_ptr++;
-
-        ((Tile_t *) right_ptr)->feature_id = TILE_BOUNDARY_WALL;
-        right_ptr++;
+    for (int y = 0; y < dg.height; y++) {
+        dg.floor[y][0].feature_id = TILE_BOUNDARY_WALL;
+        dg.floor[y][dg.width - 1].feature_id = TILE_BOUNDARY_WALL;
     }
 
     // put permanent wall on top row and bottom row
-    Tile_t *top_ptr = &dg.floor[0][0];
-    Tile_t *bottom_ptr = &dg.floor[dg.height - 1][0];
-
-    for (int i = 0; i < dg.width; i++) {
-#ifdef DEBUG
-        assert(top_ptr == &floor[0][i]);
-        assert(bottom_ptr == &floor[dg.height - 1][i]);
-#endif
-        top_ptr->feature_id = TILE_BOUNDARY_WALL;
-        top_ptr++;
-
-        bottom_ptr->feature_id = TILE_BOUNDARY_WALL;
-        bottom_ptr++;
+    for (int x = 0; x < dg.width; x++) {
+        dg.floor[0][x].feature_id = TILE_BOUNDARY_WALL;
+        dg.floor[dg.height - 1][x].feature_id = TILE_BOUNDARY_WALL;
     }
 }
 
@@ -162,14 +149,14 @@ static void dungeonPlaceStreamerRock(uint8_t rock_type, int chance_of_treasure)
 
 static void dungeonPlaceOpenDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_OPEN_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_CORR_FLOOR;
 }
 
 static void dungeonPlaceBrokenDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_OPEN_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_CORR_FLOOR;
     game.treasure.list[cur_pos].misc_use = 1;
@@ -177,14 +164,14 @@ static void dungeonPlaceBrokenDoor(Coord_t coord) {
 
 static void dungeonPlaceClosedDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
 }
 
 static void dungeonPlaceLockedDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
     game.treasure.list[cur_pos].misc_use = (int16_t)(randomNumber(10) + 10);
@@ -192,7 +179,7 @@ static void dungeonPlaceLockedDoor(Coord_t coord) {
 
 static void dungeonPlaceStuckDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
     game.treasure.list[cur_pos].misc_use = (int16_t)(-randomNumber(10) - 10);
@@ -200,7 +187,7 @@ static void dungeonPlaceStuckDoor(Coord_t coord) {
 
 static void dungeonPlaceSecretDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_SECRET_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
 }
@@ -236,7 +223,7 @@ static void dungeonPlaceUpStairs(Coord_t coord) {
     }
 
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_UP_STAIR, game.treasure.list[cur_pos]);
 }
 
@@ -247,7 +234,7 @@ static void dungeonPlaceDownStairs(Coord_t coord) {
     }
 
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_DOWN_STAIR, game.treasure.list[cur_pos]);
 }
 
@@ -433,6 +420,8 @@ static void dungeonPlaceRandomSecretDoor(Coord_t coord, int depth, int height, i
 }
 
 static void dungeonPlaceVault(Coord_t coord) {
+    generation_stats.vaults++;
+
     for (int y = coord.y - 1; y <= coord.y + 1; y++) {
         dg.floor[y][coord.x - 1].feature_id = TMP1_WALL;
         dg.floor[y][coord.x + 1].feature_id = TMP1_WALL;
@@ -807,6 +796,60 @@ static void dungeonBuildRoomCrossShaped(Coord_t coord) {
     }
 }
 
+// A directed tunneler may take this many steps for each tile between
+// its ends, plus some for detours, but never more than it can record.
+constexpr int TUNNEL_STEPS_PER_TILE = 3;
+constexpr int TUNNEL_DETOUR_STEPS = 60;
+constexpr int TUNNEL_MAX_STEPS = 1000;
+
+static int tunnelStepBudget(Coord_t start, Coord_t end) {
+    if (tunnel_mode == TunnelMode::Classic) {
+        return 2000;
+    }
+
+    int distance = std::abs(end.y - start.y) + std::abs(end.x - start.x);
+    return std::min(TUNNEL_STEPS_PER_TILE * distance + TUNNEL_DETOUR_STEPS, TUNNEL_MAX_STEPS);
+}
+
+static int directionTowards(int from, int to) {
+    return (from < to) - (to < from);
+}
+
+// The directed tunneler keeps going while its direction still takes it
+// closer to the end, with the odd random turn, and walks alongside room
+// walls for a few steps when it runs into one, rather than waiting in
+// front of the wall for a random turn to come up.
+static void pickDirectedDirection(int &vertical, int &horizontal, int &detour_steps, Coord_t start, Coord_t end) {
+    if (detour_steps > 0) {
+        detour_steps--;
+        return;
+    }
+
+    if (randomNumber(config::dungeon::DUN_RANDOM_DIR) == 1) {
+        chanceOfRandomDirection(vertical, horizontal);
+        return;
+    }
+
+    bool closer = (vertical != 0 && vertical == directionTowards(start.y, end.y)) || (horizontal != 0 && horizontal == directionTowards(start.x, end.x));
+    if (!closer) {
+        pickCorrectDirection(vertical, horizontal, start, end);
+    }
+}
+
+static void pickDetourDirection(int &vertical, int &horizontal, int &detour_steps) {
+    int side = randomNumber(2) == 1 ? -1 : 1;
+
+    if (vertical != 0) {
+        vertical = 0;
+        horizontal = side;
+    } else {
+        vertical = side;
+        horizontal = 0;
+    }
+
+    detour_steps = randomNumber(6);
+}
+
 // Constructs a tunnel between two points
 static void dungeonBuildTunnel(Coord_t start, Coord_t end) {
     Coord_t tunnels_tk[1000], walls_tk[1000];
@@ -821,17 +864,24 @@ static void dungeonBuildTunnel(Coord_t start, Coord_t end) {
     int tunnel_index = 0;
     int wall_index = 0;
 
+    bool directed = tunnel_mode == TunnelMode::Directed;
+    int step_budget = tunnelStepBudget(start, end);
+    int detour_steps = 0;
+
     int y_direction, x_direction;
     pickCorrectDirection(y_direction, x_direction, start, end);
 
     do {
         // prevent infinite loops, just in case
         main_loop_count++;
-        if (main_loop_count > 2000) {
+        if (main_loop_count > step_budget) {
             stop_flag = true;
+            generation_stats.tunnels_out_of_steps++;
         }
 
-        if (randomNumber(100) > config::dungeon::DUN_DIR_CHANGE) {
+        if (directed) {
+            pickDirectedDirection(y_direction, x_direction, detour_steps, start, end);
+        } else if (randomNumber(100) > config::dungeon::DUN_DIR_CHANGE) {
             if (randomNumber(config::dungeon::DUN_RANDOM_DIR) == 1) {
                 chanceOfRandomDirection(y_direction, x_direction);
             } else {
@@ -864,7 +914,10 @@ static void dungeonBuildTunnel(Coord_t start, Coord_t end) {
                 door_flag = false;
                 break;
             case TMP2_WALL:
-                // do nothing
+                // do nothing, unless directed
+                if (directed) {
+                    pickDetourDirection(y_direction, x_direction, detour_steps);
+                }
                 break;
             case TILE_GRANITE_WALL:
                 start.y = tmp_row;
@@ -930,9 +983,13 @@ static void dungeonBuildTunnel(Coord_t start, Coord_t end) {
     for (int i = 0; i < tunnel_index; i++) {
         dg.floor[tunnels_tk[i].y][tunnels_tk[i].x].feature_id = TILE_CORR_FLOOR;
     }
+    generation_stats.tunnels++;
+    generation_stats.tunnel_length += tunnel_index;
+    generation_stats.tunnel_steps += main_loop_count;
+    generation_stats.max_tunnel_steps = std::max(generation_stats.max_tunnel_steps, main_loop_count);
 
     for (int i = 0; i < wall_index; i++) {
-        Tile_t &tile = dg.floor[walls_tk[i].y][walls_tk[i].x];
+        Tile_t tile = dg.floor[walls_tk[i].y][walls_tk[i].x];
 
         if (tile.feature_id == TMP2_WALL) {
             if (randomNumber(100) < config::dungeon::DUN_ROOM_DOORS) {
@@ -965,14 +1022,16 @@ static void dungeonPlaceDoorIfNextToTwoWalls(Coord_t coord) {
 
 // Returns random co-ordinates -RAK-
 static void dungeonNewSpot(Coord_t &coord) {
-    Tile_t *tile = nullptr;
     Coord_t position = Coord_t{0, 0};
+    bool occupied;
 
     do {
         position.y = (int32_t) randomNumber(dg.height - 2);
         position.x = (int32_t) randomNumber(dg.width - 2);
-        tile = &dg.floor[position.y][position.x];
-    } while (tile->feature_id >= MIN_CLOSED_SPACE || tile->creature_id != 0 || tile->treasure_id != 0);
+
+        Tile_t const &tile = dg.floor[position.y][position.x];
+        occupied = tile.feature_id >= MIN_CLOSED_SPACE || tile.creature_id != 0 || tile.treasure_id != 0;
+    } while (occupied);
 
     coord.y = position.y;
     coord.x = position.x;
@@ -991,51 +1050,258 @@ static bool setFloors(int tile_id) {
     return (tile_id <= MAX_CAVE_FLOOR);
 }
 
+// Worker threads
+//
+// All game state is thread_local, so a worker thread is a complete game
+// instance of its own. To build a level, or part of one, it is given the
+// settings generation reads, builds into its own `dg`, `monsters[]` and
+// treasure list, and copies them into a GeneratedLevel_t for the game.
+
+// Everything a worker needs to know of the game to generate a level
+typedef struct {
+    int16_t level;
+    uint32_t seed;
+    RandomMode random_mode;
+    TunnelMode tunnel_mode;
+    SelectionMode selection_mode;
+    int room_threads;
+    int rows;
+    int columns;
+    int16_t player_speed;
+    bool total_winner;
+} LevelRecipe_t;
+
+// A level, or the rooms of one, generated by a worker
+typedef struct {
+    int16_t height;
+    int16_t width;
+    Panel_t panel;
+    DungeonFloor_t floor;
+    Coord_t player;
+    decltype(Game_t::treasure) treasure;
+    Monster_t monsters[MON_TOTAL_ALLOCATIONS];
+    int16_t next_free_monster_id;
+    DungeonGenerationStats_t stats;
+} GeneratedLevel_t;
+
+// Captures the game side of a recipe, the caller sets `level` and `seed`
+static void levelRecipeCapture(LevelRecipe_t &recipe) {
+    recipe.level = dg.current_level;
+    recipe.seed = 0;
+    recipe.random_mode = getRandomMode();
+    recipe.tunnel_mode = getTunnelMode();
+    recipe.selection_mode = getSelectionMode();
+    recipe.room_threads = getRoomBuildThreads();
+    recipe.rows = dg.floor.rows;
+    recipe.columns = dg.floor.columns;
+    recipe.player_speed = py.flags.speed;
+    recipe.total_winner = game.total_winner;
+}
+
+// Workers never wait on a key press, this only answers a prompt left by mistake
+static int levelWorkerKeySource() {
+    return ESCAPE;
+}
+
+// Sets up the worker's game state from a recipe
+static void levelRecipeApply(LevelRecipe_t const &recipe) {
+    // A worker has no terminal, yet a level can still print a message,
+    // such as when its objects are compacted
+    (void) terminalInitializeHeadless(levelWorkerKeySource);
+
+    (void) dungeonSetSize(recipe.rows, recipe.columns);
+
+    py.flags.speed = recipe.player_speed;
+    game.total_winner = recipe.total_winner;
+
+    setRandomMode(recipe.random_mode);
+    setTunnelMode(recipe.tunnel_mode);
+    setSelectionMode(recipe.selection_mode);
+    setRoomBuildThreads(recipe.room_threads);
+
+    dg.current_level = recipe.level;
+}
+
+// Copies what the worker built, for the game thread
+static void generatedLevelSave(GeneratedLevel_t &level) {
+    level.height = dg.height;
+    level.width = dg.width;
+    level.panel = dg.panel;
+    level.floor = std::move(dg.floor);
+    level.player = py.pos;
+    level.treasure = game.treasure;
+    std::copy(std::begin(monsters), std::end(monsters), level.monsters);
+    level.next_free_monster_id = next_free_monster_id;
+    level.stats = generation_stats;
+}
+
+// Parallel room building
+//
+// With room threads set, each room is built from an RNG stream of its own,
+// seeded in room order from the game RNG, and the rooms are shared out
+// between that many workers. A room never reaches outside its block of the
+// room grid, so each block is then copied into the level, along with the
+// objects and monsters in it, in room order. A seed therefore builds the
+// same level whatever the number of threads.
+
+static thread_local int room_build_threads = 0;
+
+int getRoomBuildThreads() {
+    return room_build_threads;
+}
+
+void setRoomBuildThreads(int threads) {
+    room_build_threads = threads;
+}
+
+// Rooms are placed by the room grid, then built from their own seeds
+typedef struct {
+    Coord_t center;
+    int type; // 0 for a plain room, or the unusual room type, 1 to 3
+    uint32_t seed;
+} RoomPlan_t;
+
+static void treasureLinker();
+static void monsterLinker();
+
+static void dungeonBuildRoomOfType(Coord_t coord, int room_type) {
+    if (room_type == 1) {
+        dungeonBuildRoomOverlappingRectangles(coord);
+    } else if (room_type == 2) {
+        dungeonBuildRoomWithInnerRooms(coord);
+    } else if (room_type == 3) {
+        dungeonBuildRoomCrossShaped(coord);
+    } else {
+        dungeonBuildRoom(coord);
+    }
+}
+
+// Runs on a worker thread: builds every `step`th room, from `first`
+static void dungeonBuildRoomsOnWorker(LevelRecipe_t const *recipe, RoomPlan_t const *plans, size_t plan_count, size_t first, size_t step, GeneratedLevel_t *rooms) {
+    levelRecipeApply(*recipe);
+
+    dungeonAllocateFloor();
+    treasureLinker();
+    monsterLinker();
+
+    dg.height = dg.floor.rows;
+    dg.width = dg.floor.columns;
+    py.pos = Coord_t{-1, -1};
+
+    for (size_t i = first; i < plan_count; i += step) {
+        RoomPlan_t const &plan = plans[i];
+
+        setRandomSeed(plan.seed);
+        setRandomStream(randomStreamCreate(plan.seed, RNG_STREAM_ROOMS));
+
+        dungeonBuildRoomOfType(plan.center, plan.type);
+    }
+
+    generatedLevelSave(*rooms);
+}
+
+// Copies the block of the room grid around `center` into the level
+static void dungeonCopyRoomBlock(GeneratedLevel_t &rooms, Coord_t center) {
+    for (int y = center.y - QUART_HEIGHT; y <= center.y + QUART_HEIGHT; y++) {
+        for (int x = center.x - QUART_WIDTH; x <= center.x + QUART_WIDTH; x++) {
+            Tile_t from = rooms.floor[y][x];
+            Tile_t tile = dg.floor[y][x];
+
+            tile.feature_id = from.feature_id;
+            tile.perma_lit_room = from.perma_lit_room;
+            tile.field_mark = from.field_mark;
+            tile.permanent_light = from.permanent_light;
+
+            if (from.treasure_id != 0) {
+                int treasure_id = popt();
+                game.treasure.list[treasure_id] = rooms.treasure.list[from.treasure_id];
+                dungeonSetTreasureId(Coord_t{y, x}, treasure_id);
+            }
+
+            if (from.creature_id > 1) {
+                (void) monsterPlaceCopy(rooms.monsters[from.creature_id]);
+            }
+        }
+    }
+}
+
+static void dungeonBuildRoomsInParallel(RoomPlan_t const *plans, size_t plan_count) {
+    LevelRecipe_t recipe{};
+    levelRecipeCapture(recipe);
+
+    size_t thread_count = std::min((size_t) room_build_threads, plan_count);
+
+    std::vector<std::unique_ptr<GeneratedLevel_t>> rooms;
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < thread_count; i++) {
+        rooms.emplace_back(new GeneratedLevel_t);
+        workers.emplace_back(dungeonBuildRoomsOnWorker, &recipe, plans, plan_count, i, thread_count, rooms.back().get());
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    for (size_t i = 0; i < plan_count; i++) {
+        dungeonCopyRoomBlock(*rooms[i % thread_count], plans[i].center);
+    }
+    for (auto &built : rooms) {
+        generation_stats.vaults += built->stats.vaults;
+    }
+}
+
 // Cave logic flow for generation of new dungeon
 static void dungeonGenerate() {
     // Room initialization
     int row_rooms = 2 * (dg.height / SCREEN_HEIGHT);
     int col_rooms = 2 * (dg.width / SCREEN_WIDTH);
 
-    bool room_map[20][20];
-    for (int row = 0; row < row_rooms; row++) {
-        for (int col = 0; col < col_rooms; col++) {
-            room_map[row][col] = false;
-        }
-    }
+    auto room_count = (size_t) row_rooms * col_rooms;
+    bool *room_map = level_arena.allocateArray<bool>(room_count);
 
-    int random_room_count = randomNumberNormalDistribution(config::dungeon::DUN_ROOMS_MEAN, 2);
+    // Larger than classic levels get the same density of rooms
+    int rooms_mean = config::dungeon::DUN_ROOMS_MEAN * (dg.height * dg.width) / (MAX_HEIGHT * MAX_WIDTH);
+
+    int random_room_count = randomNumberNormalDistribution(rooms_mean, 2);
     for (int i = 0; i < random_room_count; i++) {
-        room_map[randomNumber(row_rooms) - 1][randomNumber(col_rooms) - 1] = true;
+        int row = randomNumber(row_rooms) - 1;
+        int col = randomNumber(col_rooms) - 1;
+        room_map[row * col_rooms + col] = true;
     }
 
     // Build rooms
     int location_id = 0;
-    Coord_t locations[400];
+    Coord_t *locations = level_arena.allocateArray<Coord_t>(room_count + 1);
+    RoomPlan_t *room_plans = level_arena.allocateArray<RoomPlan_t>(room_count);
+    size_t room_plan_count = 0;
 
     for (int row = 0; row < row_rooms; row++) {
         for (int col = 0; col < col_rooms; col++) {
-            if (room_map[row][col]) {
+            if (room_map[row * col_rooms + col]) {
                 locations[location_id].y = (int32_t)(row * (SCREEN_HEIGHT >> 1) + QUART_HEIGHT);
                 locations[location_id].x = (int32_t)(col * (SCREEN_WIDTH >> 1) + QUART_WIDTH);
+                int room_type = 0;
                 if (dg.current_level > randomNumber(config::dungeon::DUN_UNUSUAL_ROOMS)) {
-                    int room_type = randomNumber(3);
-
-                    if (room_type == 1) {
-                        dungeonBuildRoomOverlappingRectangles(locations[location_id]);
-                    } else if (room_type == 2) {
-                        dungeonBuildRoomWithInnerRooms(locations[location_id]);
-                    } else {
-                        dungeonBuildRoomCrossShaped(locations[location_id]);
-                    }
+                    room_type = randomNumber(3);
+                    generation_stats.unusual_rooms++;
+                }
+
+                if (room_build_threads > 0) {
+                    room_plans[room_plan_count++] = RoomPlan_t{locations[location_id], room_type, (uint32_t) rnd()};
                 } else {
-                    dungeonBuildRoom(locations[location_id]);
+                    dungeonBuildRoomOfType(locations[location_id], room_type);
                 }
                 location_id++;
             }
         }
     }
 
+    if (room_plan_count > 0) {
+        dungeonBuildRoomsInParallel(room_plans, room_plan_count);
+    }
+
+    generation_stats.rooms = location_id;
+
     for (int i = 0; i < location_id; i++) {
         int pick1 = randomNumber(location_id) - 1;
         int pick2 = randomNumber(location_id) - 1;
@@ -1143,7 +1409,7 @@ static void dungeonBuildStore(int store_id, Coord_t coord) {
     dg.floor[y][x].feature_id = TILE_CORR_FLOOR;
 
     int cur_pos = popt();
-    dg.floor[y][x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(Coord_t{y, x}, cur_pos);
 
     inventoryItemCopyTo(config::dungeon::objects::OBJ_STORE_DOOR + store_id, game.treasure.list[cur_pos]);
 }
@@ -1162,6 +1428,7 @@ static void monsterLinker() {
         monster = blank_monster;
     }
     next_free_monster_id = config::monsters::MON_MIN_INDEX_ID;
+    monsterIndexReset();
 }
 
 static void dungeonPlaceTownStores() {
@@ -1216,17 +1483,90 @@ static void lightTown() {
 // proud of it.   Adding the stores required some real slucky
 // hooks which I have not had time to re-think. -RAK-
 
+// The stores, walls and stairs of the town are built with the town seed, so
+// the layout is the same on every visit: it is built once, then copied in.
+constexpr int TOWN_ROW_WORDS = (SCREEN_WIDTH + 63) / 64;
+
+typedef struct {
+    bool valid;
+    uint32_t seed;
+    RandomMode random_mode;
+    uint8_t features[SCREEN_HEIGHT][SCREEN_WIDTH];
+    uint64_t walls[SCREEN_HEIGHT][TOWN_ROW_WORDS];
+    std::vector<Inventory_t> treasure_list; // The store doors and stairs
+    std::vector<Coord_t> treasure_coords;
+} TownLayout_t;
+
+static thread_local TownLayout_t town_layout = TownLayout_t{};
+
+static bool townLayoutCached() {
+    return town_layout.valid && town_layout.seed == game.town_seed && town_layout.random_mode == getRandomMode();
+}
+
+static void townLayoutSave() {
+    DungeonFloor_t const &floor = dg.floor;
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        auto row = (size_t) y * floor.columns;
+        std::copy_n(floor.features.begin() + row, SCREEN_WIDTH, town_layout.features[y]);
+        std::copy_n(floor.walls.begin() + floor.wordIndex(y, 0), TOWN_ROW_WORDS, town_layout.walls[y]);
+    }
+
+    town_layout.treasure_list.assign(game.treasure.list + config::treasure::MIN_TREASURE_LIST_ID, game.treasure.list + game.treasure.current_id);
+    town_layout.treasure_coords.assign(town_layout.treasure_list.size(), Coord_t{0, 0});
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            int treasure_id = dg.floor[y][x].treasure_id;
+            if (treasure_id != 0) {
+                town_layout.treasure_coords[treasure_id - config::treasure::MIN_TREASURE_LIST_ID] = Coord_t{y, x};
+            }
+        }
+    }
+
+    town_layout.seed = game.town_seed;
+    town_layout.random_mode = getRandomMode();
+    town_layout.valid = true;
+}
+
+// The floor must be blank, as it is after dungeonBlankEntireCave()
+static void townLayoutRestore() {
+    DungeonFloor_t &floor = dg.floor;
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        auto row = (size_t) y * floor.columns;
+        std::copy_n(town_layout.features[y], SCREEN_WIDTH, floor.features.begin() + row);
+        std::copy_n(town_layout.walls[y], TOWN_ROW_WORDS, floor.walls.begin() + floor.wordIndex(y, 0));
+    }
+    tile_feature_changes++; // copied in whole, not through TileFeature_t
+
+    int treasure_id = config::treasure::MIN_TREASURE_LIST_ID;
+    for (size_t i = 0; i < town_layout.treasure_list.size(); i++, treasure_id++) {
+        game.treasure.list[treasure_id] = town_layout.treasure_list[i];
+        dungeonSetTreasureId(town_layout.treasure_coords[i], treasure_id);
+    }
+    game.treasure.current_id = (int16_t) treasure_id;
+}
+
 // Town logic flow for generation of new town
 static void townGeneration() {
-    seedSet(game.town_seed);
+    // Switching seeds is kept for a cached town too, as restoring the
+    // old seed doesn't leave the RNG exactly where it was.
+    seedSet(game.town_seed, RNG_STREAM_TOWN);
 
-    dungeonPlaceTownStores();
+    if (townLayoutCached()) {
+        townLayoutRestore();
+    } else {
+        dungeonPlaceTownStores();
 
-    dungeonFillEmptyTilesWith(TILE_DARK_FLOOR);
+        dungeonFillEmptyTilesWith(TILE_DARK_FLOOR);
 
-    // make stairs before seedResetToOldSeed, so that they don't move around
-    dungeonPlaceBoundaryWalls();
-    dungeonPlaceStairs(2, 1, 0);
+        // make stairs before seedResetToOldSeed, so that they don't move around
+        dungeonPlaceBoundaryWalls();
+        dungeonPlaceStairs(2, 1, 0);
+
+        townLayoutSave();
+    }
 
     seedResetToOldSeed();
 
@@ -1238,11 +1578,13 @@ static void townGeneration() {
 
     lightTown();
 
-    storeMaintenance();
+    storeScheduleMaintenance();
 }
 
 // Generates a random dungeon level -RAK-
-void generateCave() {
+static void dungeonGenerateLevel() {
+    generation_stats = DungeonGenerationStats_t{};
+
     dg.panel.top = 0;
     dg.panel.bottom = 0;
     dg.panel.left = 0;
@@ -1251,13 +1593,15 @@ void generateCave() {
     py.pos.y = -1;
     py.pos.x = -1;
 
+    dungeonAllocateFloor();
     treasureLinker();
     monsterLinker();
     dungeonBlankEntireCave();
+    level_arena.reset();
 
     // We're in the dungeon more than the town, so let's default to that -MRC-
-    dg.height = MAX_HEIGHT;
-    dg.width = MAX_WIDTH;
+    dg.height = dg.floor.rows;
+    dg.width = dg.floor.columns;
 
     if (dg.current_level == 0) {
         dg.height = SCREEN_HEIGHT;
@@ -1276,3 +1620,146 @@ void generateCave() {
         dungeonGenerate();
     }
 }
+
+// Generates the level `dg.current_level` from a seed of its own, rather than
+// from the game RNG, so the level is the same whatever was played before it.
+// The RNG is left seeded from `seed` afterwards. The town still uses the
+// town seed for its layout.
+void generateCaveFromSeed(uint32_t seed) {
+    setRandomSeed(seed);
+    setRandomStream(randomStreamCreate(seed, RNG_STREAM_LEVELS));
+
+    dungeonGenerateLevel();
+}
+
+// Background level generation (the -p option)
+//
+// Once a level has been entered, the levels above and below it are built
+// on worker threads, each from its own seed drawn from the game RNG, so the
+// level behind a staircase is the same whether or not its worker had
+// finished by the time the player got there. All game state is thread_local,
+// so a worker is a complete game instance of its own: it generates the level
+// into its own `dg`, `monsters[]` and treasure list, which are then copied
+// into a buffer and swapped in here when the player takes the stairs.
+
+struct PregenerationSlot_t {
+    LevelRecipe_t recipe{};
+    std::unique_ptr<GeneratedLevel_t> level;
+    std::thread worker;
+
+    PregenerationSlot_t() {
+        recipe.level = -1;
+    }
+
+    ~PregenerationSlot_t() {
+        wait();
+    }
+
+    void wait() {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+};
+
+// One slot for the level above, one for the level below
+constexpr int PREGENERATION_SLOTS = 2;
+static thread_local PregenerationSlot_t pregeneration_slots[PREGENERATION_SLOTS];
+
+// Runs on the worker thread, with a fresh set of thread_local game state
+static void dungeonPregenerateLevel(LevelRecipe_t const *recipe, GeneratedLevel_t *level) {
+    levelRecipeApply(*recipe);
+
+    generateCaveFromSeed(recipe->seed);
+
+    generatedLevelSave(*level);
+}
+
+// Swaps in the pregenerated level for `dg.current_level`, if there is one.
+// Waits for all the workers, so the slots are free to be used again.
+static bool dungeonTakePregeneratedLevel() {
+    bool taken = false;
+
+    for (auto &slot : pregeneration_slots) {
+        slot.wait();
+
+        bool usable = slot.level != nullptr &&                        //
+                      slot.recipe.level == dg.current_level &&        //
+                      slot.recipe.total_winner == game.total_winner && //
+                      slot.recipe.rows == dg.floor.rows &&             //
+                      slot.recipe.columns == dg.floor.columns;
+
+        if (usable && !taken) {
+            GeneratedLevel_t &level = *slot.level;
+
+            dg.height = level.height;
+            dg.width = level.width;
+            dg.panel = level.panel;
+            std::swap(dg.floor, level.floor);
+
+            py.pos = level.player;
+            game.treasure = level.treasure;
+
+            std::copy(std::begin(level.monsters), std::end(level.monsters), monsters);
+            next_free_monster_id = level.next_free_monster_id;
+
+            // The player may have changed speed since the level was built
+            int speed_change = py.flags.speed - slot.recipe.player_speed;
+
+            monsterIndexReset();
+            for (int id = config::monsters::MON_MIN_INDEX_ID; id < next_free_monster_id; id++) {
+                monsters[id].speed = (int16_t)(monsters[id].speed + speed_change);
+                monsterIndexAdd(id);
+            }
+            treasureFindPositions();
+
+            // The floor was built on another thread, which counted its changes
+            tile_feature_changes++;
+
+            generation_stats = level.stats;
+            taken = true;
+        }
+
+        slot.level = nullptr;
+        slot.recipe.level = -1;
+    }
+
+    return taken;
+}
+
+// Starts building the levels next to the current one
+static void dungeonPregenerateNextLevels() {
+    int16_t const levels[PREGENERATION_SLOTS] = {(int16_t)(dg.current_level - 1), (int16_t)(dg.current_level + 1)};
+
+    for (int i = 0; i < PREGENERATION_SLOTS; i++) {
+        // The town is lit by the time of day, so it is always built when entered
+        if (levels[i] < 1) {
+            continue;
+        }
+
+        PregenerationSlot_t &slot = pregeneration_slots[i];
+        LevelRecipe_t &recipe = slot.recipe;
+
+        levelRecipeCapture(recipe);
+        recipe.level = levels[i];
+        recipe.seed = (uint32_t) rnd();
+
+        slot.level.reset(new GeneratedLevel_t);
+        slot.worker = std::thread(dungeonPregenerateLevel, &slot.recipe, slot.level.get());
+    }
+}
+
+// Generates the next level, or swaps in the one already built in the background
+void generateCave() {
+    PROFILE_SCOPE(GenerateCave);
+
+    if (!dungeonTakePregeneratedLevel()) {
+        dungeonGenerateLevel();
+    }
+
+    TELEMETRY_EVENT(Level, dg.current_level, py.misc.max_dungeon_depth);
+
+    if (game.pregenerate_levels) {
+        dungeonPregenerateNextLevels();
+    }
+}
@@ -23,6 +23,8 @@
 // Because this function uses (short) ints for all calculations, overflow may
 // occur if deltaX and deltaY exceed 90.
 bool los(Coord_t from, Coord_t to) {
+    PROFILE_SCOPE(Los);
+
     int delta_x = to.x - from.x;
     int delta_y = to.y - from.y;
 
@@ -175,6 +177,97 @@ bool los(Coord_t from, Coord_t to) {
     }
 }
 
+// Cache of los() results from the player's position. Monster visibility
+// and most spells need los(py.pos, monster.pos) for every monster on the
+// level, every turn, while the player often doesn't move (resting, searching,
+// fighting) and walls and doors rarely change.
+//
+// Each entry holds the stamp it was computed under, shifted up one bit, and
+// the result in the low bit. Bumping the stamp invalidates the whole cache
+// in O(1), the array only needs clearing when the stamp wraps around. It is
+// bumped when the player moves or `tile_feature_changes` does, los() only
+// looking at the features of the tiles, not at their light.
+static thread_local std::vector<uint16_t> los_cache;
+static thread_local uint16_t los_cache_stamp = 0;
+static thread_local Coord_t los_cache_origin = Coord_t{-1, -1};
+static thread_local uint32_t los_cache_feature_changes = 0;
+
+constexpr uint16_t LOS_CACHE_MAX_STAMP = 0x7FFF;
+
+// Same result as los(py.pos, to), but remembered until the player
+// moves or the dungeon layout changes.
+bool losFromPlayer(Coord_t to) {
+    if (los_cache_origin.y != py.pos.y || los_cache_origin.x != py.pos.x || los_cache_feature_changes != tile_feature_changes || los_cache.size() != dg.floor.size()) {
+        los_cache_origin = py.pos;
+        los_cache_feature_changes = tile_feature_changes;
+
+        if (los_cache_stamp == LOS_CACHE_MAX_STAMP || los_cache.size() != dg.floor.size()) {
+            los_cache.assign(dg.floor.size(), 0);
+            los_cache_stamp = 0;
+        }
+        los_cache_stamp++;
+    }
+
+    uint16_t &entry = los_cache[(size_t) to.y * dg.floor.columns + to.x];
+
+    if ((entry >> 1) != los_cache_stamp) {
+        entry = (uint16_t) ((los_cache_stamp << 1) | (los(py.pos, to) ? 1 : 0));
+    }
+
+    return (entry & 1) != 0;
+}
+
+// Steps of playerMovePosition(), by direction
+static constexpr int8_t projectile_step_y[10] = {0, 1, 1, 1, 0, 0, 0, -1, -1, -1};
+static constexpr int8_t projectile_step_x[10] = {0, -1, 0, 1, -1, 0, 1, -1, 0, 1};
+
+// Traces the line from `from` in `direction`, up to `range` tiles away, as
+// stepping with playerMovePosition() would. The effects of what flies along
+// it are left to the caller, which reads the tiles it reaches as they are
+// then: the blocker and creature found here are as the level was beforehand.
+void projectilePathTrace(Coord_t from, int direction, int range, ProjectilePath_t &path) {
+    range = std::min(range, PROJECTILE_PATH_MAX_TILES - 1);
+
+    int step_y = direction >= 1 && direction <= 9 ? projectile_step_y[direction] : 0;
+    int step_x = direction >= 1 && direction <= 9 ? projectile_step_x[direction] : 0;
+
+    DungeonFloor_t const &floor = dg.floor;
+
+    path.tiles[0] = from;
+    path.length = 0;
+    path.blocked = -1;
+    path.creature = -1;
+
+    Coord_t coord = from;
+    for (int distance = 0;; distance++) {
+        size_t i = (size_t) coord.y * floor.columns + coord.x;
+
+        if (path.blocked < 0 && floor.features[i] >= MIN_CLOSED_SPACE) {
+            path.blocked = distance;
+        }
+        if (path.blocked < 0 && path.creature < 0 && floor.creatures[i] > 1) {
+            path.creature = distance;
+        }
+
+        coord.y += step_y;
+        coord.x += step_x;
+
+        if (distance == range || coord.y < 0 || coord.y >= dg.height || coord.x < 0 || coord.x >= dg.width) {
+            break;
+        }
+
+        path.tiles[distance + 1] = coord;
+        path.length = distance + 1;
+    }
+
+    if (path.blocked < 0) {
+        path.blocked = path.length + 1;
+    }
+    if (path.creature < 0) {
+        path.creature = path.length + 1;
+    }
+}
+
 /*
   An enhanced look, with peripheral vision. Looking all 8 -CJS- directions will
   see everything which ought to be visible. Can specify direction 5, which looks
@@ -224,10 +317,10 @@ bool los(Coord_t from, Coord_t to) {
   dungeon y = py.pos.y + los_fyx * (ray x) + los_fyy * (ray y)
   dungeon x = py.pos.x + los_fxx * (ray x) + los_fxy * (ray y)
 */
-static int los_fxx, los_fxy, los_fyx, los_fyy;
-static int los_num_places_seen;
-static bool los_hack_no_query;
-static int los_rocks_and_objects;
+static thread_local int los_fxx, los_fxy, los_fyx, los_fyy;
+static thread_local int los_num_places_seen;
+static thread_local bool los_hack_no_query;
+static thread_local int los_rocks_and_objects;
 
 // Intended to be indexed by dir/2, since is only
 // relevant to horizontal or vertical directions.
@@ -242,8 +335,22 @@ static int los_map_diagonals2[] = {2, 1, 0, 4, 3};
 
 #define GRADF 10000 // Any sufficiently big number will do
 
-static bool lookRay(int y, int from, int to);
-static bool lookSee(Coord_t coord, bool &transparent);
+// What look() shows of one place, found by sweeping the rays before any of
+// it is shown: the description of each thing is only made once it's shown,
+// and stepping on to the next place is taking the next one of the list.
+typedef struct {
+    Coord_t coord;
+    const char *description;      // "You see", or "You are on" for the player's own tile
+    int monster_id;               // 0 when no monster is shown
+    int treasure_id;              // 0 when no object is shown
+    const char *wall_description; // CNIL when no rock is shown
+} LookTarget_t;
+
+static thread_local std::vector<LookTarget_t> look_targets;
+
+static void lookRay(int y, int from, int to);
+static void lookSee(Coord_t coord, bool &transparent);
+static bool lookShow(LookTarget_t const &target);
 
 // Look at what we can see. This is a free move.
 //
@@ -271,6 +378,7 @@ void look() {
         return;
     }
 
+    look_targets.clear();
     los_num_places_seen = 0;
     los_rocks_and_objects = 0;
 
@@ -278,29 +386,19 @@ void look() {
     los_hack_no_query = false;
 
     bool dummy;
-    if (lookSee(Coord_t{0, 0}, dummy)) {
-        return;
-    }
+    lookSee(Coord_t{0, 0}, dummy);
 
-    bool abort;
     do {
-        abort = false;
         if (dir == 5) {
             for (int i = 1; i <= 4; i++) {
                 los_fxx = los_dir_set_fxx[i];
                 los_fyx = los_dir_set_fyx[i];
                 los_fxy = los_dir_set_fxy[i];
                 los_fyy = los_dir_set_fyy[i];
-                if (lookRay(0, 2 * GRADF - 1, 1)) {
-                    abort = true;
-                    break;
-                }
+                lookRay(0, 2 * GRADF - 1, 1);
                 los_fxy = -los_fxy;
                 los_fyy = -los_fyy;
-                if (lookRay(0, 2 * GRADF, 2)) {
-                    abort = true;
-                    break;
-                }
+                lookRay(0, 2 * GRADF, 2);
             }
         } else if ((dir & 1) == 0) {
             // Straight directions
@@ -310,37 +408,35 @@ void look() {
             los_fyx = los_dir_set_fyx[i];
             los_fxy = los_dir_set_fxy[i];
             los_fyy = los_dir_set_fyy[i];
-            if (lookRay(0, GRADF, 1)) {
-                abort = true;
-            } else {
-                los_fxy = -los_fxy;
-                los_fyy = -los_fyy;
-                abort = lookRay(0, GRADF, 2);
-            }
+            lookRay(0, GRADF, 1);
+            los_fxy = -los_fxy;
+            los_fyy = -los_fyy;
+            lookRay(0, GRADF, 2);
         } else {
             int i = los_map_diagonals1[dir >> 1];
             los_fxx = los_dir_set_fxx[i];
             los_fyx = los_dir_set_fyx[i];
             los_fxy = -los_dir_set_fxy[i];
             los_fyy = -los_dir_set_fyy[i];
-            if (lookRay(1, 2 * GRADF, GRADF)) {
-                abort = true;
-            } else {
-                i = los_map_diagonals2[dir >> 1];
-                los_fxx = los_dir_set_fxx[i];
-                los_fyx = los_dir_set_fyx[i];
-                los_fxy = los_dir_set_fxy[i];
-                los_fyy = los_dir_set_fyy[i];
-                abort = lookRay(1, 2 * GRADF - 1, GRADF);
-            }
+            lookRay(1, 2 * GRADF, GRADF);
+            i = los_map_diagonals2[dir >> 1];
+            los_fxx = los_dir_set_fxx[i];
+            los_fyx = los_dir_set_fyx[i];
+            los_fxy = los_dir_set_fxy[i];
+            los_fyy = los_dir_set_fyy[i];
+            lookRay(1, 2 * GRADF - 1, GRADF);
         }
 
         los_rocks_and_objects++;
-    } while (!abort && config::options::highlight_seams && (los_rocks_and_objects < 2));
+    } while (config::options::highlight_seams && (los_rocks_and_objects < 2));
 
-    if (abort) {
-        printMessage("--Aborting look--");
-        return;
+    for (auto const &target : look_targets) {
+        los_num_places_seen++;
+
+        if (lookShow(target)) {
+            printMessage("--Aborting look--");
+            return;
+        }
     }
 
     if (los_num_places_seen != 0) {
@@ -372,11 +468,11 @@ void look() {
 //     @-------------------->   direction in which you are looking. (x axis)
 //     |
 //     |
-static bool lookRay(int y, int from, int to) {
+static void lookRay(int y, int from, int to) {
     // from is the larger angle of the ray, since we scan towards the
     // center line. If from is smaller, then the ray does not exist.
     if (from <= to || y > config::monsters::MON_MAX_SIGHT) {
-        return false;
+        return;
     }
 
     // Find first visible location along this line. Minimum x such
@@ -395,7 +491,7 @@ static bool lookRay(int y, int from, int to) {
         max_x = config::monsters::MON_MAX_SIGHT;
     }
     if (max_x < x) {
-        return false;
+        return;
     }
 
     // los_hack_no_query is a HACK to prevent doubling up on direct lines of
@@ -406,9 +502,7 @@ static bool lookRay(int y, int from, int to) {
 
     bool transparent;
 
-    if (lookSee(Coord_t{y, x}, transparent)) {
-        return true;
-    }
+    lookSee(Coord_t{y, x}, transparent);
 
     if (y == x) {
         los_hack_no_query = false;
@@ -420,28 +514,24 @@ static bool lookRay(int y, int from, int to) {
 
     while (true) {
         // Look down the window we've found.
-        if (lookRay(y + 1, from, ((2 * y + 1) * (int32_t) GRADF / x))) {
-            return true;
-        }
+        lookRay(y + 1, from, ((2 * y + 1) * (int32_t) GRADF / x));
 
         // Find the start of next window.
         do {
             if (x == max_x) {
-                return false;
+                return;
             }
 
             // See if this seals off the scan. (If y is zero, then it will.)
             from = ((2 * y - 1) * (int32_t) GRADF / x);
 
             if (from <= to) {
-                return false;
+                return;
             }
 
             x++;
 
-            if (lookSee(Coord_t{y, x}, transparent)) {
-                return true;
-            }
+            lookSee(Coord_t{y, x}, transparent);
         } while (!transparent);
 
     init_transparent:
@@ -450,30 +540,30 @@ static bool lookRay(int y, int from, int to) {
         do {
             if (x == max_x) {
                 // The window is trimmed by an earlier limit.
-                return lookRay(y + 1, from, to);
+                lookRay(y + 1, from, to);
+                return;
             }
 
             x++;
 
-            if (lookSee(Coord_t{y, x}, transparent)) {
-                return true;
-            }
+            lookSee(Coord_t{y, x}, transparent);
         } while (transparent);
     }
 }
 
-static bool lookSee(Coord_t coord, bool &transparent) {
+// Adds what there is to be seen at the place to the look targets
+static void lookSee(Coord_t coord, bool &transparent) {
     if (coord.x < 0 || coord.y < 0 || coord.y > coord.x) {
         obj_desc_t error_message = {'\0'};
         (void) sprintf(error_message, "Illegal call to lookSee(%d, %d)", coord.y, coord.x);
         printMessage(error_message);
     }
 
-    const char *description = nullptr;
+    LookTarget_t target{};
     if (coord.x == 0 && coord.y == 0) {
-        description = "You are on";
+        target.description = "You are on";
     } else {
-        description = "You see";
+        target.description = "You see";
     }
 
     int j = py.pos.x + los_fxx * coord.x + los_fxy * coord.y;
@@ -482,94 +572,102 @@ static bool lookSee(Coord_t coord, bool &transparent) {
 
     if (!coordInsidePanel(coord)) {
         transparent = false;
-        return false;
+        return;
     }
 
     Tile_t const &tile = dg.floor[coord.y][coord.x];
     transparent = tile.feature_id <= MAX_OPEN_SPACE;
 
     if (los_hack_no_query) {
-        return false; // Don't look at a direct line of sight. A hack.
+        return; // Don't look at a direct line of sight. A hack.
     }
 
-    char key = ESCAPE;
-    obj_desc_t msg = {'\0'};
+    target.coord = coord;
+    target.wall_description = CNIL;
 
     if (los_rocks_and_objects == 0 && tile.creature_id > 1 && monsters[tile.creature_id].lit) {
-        j = monsters[tile.creature_id].creature_id;
-        (void) sprintf(msg, "%s %s %s. [(r)ecall]", description, isVowel(creatures_list[j].name[0]) ? "an" : "a", creatures_list[j].name);
-        description = "It is on";
-        putStringClearToEOL(msg, Coord_t{0, 0});
-
-        panelMoveCursor(coord);
-        key = getKeyInput();
-
-        if (key == 'r' || key == 'R') {
-            terminalSaveScreen();
-            key = (char) memoryRecall(j);
-            terminalRestoreScreen();
-        }
+        target.monster_id = tile.creature_id;
     }
 
     if (tile.temporary_light || tile.permanent_light || tile.field_mark) {
-        const char *wall_description;
-
         if (tile.treasure_id != 0) {
             if (game.treasure.list[tile.treasure_id].category_id == TV_SECRET_DOOR) {
                 goto granite;
             }
 
             if (los_rocks_and_objects == 0 && game.treasure.list[tile.treasure_id].category_id != TV_INVIS_TRAP) {
-                obj_desc_t obj_string = {'\0'};
-                itemDescription(obj_string, game.treasure.list[tile.treasure_id], true);
-
-                (void) sprintf(msg, "%s %s ---pause---", description, obj_string);
-                description = "It is in";
-                putStringClearToEOL(msg, Coord_t{0, 0});
-
-                panelMoveCursor(coord);
-                key = getKeyInput();
+                target.treasure_id = tile.treasure_id;
             }
         }
 
-        if (((los_rocks_and_objects != 0) || (msg[0] != 0)) && tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (((los_rocks_and_objects != 0) || target.monster_id != 0 || target.treasure_id != 0) && tile.feature_id >= MIN_CLOSED_SPACE) {
             switch (tile.feature_id) {
                 case TILE_BOUNDARY_WALL:
                 case TILE_GRANITE_WALL:
                 granite:
                     // Granite is only interesting if it contains something.
-                    if (msg[0] != 0) {
-                        wall_description = "a granite wall";
-                    } else {
-                        wall_description = CNIL; // In case we jump here
+                    if (target.monster_id != 0 || target.treasure_id != 0) {
+                        target.wall_description = "a granite wall";
                     }
                     break;
                 case TILE_MAGMA_WALL:
-                    wall_description = "some dark rock";
+                    target.wall_description = "some dark rock";
                     break;
                 case TILE_QUARTZ_WALL:
-                    wall_description = "a quartz vein";
+                    target.wall_description = "a quartz vein";
                     break;
                 default:
-                    wall_description = CNIL;
                     break;
             }
-
-            if (wall_description != nullptr) {
-                (void) sprintf(msg, "%s %s ---pause---", description, wall_description);
-                putStringClearToEOL(msg, Coord_t{0, 0});
-                panelMoveCursor(coord);
-                key = getKeyInput();
-            }
         }
     }
 
-    if (msg[0] != 0) {
-        los_num_places_seen++;
-        if (key == ESCAPE) {
-            return true;
+    if (target.monster_id != 0 || target.treasure_id != 0 || target.wall_description != nullptr) {
+        look_targets.push_back(target);
+    }
+}
+
+// Shows the things of a look target in turn, each waiting for a key.
+// Returns true when the look is aborted, with ESCAPE for the last key.
+static bool lookShow(LookTarget_t const &target) {
+    const char *description = target.description;
+    char key = ESCAPE;
+    obj_desc_t msg = {'\0'};
+
+    if (target.monster_id != 0) {
+        int j = monsters[target.monster_id].creature_id;
+        (void) sprintf(msg, "%s %s %s. [(r)ecall]", description, isVowel(creatures_list[j].name[0]) ? "an" : "a", creatures_list[j].name);
+        description = "It is on";
+        putStringClearToEOL(msg, Coord_t{0, 0});
+
+        panelMoveCursor(target.coord);
+        key = getKeyInput();
+
+        if (key == 'r' || key == 'R') {
+            terminalSaveScreen();
+            key = (char) memoryRecall(j);
+            terminalRestoreScreen();
         }
     }
 
-    return false;
+    if (target.treasure_id != 0) {
+        obj_desc_t obj_string = {'\0'};
+        itemDescription(obj_string, game.treasure.list[target.treasure_id], true);
+
+        (void) sprintf(msg, "%s %s ---pause---", description, obj_string);
+        description = "It is in";
+        putStringClearToEOL(msg, Coord_t{0, 0});
+
+        panelMoveCursor(target.coord);
+        key = getKeyInput();
+    }
+
+    if (target.wall_description != nullptr) {
+        (void) sprintf(msg, "%s %s ---pause---", description, target.wall_description);
+        putStringClearToEOL(msg, Coord_t{0, 0});
+        panelMoveCursor(target.coord);
+        key = getKeyInput();
+    }
+
+    return key == ESCAPE;
 }
@@ -5,16 +5,66 @@
 
 #pragma once
 
-// Tile_t holds data about a specific tile in the dungeon.
+// The dungeon floor is stored as separate planes, one for each Tile_t field,
+// rather than as an array of tiles. The flags are bit planes with one bit for
+// each tile, so whole level scans only read the fields they test, and "is
+// wall", "is lit" and "is marked" can be tested 64 tiles at a time.
+
+// TileFlag_t refers to the bit of a single tile in one of the flag planes.
+class TileFlag_t {
+public:
+    TileFlag_t(uint64_t *word, uint64_t mask) : word(word), mask(mask) {}
+
+    operator bool() const { return (*word & mask) != 0; }
+
+    TileFlag_t &operator=(bool value) {
+        if (value) {
+            *word |= mask;
+        } else {
+            *word &= ~mask;
+        }
+        return *this;
+    }
+
+    TileFlag_t &operator=(TileFlag_t const &flag) { return *this = (bool) flag; }
+
+private:
+    uint64_t *word;
+    uint64_t mask;
+};
+
+// Counts the changes to the features of any tile, so that what is worked
+// out from the layout of a level can tell when it has to be done again.
+extern thread_local uint32_t tile_feature_changes;
+
+// TileFeature_t refers to the feature ID of a single tile, and keeps
+// the wall plane in step with it whenever it is changed.
+class TileFeature_t {
+public:
+    TileFeature_t(uint8_t *feature, uint64_t *wall_word, uint64_t mask) : feature(feature), wall(wall_word, mask) {}
+
+    operator uint8_t() const { return *feature; }
+
+    TileFeature_t &operator=(uint8_t value);
+
+    TileFeature_t &operator=(TileFeature_t const &feature_id) { return *this = (uint8_t) feature_id; }
+
+private:
+    uint8_t *feature;
+    TileFlag_t wall;
+};
+
+// Tile_t refers to the data about a specific tile in the dungeon. It is a
+// view onto the floor planes, so it is passed around by value.
 typedef struct {
-    uint8_t creature_id; // ID for any creature occupying the tile
-    uint8_t treasure_id; // ID for any treasure item occupying the tile
-    uint8_t feature_id;  // ID of cave feature; walls, floors, open space, etc.
-
-    bool perma_lit_room : 1;  // Room should be lit with perm light, walls with this set should be perm lit after tunneled out.
-    bool field_mark : 1;      // Field mark, used for traps/doors/stairs, object is hidden if fm is false.
-    bool permanent_light : 1; // Permanent light, used for walls and lighted rooms.
-    bool temporary_light : 1; // Temporary light, used for player's lamp light,etc.
+    uint8_t &creature_id;     // ID for any creature occupying the tile
+    uint8_t &treasure_id;     // ID for any treasure item occupying the tile
+    TileFeature_t feature_id; // ID of cave feature; walls, floors, open space, etc.
+
+    TileFlag_t perma_lit_room;  // Room should be lit with perm light, walls with this set should be perm lit after tunneled out.
+    TileFlag_t field_mark;      // Field mark, used for traps/doors/stairs, object is hidden if fm is false.
+    TileFlag_t permanent_light; // Permanent light, used for walls and lighted rooms.
+    TileFlag_t temporary_light; // Temporary light, used for player's lamp light,etc.
 } Tile_t;
 
 // `fval` definitions: these describe the various types of dungeon floors and
@@ -39,3 +89,10 @@ constexpr uint8_t TILE_GRANITE_WALL = 12;
 constexpr uint8_t TILE_MAGMA_WALL = 13;
 constexpr uint8_t TILE_QUARTZ_WALL = 14;
 constexpr uint8_t TILE_BOUNDARY_WALL = 15;
+
+inline TileFeature_t &TileFeature_t::operator=(uint8_t value) {
+    *feature = value;
+    wall = value >= MIN_CAVE_WALL;
+    tile_feature_changes++;
+    return *this;
+}
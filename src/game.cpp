@@ -9,9 +9,10 @@
 #include "version.h"
 
 // holds the previous rnd state
-static uint32_t old_seed;
+static thread_local uint32_t old_seed;
+static thread_local RandomStream_t old_stream;
 
-Game_t game = Game_t{};
+thread_local Game_t game = Game_t{};
 
 // gets a new random seed for the random number generator
 void seedsInitialize(uint32_t seed) {
@@ -37,16 +38,25 @@ void seedsInitialize(uint32_t seed) {
     }
 }
 
-// change to different random number generator state
-void seedSet(uint32_t seed) {
+// change to different random number generator state, the counter
+// generator also gets a separate stream for each `stream_id`.
+void seedSet(uint32_t seed, uint64_t stream_id) {
     old_seed = getRandomSeed();
+    old_stream = getRandomStream();
 
     // want reproducible state here
     setRandomSeed(seed);
+    setRandomStream(randomStreamCreate(seed, stream_id));
 }
 
 // restore the normal random generator state
 void seedResetToOldSeed() {
+    // The counter generator can restore its exact state.
+    if (getRandomMode() == RandomMode::Counter) {
+        setRandomStream(old_stream);
+        return;
+    }
+
     setRandomSeed(old_seed);
 }
 
@@ -55,29 +65,10 @@ int randomNumber(int const max) {
     return (rnd() % max) + 1;
 }
 
-// Generates a random integer number of NORMAL distribution -RAK-
-int randomNumberNormalDistribution(int mean, int standard) {
-    // alternate randomNumberNormalDistribution() code, slower but much smaller since no table
-    // 2 per 1,000,000 will be > 4*SD, max is 5*SD
-    //
-    // tmp = diceRoll(8, 99);             // mean 400, SD 81
-    // tmp = (tmp - 400) * standard / 81;
-    // return tmp + mean;
-
-    int tmp = randomNumber(SHRT_MAX);
-
-    // off scale, assign random value between 4 and 5 times SD
-    if (tmp == SHRT_MAX) {
-        int offset = 4 * standard + randomNumber(standard);
-
-        // one half are negative
-        if (randomNumber(2) == 1) {
-            offset = -offset;
-        }
-
-        return mean + offset;
-    }
-
+// The index of normal_table a draw of randomNumber(SHRT_MAX) falls on,
+// by binary search. The lookup table below is built from it, so each draw
+// still gives the value it always has.
+static int normalTableSearch(int tmp) {
     // binary search normal normal_table to get index that
     // matches tmp this takes up to 8 iterations.
     int low = 0;
@@ -103,6 +94,52 @@ int randomNumberNormalDistribution(int mean, int standard) {
         iindex = iindex + 1;
     }
 
+    return iindex;
+}
+
+// The index of every draw below SHRT_MAX, so a draw takes one lookup
+// rather than up to 8 search steps. normal_table ends at 32766, which
+// is index 255, so a byte holds any of them.
+typedef struct {
+    uint8_t index[SHRT_MAX];
+} NormalTableIndex_t;
+
+static NormalTableIndex_t normalTableIndexBuild() {
+    NormalTableIndex_t table{};
+    for (int tmp = 1; tmp < SHRT_MAX; tmp++) {
+        table.index[tmp] = (uint8_t) normalTableSearch(tmp);
+    }
+    return table;
+}
+
+// Built before main(), normal_table itself being a constant
+static const NormalTableIndex_t normal_table_index = normalTableIndexBuild();
+
+// Generates a random integer number of NORMAL distribution -RAK-
+int randomNumberNormalDistribution(int mean, int standard) {
+    // alternate randomNumberNormalDistribution() code, slower but much smaller since no table
+    // 2 per 1,000,000 will be > 4*SD, max is 5*SD
+    //
+    // tmp = diceRoll(8, 99);             // mean 400, SD 81
+    // tmp = (tmp - 400) * standard / 81;
+    // return tmp + mean;
+
+    int tmp = randomNumber(SHRT_MAX);
+
+    // off scale, assign random value between 4 and 5 times SD
+    if (tmp == SHRT_MAX) {
+        int offset = 4 * standard + randomNumber(standard);
+
+        // one half are negative
+        if (randomNumber(2) == 1) {
+            offset = -offset;
+        }
+
+        return mean + offset;
+    }
+
+    int iindex = normal_table_index.index[tmp];
+
     // normal_table is based on SD of 64, so adjust the
     // index value here, round the half way case up.
     int offset = ((standard * iindex) + (NORMAL_TABLE_SD >> 1)) / NORMAL_TABLE_SD;
@@ -115,7 +152,67 @@ int randomNumberNormalDistribution(int mean, int standard) {
     return mean + offset;
 }
 
-static struct {
+// Builds the table with Vose's method, values with no weight are left out
+void aliasTableBuild(AliasTable_t &table, std::vector<int16_t> const &values, std::vector<double> const &weights) {
+    table.values.clear();
+    table.thresholds.clear();
+    table.aliases.clear();
+
+    double total = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (weights[i] > 0) {
+            table.values.push_back(values[i]);
+            total += weights[i];
+        }
+    }
+
+    auto columns = (int) table.values.size();
+    table.thresholds.assign((size_t) columns, ALIAS_TABLE_SCALE);
+    table.aliases.assign((size_t) columns, 0);
+
+    // Each column's share of the weight, scaled so an average column holds 1
+    std::vector<double> shares;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (weights[i] > 0) {
+            shares.push_back(weights[i] * columns / total);
+        }
+    }
+
+    std::vector<int16_t> small;
+    std::vector<int16_t> large;
+    for (int i = 0; i < columns; i++) {
+        (shares[i] < 1.0 ? small : large).push_back((int16_t) i);
+    }
+
+    // Every column short of 1 is topped up from one with more than 1,
+    // what is left over (rounding errors) keeps its own value.
+    while (!small.empty() && !large.empty()) {
+        int16_t less = small.back();
+        small.pop_back();
+        int16_t more = large.back();
+        large.pop_back();
+
+        table.thresholds[less] = (int32_t)(shares[less] * ALIAS_TABLE_SCALE + 0.5);
+        table.aliases[less] = more;
+
+        shares[more] -= 1.0 - shares[less];
+        (shares[more] < 1.0 ? small : large).push_back(more);
+    }
+}
+
+int aliasTableDraw(AliasTable_t const &table) {
+    int column = randomNumber((int) table.values.size()) - 1;
+
+    if (randomNumber(ALIAS_TABLE_SCALE) > table.thresholds[column]) {
+        column = table.aliases[column];
+    }
+
+    return table.values[column];
+}
+
+// The options are thread_local, so this table must be too,
+// otherwise it would point at the options of the first thread.
+static thread_local struct {
     const char *o_prompt;
     bool *o_var;
 } game_options[] = {
@@ -319,10 +416,14 @@ bool getAllDirections(const char *prompt, int &direction) {
     }
 }
 
-// Restore the terminal and exit
+// Restore the terminal and exit, a remote player's session only
 void exitProgram() {
     flushInputBuffer();
     terminalRestore();
+
+    if (terminalIsRemote()) {
+        terminalEndRemoteSession();
+    }
     exit(0);
 }
 
@@ -331,6 +432,10 @@ void abortProgram(const char *msg) {
     flushInputBuffer();
     terminalRestore();
 
+    if (terminalIsRemote()) {
+        terminalEndRemoteSession();
+    }
+
     printf("Program was manually aborted with the message:\n");
     printf("%s\n", msg);
 
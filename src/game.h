@@ -54,6 +54,14 @@ typedef struct Game_t {
     char last_command = ' ';          // Save of the previous player command
     int command_count = 0;            // How many times to repeat a specific command -CJS-
 
+    int autosave_turns = 0; // Checkpoint the game every this many turns, `0` is off (-a option)
+
+    bool pregenerate_levels = false; // Build the levels next to the current one in the background (-p option)
+
+    bool lazy_store_maintenance = false; // Restock the stores only once they can be looked at (-u option)
+
+    bool coarse_distant_monsters = false; // Move the monsters out of sight in batches of turns (-e option)
+
     vtype_t character_died_from = {'\0'}; // What the character died from: starvation, Bat, etc.
 
     struct {
@@ -71,17 +79,33 @@ typedef struct Game_t {
     } screen;
 } Game_t;
 
-extern Game_t game;
+// All mutable game state (`game`, `dg`, `py`, `monsters`, `stores`, the RNG
+// seed, etc.) is thread_local: each thread is its own game instance, so any
+// number of independent games can be played side by side in one process.
+extern thread_local Game_t game;
 
-extern int16_t sorted_objects[MAX_DUNGEON_OBJECTS];
-extern uint16_t normal_table[NORMAL_TABLE_SIZE];
-extern int16_t treasure_levels[TREASURE_MAX_LEVELS + 1];
+extern const int16_t (&sorted_objects)[MAX_DUNGEON_OBJECTS]; // Built from game_objects at compile time
+extern const uint16_t normal_table[NORMAL_TABLE_SIZE];
+extern const int16_t (&treasure_levels)[TREASURE_MAX_LEVELS + 1]; // Built from game_objects at compile time
 
 void seedsInitialize(uint32_t seed);
-void seedSet(uint32_t seed);
+void seedSet(uint32_t seed, uint64_t stream_id);
 void seedResetToOldSeed();
 int randomNumber(int max);
 int randomNumberNormalDistribution(int mean, int standard);
+
+// Walker's alias method, a draw from any fixed weighted distribution
+// costs two random numbers whatever the number of values.
+constexpr int ALIAS_TABLE_SCALE = 1 << 30;
+
+typedef struct {
+    std::vector<int16_t> values;
+    std::vector<int32_t> thresholds; // Chance out of ALIAS_TABLE_SCALE of keeping a column's value
+    std::vector<int16_t> aliases;    // Column drawn instead when it isn't kept
+} AliasTable_t;
+
+void aliasTableBuild(AliasTable_t &table, std::vector<int16_t> const &values, std::vector<double> const &weights);
+int aliasTableDraw(AliasTable_t const &table);
 void setGameOptions();
 bool validGameVersion(uint8_t major, uint8_t minor, uint8_t patch);
 bool isCurrentGameVersion(uint8_t major, uint8_t minor, uint8_t patch);
@@ -96,10 +120,29 @@ void abortProgram(const char *msg);
 // game object management
 int popt();
 void pusht(uint8_t treasure_id);
+void dungeonSetTreasureId(Coord_t const &coord, int treasure_id);
+void treasureFindPositions();
+int treasuresWithinArea(Coord_t const &top_left, Coord_t const &bottom_right, Coord_t *coords);
 int itemGetRandomObjectId(int level, bool must_be_small);
+void itemBuildSelectionTables();
+
+// How objects and monsters are picked for a level. Classic picks roll
+// several times (and roll again for a small object), table picks make a
+// single draw from a table built at startup, with the same odds. Classic
+// remains the default, as table picks give different levels from a seed.
+enum class SelectionMode {
+    Classic,
+    Tables,
+};
+
+SelectionMode getSelectionMode();
+void setSelectionMode(SelectionMode mode);
 
 // game files
 bool initializeScoreFile();
+bool fileWriteAll(int fd, std::vector<uint8_t> const &data);
+bool fileReplace(const std::string &filename, std::vector<uint8_t> const &data, int mode);
+FILE *fileOpenOutput(const char *filename);
 void displaySplashScreen();
 void displayTextHelpFile(const std::string &filename);
 void displayDeathFile(const std::string &filename);
@@ -112,9 +155,42 @@ void endGame();
 // save/load
 bool saveGame();
 bool loadGame(bool &generate);
-void setFileptr(FILE *file);
+void autosaveGame();
+constexpr int HANGUP_IMAGE_TURNS = 10; // Game turns between refreshes of the hangup save image
+void hangupImageRefresh();
+bool saveGameOnHangup();
+void hangupSaveOnSignal();
+
+// game_hash.cpp
+uint64_t gameHashPlayer();
+uint64_t gameHashDungeon();
+uint64_t gameHashMonsters();
+uint64_t gameHashTreasure();
+uint64_t gameHashRandom();
+uint64_t gameHashState();
+void gameHashSetTurnOutput(FILE *file);
+void gameHashTurnEnded();
+
+// game_snapshot.cpp
+void gameSnapshotTake();
+bool gameSnapshotRestore();
+
+// game_replay.cpp
+bool replayRecordStart(const std::string &filename, uint32_t seed);
+bool replayReadLog(const std::string &filename, std::vector<uint8_t> &log);
+bool replayPlayStart(const std::string &filename, uint32_t &seed);
+bool replayPlayLog(std::vector<uint8_t> const &log, uint32_t &seed);
+bool replayIsPlaying();
+int replayReadKey();
+void replayRecordKey(char key);
+bool replayKeyCheck(bool pressed);
+uint32_t replayClock(uint32_t now);
+bool replayCheck(bool answer);
 
 // game_run.cpp
 // (includes the playDungeon() main game loop)
 void startMoria(int seed, bool start_new_game);
+void setupSimulatedGame(uint32_t seed);
+void simulateMoria(uint32_t seed);
+void replayMoria(uint32_t seed);
 
@@ -141,14 +141,22 @@ void endGame() {
 
     // add score to score file if applicable
     if (game.character_generated) {
+        TELEMETRY_EVENT(GameEnd, py.misc.level, py.misc.exp, game.character_died_from);
+
         // Clear `game.character_saved`, strange thing to do, but it prevents
         // getKeyInput() from recursively calling endGame() when there has
         // been an eof on stdin detected.
         game.character_saved = false;
-        recordNewHighScore();
+
+        // A replayed game has already been scored, when it was played
+        if (!replayIsPlaying()) {
+            recordNewHighScore();
+        }
         showScoresScreen();
     }
     eraseLine(Coord_t{23, 0});
 
+    TELEMETRY_END_GAME();
+
     exitProgram();
 }
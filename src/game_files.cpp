@@ -7,6 +7,14 @@
 
 #include "headers.h"
 
+#include <map>
+#include <mutex>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
 // This must be included after fcntl.h, which has a prototype for `open' on some
 // systems.  Otherwise, the `open' prototype conflicts with the `topen' declaration.
 
@@ -21,28 +29,181 @@ bool initializeScoreFile() {
     return highscore_fp != nullptr;
 }
 
+// Write the whole of `data` to the file, and make sure it is on the disk
+bool fileWriteAll(int fd, std::vector<uint8_t> const &data) {
+    const uint8_t *ptr = data.data();
+    size_t remaining = data.size();
+
+    while (remaining > 0) {
+        auto written = write(fd, ptr, (unsigned int) remaining);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        ptr += written;
+        remaining -= (size_t) written;
+    }
+
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+}
+
+// Replace the contents of a file with `data`, by way of a temporary file
+// which is renamed over it once safely written. Anyone reading the file
+// sees either all of the old contents, or all of the new.
+bool fileReplace(const std::string &filename, std::vector<uint8_t> const &data, int mode) {
+    std::string temp_filename = filename + ".tmp";
+
+    int fd = open(temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, mode);
+    if (fd < 0) {
+        return false;
+    }
+
+#ifndef _WIN32
+    // exactly `mode`, the umask may not allow a shared file to be group writable
+    (void) fchmod(fd, (mode_t) mode);
+#endif
+
+    bool ok = fileWriteAll(fd, data);
+
+    if (close(fd) < 0) {
+        ok = false;
+    }
+
+#ifdef _WIN32
+    // rename() will not replace an existing file on Windows
+    if (ok) {
+        (void) unlink(filename.c_str());
+    }
+#endif
+
+    if (ok && rename(temp_filename.c_str(), filename.c_str()) < 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        (void) unlink(temp_filename.c_str());
+    }
+
+    return ok;
+}
+
+// Opens a report for writing: a Unix socket when one is listening at
+// `filename`, otherwise the file itself.
+FILE *fileOpenOutput(const char *filename) {
+#ifndef _WIN32
+    struct stat info {};
+    if (stat(filename, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        struct sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        (void) strncpy(address.sun_path, filename, sizeof(address.sun_path) - 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return nullptr;
+        }
+        if (connect(fd, (struct sockaddr *) &address, sizeof(address)) < 0) {
+            (void) close(fd);
+            return nullptr;
+        }
+        return fdopen(fd, "w");
+    }
+#endif
+
+    return fopen(filename, "w");
+}
+
+// The splash, help and death screens are read from their files on first
+// use only, then kept for all the games of the process.
+static std::mutex text_files_mutex;
+static std::map<std::string, std::string> text_files;
+
+// A text file, read from memory line by line as fgets() and feof() would
+typedef struct {
+    const std::string *text; // Kept in `text_files`
+    size_t position;
+    bool end_of_file;
+} TextFile_t;
+
+static bool textFileOpen(const std::string &filename, TextFile_t &file) {
+    std::lock_guard<std::mutex> lock(text_files_mutex);
+
+    auto cached = text_files.find(filename);
+
+    if (cached == text_files.end()) {
+        PROFILE_SCOPE(ReadTextFile);
+
+        FILE *fp = fopen(filename.c_str(), "r");
+        if (fp == nullptr) {
+            return false;
+        }
+
+        std::string text;
+        char buffer[1024];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+            text.append(buffer, count);
+        }
+        (void) fclose(fp);
+
+        cached = text_files.emplace(filename, std::move(text)).first;
+    }
+
+    file.text = &cached->second;
+    file.position = 0;
+    file.end_of_file = false;
+
+    return true;
+}
+
+// Same as fgets(), the line is cut after `size - 1` characters
+static bool textFileGetLine(TextFile_t &file, char *line, int size) {
+    int length = 0;
+
+    while (length < size - 1) {
+        if (file.position == file.text->size()) {
+            file.end_of_file = true;
+            break;
+        }
+
+        char ch = (*file.text)[file.position++];
+        line[length++] = ch;
+
+        if (ch == '\n') {
+            break;
+        }
+    }
+
+    line[length] = '\0';
+
+    return length > 0;
+}
+
 // Attempt to open and print the file containing the intro splash screen text -RAK-
 void displaySplashScreen() {
     vtype_t in_line = {'\0'};
 
-    FILE *screen_file = fopen(config::files::splash_screen.c_str(), "r");
-    if (screen_file != nullptr) {
+    TextFile_t screen_file;
+    if (textFileOpen(config::files::splash_screen, screen_file)) {
         clearScreen();
-        for (int i = 0; fgets(in_line, 80, screen_file) != CNIL; i++) {
+        for (int i = 0; textFileGetLine(screen_file, in_line, 80); i++) {
             putString(in_line, Coord_t{i, 0});
         }
         waitForContinueKey(23);
-
-        (void) fclose(screen_file);
     }
 }
 
 // Open and display a text help file
 // File perusal, primitive, but portable -CJS-
 void displayTextHelpFile(const std::string &filename) {
-    FILE *file = fopen(filename.c_str(), "r");
-    if (file == nullptr) {
-        putStringClearToEOL("Can not find help file '" + filename + "'.", Coord_t{0, 0});
+    TextFile_t file;
+    if (!textFileOpen(filename, file)) {
+        putStringClearToEOL(("Can not find help file '" + filename + "'.").c_str(), Coord_t{0, 0});
         return;
     }
 
@@ -51,11 +212,11 @@ void displayTextHelpFile(const std::string &filename) {
     constexpr uint8_t max_line_length = 80;
     char line_buffer[max_line_length];
 
-    while (feof(file) == 0) {
+    while (!file.end_of_file) {
         clearScreen();
 
         for (int i = 0; i < 23; i++) {
-            if (fgets(line_buffer, max_line_length - 1, file) != CNIL) {
+            if (textFileGetLine(file, line_buffer, max_line_length - 1)) {
                 putString(line_buffer, Coord_t{i, 0});
             }
         }
@@ -66,16 +227,14 @@ void displayTextHelpFile(const std::string &filename) {
         }
     }
 
-    (void) fclose(file);
-
     terminalRestoreScreen();
 }
 
 // Open and display a "death" text file
 void displayDeathFile(const std::string &filename) {
-    FILE *file = fopen(filename.c_str(), "r");
-    if (file == nullptr) {
-        putStringClearToEOL("Can not find help file '" + filename + "'.", Coord_t{0, 0});
+    TextFile_t file;
+    if (!textFileOpen(filename, file)) {
+        putStringClearToEOL(("Can not find help file '" + filename + "'.").c_str(), Coord_t{0, 0});
         return;
     }
 
@@ -84,12 +243,11 @@ void displayDeathFile(const std::string &filename) {
     constexpr uint8_t max_line_length = 80;
     char line_buffer[max_line_length];
 
-    for (int i = 0; i < 23 && feof(file) == 0; i++) {
-        if (fgets(line_buffer, max_line_length - 1, file) != CNIL) {
+    for (int i = 0; i < 23 && !file.end_of_file; i++) {
+        if (textFileGetLine(file, line_buffer, max_line_length - 1)) {
             putString(line_buffer, Coord_t{i, 0});
         }
     }
-    (void) fclose(file);
 }
 
 // Prints a list of random objects to a file. -RAK-
@@ -357,10 +515,15 @@ static void writeInventoryToFile(FILE *inv_file) {
 }
 
 // Print the character to a file or device -RAK-
+//
+// A replay writes nothing, going by whether the file was there, and could
+// be written, when the game was recorded.
 bool outputPlayerCharacterToFile(char *filename) {
-    int fd = open(filename, O_WRONLY | O_CREAT | O_EXCL, 0644);
-    if (fd < 0 && errno == EEXIST) {
-        if (getInputConfirmation("Replace existing file " + std::string(filename) + "?")) {
+    bool playing = replayIsPlaying();
+
+    int fd = playing ? -1 : open(filename, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (replayCheck(fd < 0 && errno == EEXIST)) {
+        if (getInputConfirmation("Replace existing file " + std::string(filename) + "?") && !playing) {
             fd = open(filename, O_WRONLY, 0644);
         }
     }
@@ -375,7 +538,7 @@ bool outputPlayerCharacterToFile(char *filename) {
         file = nullptr;
     }
 
-    if (file == nullptr) {
+    if (!replayCheck(file != nullptr)) {
         if (fd >= 0) {
             (void) close(fd);
         }
@@ -385,11 +548,13 @@ bool outputPlayerCharacterToFile(char *filename) {
         return false;
     }
 
-    writeCharacterSheetToFile(file);
-    writeEquipmentListToFile(file);
-    writeInventoryToFile(file);
+    if (file != nullptr) {
+        writeCharacterSheetToFile(file);
+        writeEquipmentListToFile(file);
+        writeInventoryToFile(file);
 
-    (void) fclose(file);
+        (void) fclose(file);
+    }
 
     putStringClearToEOL("Completed.", Coord_t{0, 0});
 
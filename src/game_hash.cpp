@@ -0,0 +1,235 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Hashes of the game state, to tell whether two runs of a game went the same.
+// Hashing the state after every turn, two runs of a replay log can be
+// compared to find the first turn on which they differ.
+
+#include "headers.h"
+
+// 64 bit FNV-1a, fed the fields one by one, as structs hold padding.
+// The floor planes, with no padding, are hashed by the word instead.
+class StateHash_t {
+  public:
+    template <typename T> void add(T const &value) {
+        auto const *bytes = reinterpret_cast<uint8_t const *>(&value);
+        addBytes(bytes, sizeof(value));
+    }
+
+    template <typename T> void addArray(T const *values, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            add(values[i]);
+        }
+    }
+
+    void addBytes(uint8_t const *bytes, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+    }
+
+    // A floor plane, a word at a time over four independent lanes, which the
+    // compiler can keep in vector registers. Its value is that of the lanes.
+    void addPlane(uint8_t const *bytes, size_t count) {
+        uint64_t lanes[4] = {hash, hash ^ 1, hash ^ 2, hash ^ 3};
+
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            uint64_t words[4];
+            memcpy(words, bytes + i, sizeof(words));
+
+            for (int lane = 0; lane < 4; lane++) {
+                lanes[lane] = (lanes[lane] ^ words[lane]) * PLANE_PRIME;
+                lanes[lane] ^= lanes[lane] >> 29;
+            }
+        }
+
+        for (auto lane : lanes) {
+            add(lane);
+        }
+        addBytes(bytes + i, count - i);
+    }
+
+    uint64_t value() const { return hash; }
+
+  private:
+    static constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+    static constexpr uint64_t PLANE_PRIME = 0x9e3779b97f4a7c15ull;
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+};
+
+static void hashItem(StateHash_t &hash, Inventory_t const &item) {
+    hash.add(item.id);
+    hash.add(item.special_name_id);
+    hash.add(item.flags);
+    hash.add(item.category_id);
+    hash.add(item.misc_use);
+    hash.add(item.cost);
+    hash.add(item.sub_category_id);
+    hash.add(item.items_count);
+    hash.add(item.to_hit);
+    hash.add(item.to_damage);
+    hash.add(item.ac);
+    hash.add(item.to_ac);
+    hash.add(item.damage.dice);
+    hash.add(item.damage.sides);
+    hash.add(item.depth_first_found);
+    hash.add(item.identification);
+}
+
+// The player's stats, status, position and belongings
+uint64_t gameHashPlayer() {
+    StateHash_t hash;
+
+    hash.addArray(py.stats.max, 6);
+    hash.addArray(py.stats.current, 6);
+    hash.addArray(py.stats.modified, 6);
+
+    hash.add(py.flags.status);
+    hash.add(py.flags.food);
+    hash.add(py.flags.speed);
+    hash.add(py.flags.spells_learnt);
+    hash.add(py.flags.spells_worked);
+    hash.add(py.flags.spells_forgotten);
+
+    hash.add(py.pos.y);
+    hash.add(py.pos.x);
+
+    hash.add(py.misc.au);
+    hash.add(py.misc.max_exp);
+    hash.add(py.misc.exp);
+    hash.add(py.misc.level);
+    hash.add(py.misc.max_dungeon_depth);
+    hash.add(py.misc.mana);
+    hash.add(py.misc.max_hp);
+    hash.add(py.misc.current_mana);
+    hash.add(py.misc.current_hp);
+    hash.add(py.misc.current_hp_fraction);
+
+    for (auto const &item : py.inventory) {
+        hashItem(hash, item);
+    }
+
+    return hash.value();
+}
+
+// The current level: its tiles, turn and depth
+uint64_t gameHashDungeon() {
+    StateHash_t hash;
+
+    hash.add(dg.current_level);
+    hash.add(dg.game_turn);
+    hash.add(dg.floor.rows);
+    hash.add(dg.floor.columns);
+
+    DungeonFloor_t const &floor = dg.floor;
+
+    hash.addPlane(floor.creatures.data(), floor.creatures.size());
+    hash.addPlane(floor.treasures.data(), floor.treasures.size());
+    hash.addPlane(floor.features.data(), floor.features.size());
+
+    for (auto const *plane : {&floor.room_lights, &floor.field_marks, &floor.permanent_lights, &floor.temporary_lights}) {
+        hash.addPlane(reinterpret_cast<uint8_t const *>(plane->data()), plane->size() * sizeof(uint64_t));
+    }
+
+    return hash.value();
+}
+
+// The monsters of the level, in their slots
+uint64_t gameHashMonsters() {
+    StateHash_t hash;
+
+    hash.add(next_free_monster_id);
+    for (int id = config::monsters::MON_MIN_INDEX_ID; id < next_free_monster_id; id++) {
+        Monster_t const &monster = monsters[id];
+
+        hash.add(monster.hp);
+        hash.add(monster.sleep_count);
+        hash.add(monster.speed);
+        hash.add(monster.creature_id);
+        hash.add(monster.pos.y);
+        hash.add(monster.pos.x);
+        hash.add(monster.distance_from_player);
+        hash.add(monster.lit);
+        hash.add(monster.stunned_amount);
+        hash.add(monster.confused_amount);
+    }
+
+    return hash.value();
+}
+
+// The objects of the level, in their slots
+uint64_t gameHashTreasure() {
+    StateHash_t hash;
+
+    hash.add(game.treasure.current_id);
+    for (int id = config::treasure::MIN_TREASURE_LIST_ID; id < game.treasure.current_id; id++) {
+        hashItem(hash, game.treasure.list[id]);
+    }
+
+    return hash.value();
+}
+
+// Where the game's RNG is, whichever the generator
+uint64_t gameHashRandom() {
+    RandomState_t state = getRandomState();
+
+    StateHash_t hash;
+    hash.add(state.seed);
+    hash.add(state.stream.key);
+    hash.add(state.stream.counter);
+
+    return hash.value();
+}
+
+constexpr int STATE_HASH_PARTS = 5;
+
+// The hashes of all the parts above, and of them all together
+static uint64_t gameHashParts(uint64_t (&parts)[STATE_HASH_PARTS]) {
+    parts[0] = gameHashDungeon();
+    parts[1] = gameHashMonsters();
+    parts[2] = gameHashPlayer();
+    parts[3] = gameHashTreasure();
+    parts[4] = gameHashRandom();
+
+    StateHash_t hash;
+    hash.addArray(parts, STATE_HASH_PARTS);
+
+    return hash.value();
+}
+
+uint64_t gameHashState() {
+    uint64_t parts[STATE_HASH_PARTS];
+    return gameHashParts(parts);
+}
+
+// Where the hashes are written after every turn, if anywhere
+static thread_local FILE *turn_hash_output = nullptr;
+
+// Has the state hashed after every game turn, one CSV record a turn to
+// `file`, with each part's hash, so the part first differing shows.
+void gameHashSetTurnOutput(FILE *file) {
+    turn_hash_output = file;
+
+    if (file != nullptr) {
+        fprintf(file, "turn,state,dungeon,monsters,player,treasure,random\n");
+    }
+}
+
+void gameHashTurnEnded() {
+    if (turn_hash_output == nullptr) {
+        return;
+    }
+
+    uint64_t parts[STATE_HASH_PARTS];
+    uint64_t state = gameHashParts(parts);
+
+    fprintf(turn_hash_output, "%d,%016llx", dg.game_turn, (unsigned long long) state);
+    for (auto part : parts) {
+        fprintf(turn_hash_output, ",%016llx", (unsigned long long) part);
+    }
+    fprintf(turn_hash_output, "\n");
+}
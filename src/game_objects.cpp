@@ -7,8 +7,7 @@
 
 #include "headers.h"
 
-int16_t sorted_objects[MAX_DUNGEON_OBJECTS];
-int16_t treasure_levels[TREASURE_MAX_LEVELS + 1];
+#include <mutex>
 
 // If too many objects on floor level, delete some of them-RAK-
 static void compactObjects() {
@@ -75,21 +74,86 @@ int popt() {
     return game.treasure.current_id++;
 }
 
+// Where each treasure record was put on the floor. To pusht(), finding the
+// tile of the record it moves without searching the whole level, this is
+// only a hint: it checks the tile, and searches when it doesn't match. But
+// treasuresWithinArea() relies on it, with no search to fall back on, so a
+// record must be put on the floor with dungeonSetTreasureId(), and the
+// positions recreated by treasureFindPositions() after a level is read in.
+static thread_local Coord_t treasure_positions[LEVEL_MAX_OBJECTS];
+
+// Places the treasure record on the floor tile. Use this rather
+// than assigning the tile's treasure_id directly.
+void dungeonSetTreasureId(Coord_t const &coord, int treasure_id) {
+    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) treasure_id;
+    treasure_positions[treasure_id] = coord;
+}
+
+// Recreates the floor position of every treasure record,
+// needed after a level was read from a save file or a snapshot.
+void treasureFindPositions() {
+    DungeonFloor_t const &floor = dg.floor;
+
+    for (int y = 0; y < dg.height; y++) {
+        const uint8_t *row = floor.treasures.data() + (size_t) y * floor.columns;
+
+        for (int x = 0; x < dg.width; x++) {
+            uint8_t treasure_id = row[x];
+
+            if (treasure_id != 0 && treasure_id < LEVEL_MAX_OBJECTS) {
+                treasure_positions[treasure_id] = Coord_t{y, x};
+            }
+        }
+    }
+}
+
+// Fills `coords` with the tiles of the treasure records on the floor inside
+// the given area, lowest record first, going through the records rather than
+// every tile of the area: a level holds at most LEVEL_MAX_OBJECTS of them, a
+// panel alone some 1,500 tiles. The positions are kept for every record
+// put on the floor, so one not matching its tile is not on the floor.
+int treasuresWithinArea(Coord_t const &top_left, Coord_t const &bottom_right, Coord_t *coords) {
+    int count = 0;
+
+    for (int treasure_id = config::treasure::MIN_TREASURE_LIST_ID; treasure_id < game.treasure.current_id; treasure_id++) {
+        Coord_t const &coord = treasure_positions[treasure_id];
+
+        if (coord.y < top_left.y || coord.y > bottom_right.y || coord.x < top_left.x || coord.x > bottom_right.x) {
+            continue;
+        }
+
+        if (coordInBounds(coord) && dg.floor[coord.y][coord.x].treasure_id == treasure_id) {
+            coords[count++] = coord;
+        }
+    }
+
+    return count;
+}
+
 // Pushes a record back onto free space list -RAK-
 // `dungeonDeleteObject()` should always be called instead, unless the object
 // in question is not in the dungeon, e.g. in store1.c and files.c
 void pusht(uint8_t treasure_id) {
     if (treasure_id != game.treasure.current_id - 1) {
-        game.treasure.list[treasure_id] = game.treasure.list[game.treasure.current_id - 1];
+        int last_id = game.treasure.current_id - 1;
+        game.treasure.list[treasure_id] = game.treasure.list[last_id];
 
         // must change the treasure_id in the cave of the object just moved
-        for (int y = 0; y < dg.height; y++) {
-            for (int x = 0; x < dg.width; x++) {
-                if (dg.floor[y][x].treasure_id == game.treasure.current_id - 1) {
-                    dg.floor[y][x].treasure_id = treasure_id;
+        Coord_t coord = treasure_positions[last_id];
+
+        if (dg.floor[coord.y][coord.x].treasure_id == last_id) {
+            dg.floor[coord.y][coord.x].treasure_id = treasure_id;
+        } else {
+            for (int y = 0; y < dg.height; y++) {
+                for (int x = 0; x < dg.width; x++) {
+                    if (dg.floor[y][x].treasure_id == last_id) {
+                        dg.floor[y][x].treasure_id = treasure_id;
+                        coord = Coord_t{y, x};
+                    }
                 }
             }
         }
+        treasure_positions[treasure_id] = coord;
     }
     game.treasure.current_id--;
 
@@ -116,6 +180,64 @@ static bool itemBiggerThanChest(DungeonObject_t const &obj) {
     }
 }
 
+static thread_local SelectionMode selection_mode = SelectionMode::Classic;
+
+SelectionMode getSelectionMode() {
+    return selection_mode;
+}
+
+// The selection tables are only built, once for all threads, when first needed
+void setSelectionMode(SelectionMode mode) {
+    selection_mode = mode;
+
+    if (mode == SelectionMode::Tables) {
+        monsterBuildSelectionTables();
+        itemBuildSelectionTables();
+    }
+}
+
+// The odds of itemGetRandomObjectId() for each level, of any object and of
+// small ones only. `treasure_levels` and `sorted_objects` are the same on
+// every thread, so the tables are shared and only built once.
+static AliasTable_t object_selection_tables[TREASURE_MAX_LEVELS + 1][2];
+
+void itemBuildSelectionTables() {
+    static std::once_flag tables_built;
+
+    std::call_once(tables_built, [] {
+        for (int level = 1; level <= TREASURE_MAX_LEVELS; level++) {
+            int total = treasure_levels[level];
+
+            // Chance of the highest of three objects being of each level
+            double level_odds[TREASURE_MAX_LEVELS + 1] = {};
+            for (int i = 0; i < total; i++) {
+                double highest = ((double) (i + 1) * (i + 1) * (i + 1) - (double) i * i * i) / ((double) total * total * total);
+                level_odds[game_objects[sorted_objects[i]].depth_first_found] += highest;
+            }
+
+            std::vector<int16_t> values;
+            std::vector<double> weights;
+            std::vector<double> small_weights;
+
+            // Half of the picks are uniform, the others uniform within the level of the highest of three
+            for (int i = 0; i < total; i++) {
+                DungeonObject_t const &object = game_objects[sorted_objects[i]];
+
+                int found_level = object.depth_first_found;
+                int first = found_level == 0 ? 0 : treasure_levels[found_level - 1];
+                double weight = 0.5 / total + 0.5 * level_odds[found_level] / (treasure_levels[found_level] - first);
+
+                values.push_back((int16_t) i);
+                weights.push_back(weight);
+                small_weights.push_back(itemBiggerThanChest(object) ? 0 : weight);
+            }
+
+            aliasTableBuild(object_selection_tables[level][0], values, weights);
+            aliasTableBuild(object_selection_tables[level][1], values, small_weights);
+        }
+    });
+}
+
 // Returns the array number of a random object -RAK-
 int itemGetRandomObjectId(int level, bool must_be_small) {
     if (level == 0) {
@@ -131,6 +253,10 @@ int itemGetRandomObjectId(int level, bool must_be_small) {
         }
     }
 
+    if (selection_mode == SelectionMode::Tables) {
+        return aliasTableDraw(object_selection_tables[level][must_be_small ? 1 : 0]);
+    }
+
     int object_id;
 
     // This code has been added to make it slightly more likely to get the
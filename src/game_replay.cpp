@@ -0,0 +1,272 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Replay logs: everything a new game takes from outside, so it can be played again
+
+#include "headers.h"
+
+// A log starts with a header (magic, seed, option flags, level size, and the
+// autosave turns, as saves read the clock too), then holds the events in the
+// order the game took them, one byte per key press.
+// REPLAY_ESCAPE starts the other events:
+//   ESCAPE, 0            a key press of REPLAY_ESCAPE itself
+//   ESCAPE, 1            a key press only checked for, and thrown away
+//   ESCAPE, 2, 4 bytes   a clock reading, the Unix time in little endian
+//   ESCAPE, 3, 0 or 1    an answer from the file system, see replayCheck()
+static const uint8_t replay_magic[4] = {'U', 'M', 'R', '1'};
+
+constexpr uint8_t REPLAY_ESCAPE = 0xFF;
+constexpr uint8_t REPLAY_LITERAL = 0;
+constexpr uint8_t REPLAY_INTERRUPT = 1;
+constexpr uint8_t REPLAY_CLOCK = 2;
+constexpr uint8_t REPLAY_CHECK = 3;
+
+constexpr int REPLAY_HEADER_SIZE = 17;
+
+// The options giving a different game from the same seed and keys
+enum ReplayOption : uint8_t {
+    CoarseMonsters = 1 << 0,
+    FlowPathing = 1 << 1,
+    TableSelection = 1 << 2,
+    PregenerateLevels = 1 << 3,
+    DirectedTunnels = 1 << 4,
+    LazyStores = 1 << 5,
+    Wizard = 1 << 6,
+};
+
+static thread_local FILE *replay_record = nullptr;
+
+static thread_local bool replay_playing = false;
+static thread_local std::vector<uint8_t> replay_log;
+static thread_local size_t replay_position = 0;
+
+static void replayWrite(uint8_t const *data, size_t count) {
+    if (fwrite(data, 1, count, replay_record) != count) {
+        (void) fclose(replay_record);
+        replay_record = nullptr;
+        return;
+    }
+
+    // A crash must still leave the keys leading up to it. Batch games are
+    // let off, they can take thousands of keys a second.
+    if (!terminalIsHeadless()) {
+        (void) fflush(replay_record);
+    }
+}
+
+// Starts recording a new game to `filename`, with the options already set.
+bool replayRecordStart(const std::string &filename, uint32_t seed) {
+    replay_record = fopen(filename.c_str(), "wb");
+    if (replay_record == nullptr) {
+        return false;
+    }
+
+    uint8_t options = 0;
+    options |= game.coarse_distant_monsters ? CoarseMonsters : 0;
+    options |= getPathingMode() == PathingMode::Flow ? FlowPathing : 0;
+    options |= getSelectionMode() == SelectionMode::Tables ? TableSelection : 0;
+    options |= game.pregenerate_levels ? PregenerateLevels : 0;
+    options |= getTunnelMode() == TunnelMode::Directed ? DirectedTunnels : 0;
+    options |= game.lazy_store_maintenance ? LazyStores : 0;
+    options |= game.to_be_wizard ? Wizard : 0;
+
+    int height = 0;
+    int width = 0;
+    dungeonGetSize(height, width);
+
+    uint8_t header[REPLAY_HEADER_SIZE] = {
+        replay_magic[0],
+        replay_magic[1],
+        replay_magic[2],
+        replay_magic[3],
+        (uint8_t) seed,
+        (uint8_t) (seed >> 8),
+        (uint8_t) (seed >> 16),
+        (uint8_t) (seed >> 24),
+        options,
+        (uint8_t) height,
+        (uint8_t) (height >> 8),
+        (uint8_t) width,
+        (uint8_t) (width >> 8),
+        (uint8_t) game.autosave_turns,
+        (uint8_t) (game.autosave_turns >> 8),
+        (uint8_t) (game.autosave_turns >> 16),
+        (uint8_t) (game.autosave_turns >> 24),
+    };
+    replayWrite(header, sizeof(header));
+
+    return replay_record != nullptr;
+}
+
+// Reads the whole of the log in `filename`, to be played with replayPlayLog()
+bool replayReadLog(const std::string &filename, std::vector<uint8_t> &log) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    log.clear();
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        log.insert(log.end(), buffer, buffer + count);
+    }
+    (void) fclose(file);
+
+    return true;
+}
+
+// Loads the log in `filename` to be played, see replayPlayLog()
+bool replayPlayStart(const std::string &filename, uint32_t &seed) {
+    std::vector<uint8_t> log;
+    return replayReadLog(filename, log) && replayPlayLog(log, seed);
+}
+
+// Sets up this thread's game to play `log`, with the options it was recorded
+// with. Its seed goes in `seed`, to start the new game from.
+bool replayPlayLog(std::vector<uint8_t> const &log, uint32_t &seed) {
+    replay_log = log;
+
+    if (replay_log.size() < REPLAY_HEADER_SIZE || !std::equal(std::begin(replay_magic), std::end(replay_magic), replay_log.begin())) {
+        return false;
+    }
+
+    uint8_t const *header = replay_log.data();
+    seed = (uint32_t) header[4] | (uint32_t) header[5] << 8 | (uint32_t) header[6] << 16 | (uint32_t) header[7] << 24;
+
+    uint8_t options = header[8];
+    int height = header[9] | header[10] << 8;
+    int width = header[11] | header[12] << 8;
+    auto autosave_turns = (int32_t) ((uint32_t) header[13] | (uint32_t) header[14] << 8 | (uint32_t) header[15] << 16 | (uint32_t) header[16] << 24);
+
+    if (!dungeonSetSize(height, width)) {
+        return false;
+    }
+
+    game.coarse_distant_monsters = (options & CoarseMonsters) != 0;
+    setPathingMode((options & FlowPathing) != 0 ? PathingMode::Flow : PathingMode::Classic);
+    setSelectionMode((options & TableSelection) != 0 ? SelectionMode::Tables : SelectionMode::Classic);
+    game.pregenerate_levels = (options & PregenerateLevels) != 0;
+    setTunnelMode((options & DirectedTunnels) != 0 ? TunnelMode::Directed : TunnelMode::Classic);
+    game.lazy_store_maintenance = (options & LazyStores) != 0;
+    game.to_be_wizard = (options & Wizard) != 0;
+    game.autosave_turns = autosave_turns;
+
+    replay_position = REPLAY_HEADER_SIZE;
+    replay_playing = true;
+
+    return true;
+}
+
+bool replayIsPlaying() {
+    return replay_playing;
+}
+
+// The event at the play position, when it is the escaped `kind`
+static bool replayNextIs(uint8_t kind) {
+    return replay_position + 1 < replay_log.size() && replay_log[replay_position] == REPLAY_ESCAPE && replay_log[replay_position + 1] == kind;
+}
+
+// Key source of a replay, EOF once the log runs out. A key press
+// thrown away in the log is played where it is checked for instead.
+int replayReadKey() {
+    while (replay_position < replay_log.size()) {
+        uint8_t key = replay_log[replay_position++];
+        if (key != REPLAY_ESCAPE) {
+            return key;
+        }
+        if (replay_position >= replay_log.size()) {
+            break;
+        }
+
+        uint8_t kind = replay_log[replay_position++];
+        if (kind == REPLAY_LITERAL) {
+            return REPLAY_ESCAPE;
+        }
+        if (kind == REPLAY_CLOCK) {
+            replay_position += 4;
+        } else if (kind == REPLAY_CHECK) {
+            replay_position += 1;
+        }
+    }
+
+    return EOF;
+}
+
+void replayRecordKey(char key) {
+    if (replay_record == nullptr) {
+        return;
+    }
+
+    if ((uint8_t) key == REPLAY_ESCAPE) {
+        uint8_t event[2] = {REPLAY_ESCAPE, REPLAY_LITERAL};
+        replayWrite(event, sizeof(event));
+    } else {
+        auto event = (uint8_t) key;
+        replayWrite(&event, 1);
+    }
+}
+
+// Whether a key press was waiting, when the game checks for one without
+// waiting, to stop resting or running. `pressed` is the terminal's answer,
+// which is recorded, and replaced by the log's when playing.
+bool replayKeyCheck(bool pressed) {
+    if (replay_playing) {
+        if (!replayNextIs(REPLAY_INTERRUPT)) {
+            return false;
+        }
+        replay_position += 2;
+        return true;
+    }
+
+    if (pressed && replay_record != nullptr) {
+        uint8_t event[2] = {REPLAY_ESCAPE, REPLAY_INTERRUPT};
+        replayWrite(event, sizeof(event));
+    }
+
+    return pressed;
+}
+
+// The clock reading `now`, recorded, or replaced by the log's when playing
+uint32_t replayClock(uint32_t now) {
+    if (replay_playing) {
+        if (!replayNextIs(REPLAY_CLOCK) || replay_position + 6 > replay_log.size()) {
+            return now;
+        }
+
+        uint8_t const *time = &replay_log[replay_position + 2];
+        replay_position += 6;
+        return (uint32_t) time[0] | (uint32_t) time[1] << 8 | (uint32_t) time[2] << 16 | (uint32_t) time[3] << 24;
+    }
+
+    if (replay_record != nullptr) {
+        uint8_t event[6] = {REPLAY_ESCAPE, REPLAY_CLOCK, (uint8_t) now, (uint8_t) (now >> 8), (uint8_t) (now >> 16), (uint8_t) (now >> 24)};
+        replayWrite(event, sizeof(event));
+    }
+
+    return now;
+}
+
+// Whether a file the game looked for was there, or could be written, when
+// that changes what it asks next. `answer` is recorded, and replaced by the
+// log's when playing.
+bool replayCheck(bool answer) {
+    if (replay_playing) {
+        if (!replayNextIs(REPLAY_CHECK) || replay_position + 3 > replay_log.size()) {
+            return answer;
+        }
+
+        bool logged = replay_log[replay_position + 2] != 0;
+        replay_position += 3;
+        return logged;
+    }
+
+    if (replay_record != nullptr) {
+        uint8_t event[3] = {REPLAY_ESCAPE, REPLAY_CHECK, (uint8_t) (answer ? 1 : 0)};
+        replayWrite(event, sizeof(event));
+    }
+
+    return answer;
+}
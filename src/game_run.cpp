@@ -9,10 +9,9 @@
 
 static void playDungeon();
 
+static void initializeGame(uint32_t seed);
+static void createNewCharacter();
 static void initializeCharacterInventory();
-static void initializeMonsterLevels();
-static void initializeTreasureLevels();
-static void priceAdjust();
 static char originalCommands(char command);
 static void doCommand(char command);
 static bool validCountCommand(char command);
@@ -30,28 +29,10 @@ void startMoria(int seed, bool start_new_game) {
     // This will be overridden by the setting in the game save file.
     config::options::use_roguelike_keys = false;
 
-    priceAdjust();
-
     // Show the game splash screen
     displaySplashScreen();
 
-    // Grab a random seed from the clock
-    seedsInitialize(static_cast<uint32_t>(seed));
-
-    // Init monster and treasure levels for allocate
-    initializeMonsterLevels();
-    initializeTreasureLevels();
-
-    // Init the store inventories
-    storeInitializeOwners();
-
-    // NOTE: base exp levels need initializing before loading a game
-    playerInitializeBaseExperienceLevels();
-
-    // initialize some player fields - may or may not be needed -MRC-
-    py.flags.spells_learnt = 0;
-    py.flags.spells_worked = 0;
-    py.flags.spells_forgotten = 0;
+    initializeGame(static_cast<uint32_t>(seed));
 
     // If -n is not passed, the calling routine will know
     // save file name, hence, this code is not necessary.
@@ -64,8 +45,9 @@ void startMoria(int seed, bool start_new_game) {
     bool result = false;
     bool generate = false;
 
-    if (!start_new_game && (access(config::files::save_game.c_str(), 0) == 0) && loadGame(generate)) {
-        result = true;
+    if (!start_new_game && (access(config::files::save_game.c_str(), 0) == 0)) {
+        PROFILE_SCOPE(LoadGame);
+        result = loadGame(generate);
     }
 
     // enter wizard mode before showing the character display, but must wait
@@ -84,35 +66,7 @@ void startMoria(int seed, bool start_new_game) {
             game.character_is_dead = true;
         }
     } else {
-        // Create character
-        characterCreate();
-
-        py.misc.date_of_birth = getCurrentUnixTime();
-
-        initializeCharacterInventory();
-        py.flags.food = 7500;
-        py.flags.food_digested = 2;
-
-        // Spell and Mana based on class: Mage or Clerical realm.
-        if (classes[py.misc.class_id].class_to_use_mage_spells == config::spells::SPELL_TYPE_MAGE) {
-            clearScreen(); // makes spell list easier to read
-            playerCalculateAllowedSpellsCount(PlayerAttr::A_INT);
-            playerGainMana(PlayerAttr::A_INT);
-        } else if (classes[py.misc.class_id].class_to_use_mage_spells == config::spells::SPELL_TYPE_PRIEST) {
-            playerCalculateAllowedSpellsCount(PlayerAttr::A_WIS);
-            clearScreen(); // force out the 'learn prayer' message
-            playerGainMana(PlayerAttr::A_WIS);
-        }
-
-        // Set some default values -MRC-
-        py.temporary_light_only = false;
-        py.weapon_is_heavy = false;
-        py.pack.heaviness = 0;
-
-        // prevent ^c quit from entering score into scoreboard,
-        // and prevent signal from creating panic save until this
-        // point, all info needed for save file is now valid.
-        game.character_generated = true;
+        createNewCharacter();
         generate = true;
     }
 
@@ -138,7 +92,7 @@ void startMoria(int seed, bool start_new_game) {
         // eof can occur if the process gets a HANGUP signal
         if (eof_flag != 0) {
             (void) strcpy(game.character_died_from, "(end of input: saved)");
-            if (!saveGame()) {
+            if (!saveGameOnHangup() && !saveGame()) {
                 (void) strcpy(game.character_died_from, "unexpected eof");
             }
 
@@ -156,6 +110,122 @@ void startMoria(int seed, bool start_new_game) {
     endGame();
 }
 
+// Creates a new character and its first level (the town) without playing
+// any turns, as simulateMoria() does, also used to set up benchmarks.
+void setupSimulatedGame(uint32_t seed) {
+    config::options::use_roguelike_keys = false;
+
+    initializeGame(seed);
+    createNewCharacter();
+    magicInitializeItemNames();
+
+    generateCave();
+}
+
+// Play a complete new game for automated simulations, the terminal must
+// already be set up with terminalInitializeHeadless(). Unlike startMoria()
+// nothing is saved or scored, and this returns (rather than exiting the
+// program) once the character dies or the key source runs dry.
+//
+// Everything here is thread_local, so each simulated game must be played
+// on a new thread to start from a clean state.
+void simulateMoria(uint32_t seed) {
+    setupSimulatedGame(seed);
+
+    while (!game.character_is_dead && eof_flag == 0) {
+        playDungeon();
+
+        if (!game.character_is_dead && eof_flag == 0) {
+            generateCave();
+        }
+    }
+}
+
+// Play back a replay log set up with replayPlayLog(), for benchmarks. The
+// game goes through the same prompts as a new game of startMoria(), but as
+// with simulateMoria() nothing is saved or scored, and this returns once the
+// character dies or the log runs out.
+void replayMoria(uint32_t seed) {
+    config::options::use_roguelike_keys = false;
+
+    displaySplashScreen();
+    initializeGame(seed);
+
+    if (game.to_be_wizard && !enterWizardMode()) {
+        return;
+    }
+
+    createNewCharacter();
+
+    // The log ran out, or the player quit, before the game began
+    if (eof_flag != 0) {
+        return;
+    }
+
+    magicInitializeItemNames();
+
+    generateCave();
+
+    while (!game.character_is_dead && eof_flag == 0) {
+        playDungeon();
+
+        if (!game.character_is_dead && eof_flag == 0) {
+            generateCave();
+        }
+    }
+}
+
+// Sets up the RNG, the monster/treasure level tables and the stores,
+// ready for a game to be loaded or a new character to be created.
+static void initializeGame(uint32_t seed) {
+    PROFILE_SCOPE(InitializeGame);
+
+    // Grab a random seed from the clock
+    seedsInitialize(seed);
+
+    // Init the store inventories
+    storeInitializeOwners();
+
+    // NOTE: base exp levels need initializing before loading a game
+    playerInitializeBaseExperienceLevels();
+
+    // initialize some player fields - may or may not be needed -MRC-
+    py.flags.spells_learnt = 0;
+    py.flags.spells_worked = 0;
+    py.flags.spells_forgotten = 0;
+}
+
+static void createNewCharacter() {
+    characterCreate();
+
+    py.misc.date_of_birth = getCurrentUnixTime();
+
+    initializeCharacterInventory();
+    py.flags.food = 7500;
+    py.flags.food_digested = 2;
+
+    // Spell and Mana based on class: Mage or Clerical realm.
+    if (classes[py.misc.class_id].class_to_use_mage_spells == config::spells::SPELL_TYPE_MAGE) {
+        clearScreen(); // makes spell list easier to read
+        playerCalculateAllowedSpellsCount(PlayerAttr::A_INT);
+        playerGainMana(PlayerAttr::A_INT);
+    } else if (classes[py.misc.class_id].class_to_use_mage_spells == config::spells::SPELL_TYPE_PRIEST) {
+        playerCalculateAllowedSpellsCount(PlayerAttr::A_WIS);
+        clearScreen(); // force out the 'learn prayer' message
+        playerGainMana(PlayerAttr::A_WIS);
+    }
+
+    // Set some default values -MRC-
+    py.temporary_light_only = false;
+    py.weapon_is_heavy = false;
+    py.pack.heaviness = 0;
+
+    // prevent ^c quit from entering score into scoreboard,
+    // and prevent signal from creating panic save until this
+    // point, all info needed for save file is now valid.
+    game.character_generated = true;
+}
+
 // Init players with some belongings -RAK-
 static void initializeCharacterInventory() {
     Inventory_t item{};
@@ -185,63 +255,6 @@ static void initializeCharacterInventory() {
     }
 }
 
-// Initializes M_LEVEL array for use with PLACE_MONSTER -RAK-
-static void initializeMonsterLevels() {
-    for (auto &level : monster_levels) {
-        level = 0;
-    }
-
-    for (int i = 0; i < MON_MAX_CREATURES - config::monsters::MON_ENDGAME_MONSTERS; i++) {
-        monster_levels[creatures_list[i].level]++;
-    }
-
-    for (int i = 1; i <= MON_MAX_LEVELS; i++) {
-        monster_levels[i] += monster_levels[i - 1];
-    }
-}
-
-// Initializes T_LEVEL array for use with PLACE_OBJECT -RAK-
-static void initializeTreasureLevels() {
-    for (auto &level : treasure_levels) {
-        level = 0;
-    }
-
-    for (int i = 0; i < MAX_DUNGEON_OBJECTS; i++) {
-        treasure_levels[game_objects[i].depth_first_found]++;
-    }
-
-    for (int i = 1; i <= TREASURE_MAX_LEVELS; i++) {
-        treasure_levels[i] += treasure_levels[i - 1];
-    }
-
-    // now produce an array with object indexes sorted by level,
-    // by using the info in treasure_levels, this is an O(n) sort!
-    // this is not a stable sort, but that does not matter
-    int indexes[TREASURE_MAX_LEVELS + 1] = {};
-    for (auto &i : indexes) {
-        i = 1;
-    }
-
-    for (int i = 0; i < MAX_DUNGEON_OBJECTS; i++) {
-        int level = game_objects[i].depth_first_found;
-        int object_id = treasure_levels[level] - indexes[level];
-
-        sorted_objects[object_id] = (int16_t) i;
-
-        indexes[level]++;
-    }
-}
-
-// Adjust prices of objects -RAK-
-static void priceAdjust() {
-#if (COST_ADJUSTMENT != 100)
-    // round half-way cases up
-    for (auto &item : game_objects) {
-        item.cost = ((item.cost * COST_ADJUSTMENT) + 50) / 100;
-    }
-#endif
-}
-
 // Moria game module -RAK-
 // The code in this section has gone through many revisions, and
 // some of it could stand some more hard work. -RAK-
@@ -654,11 +667,6 @@ static void playerUpdateSlowness() {
     }
 }
 
-static void playerUpdateSpeed() {
-    playerUpdateFastness();
-    playerUpdateSlowness();
-}
-
 // Resting is over?
 static void playerUpdateRestingState() {
     if (py.flags.rest > 0) {
@@ -882,6 +890,56 @@ static void playerUpdateWordOfRecall() {
     }
 }
 
+typedef decltype(Player_t::flags) PlayerFlags_t;
+
+// A timed effect on the player, its update does nothing while the
+// counter is zero (or below, apart from resting)
+typedef struct {
+    int16_t PlayerFlags_t::*counter;
+    void (*update)();
+} TimedEffect_t;
+
+// Effects updated each turn before the check for a key press interrupting
+// a rest or run, then those updated after it, in the classic order.
+static const TimedEffect_t timed_effects_before_interrupt[] = {
+    {&PlayerFlags_t::blind, playerUpdateBlindness},
+    {&PlayerFlags_t::confused, playerUpdateConfusion},
+    {&PlayerFlags_t::afraid, playerUpdateFearState},
+    {&PlayerFlags_t::poisoned, playerUpdatePoisonedState},
+    {&PlayerFlags_t::fast, playerUpdateFastness},
+    {&PlayerFlags_t::slow, playerUpdateSlowness},
+    {&PlayerFlags_t::rest, playerUpdateRestingState},
+};
+
+static const TimedEffect_t timed_effects_after_interrupt[] = {
+    {&PlayerFlags_t::image, playerUpdateHallucination},
+    {&PlayerFlags_t::paralysis, playerUpdateParalysis},
+    {&PlayerFlags_t::protect_evil, playerUpdateEvilProtection},
+    {&PlayerFlags_t::invulnerability, playerUpdateInvulnerability},
+    {&PlayerFlags_t::blessed, playerUpdateBlessedness},
+    {&PlayerFlags_t::heat_resistance, playerUpdateHeatResistance},
+    {&PlayerFlags_t::cold_resistance, playerUpdateColdResistance},
+    {&PlayerFlags_t::detect_invisible, playerUpdateDetectInvisible},
+    {&PlayerFlags_t::timed_infra, playerUpdateInfraVision},
+    {&PlayerFlags_t::word_of_recall, playerUpdateWordOfRecall},
+};
+
+// Runs the updates of the active effects only. Most turns none are, so the
+// counters are all looked at in one pass first. None of the updates starts
+// an effect later in the list, which is why that pass can come first.
+template <size_t N>
+static void playerUpdateTimedEffects(TimedEffect_t const (&effects)[N]) {
+    uint32_t active = 0;
+    for (size_t i = 0; i < N; i++) {
+        active |= (uint32_t)(py.flags.*effects[i].counter != 0) << i;
+    }
+
+    int i;
+    while ((i = getAndClearFirstBit(active)) >= 0) {
+        effects[i].update();
+    }
+}
+
 static void playerUpdateStatusFlags() {
     if ((py.flags.status & config::player::status::PY_SPEED) != 0u) {
         py.flags.status &= ~config::player::status::PY_SPEED;
@@ -1034,7 +1092,7 @@ static void executeInputCommands(char &command, int &find_count) {
                 playerEndRunning();
             }
 
-            putQIO();
+            putQIOFrame();
             continue;
         }
 
@@ -1048,8 +1106,28 @@ static void executeInputCommands(char &command, int &find_count) {
 
         message_ready_to_print = false;
 
+        ObservationCommand_t bot_command;
+
         if (game.command_count > 0) {
             game.use_last_direction = true;
+        } else if (observationNextCommand(bot_command)) {
+            // Already in rogue form, with the keys its prompts read queued up
+            char arguments[OBSERVATION_COMMAND_ARGUMENTS + 1] = {};
+            (void) strncpy(arguments, bot_command.arguments, OBSERVATION_COMMAND_ARGUMENTS);
+            terminalQueueKeys(arguments);
+
+            last_input_command = bot_command.command;
+
+            if (bot_command.count > 0) {
+                if (!validCountCommand(last_input_command)) {
+                    game.player_free_turn = true;
+                    last_input_command = ' ';
+                    printMessage("Invalid command with a count.");
+                } else {
+                    game.command_count = bot_command.count;
+                    printCharacterMovementState();
+                }
+            }
         } else {
             last_input_command = getKeyInput();
 
@@ -1087,9 +1165,14 @@ static void executeInputCommands(char &command, int &find_count) {
         // Flash the message line.
         messageLineClear();
         panelMoveCursor(py.pos);
-        putQIO();
+        if (game.command_count > 0) {
+            putQIOFrame();
+        } else {
+            putQIO();
+        }
 
         doCommand(last_input_command);
+        terminalQueueKeys("");
 
         // Find is counted differently, as the command changes.
         if (py.running_tracker != 0) {
@@ -1167,6 +1250,7 @@ static char originalCommands(char command) {
         case '{':
         case '?':
         case 'A':
+        case '_':
             break;
         case '1':
             command = 'b';
@@ -1317,6 +1401,8 @@ static char originalCommands(char command) {
         case CTRL_KEY('G'): // ^G = treasure
         case '@':
         case '+':
+        case '[': // [ = take a snapshot
+        case ']': // ] = back to the snapshot
             break;
         case CTRL_KEY('U'): // ^U = summon
             command = '&';
@@ -1619,6 +1705,22 @@ static void doWizardCommands(char command) {
             // NOTE: every field from the struct needs to be filled correctly
             wizardCreateObjects();
             break;
+        case '[':
+            // Take a snapshot of the game, to go back to
+            gameSnapshotTake();
+            printMessage("Snapshot taken.");
+            break;
+        case ']':
+            // Go back to the last snapshot
+            if (gameSnapshotRestore()) {
+                clearScreen();
+                printCharacterStatsBlock();
+                drawDungeonPanel();
+                printMessage("Back to the snapshot.");
+            } else {
+                printMessage("No snapshot has been taken.");
+            }
+            break;
         default:
             if (config::options::use_roguelike_keys) {
                 putStringClearToEOL("Type '?' or '\\' for help.", Coord_t{0, 0});
@@ -1738,6 +1840,9 @@ static void doCommand(char command) {
         case '>': // (>) go up a staircase
             dungeonGoDownLevel();
             break;
+        case '_': // (_) travel to a staircase
+            playerTravel();
+            break;
         case '?': // (?) help with commands
             if (config::options::use_roguelike_keys) {
                 displayTextHelpFile(config::files::help_roguelike);
@@ -1900,6 +2005,7 @@ static bool validCountCommand(char command) {
         case '/':
         case '<':
         case '>':
+        case '_':
         case '?':
         case 'C':
         case 'E':
@@ -2314,12 +2420,22 @@ static void playDungeon() {
     // Loop until dead,  or new level
     // Exit when `dg.generate_new_level` and `eof_flag` are both set
     do {
+        PROFILE_SCOPE(Turn);
+
         // Increment turn counter
         dg.game_turn++;
 
         // turn over the store contents every, say, 1000 turns
         if (dg.current_level != 0 && dg.game_turn % 1000 == 0) {
-            storeMaintenance();
+            PROFILE_SCOPE(StoreMaintenance);
+            storeScheduleMaintenance();
+        }
+
+        // checkpoint the game, so little is lost if the process dies
+        if (game.autosave_turns > 0 && dg.game_turn % game.autosave_turns == 0) {
+            autosaveGame();
+        } else if (dg.game_turn % HANGUP_IMAGE_TURNS == 0) {
+            hangupImageRefresh();
         }
 
         // Check for creature generation
@@ -2327,84 +2443,79 @@ static void playDungeon() {
             monsterPlaceNewWithinDistance(1, config::monsters::MON_MAX_SIGHT, false);
         }
 
-        playerUpdateLightStatus();
+        // Update the player, the time passing for their status
+        {
+            PROFILE_SCOPE(PlayerStatus);
 
-        //
-        // Update counters and messages
-        //
+            playerUpdateLightStatus();
 
-        // Heroism and Super Heroism must precede anything that can damage player
-        playerUpdateHeroStatus();
+            //
+            // Update counters and messages
+            //
 
-        int regen_amount = playerFoodConsumption();
-        playerUpdateRegeneration(regen_amount);
+            // Heroism and Super Heroism must precede anything that can damage player
+            playerUpdateHeroStatus();
 
-        playerUpdateBlindness();
-        playerUpdateConfusion();
-        playerUpdateFearState();
-        playerUpdatePoisonedState();
-        playerUpdateSpeed();
-        playerUpdateRestingState();
+            int regen_amount = playerFoodConsumption();
+            playerUpdateRegeneration(regen_amount);
 
-        // Check for interrupts to find or rest.
-        int microseconds = (py.running_tracker != 0 ? 0 : 10000);
-        if ((game.command_count > 0 || (py.running_tracker != 0) || py.flags.rest != 0) && checkForNonBlockingKeyPress(microseconds)) {
-            playerDisturb(0, 0);
-        }
+            playerUpdateTimedEffects(timed_effects_before_interrupt);
 
-        playerUpdateHallucination();
-        playerUpdateParalysis();
-        playerUpdateEvilProtection();
-        playerUpdateInvulnerability();
-        playerUpdateBlessedness();
-        playerUpdateHeatResistance();
-        playerUpdateColdResistance();
-        playerUpdateDetectInvisible();
-        playerUpdateInfraVision();
-        playerUpdateWordOfRecall();
-
-        // Random teleportation
-        if (py.flags.teleport && randomNumber(100) == 1) {
-            playerDisturb(0, 0);
-            playerTeleport(40);
-        }
+            // Check for interrupts to find or rest.
+            if ((game.command_count > 0 || (py.running_tracker != 0) || py.flags.rest != 0) && checkForNonBlockingKeyPress()) {
+                playerDisturb(0, 0);
+            }
 
-        // See if we are too weak to handle the weapon or pack. -CJS-
-        if ((py.flags.status & config::player::status::PY_STR_WGT) != 0u) {
-            playerStrength();
-        }
+            playerUpdateTimedEffects(timed_effects_after_interrupt);
 
-        if ((py.flags.status & config::player::status::PY_STUDY) != 0u) {
-            printCharacterStudyInstruction();
-        }
+            // Random teleportation
+            if (py.flags.teleport && randomNumber(100) == 1) {
+                playerDisturb(0, 0);
+                playerTeleport(40);
+            }
 
-        playerUpdateStatusFlags();
+            // See if we are too weak to handle the weapon or pack. -CJS-
+            if ((py.flags.status & config::player::status::PY_STR_WGT) != 0u) {
+                playerStrength();
+            }
 
-        // Allow for a slim chance of detect enchantment -CJS-
-        // for 1st level char, check once every 2160 turns
-        // for 40th level char, check once every 416 turns
-        int chance = 10 + 750 / (5 + py.misc.level);
-        if ((dg.game_turn & 0xF) == 0 && py.flags.confused == 0 && randomNumber(chance) == 1) {
-            playerDetectEnchantment();
-        }
+            if ((py.flags.status & config::player::status::PY_STUDY) != 0u) {
+                printCharacterStudyInstruction();
+            }
 
-        // Check the state of the monster list, and delete some monsters if
-        // the monster list is nearly full.  This helps to avoid problems in
-        // creature.c when monsters try to multiply.  Compact_monsters() is
-        // much more likely to succeed if called from here, than if called
-        // from within updateMonsters().
-        if (MON_TOTAL_ALLOCATIONS - next_free_monster_id < 10) {
-            (void) compactMonsters();
+            playerUpdateStatusFlags();
+
+            // Allow for a slim chance of detect enchantment -CJS-
+            // for 1st level char, check once every 2160 turns
+            // for 40th level char, check once every 416 turns
+            int chance = 10 + 750 / (5 + py.misc.level);
+            if ((dg.game_turn & 0xF) == 0 && py.flags.confused == 0 && randomNumber(chance) == 1) {
+                playerDetectEnchantment();
+            }
+
+            // Check the state of the monster list, and delete some monsters if
+            // the monster list is nearly full.  This helps to avoid problems in
+            // creature.c when monsters try to multiply.  Compact_monsters() is
+            // much more likely to succeed if called from here, than if called
+            // from within updateMonsters().
+            if (MON_TOTAL_ALLOCATIONS - next_free_monster_id < 10) {
+                (void) compactMonsters();
+            }
         }
 
-        // Accept a command?
+        // Accept a command? A turn the player only dug, e.g. every attempt
+        // of a repeated tunnel command, leaves the monsters as idle as a rest.
+        bool player_idle = true;
+
         if (py.flags.paralysis < 1 && py.flags.rest == 0 && !game.character_is_dead) {
+            PROFILE_SCOPE(PlayerCommands);
             executeInputCommands(last_input_command, find_count);
+            player_idle = playerTurnWasTunnelling();
         } else {
-            // if paralyzed, resting, or dead, flush output
+            // if paralyzed, resting, or dead, flush output (once a frame)
             // but first move the cursor onto the player, for aesthetics
             panelMoveCursor(py.pos);
-            putQIO();
+            putQIOFrame();
         }
 
         // Teleport?
@@ -2414,7 +2525,13 @@ static void playDungeon() {
 
         // Move the creatures
         if (!dg.generate_new_level) {
-            updateMonsters(true);
+            if (player_idle) {
+                updateMonstersAfterIdleTurn();
+            } else {
+                updateMonsters(true);
+            }
         }
+
+        gameHashTurnEnded();
     } while (!dg.generate_new_level && (eof_flag == 0));
 }
@@ -8,7 +8,13 @@
 #include "headers.h"
 #include "version.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <signal.h>
 #include <sstream>
+#include <thread>
 
 // For debugging the save file code on systems with broken compilers.
 #define DEBUG(x)
@@ -17,6 +23,10 @@ DEBUG(static FILE *logfile)
 
 static bool saveChar(const std::string &filename);
 static bool svWrite();
+static bool rdOriginalLevel();
+static bool rdCompactLevel();
+static int savedFloorRows();
+static int savedFloorColumns();
 
 static void wrBool(bool value);
 static void wrByte(uint8_t value);
@@ -26,11 +36,24 @@ static void wrBytes(uint8_t *value, int count);
 static void wrString(char *str);
 static void wrShorts(uint16_t *value, int count);
 
+static void wrVarint(uint32_t value);
 static void wrItem(Inventory_t &item);
 static void wrMonster(Monster_t const &monster);
 
+static void putByte(uint8_t value);
 static uint8_t getByte();
 
+static bool readFile(int fd, std::vector<uint8_t> &data);
+static bool writeSaveBuffer(const std::string &filename);
+static bool readSaveBuffer(int fd);
+
+static void encodeSaveBuffer(uint8_t char_tmp);
+static bool replaySaveJournal();
+static void discardSaveJournal();
+static void saveWriterFinish();
+static void encodeTurnBoundary(uint8_t char_tmp);
+static void hangupImagePublish();
+
 static bool rdBool();
 static uint8_t rdByte();
 static uint16_t rdShort();
@@ -39,14 +62,44 @@ static void rdBytes(uint8_t *value, int count);
 static void rdString(char *str);
 static void rdShorts(uint16_t *value, int count);
 
+static uint32_t rdVarint();
+static void wrRecalls();
+static bool rdRecalls();
 static void rdItem(Inventory_t &item);
 static void rdMonster(Monster_t &monster);
 
 // these are used for the save file, to avoid having to pass them to every procedure
-static FILE *fileptr;
-static uint8_t xor_byte;
-static int from_save_file;   // can overwrite old save file when save
-static uint32_t start_time; // time that play started
+static thread_local uint8_t xor_byte;
+static thread_local int from_save_file;   // can overwrite old save file when save
+static thread_local uint32_t start_time; // time that play started
+
+// The save file is encoded into, or decoded from, this buffer and moved to
+// or from the disk in one block, instead of a byte at a time.
+static thread_local std::vector<uint8_t> io_buffer;
+static thread_local size_t io_position; // next byte to decode
+static thread_local bool io_error;      // truncated or invalid data was read
+static thread_local bool io_compact;    // items are stored in the compact v2 layout
+static thread_local bool io_recall_map; // monster memories are listed by a bitmap
+
+// Autosave journal: the decoded save data as it was at the last autosave,
+// and how many bytes have been appended to the journal since the snapshot.
+static thread_local std::vector<uint8_t> journal_state;
+static thread_local size_t journal_size;
+static thread_local uint32_t journal_snapshot_id; // checksum of the save file the journal belongs to
+
+// Save files from 5.7.16 onwards use the compact v2 layout: items only store
+// the fields which differ from their game_objects[] entry, and the dungeon
+// level uses delta coded creature/treasure positions and a variable length
+// RLE for the floor tiles. Anything older is read using the original layout.
+static bool saveFileIsCompact(uint8_t major, uint8_t minor, uint8_t patch) {
+    return major > 5 || (major == 5 && (minor > 7 || (minor == 7 && patch >= 16)));
+}
+
+// Save files from 5.7.17 onwards list the monster memories the player has
+// behind a bitmap, each with only its non-zero fields, see wrRecalls().
+static bool saveFileHasRecallMap(uint8_t major, uint8_t minor, uint8_t patch) {
+    return major > 5 || (major == 5 && (minor > 7 || (minor == 7 && patch >= 17)));
+}
 
 // This save package was brought to by                -JWT-
 // and                                                -RAK-
@@ -55,6 +108,12 @@ static uint32_t start_time; // time that play started
 // and completely rewritten again! for portability by -JEW-
 
 // Set up prior to actual save, do the save, then clean up
+//
+// Unlike autosaveGame(), the full save is written here and waited on, not
+// handed to the writer thread: it ends the game, right before the program
+// exits or the session is hung up, so the write has to be waited for anyway,
+// and a failure has to be put to the player (the retry loop below) while
+// they are still there to answer.
 bool saveGame() {
     vtype_t input = {'\0'};
     std::string output;
@@ -79,7 +138,7 @@ bool saveGame() {
             }
         }
         output = "Saving with '" + config::files::save_game + "'...";
-        putStringClearToEOL(output, Coord_t{0, 0});
+        putStringClearToEOL(output.c_str(), Coord_t{0, 0});
     }
 
     return true;
@@ -135,23 +194,7 @@ static bool svWrite() {
         l |= 0x40000000L;
     }
 
-    for (int i = 0; i < MON_MAX_CREATURES; i++) {
-        Recall_t &r = creature_recall[i];
-        if (r.movement || r.defenses || r.kills || r.spells || r.deaths || r.attacks[0] || r.attacks[1] || r.attacks[2] || r.attacks[3]) {
-            wrShort((uint16_t) i);
-            wrLong(r.movement);
-            wrLong(r.spells);
-            wrShort(r.kills);
-            wrShort(r.deaths);
-            wrShort(r.defenses);
-            wrByte(r.wake);
-            wrByte(r.ignore);
-            wrBytes(r.attacks, MON_MAX_ATTACKS);
-        }
-    }
-
-    // sentinel to indicate no more monster info
-    wrShort((uint16_t) 0xFFFF);
+    wrRecalls();
 
     wrLong(l);
 
@@ -311,7 +354,7 @@ static bool svWrite() {
     // only level specific info follows, this allows characters to be
     // resurrected, the dungeon level info is not needed for a resurrection
     if (game.character_is_dead) {
-        return !((ferror(fileptr) != 0) || fflush(fileptr) == EOF);
+        return true;
     }
 
     wrShort((uint16_t) dg.current_level);
@@ -323,53 +366,59 @@ static bool svWrite() {
     wrShort((uint16_t) dg.panel.max_rows);
     wrShort((uint16_t) dg.panel.max_cols);
 
-    for (int i = 0; i < MAX_HEIGHT; i++) {
-        for (int j = 0; j < MAX_WIDTH; j++) {
+    int rows = savedFloorRows();
+    int columns = savedFloorColumns();
+
+    // Occupied tiles are stored as the distance from the previous
+    // occupied tile, followed by the ID. A zero distance ends the list.
+    int last_position = -1;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < columns; j++) {
             if (dg.floor[i][j].creature_id != 0) {
-                wrByte((uint8_t) i);
-                wrByte((uint8_t) j);
+                int position = i * columns + j;
+                wrVarint((uint32_t)(position - last_position));
                 wrByte(dg.floor[i][j].creature_id);
+                last_position = position;
             }
         }
     }
+    wrVarint(0);
 
-    // marks end of creature_id info
-    wrByte((uint8_t) 0xFF);
-
-    for (int i = 0; i < MAX_HEIGHT; i++) {
-        for (int j = 0; j < MAX_WIDTH; j++) {
+    last_position = -1;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < columns; j++) {
             if (dg.floor[i][j].treasure_id != 0) {
-                wrByte((uint8_t) i);
-                wrByte((uint8_t) j);
+                int position = i * columns + j;
+                wrVarint((uint32_t)(position - last_position));
                 wrByte(dg.floor[i][j].treasure_id);
+                last_position = position;
             }
         }
     }
+    wrVarint(0);
 
-    // marks end of treasure_id info
-    wrByte((uint8_t) 0xFF);
-
-    // must set counter to zero, note that code may write out two bytes unnecessarily
-    int count = 0;
+    // Run length encoded tiles, runs are not limited to 255 tiles,
+    // so the mostly granite levels collapse into only a few runs.
+    uint32_t count = 0;
     uint8_t prev_char = 0;
 
-    for (auto &row : dg.floor) {
-        for (auto tile : row) {
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < columns; j++) {
+            Tile_t const &tile = dg.floor[i][j];
             auto char_tmp = (uint8_t)(tile.feature_id | (tile.perma_lit_room << 4) | (tile.field_mark << 5) | (tile.permanent_light << 6) | (tile.temporary_light << 7));
 
-            if (char_tmp != prev_char || count == UCHAR_MAX) {
-                wrByte((uint8_t) count);
+            if (count > 0 && char_tmp != prev_char) {
+                wrVarint(count);
                 wrByte(prev_char);
-                prev_char = char_tmp;
-                count = 1;
-            } else {
-                count++;
+                count = 0;
             }
+            prev_char = char_tmp;
+            count++;
         }
     }
 
     // save last entry
-    wrByte((uint8_t) count);
+    wrVarint(count);
     wrByte(prev_char);
 
     wrShort((uint16_t) game.treasure.current_id);
@@ -381,7 +430,7 @@ static bool svWrite() {
         wrMonster(monsters[i]);
     }
 
-    return !((ferror(fileptr) != 0) || fflush(fileptr) == EOF);
+    return true;
 }
 
 static bool saveChar(const std::string &filename) {
@@ -389,53 +438,43 @@ static bool saveChar(const std::string &filename) {
         return true; // Nothing to save.
     }
 
+    PROFILE_SCOPE(SaveGame);
+
+    // The autosave being written, if any, lands before the full save does
+    saveWriterFinish();
+
     putQIO();
     playerDisturb(1, 0);                   // Turn off resting and searching.
     playerChangeSpeed(-py.pack.heaviness); // Fix the speed
     py.pack.heaviness = 0;
+    storeApplyPendingMaintenance();
     bool ok = false;
 
-    fileptr = nullptr; // Do not assume it has been init'ed
-
     int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    bool created = fd >= 0;
 
+    // The old save file is only replaced once the new one is safely written.
     if (fd < 0 && access(filename.c_str(), 0) >= 0 && ((from_save_file != 0) || (game.wizard_mode && getInputConfirmation("Can't make new save file. Overwrite old?")))) {
         (void) chmod(filename.c_str(), 0600);
-        fd = open(filename.c_str(), O_RDWR | O_TRUNC, 0600);
-    }
-
-    if (fd >= 0) {
-        (void) close(fd);
-        fileptr = fopen(config::files::save_game.c_str(), "wb");
+        fd = open(filename.c_str(), O_RDWR, 0600);
     }
 
     DEBUG(logfile = fopen("IO_LOG", "a"))
     DEBUG(fprintf(logfile, "Saving data to %s\n", config::files::save_game))
 
-    if (fileptr != nullptr) {
-        xor_byte = 0;
-        wrByte(CURRENT_VERSION_MAJOR);
-        xor_byte = 0;
-        wrByte(CURRENT_VERSION_MINOR);
-        xor_byte = 0;
-        wrByte(CURRENT_VERSION_PATCH);
-        xor_byte = 0;
+    if (fd >= 0) {
+        (void) close(fd);
 
-        auto char_tmp = (uint8_t)(randomNumber(256) - 1);
-        wrByte(char_tmp);
-        // Note that xor_byte is now equal to char_tmp
+        encodeSaveBuffer((uint8_t)(randomNumber(256) - 1));
 
-        ok = svWrite();
+        ok = writeSaveBuffer(filename);
 
         DEBUG(fclose(logfile))
-
-        if (fclose(fileptr) == EOF) {
-            ok = false;
-        }
     }
 
     if (!ok) {
-        if (fd >= 0) {
+        // Don't leave an empty file behind, an existing one is still intact.
+        if (created) {
             (void) unlink(filename.c_str());
         }
 
@@ -450,16 +489,608 @@ static bool saveChar(const std::string &filename) {
         return false;
     }
 
+    // The full save supersedes any autosave journal
+    discardSaveJournal();
+
+    game.character_saved = true;
+    dg.game_turn = -1;
+
+    return true;
+}
+
+// Encode the whole game into `io_buffer`
+static void encodeSaveBuffer(uint8_t char_tmp) {
+    io_buffer.clear();
+    io_compact = true;
+
+    xor_byte = 0;
+    wrByte(CURRENT_VERSION_MAJOR);
+    xor_byte = 0;
+    wrByte(CURRENT_VERSION_MINOR);
+    xor_byte = 0;
+    wrByte(CURRENT_VERSION_PATCH);
+    xor_byte = 0;
+
+    wrByte(char_tmp);
+    // Note that xor_byte is now equal to char_tmp
+
+    (void) svWrite();
+}
+
+// The autosave journal is a series of records appended to this file. Each
+// record holds the bytes of the decoded save data which changed since the
+// previous autosave. The save file itself is the snapshot they apply to,
+// the journal starts with its checksum so a stale journal is never applied.
+static std::string journalFilename() {
+    return config::files::save_game + ".journal";
+}
+
+// The first four bytes (version and xor seed) are stored as is, the rest
+// is chained by xor_byte, so one changed field would alter every byte
+// that follows it. Journal records are made against the unchained data.
+static void unchainSaveData(std::vector<uint8_t> const &encoded, std::vector<uint8_t> &decoded) {
+    decoded = encoded;
+    for (size_t i = 4; i < encoded.size(); i++) {
+        decoded[i] = encoded[i] ^ encoded[i - 1];
+    }
+}
+
+static void chainSaveData(std::vector<uint8_t> const &decoded, std::vector<uint8_t> &encoded) {
+    encoded = decoded;
+    for (size_t i = 4; i < decoded.size(); i++) {
+        encoded[i] = decoded[i] ^ encoded[i - 1];
+    }
+}
+
+static void putJournalLong(std::vector<uint8_t> &data, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+static uint32_t getJournalLong(std::vector<uint8_t> const &data, size_t offset) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t) data[offset + i] << (i * 8);
+    }
+    return value;
+}
+
+// FNV-1a, so a record torn by a crash part way through a write is ignored
+static uint32_t journalChecksum(std::vector<uint8_t> const &data, size_t offset, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = offset; i < offset + length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Differences closer together than this are stored as a single range
+constexpr size_t JOURNAL_RANGE_GAP = 8;
+
+// Record layout: size of the record body, the body itself, then a checksum
+// of the body. The body is the new data length followed by (offset, length,
+// bytes) ranges which replace the old data.
+static void makeJournalRecord(std::vector<uint8_t> const &old_state, std::vector<uint8_t> const &new_state, std::vector<uint8_t> &record) {
+    record.clear();
+    putJournalLong(record, 0); // body size, filled in below
+    putJournalLong(record, (uint32_t) new_state.size());
+
+    size_t common = std::min(old_state.size(), new_state.size());
+    size_t i = 0;
+
+    while (i < new_state.size()) {
+        if (i < common && old_state[i] == new_state[i]) {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        size_t end = i + 1;
+        if (start >= common) {
+            end = new_state.size();
+        } else {
+            // extend over changed bytes, and over short runs of unchanged ones
+            size_t same = 0;
+            for (size_t j = end; j < common && same < JOURNAL_RANGE_GAP; j++) {
+                if (old_state[j] == new_state[j]) {
+                    same++;
+                } else {
+                    same = 0;
+                    end = j + 1;
+                }
+            }
+        }
+
+        putJournalLong(record, (uint32_t) start);
+        putJournalLong(record, (uint32_t)(end - start));
+        record.insert(record.end(), new_state.begin() + start, new_state.begin() + end);
+
+        i = end;
+    }
+
+    uint32_t body_size = (uint32_t) record.size() - 4;
+    for (int b = 0; b < 4; b++) {
+        record[b] = (uint8_t)(body_size >> (b * 8));
+    }
+    putJournalLong(record, journalChecksum(record, 4, body_size));
+}
+
+// Applies a record body to `state`, returns false if it is not valid
+static bool applyJournalRecord(std::vector<uint8_t> const &journal, size_t offset, size_t body_size, std::vector<uint8_t> &state) {
+    size_t end = offset + body_size;
+
+    if (body_size < 4) {
+        return false;
+    }
+
+    std::vector<uint8_t> next = state;
+    next.resize(getJournalLong(journal, offset));
+    offset += 4;
+
+    while (offset < end) {
+        if (end - offset < 8) {
+            return false;
+        }
+        size_t start = getJournalLong(journal, offset);
+        size_t length = getJournalLong(journal, offset + 4);
+        offset += 8;
+
+        if (length > end - offset || start + length > next.size()) {
+            return false;
+        }
+        std::copy(journal.begin() + offset, journal.begin() + offset + length, next.begin() + start);
+        offset += length;
+    }
+
+    state.swap(next);
+
+    return true;
+}
+
+static bool appendSaveJournal(std::string const &filename, std::vector<uint8_t> const &record) {
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_BINARY, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok = fileWriteAll(fd, record);
+
+    if (close(fd) < 0) {
+        ok = false;
+    }
+
+    return ok;
+}
+
+// Applies the autosave journal, if there is one, to the save file in `io_buffer`
+static bool replaySaveJournal() {
+    journal_state.clear();
+    journal_size = 0;
+
+    int fd = open(journalFilename().c_str(), O_RDONLY | O_BINARY, 0);
+    if (fd < 0) {
+        return true; // no journal, the save file is complete as is
+    }
+
+    std::vector<uint8_t> journal;
+    bool ok = readFile(fd, journal);
+    (void) close(fd);
+
+    if (!ok || io_buffer.size() < 4) {
+        return false;
+    }
+
+    std::vector<uint8_t> state;
+    unchainSaveData(io_buffer, state);
+
+    journal_snapshot_id = journalChecksum(io_buffer, 0, io_buffer.size());
+
+    if (journal.size() < 4 || getJournalLong(journal, 0) != journal_snapshot_id) {
+        // left over from an older save file
+        discardSaveJournal();
+        return true;
+    }
+
+    // Stop at the first incomplete or damaged record, it was being
+    // written when the game died, so the ones before it are all there is.
+    size_t offset = 4;
+    while (journal.size() - offset >= 8) {
+        size_t body_size = getJournalLong(journal, offset);
+        if (body_size > journal.size() - offset - 8) {
+            break;
+        }
+        if (getJournalLong(journal, offset + 4 + body_size) != journalChecksum(journal, offset + 4, body_size)) {
+            break;
+        }
+        if (!applyJournalRecord(journal, offset + 4, body_size, state)) {
+            return false;
+        }
+        offset += body_size + 8;
+    }
+
+    chainSaveData(state, io_buffer);
+
+    journal_state.swap(state);
+    journal_size = offset;
+
+    // Cut off the damaged record, the next autosave is appended to the
+    // journal and would otherwise land after it, never to be replayed.
+    // Failing that, the next autosave starts over from a whole save file.
+    if (offset < journal.size()) {
+        journal.resize(offset);
+        if (!fileReplace(journalFilename(), journal, 0600)) {
+            discardSaveJournal();
+        }
+    }
+
+    return true;
+}
+
+static void discardSaveJournal() {
+    (void) unlink(journalFilename().c_str());
+    journal_state.clear();
+    journal_size = 0;
+}
+
+// Autosaves are written out on a thread of the game's own, so that a slow
+// disk never holds up play: the game encodes the save data at the turn
+// boundary, which is its snapshot, and hands the bytes over to be written
+// (and synced) while it carries on. One write is in flight at a time.
+class SaveWriter_t {
+  public:
+    ~SaveWriter_t();
+
+    std::mutex mutex;
+    std::condition_variable job_given;
+    std::condition_variable job_done;
+
+    std::string filename;
+    std::string journal_filename; // Removed once the whole save file is replaced
+    std::vector<uint8_t> data;
+    bool append = false;          // A journal record, rather than the whole save file
+    bool busy = false;            // Given a write not yet done
+    bool failed = false;          // The last write, until the game has heard of it
+    int previous_save_file = 0;   // from_save_file before a whole save file write
+    bool ending = false;
+
+    std::thread thread;
+};
+
+static thread_local std::unique_ptr<SaveWriter_t> save_writer;
+
+static void saveWriterRun(SaveWriter_t *writer) {
+    std::unique_lock<std::mutex> lock(writer->mutex);
+
+    while (true) {
+        writer->job_given.wait(lock, [writer]() { return writer->busy || writer->ending; });
+
+        if (!writer->busy) {
+            return;
+        }
+
+        // The game doesn't touch the job while the writer is busy with it
+        lock.unlock();
+        bool ok;
+        if (writer->append) {
+            ok = appendSaveJournal(writer->filename, writer->data);
+        } else {
+            ok = fileReplace(writer->filename, writer->data, 0600);
+            if (ok) {
+                (void) unlink(writer->journal_filename.c_str());
+            }
+        }
+        lock.lock();
+
+        writer->failed = !ok;
+        writer->busy = false;
+        writer->job_done.notify_all();
+    }
+}
+
+// Writes out what is left, when the game's thread ends
+SaveWriter_t::~SaveWriter_t() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ending = true;
+    }
+    job_given.notify_all();
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+// Waits for the write in flight, if any. When it failed the game is told,
+// and the next autosave writes the whole save file again.
+static void saveWriterFinish() {
+    if (save_writer == nullptr) {
+        return;
+    }
+    SaveWriter_t &writer = *save_writer;
+
+    {
+        std::unique_lock<std::mutex> lock(writer.mutex);
+        writer.job_done.wait(lock, [&writer]() { return !writer.busy; });
+
+        if (!writer.failed) {
+            return;
+        }
+        writer.failed = false;
+    }
+
+    if (!writer.append) {
+        from_save_file = writer.previous_save_file;
+    }
+    journal_state.clear();
+    journal_size = 0;
+
+    printMessage("Autosave failed.");
+}
+
+// Hands `data` over to be written to the file, once the last write is done
+static void saveWriterGive(std::string const &filename, std::string const &journal_filename, std::vector<uint8_t> &data, bool append) {
+    saveWriterFinish();
+
+    if (save_writer == nullptr) {
+        save_writer.reset(new SaveWriter_t);
+        save_writer->thread = std::thread(saveWriterRun, save_writer.get());
+    }
+    SaveWriter_t &writer = *save_writer;
+
+    {
+        std::lock_guard<std::mutex> lock(writer.mutex);
+        writer.filename = filename;
+        writer.journal_filename = journal_filename;
+        writer.data.swap(data);
+        writer.append = append;
+        writer.previous_save_file = from_save_file;
+        writer.busy = true;
+    }
+    writer.job_given.notify_all();
+}
+
+// Encode the game at the turn boundary into `io_buffer`, as saveChar()
+// would, but leaving the game to carry on unchanged.
+static void encodeTurnBoundary(uint8_t char_tmp) {
+    // The stores are saved as they would be seen, this doesn't change the game
+    storeApplyPendingMaintenance();
+
+    // Save the speed without a heavy pack slowing it, as saveChar() does
+    auto heaviness = py.pack.heaviness;
+    auto status = py.flags.status;
+    playerChangeSpeed(-heaviness);
+    py.pack.heaviness = 0;
+
+    encodeSaveBuffer(char_tmp);
+
+    playerChangeSpeed(heaviness);
+    py.pack.heaviness = heaviness;
+    py.flags.status = status;
+}
+
+// Checkpoint the game for crash recovery, without ending it like saveGame().
+// Only the changes since the last autosave are written, as a journal
+// record. Once the journal grows to half the size of the full save it is
+// folded back into a new snapshot of the save file.
+void autosaveGame() {
+    if (!game.character_generated || game.character_saved || game.character_is_dead) {
+        return;
+    }
+
+    PROFILE_SCOPE(Autosave);
+
+    // A write which failed starts the journal over
+    saveWriterFinish();
+
+    if (journal_state.empty() && from_save_file == 0 && access(config::files::save_game.c_str(), 0) == 0) {
+        printMessage("Autosave is off, the save file belongs to another game.");
+        game.autosave_turns = 0;
+        return;
+    }
+
+    // The xor seed is kept, using randomNumber() would change the game
+    encodeTurnBoundary(journal_state.empty() ? (uint8_t) getCurrentUnixTime() : journal_state[3]);
+
+    hangupImagePublish();
+
+    std::vector<uint8_t> state;
+    unchainSaveData(io_buffer, state);
+
+    if (!journal_state.empty()) {
+        std::vector<uint8_t> record;
+        makeJournalRecord(journal_state, state, record);
+
+        if (journal_size == 0) {
+            std::vector<uint8_t> header;
+            putJournalLong(header, journal_snapshot_id);
+            record.insert(record.begin(), header.begin(), header.end());
+        }
+
+        if (journal_size + record.size() < io_buffer.size() / 2) {
+            journal_size += record.size();
+            journal_state.swap(state);
+            io_buffer.clear();
+
+            saveWriterGive(journalFilename(), "", record, true);
+            return;
+        }
+    }
+
+    journal_snapshot_id = journalChecksum(io_buffer, 0, io_buffer.size());
+    journal_size = 0;
+    journal_state.swap(state);
+
+    // The old journal is only removed once the new save file is in place
+    saveWriterGive(config::files::save_game, journalFilename(), io_buffer, false);
+    from_save_file = 1;
+
+    io_buffer.clear();
+}
+
+// The save data is kept encoded ready for a hangup, which leaves no time
+// for a full save: when the input ends the process may be killed soon
+// after, and when the terminal goes away it is hung up on by a signal,
+// which can do little more than write bytes out. There are two slots, one
+// published (whole) while the other is encoded into, so the signal handler
+// never sees one half written.
+typedef struct {
+    std::vector<uint8_t> data;
+    std::string filename; // Everything the signal handler needs, ready made
+    std::string temp_filename;
+    std::string journal_filename;
+} HangupImage_t;
+
+class HangupImages_t {
+  public:
+    ~HangupImages_t();
+
+    HangupImage_t slots[2];
+    std::atomic<int> published{-1}; // The slot to write out, if any
+    std::atomic<bool> signalled{false};
+};
+
+static thread_local HangupImages_t hangup_images;
+
+// The game played at the terminal, the one SIGHUP saves
+static std::atomic<HangupImages_t *> terminal_hangup_images{nullptr};
+
+// A signal while the game's thread ends finds no images to write
+HangupImages_t::~HangupImages_t() {
+    HangupImages_t *images = this;
+    (void) terminal_hangup_images.compare_exchange_strong(images, nullptr);
+}
+
+// Publishes the save data in `io_buffer` as the hangup image. Only a game
+// played at a terminal or over the network can be hung up on.
+static void hangupImagePublish() {
+    HangupImages_t &images = hangup_images;
+
+    if (terminalIsHeadless() || images.signalled) {
+        return;
+    }
+
+    // A save file of another game is never replaced, as by saveChar()
+    if (from_save_file == 0 && access(config::files::save_game.c_str(), 0) == 0) {
+        images.published = -1;
+        return;
+    }
+
+    int published = images.published;
+    HangupImage_t &image = images.slots[published == 0 ? 1 : 0];
+
+    image.data.assign(io_buffer.begin(), io_buffer.end());
+    image.filename = config::files::save_game;
+    image.temp_filename = config::files::save_game + ".hangup";
+    image.journal_filename = journalFilename();
+
+    images.published = published == 0 ? 1 : 0;
+}
+
+// Keep the hangup image up to date, every HANGUP_IMAGE_TURNS game turns
+void hangupImageRefresh() {
+    if (terminalIsHeadless() || !game.character_generated || game.character_saved || game.character_is_dead) {
+        return;
+    }
+
+    PROFILE_SCOPE(HangupImage);
+
+    int published = hangup_images.published;
+    encodeTurnBoundary(published < 0 ? (uint8_t) getCurrentUnixTime() : hangup_images.slots[published].data[3]);
+    hangupImagePublish();
+
+    io_buffer.clear();
+}
+
+// Write the image out in place of the save file, with nothing but calls
+// which are safe in a signal handler.
+static bool hangupImageWrite(HangupImage_t const &image) {
+    int fd = open(image.temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    auto written = write(fd, image.data.data(), image.data.size());
+    bool ok = written == (ssize_t) image.data.size();
+
+    if (close(fd) < 0) {
+        ok = false;
+    }
+
+    if (ok && rename(image.temp_filename.c_str(), image.filename.c_str()) < 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        (void) unlink(image.temp_filename.c_str());
+        return false;
+    }
+
+    // The full save supersedes any autosave journal
+    (void) unlink(image.journal_filename.c_str());
+
+    return true;
+}
+
+// Rather than encoding the game as whatever state unwinding the command
+// left it in when the input ended, the image of the last turn boundary is
+// written out. Returns false when there's no image to write, for saveGame()
+// to try instead.
+bool saveGameOnHangup() {
+    int published = hangup_images.published;
+    if (published < 0 || game.character_saved) {
+        return false;
+    }
+
+    PROFILE_SCOPE(SaveGame);
+
+    // An autosave being written lands first, the image is newer
+    saveWriterFinish();
+
+    if (!hangupImageWrite(hangup_images.slots[published])) {
+        return false;
+    }
+
+    journal_state.clear();
+    journal_size = 0;
+    hangup_images.published = -1;
+
     game.character_saved = true;
     dg.game_turn = -1;
 
     return true;
 }
 
+#ifndef _WIN32
+static void hangupSignalHandler(int signal_number) {
+    HangupImages_t *images = terminal_hangup_images;
+
+    if (images != nullptr) {
+        images->signalled = true;
+
+        int published = images->published;
+        if (published >= 0) {
+            (void) hangupImageWrite(images->slots[published]);
+        }
+    }
+
+    // Then hang up as the process would have
+    (void) signal(signal_number, SIG_DFL);
+    (void) raise(signal_number);
+}
+#endif
+
+// Save this thread's game when the process is hung up on (SIGHUP), as when
+// the terminal it is played at goes away.
+void hangupSaveOnSignal() {
+#ifndef _WIN32
+    terminal_hangup_images = &hangup_images;
+    (void) signal(SIGHUP, hangupSignalHandler);
+#endif
+}
+
 // Certain checks are omitted for the wizard. -CJS-
 bool loadGame(bool &generate) {
-    Tile_t *tile = nullptr;
-    int c;
     uint32_t time_saved = 0;
     uint8_t version_maj = 0;
     uint8_t version_min = 0;
@@ -467,7 +1098,6 @@ bool loadGame(bool &generate) {
 
     generate = true;
     int fd = -1;
-    int total_count = 0;
 
     // Not required for Mac, because the file name is obtained through a dialog.
     // There is no way for a nonexistent file to be specified. -BS-
@@ -484,8 +1114,8 @@ bool loadGame(bool &generate) {
     // FIXME: check this if/else logic! -- MRC
     if (dg.game_turn >= 0) {
         printMessage("IMPOSSIBLE! Attempt to restore while still alive!");
-    } else if ((fd = open(config::files::save_game.c_str(), O_RDONLY, 0)) < 0 &&
-               (chmod(config::files::save_game.c_str(), 0400) < 0 || (fd = open(config::files::save_game.c_str(), O_RDONLY, 0)) < 0)) {
+    } else if ((fd = open(config::files::save_game.c_str(), O_RDONLY | O_BINARY, 0)) < 0 &&
+               (chmod(config::files::save_game.c_str(), 0400) < 0 || (fd = open(config::files::save_game.c_str(), O_RDONLY | O_BINARY, 0)) < 0)) {
         // Allow restoring a file belonging to someone else, if we can delete it.
         // Hence first try to read without doing a chmod.
 
@@ -494,11 +1124,12 @@ bool loadGame(bool &generate) {
         dg.game_turn = -1;
         bool ok = true;
 
+        bool loaded = readSaveBuffer(fd);
+
         (void) close(fd);
         fd = -1; // Make sure it isn't closed again
-        fileptr = fopen(config::files::save_game.c_str(), "rb");
 
-        if (fileptr == nullptr) {
+        if (!loaded || !replaySaveJournal()) {
             goto error;
         }
 
@@ -523,24 +1154,15 @@ bool loadGame(bool &generate) {
             goto error;
         }
 
+        io_compact = saveFileIsCompact(version_maj, version_min, patch_level);
+
         uint16_t uint_16_t_tmp;
         uint32_t l;
 
-        uint_16_t_tmp = rdShort();
-        while (uint_16_t_tmp != 0xFFFF) {
-            if (uint_16_t_tmp >= MON_MAX_CREATURES) {
-                goto error;
-            }
-            Recall_t &memory = creature_recall[uint_16_t_tmp];
-            memory.movement = rdLong();
-            memory.spells = rdLong();
-            memory.kills = rdShort();
-            memory.deaths = rdShort();
-            memory.defenses = rdShort();
-            memory.wake = rdByte();
-            memory.ignore = rdByte();
-            rdBytes(memory.attacks, MON_MAX_ATTACKS);
-            uint_16_t_tmp = rdShort();
+        io_recall_map = saveFileHasRecallMap(version_maj, version_min, patch_level);
+
+        if (!rdRecalls()) {
+            goto error;
         }
 
         l = rdLong();
@@ -677,6 +1299,7 @@ bool loadGame(bool &generate) {
             py.flags.spells_forgotten = rdLong();
             rdBytes(py.flags.spells_learned_order, 32);
             rdBytes(objects_identified, OBJECT_IDENT_SIZE);
+            itemDescriptionCacheInvalidate();
             game.magic_seed = rdLong();
             game.town_seed = rdLong();
             last_message_id = rdShort();
@@ -701,6 +1324,7 @@ bool loadGame(bool &generate) {
                 store.unique_items_counter = rdByte();
                 store.good_purchases = rdShort();
                 store.bad_purchases = rdShort();
+                store.stock_version++;
                 if (store.unique_items_counter > STORE_MAX_DISCRETE_ITEMS) {
                     goto error;
                 }
@@ -716,8 +1340,7 @@ bool loadGame(bool &generate) {
             py.misc.date_of_birth = rdLong();
         }
 
-        c = getc(fileptr);
-        if (c == EOF || ((l & 0x80000000L) != 0)) {
+        if (io_position >= io_buffer.size() || ((l & 0x80000000L) != 0)) {
             if ((l & 0x80000000L) == 0) {
                 if (!game.to_be_wizard || dg.game_turn < 0) {
                     goto error;
@@ -753,10 +1376,6 @@ bool loadGame(bool &generate) {
             putQIO();
             goto closefiles;
         }
-        if (ungetc(c, fileptr) == EOF) {
-            goto error;
-        }
-
         putStringClearToEOL("Restoring Character...", Coord_t{0, 0});
         putQIO();
 
@@ -772,53 +1391,25 @@ bool loadGame(bool &generate) {
         dg.panel.max_rows = rdShort();
         dg.panel.max_cols = rdShort();
 
-        uint8_t char_tmp, ychar, xchar, count;
+        if (dg.height < SCREEN_HEIGHT || dg.height > LEVEL_MAX_HEIGHT || dg.width < SCREEN_WIDTH || dg.width > LEVEL_MAX_WIDTH) {
+            goto error;
+        }
 
-        // read in the creature ptr info
-        char_tmp = rdByte();
-        while (char_tmp != 0xFF) {
-            ychar = char_tmp;
-            xchar = rdByte();
-            char_tmp = rdByte();
-            if (xchar > MAX_WIDTH || ychar > MAX_HEIGHT) {
-                goto error;
-            }
-            dg.floor[ychar][xchar].creature_id = char_tmp;
-            char_tmp = rdByte();
+        // The level may be larger than the dungeon size set for this game
+        dungeonAllocateFloor();
+        if (dg.floor.rows < savedFloorRows() || dg.floor.columns < savedFloorColumns()) {
+            dg.floor.resize(std::max<int>(dg.floor.rows, savedFloorRows()), std::max<int>(dg.floor.columns, savedFloorColumns()));
         }
+        dg.floor.clear();
 
-        // read in the treasure ptr info
-        char_tmp = rdByte();
-        while (char_tmp != 0xFF) {
-            ychar = char_tmp;
-            xchar = rdByte();
-            char_tmp = rdByte();
-            if (xchar > MAX_WIDTH || ychar > MAX_HEIGHT) {
+        if (io_compact) {
+            if (!rdCompactLevel()) {
                 goto error;
             }
-            dg.floor[ychar][xchar].treasure_id = char_tmp;
-            char_tmp = rdByte();
-        }
-
-        // read in the rest of the cave info
-        tile = &dg.floor[0][0];
-        total_count = 0;
-        while (total_count != MAX_HEIGHT * MAX_WIDTH) {
-            count = rdByte();
-            char_tmp = rdByte();
-            for (int i = count; i > 0; i--) {
-                if (tile > &dg.floor[MAX_HEIGHT-1][MAX_WIDTH-1]) {
-                    goto error;
-                }
-                tile->feature_id = (uint8_t)(char_tmp & 0xF);
-                tile->perma_lit_room = (bool) ((char_tmp >> 4) & 0x1);
-                tile->field_mark = (bool) ((char_tmp >> 5) & 0x1);
-                tile->permanent_light = (bool) ((char_tmp >> 6) & 0x1);
-                tile->temporary_light = (bool) ((char_tmp >> 7) & 0x1);
-                tile++;
-            }
-            total_count += count;
+        } else if (!rdOriginalLevel()) {
+            goto error;
         }
+        treasureFindPositions();
 
         game.treasure.current_id = rdShort();
         if (game.treasure.current_id > LEVEL_MAX_OBJECTS) {
@@ -831,13 +1422,15 @@ bool loadGame(bool &generate) {
         if (next_free_monster_id > MON_TOTAL_ALLOCATIONS) {
             goto error;
         }
+        monsterIndexReset();
         for (int i = config::monsters::MON_MIN_INDEX_ID; i < next_free_monster_id; i++) {
             rdMonster(monsters[i]);
+            monsterIndexAdd(i);
         }
 
         generate = false; // We have restored a cave - no need to generate.
 
-        if (ferror(fileptr) != 0) {
+        if (io_error) {
             goto error;
         }
 
@@ -856,14 +1449,8 @@ bool loadGame(bool &generate) {
 
         DEBUG(fclose(logfile));
 
-        if (fileptr != nullptr) {
-            if (fclose(fileptr) < 0) {
-                ok = false;
-            }
-        }
-        if (fd >= 0) {
-            (void) close(fd);
-        }
+        io_buffer.clear();
+        io_buffer.shrink_to_fit();
 
         if (!ok) {
             printMessage("Error during reading of file.");
@@ -933,37 +1520,191 @@ bool loadGame(bool &generate) {
     return false; // not reached
 }
 
+// The part of the floor kept in a save file: the whole level, but never less
+// than the classic dungeon size, so the town is stored the way it always was.
+static int savedFloorRows() {
+    return std::max<int>(dg.height, MAX_HEIGHT);
+}
+
+static int savedFloorColumns() {
+    return std::max<int>(dg.width, MAX_WIDTH);
+}
+
+// Reads the creature, treasure and tile info of a pre 5.7.16 save file
+static bool rdOriginalLevel() {
+    uint8_t char_tmp, ychar, xchar, count;
+
+    // read in the creature ptr info
+    char_tmp = rdByte();
+    while (char_tmp != 0xFF) {
+        ychar = char_tmp;
+        xchar = rdByte();
+        char_tmp = rdByte();
+        if (xchar > MAX_WIDTH || ychar > MAX_HEIGHT) {
+            return false;
+        }
+        dg.floor[ychar][xchar].creature_id = char_tmp;
+        char_tmp = rdByte();
+    }
+
+    // read in the treasure ptr info
+    char_tmp = rdByte();
+    while (char_tmp != 0xFF) {
+        ychar = char_tmp;
+        xchar = rdByte();
+        char_tmp = rdByte();
+        if (xchar > MAX_WIDTH || ychar > MAX_HEIGHT) {
+            return false;
+        }
+        dg.floor[ychar][xchar].treasure_id = char_tmp;
+        char_tmp = rdByte();
+    }
+
+    // read in the rest of the cave info
+    int total_count = 0;
+    while (total_count != MAX_HEIGHT * MAX_WIDTH) {
+        count = rdByte();
+        char_tmp = rdByte();
+        for (int i = count; i > 0; i--) {
+            if (total_count >= MAX_HEIGHT * MAX_WIDTH) {
+                return false;
+            }
+            Tile_t tile = dg.floor[total_count / MAX_WIDTH][total_count % MAX_WIDTH];
+            tile.feature_id = (uint8_t)(char_tmp & 0xF);
+            tile.perma_lit_room = (bool) ((char_tmp >> 4) & 0x1);
+            tile.field_mark = (bool) ((char_tmp >> 5) & 0x1);
+            tile.permanent_light = (bool) ((char_tmp >> 6) & 0x1);
+            tile.temporary_light = (bool) ((char_tmp >> 7) & 0x1);
+            total_count++;
+        }
+    }
+
+    return true;
+}
+
+// Reads the creature, treasure and tile info of a v2 (compact) save file
+static bool rdCompactLevel() {
+    int columns = savedFloorColumns();
+    int total_tiles = savedFloorRows() * columns;
+
+    int position = -1;
+    uint32_t distance = rdVarint();
+    while (distance != 0) {
+        if (distance > (uint32_t) total_tiles || (position += (int) distance) >= total_tiles) {
+            return false;
+        }
+        dg.floor[position / columns][position % columns].creature_id = rdByte();
+        distance = rdVarint();
+    }
+
+    position = -1;
+    distance = rdVarint();
+    while (distance != 0) {
+        if (distance > (uint32_t) total_tiles || (position += (int) distance) >= total_tiles) {
+            return false;
+        }
+        dg.floor[position / columns][position % columns].treasure_id = rdByte();
+        distance = rdVarint();
+    }
+
+    int total_count = 0;
+    while (total_count != total_tiles) {
+        uint32_t count = rdVarint();
+        uint8_t char_tmp = rdByte();
+        if (count == 0 || count > (uint32_t)(total_tiles - total_count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            Tile_t tile = dg.floor[total_count / columns][total_count % columns];
+            tile.feature_id = (uint8_t)(char_tmp & 0xF);
+            tile.perma_lit_room = (bool) ((char_tmp >> 4) & 0x1);
+            tile.field_mark = (bool) ((char_tmp >> 5) & 0x1);
+            tile.permanent_light = (bool) ((char_tmp >> 6) & 0x1);
+            tile.temporary_light = (bool) ((char_tmp >> 7) & 0x1);
+            total_count++;
+        }
+    }
+
+    return true;
+}
+
+// Read the rest of the file into `data`
+static bool readFile(int fd, std::vector<uint8_t> &data) {
+    data.clear();
+
+    struct stat file_info {};
+    if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+        data.reserve((size_t) file_info.st_size);
+    }
+
+    uint8_t block[4096];
+
+    for (;;) {
+        auto bytes_read = read(fd, block, sizeof(block));
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read < 0) {
+            return false;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        data.insert(data.end(), block, block + bytes_read);
+    }
+
+    return true;
+}
+
+// Write the encoded save file, a failed save never destroys the old one
+static bool writeSaveBuffer(const std::string &filename) {
+    return fileReplace(filename, io_buffer, 0600);
+}
+
+// Read the whole save file into the buffer, ready for decoding
+static bool readSaveBuffer(int fd) {
+    io_position = 0;
+    io_error = false;
+
+    return readFile(fd, io_buffer);
+}
+
+// put_byte adds a single (already encrypted) byte to the buffer
+static void putByte(uint8_t value) {
+    io_buffer.push_back(value);
+}
+
 static void wrBool(bool value) {
     wrByte((uint8_t) value);
 }
 
 static void wrByte(uint8_t value) {
     xor_byte ^= value;
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, "BYTE:  %02X = %d\n", (int) xor_byte, (int) value))
 }
 
 static void wrShort(uint16_t value) {
     xor_byte ^= (value & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, "SHORT: %02X", (int) xor_byte))
     xor_byte ^= ((value >> 8) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, " %02X = %d\n", (int) xor_byte, (int) value))
 }
 
 static void wrLong(uint32_t value) {
     xor_byte ^= (value & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, "LONG:  %02X", (int) xor_byte))
     xor_byte ^= ((value >> 8) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, " %02X", (int) xor_byte))
     xor_byte ^= ((value >> 16) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, " %02X", (int) xor_byte))
     xor_byte ^= ((value >> 24) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, " %02X = %ld\n", (int) xor_byte, (int32_t) value))
 }
 
@@ -974,7 +1715,7 @@ static void wrBytes(uint8_t *value, int count) {
     ptr = value;
     for (int i = 0; i < count; i++) {
         xor_byte ^= *ptr++;
-        (void) putc((int) xor_byte, fileptr);
+        putByte(xor_byte);
         DEBUG(fprintf(logfile, "  %02X = %d", (int) xor_byte, (int) (ptr[-1])))
     }
     DEBUG(fprintf(logfile, "\n"))
@@ -985,11 +1726,11 @@ static void wrString(char *str) {
     DEBUG(fprintf(logfile, "STRING:"))
     while (*str != '\0') {
         xor_byte ^= *str++;
-        (void) putc((int) xor_byte, fileptr);
+        putByte(xor_byte);
         DEBUG(fprintf(logfile, " %02X", (int) xor_byte))
     }
     xor_byte ^= *str;
-    (void) putc((int) xor_byte, fileptr);
+    putByte(xor_byte);
     DEBUG(fprintf(logfile, " %02X = \"%s\"\n", (int) xor_byte, s))
 }
 
@@ -1000,16 +1741,217 @@ static void wrShorts(uint16_t *value, int count) {
 
     for (int i = 0; i < count; i++) {
         xor_byte ^= (*sptr & 0xFF);
-        (void) putc((int) xor_byte, fileptr);
+        putByte(xor_byte);
         DEBUG(fprintf(logfile, "  %02X", (int) xor_byte))
         xor_byte ^= ((*sptr++ >> 8) & 0xFF);
-        (void) putc((int) xor_byte, fileptr);
+        putByte(xor_byte);
         DEBUG(fprintf(logfile, " %02X = %d", (int) xor_byte, (int) sptr[-1]))
     }
     DEBUG(fprintf(logfile, "\n"))
 }
 
+// Unsigned LEB128: seven bits per byte, the high bit flags that more follow
+static void wrVarint(uint32_t value) {
+    while (value >= 0x80) {
+        wrByte((uint8_t)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    wrByte((uint8_t) value);
+}
+
+// Which fields of a monster memory are not zero, from 5.7.17 on
+enum RecallField : uint8_t {
+    RECALL_MOVEMENT = 1 << 0,
+    RECALL_SPELLS = 1 << 1,
+    RECALL_KILLS = 1 << 2,
+    RECALL_DEATHS = 1 << 3,
+    RECALL_DEFENSES = 1 << 4,
+    RECALL_WAKE = 1 << 5,
+    RECALL_IGNORE = 1 << 6,
+    RECALL_ATTACKS = 1 << 7,
+};
+
+static bool recallHasAttacks(Recall_t const &memory) {
+    for (auto attack : memory.attacks) {
+        if (attack != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Only the monsters the player knows something about are saved. Older save
+// files list them by creature ID, up to a 0xFFFF sentinel, with all their
+// fields. From 5.7.17 on a bitmap of the creatures comes first, then, for
+// each of them, a mask of its non-zero fields followed by just those fields.
+static void wrRecalls() {
+    uint8_t known[(MON_MAX_CREATURES + 7) / 8] = {0};
+    uint8_t fields[MON_MAX_CREATURES] = {0};
+
+    for (int i = 0; i < MON_MAX_CREATURES; i++) {
+        Recall_t const &memory = creature_recall[i];
+
+        fields[i] |= memory.movement != 0 ? RECALL_MOVEMENT : 0;
+        fields[i] |= memory.spells != 0 ? RECALL_SPELLS : 0;
+        fields[i] |= memory.kills != 0 ? RECALL_KILLS : 0;
+        fields[i] |= memory.deaths != 0 ? RECALL_DEATHS : 0;
+        fields[i] |= memory.defenses != 0 ? RECALL_DEFENSES : 0;
+        fields[i] |= memory.wake != 0 ? RECALL_WAKE : 0;
+        fields[i] |= memory.ignore != 0 ? RECALL_IGNORE : 0;
+        fields[i] |= recallHasAttacks(memory) ? RECALL_ATTACKS : 0;
+
+        // As always, knowing only how the monster sleeps is not kept
+        if ((fields[i] & ~(RECALL_WAKE | RECALL_IGNORE)) != 0) {
+            known[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    wrBytes(known, (int) sizeof(known));
+
+    for (int i = 0; i < MON_MAX_CREATURES; i++) {
+        if ((known[i / 8] & (1 << (i % 8))) == 0) {
+            continue;
+        }
+
+        Recall_t &memory = creature_recall[i];
+        wrByte(fields[i]);
+
+        if ((fields[i] & RECALL_MOVEMENT) != 0) {
+            wrLong(memory.movement);
+        }
+        if ((fields[i] & RECALL_SPELLS) != 0) {
+            wrLong(memory.spells);
+        }
+        if ((fields[i] & RECALL_KILLS) != 0) {
+            wrShort(memory.kills);
+        }
+        if ((fields[i] & RECALL_DEATHS) != 0) {
+            wrShort(memory.deaths);
+        }
+        if ((fields[i] & RECALL_DEFENSES) != 0) {
+            wrShort(memory.defenses);
+        }
+        if ((fields[i] & RECALL_WAKE) != 0) {
+            wrByte(memory.wake);
+        }
+        if ((fields[i] & RECALL_IGNORE) != 0) {
+            wrByte(memory.ignore);
+        }
+        if ((fields[i] & RECALL_ATTACKS) != 0) {
+            wrBytes(memory.attacks, MON_MAX_ATTACKS);
+        }
+    }
+}
+
+// Which fields of a compact item differ from its game_objects[] entry
+enum CompactItemField : uint32_t {
+    ITEM_SPECIAL_NAME = 1L << 0,
+    ITEM_INSCRIPTION = 1L << 1,
+    ITEM_FLAGS = 1L << 2,
+    ITEM_CATEGORY = 1L << 3,
+    ITEM_SPRITE = 1L << 4,
+    ITEM_MISC_USE = 1L << 5,
+    ITEM_COST = 1L << 6,
+    ITEM_SUB_CATEGORY = 1L << 7,
+    ITEM_COUNT = 1L << 8,
+    ITEM_WEIGHT = 1L << 9,
+    ITEM_TO_HIT = 1L << 10,
+    ITEM_TO_DAMAGE = 1L << 11,
+    ITEM_AC = 1L << 12,
+    ITEM_TO_AC = 1L << 13,
+    ITEM_DAMAGE = 1L << 14,
+    ITEM_DEPTH = 1L << 15,
+    ITEM_IDENTIFICATION = 1L << 16,
+};
+
+static void wrCompactItem(Inventory_t &item) {
+    DEBUG(fprintf(logfile, "COMPACT ITEM:\n"))
+
+    Inventory_t base{};
+    inventoryItemCopyTo(item.id < MAX_OBJECTS_IN_GAME ? item.id : 0, base);
+
+    uint32_t fields = 0;
+    fields |= item.special_name_id != base.special_name_id ? ITEM_SPECIAL_NAME : 0;
+    fields |= item.inscription[0] != '\0' ? ITEM_INSCRIPTION : 0;
+    fields |= item.flags != base.flags ? ITEM_FLAGS : 0;
+    fields |= item.category_id != base.category_id ? ITEM_CATEGORY : 0;
+    fields |= item.sprite != base.sprite ? ITEM_SPRITE : 0;
+    fields |= item.misc_use != base.misc_use ? ITEM_MISC_USE : 0;
+    fields |= item.cost != base.cost ? ITEM_COST : 0;
+    fields |= item.sub_category_id != base.sub_category_id ? ITEM_SUB_CATEGORY : 0;
+    fields |= item.items_count != base.items_count ? ITEM_COUNT : 0;
+    fields |= item.weight != base.weight ? ITEM_WEIGHT : 0;
+    fields |= item.to_hit != base.to_hit ? ITEM_TO_HIT : 0;
+    fields |= item.to_damage != base.to_damage ? ITEM_TO_DAMAGE : 0;
+    fields |= item.ac != base.ac ? ITEM_AC : 0;
+    fields |= item.to_ac != base.to_ac ? ITEM_TO_AC : 0;
+    fields |= (item.damage.dice != base.damage.dice || item.damage.sides != base.damage.sides) ? ITEM_DAMAGE : 0;
+    fields |= item.depth_first_found != base.depth_first_found ? ITEM_DEPTH : 0;
+    fields |= item.identification != base.identification ? ITEM_IDENTIFICATION : 0;
+
+    wrShort(item.id);
+    wrVarint(fields);
+
+    if ((fields & ITEM_SPECIAL_NAME) != 0u) {
+        wrByte(item.special_name_id);
+    }
+    if ((fields & ITEM_INSCRIPTION) != 0u) {
+        wrString(item.inscription);
+    }
+    if ((fields & ITEM_FLAGS) != 0u) {
+        wrLong(item.flags);
+    }
+    if ((fields & ITEM_CATEGORY) != 0u) {
+        wrByte(item.category_id);
+    }
+    if ((fields & ITEM_SPRITE) != 0u) {
+        wrByte(item.sprite);
+    }
+    if ((fields & ITEM_MISC_USE) != 0u) {
+        wrShort((uint16_t) item.misc_use);
+    }
+    if ((fields & ITEM_COST) != 0u) {
+        wrLong((uint32_t) item.cost);
+    }
+    if ((fields & ITEM_SUB_CATEGORY) != 0u) {
+        wrByte(item.sub_category_id);
+    }
+    if ((fields & ITEM_COUNT) != 0u) {
+        wrByte(item.items_count);
+    }
+    if ((fields & ITEM_WEIGHT) != 0u) {
+        wrShort(item.weight);
+    }
+    if ((fields & ITEM_TO_HIT) != 0u) {
+        wrShort((uint16_t) item.to_hit);
+    }
+    if ((fields & ITEM_TO_DAMAGE) != 0u) {
+        wrShort((uint16_t) item.to_damage);
+    }
+    if ((fields & ITEM_AC) != 0u) {
+        wrShort((uint16_t) item.ac);
+    }
+    if ((fields & ITEM_TO_AC) != 0u) {
+        wrShort((uint16_t) item.to_ac);
+    }
+    if ((fields & ITEM_DAMAGE) != 0u) {
+        wrByte(item.damage.dice);
+        wrByte(item.damage.sides);
+    }
+    if ((fields & ITEM_DEPTH) != 0u) {
+        wrByte(item.depth_first_found);
+    }
+    if ((fields & ITEM_IDENTIFICATION) != 0u) {
+        wrByte(item.identification);
+    }
+}
+
 static void wrItem(Inventory_t &item) {
+    if (io_compact) {
+        wrCompactItem(item);
+        return;
+    }
+
     DEBUG(fprintf(logfile, "ITEM:\n"))
     wrShort(item.id);
     wrByte(item.special_name_id);
@@ -1038,17 +1980,29 @@ static void wrMonster(Monster_t const &monster) {
     wrShort((uint16_t) monster.sleep_count);
     wrShort((uint16_t) monster.speed);
     wrShort(monster.creature_id);
-    wrByte((uint8_t) monster.pos.y);
-    wrByte((uint8_t) monster.pos.x);
+
+    // positions only need more than a byte on the larger than classic levels
+    if (savedFloorRows() > UINT8_MAX || savedFloorColumns() > UINT8_MAX) {
+        wrShort((uint16_t) monster.pos.y);
+        wrShort((uint16_t) monster.pos.x);
+    } else {
+        wrByte((uint8_t) monster.pos.y);
+        wrByte((uint8_t) monster.pos.x);
+    }
     wrByte(monster.distance_from_player);
     wrBool(monster.lit);
     wrByte(monster.stunned_amount);
     wrByte(monster.confused_amount);
 }
 
-// get_byte reads a single byte from a file, without any xor_byte encryption
+// get_byte reads a single byte from the buffer, without any xor_byte encryption
 static uint8_t getByte() {
-    return (uint8_t)(getc(fileptr) & 0xFF);
+    if (io_position >= io_buffer.size()) {
+        // Past the end of the file, behave as getc() returning EOF used to.
+        io_error = true;
+        return 0xFF;
+    }
+    return io_buffer[io_position++];
 }
 
 static bool rdBool() {
@@ -1134,7 +2088,162 @@ static void rdShorts(uint16_t *value, int count) {
     DEBUG(fprintf(logfile, "\n"))
 }
 
+static uint32_t rdVarint() {
+    uint32_t value = 0;
+
+    // A uint32_t never needs more than five bytes
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t c = rdByte();
+        value |= (uint32_t)(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            break;
+        }
+    }
+
+    return value;
+}
+
+static void rdCompactItem(Inventory_t &item) {
+    DEBUG(fprintf(logfile, "COMPACT ITEM:\n"))
+
+    uint16_t id = rdShort();
+    if (id >= MAX_OBJECTS_IN_GAME) {
+        io_error = true;
+        id = 0;
+    }
+    inventoryItemCopyTo(id, item);
+
+    uint32_t fields = rdVarint();
+
+    if ((fields & ITEM_SPECIAL_NAME) != 0u) {
+        item.special_name_id = rdByte();
+    }
+    if ((fields & ITEM_INSCRIPTION) != 0u) {
+        rdString(item.inscription);
+    }
+    if ((fields & ITEM_FLAGS) != 0u) {
+        item.flags = rdLong();
+    }
+    if ((fields & ITEM_CATEGORY) != 0u) {
+        item.category_id = rdByte();
+    }
+    if ((fields & ITEM_SPRITE) != 0u) {
+        item.sprite = rdByte();
+    }
+    if ((fields & ITEM_MISC_USE) != 0u) {
+        item.misc_use = rdShort();
+    }
+    if ((fields & ITEM_COST) != 0u) {
+        item.cost = rdLong();
+    }
+    if ((fields & ITEM_SUB_CATEGORY) != 0u) {
+        item.sub_category_id = rdByte();
+    }
+    if ((fields & ITEM_COUNT) != 0u) {
+        item.items_count = rdByte();
+    }
+    if ((fields & ITEM_WEIGHT) != 0u) {
+        item.weight = rdShort();
+    }
+    if ((fields & ITEM_TO_HIT) != 0u) {
+        item.to_hit = rdShort();
+    }
+    if ((fields & ITEM_TO_DAMAGE) != 0u) {
+        item.to_damage = rdShort();
+    }
+    if ((fields & ITEM_AC) != 0u) {
+        item.ac = rdShort();
+    }
+    if ((fields & ITEM_TO_AC) != 0u) {
+        item.to_ac = rdShort();
+    }
+    if ((fields & ITEM_DAMAGE) != 0u) {
+        item.damage.dice = rdByte();
+        item.damage.sides = rdByte();
+    }
+    if ((fields & ITEM_DEPTH) != 0u) {
+        item.depth_first_found = rdByte();
+    }
+    if ((fields & ITEM_IDENTIFICATION) != 0u) {
+        item.identification = rdByte();
+    }
+}
+
+static bool rdRecalls() {
+    if (!io_recall_map) {
+        uint16_t creature_id = rdShort();
+
+        while (creature_id != 0xFFFF) {
+            if (creature_id >= MON_MAX_CREATURES) {
+                return false;
+            }
+
+            Recall_t &memory = creature_recall[creature_id];
+            memory.movement = rdLong();
+            memory.spells = rdLong();
+            memory.kills = rdShort();
+            memory.deaths = rdShort();
+            memory.defenses = rdShort();
+            memory.wake = rdByte();
+            memory.ignore = rdByte();
+            rdBytes(memory.attacks, MON_MAX_ATTACKS);
+
+            creature_id = rdShort();
+        }
+
+        return true;
+    }
+
+    uint8_t known[(MON_MAX_CREATURES + 7) / 8];
+    rdBytes(known, (int) sizeof(known));
+
+    for (int i = 0; i < MON_MAX_CREATURES; i++) {
+        if ((known[i / 8] & (1 << (i % 8))) == 0) {
+            continue;
+        }
+
+        // The fields left out are zero, not what an earlier game left
+        Recall_t &memory = creature_recall[i];
+        memory = Recall_t{};
+
+        uint8_t fields = rdByte();
+
+        if ((fields & RECALL_MOVEMENT) != 0) {
+            memory.movement = rdLong();
+        }
+        if ((fields & RECALL_SPELLS) != 0) {
+            memory.spells = rdLong();
+        }
+        if ((fields & RECALL_KILLS) != 0) {
+            memory.kills = rdShort();
+        }
+        if ((fields & RECALL_DEATHS) != 0) {
+            memory.deaths = rdShort();
+        }
+        if ((fields & RECALL_DEFENSES) != 0) {
+            memory.defenses = rdShort();
+        }
+        if ((fields & RECALL_WAKE) != 0) {
+            memory.wake = rdByte();
+        }
+        if ((fields & RECALL_IGNORE) != 0) {
+            memory.ignore = rdByte();
+        }
+        if ((fields & RECALL_ATTACKS) != 0) {
+            rdBytes(memory.attacks, MON_MAX_ATTACKS);
+        }
+    }
+
+    // The bitmap must not list more creatures than there are
+    return (known[sizeof(known) - 1] >> (MON_MAX_CREATURES % 8)) == 0 && !io_error;
+}
+
 static void rdItem(Inventory_t &item) {
+    if (io_compact) {
+        rdCompactItem(item);
+        return;
+    }
+
     DEBUG(fprintf(logfile, "ITEM:\n"))
     item.id = rdShort();
     item.special_name_id = rdByte();
@@ -1163,25 +2272,30 @@ static void rdMonster(Monster_t &monster) {
     monster.sleep_count = rdShort();
     monster.speed = rdShort();
     monster.creature_id = rdShort();
-    monster.pos.y = rdByte();
-    monster.pos.x = rdByte();
+
+    if (savedFloorRows() > UINT8_MAX || savedFloorColumns() > UINT8_MAX) {
+        monster.pos.y = rdShort();
+        monster.pos.x = rdShort();
+    } else {
+        monster.pos.y = rdByte();
+        monster.pos.x = rdByte();
+    }
     monster.distance_from_player = rdByte();
     monster.lit = rdBool();
     monster.stunned_amount = rdByte();
     monster.confused_amount = rdByte();
 }
 
-// functions called from death.c to implement the score file
-
-// set the local fileptr to the score file fileptr
-void setFileptr(FILE *file) {
-    fileptr = file;
-}
+// functions called from scores.cpp to implement the score file
 
-void saveHighScore(HighScore_t const &score) {
+// Encodes a score entry into a `HIGH_SCORE_RECORD_SIZE` byte record.
+// Every record starts its own encryption, so it can be decoded on its own.
+void encodeHighScore(HighScore_t const &score, uint8_t *record) {
     DEBUG(logfile = fopen("IO_LOG", "a"))
     DEBUG(fprintf(logfile, "Saving score:\n"))
 
+    io_buffer.clear();
+
     // Save the encryption byte for robustness.
     wrByte(xor_byte);
 
@@ -1198,13 +2312,19 @@ void saveHighScore(HighScore_t const &score) {
     wrByte(score.character_class);
     wrBytes((uint8_t *) score.name, PLAYER_NAME_SIZE);
     wrBytes((uint8_t *) score.died_from, 25);
+
+    (void) memcpy(record, io_buffer.data(), HIGH_SCORE_RECORD_SIZE);
     DEBUG(fclose(logfile))
 }
 
-void readHighScore(HighScore_t &score) {
+void decodeHighScore(uint8_t const *record, HighScore_t &score) {
     DEBUG(logfile = fopen("IO_LOG", "a"))
     DEBUG(fprintf(logfile, "Reading score:\n"))
 
+    io_buffer.assign(record, record + HIGH_SCORE_RECORD_SIZE);
+    io_position = 0;
+    io_error = false;
+
     // Read the encryption byte.
     xor_byte = getByte();
 
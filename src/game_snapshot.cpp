@@ -0,0 +1,118 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// In memory snapshots of the game, to go back to in wizard mode and tests
+
+#include "headers.h"
+
+#include <memory>
+
+// Everything a game turn can change, copied as is. Setting aside the floor
+// planes, it is a single block, allocated with the first snapshot and then
+// reused, as are the planes once they are large enough for the level.
+typedef struct {
+    Dungeon_t dungeon;
+    Player_t player;
+    Game_t game;
+
+    Monster_t monsters[MON_TOTAL_ALLOCATIONS];
+    int16_t next_free_monster_id;
+    int16_t monster_multiply_total;
+
+    Store_t stores[MAX_STORES];
+    Recall_t creature_recall[MON_MAX_CREATURES];
+    uint8_t objects_identified[OBJECT_IDENT_SIZE];
+    int16_t missiles_counter;
+
+    vtype_t messages[MESSAGE_HISTORY_SIZE];
+    int16_t last_message_id;
+
+    RandomState_t random_state;
+} GameSnapshot_t;
+
+static thread_local std::unique_ptr<GameSnapshot_t> game_snapshot;
+
+// Takes a snapshot of the game, in place of the last one
+void gameSnapshotTake() {
+    if (game_snapshot == nullptr) {
+        game_snapshot.reset(new GameSnapshot_t);
+    }
+    GameSnapshot_t &snapshot = *game_snapshot;
+
+    // Stocks come out the same whenever the ticks are applied, so the
+    // snapshot never has any left over
+    storeApplyPendingMaintenance();
+
+    snapshot.dungeon = dg;
+    snapshot.player = py;
+    snapshot.game = game;
+
+    std::copy(std::begin(monsters), std::end(monsters), snapshot.monsters);
+    snapshot.next_free_monster_id = next_free_monster_id;
+    snapshot.monster_multiply_total = monster_multiply_total;
+
+    std::copy(std::begin(stores), std::end(stores), snapshot.stores);
+    std::copy(std::begin(creature_recall), std::end(creature_recall), snapshot.creature_recall);
+    std::copy(std::begin(objects_identified), std::end(objects_identified), snapshot.objects_identified);
+    snapshot.missiles_counter = missiles_counter;
+
+    memcpy(snapshot.messages, messages, sizeof(messages));
+    snapshot.last_message_id = last_message_id;
+
+    snapshot.random_state = getRandomState();
+}
+
+// Puts the game back as it was at the last snapshot, which is kept, so it
+// can be gone back to again. Returns `false` when none has been taken.
+bool gameSnapshotRestore() {
+    if (game_snapshot == nullptr) {
+        return false;
+    }
+    GameSnapshot_t const &snapshot = *game_snapshot;
+
+    // Drops the ticks scheduled since the snapshot, the stores are replaced
+    storeApplyPendingMaintenance();
+
+    // The store prices shown are kept by stock version, which must not go back
+    uint16_t stock_versions[MAX_STORES];
+    for (int i = 0; i < MAX_STORES; i++) {
+        stock_versions[i] = (uint16_t)(std::max(stores[i].stock_version, snapshot.stores[i].stock_version) + 1);
+    }
+
+    dg = snapshot.dungeon;
+    py = snapshot.player;
+    game = snapshot.game;
+
+    std::copy(std::begin(snapshot.monsters), std::end(snapshot.monsters), monsters);
+    next_free_monster_id = snapshot.next_free_monster_id;
+    monster_multiply_total = snapshot.monster_multiply_total;
+
+    std::copy(std::begin(snapshot.stores), std::end(snapshot.stores), stores);
+    std::copy(std::begin(snapshot.creature_recall), std::end(snapshot.creature_recall), creature_recall);
+    std::copy(std::begin(snapshot.objects_identified), std::end(snapshot.objects_identified), objects_identified);
+    missiles_counter = snapshot.missiles_counter;
+
+    memcpy(messages, snapshot.messages, sizeof(messages));
+    last_message_id = snapshot.last_message_id;
+
+    setRandomState(snapshot.random_state);
+
+    for (int i = 0; i < MAX_STORES; i++) {
+        stores[i].stock_version = stock_versions[i];
+    }
+
+    // What is worked out from the game state, and kept, must be again
+    tile_feature_changes++;
+    treasureFindPositions();
+    itemDescriptionCacheInvalidate();
+    magicInitializeItemNames();
+
+    monsterIndexReset();
+    for (int id = config::monsters::MON_MIN_INDEX_ID; id < next_free_monster_id; id++) {
+        monsterIndexAdd(id);
+    }
+
+    return true;
+}
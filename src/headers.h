@@ -31,6 +31,7 @@
 
 // Headers we can use on all supported systems!
 
+#include <algorithm>
 #include <cctype>
 #include <cerrno>
 #include <cstdint>
@@ -40,17 +41,26 @@
 #include <ctime>
 #include <iostream>
 #include <limits>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include <fcntl.h>
 #include <sys/stat.h>
 
+// Only Windows distinguishes between text and binary files.
+#ifndef O_BINARY
+    #define O_BINARY 0
+#endif
+
 
 // General Umoria headers
 #include "config.h"
 #include "types.h"
 
 #include "character.h"
+#include "combat.h"
 #include "dice.h"
 #include "ui.h"           // before dungeon.h
 #include "inventory.h"    // before game.h
@@ -61,7 +71,9 @@
 #include "identification.h"
 #include "mage_spells.h"
 #include "monster.h"
+#include "observation.h"
 #include "player.h"
+#include "profile.h"
 #include "recall.h"
 #include "rng.h"
 #include "scores.h"
@@ -69,5 +81,7 @@
 #include "spells.h"
 #include "staves.h"
 #include "store.h"
+#include "telemetry.h"
+#include "tools.h"
 #include "treasure.h"
 #include "wizard.h"
@@ -5,21 +5,76 @@
 
 #include "headers.h"
 #include <cassert>
+#include <cstdarg>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Bit scans of a non-zero value, through the compiler's intrinsics
+
+int bitCountTrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    (void) _BitScanForward(&index, value);
+    return (int) index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+int bitCountTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    // in two halves, _BitScanForward64() is only there on 64 bit targets
+    if ((uint32_t) value != 0u) {
+        return bitCountTrailingZeros((uint32_t) value);
+    }
+    return 32 + bitCountTrailingZeros((uint32_t)(value >> 32));
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+int bitHighestSet(uint32_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    (void) _BitScanReverse(&index, value);
+    return (int) index;
+#else
+    return 31 - __builtin_clz(value);
+#endif
+}
+
+// The number of bits set, the value may be zero
+int bitPopCount(uint32_t value) {
+#ifdef _MSC_VER
+    return (int) __popcnt(value);
+#else
+    return __builtin_popcount(value);
+#endif
+}
 
 // Returns position of first set bit and clears that bit -RAK-
 int getAndClearFirstBit(uint32_t &flag) {
-    uint32_t mask = 0x1;
-
-    for (int i = 0; i < (int) sizeof(flag) * 8; i++) {
-        if ((flag & mask) != 0u) {
-            flag &= ~mask;
-            return i;
-        }
-        mask <<= 1;
+    // no one bits found
+    if (flag == 0u) {
+        return -1;
     }
 
+    int i = bitCountTrailingZeros(flag);
+    flag &= flag - 1;
+    return i;
+}
+
+int getAndClearFirstBit(uint64_t &flag) {
     // no one bits found
-    return -1;
+    if (flag == 0u) {
+        return -1;
+    }
+
+    int i = bitCountTrailingZeros(flag);
+    flag &= flag - 1;
+    return i;
 }
 
 // Insert a long number into a string (was `insert_lnum()` function)
@@ -150,8 +205,50 @@ bool stringToNumber(const char *str, int &number) {
     return true;
 }
 
+// Reads a "HEIGHTxWIDTH" size, e.g. "66x198"
+bool stringToDimensions(const char *str, int &height, int &width) {
+    const char *separator = strchr(str, 'x');
+    if (separator == nullptr) {
+        return false;
+    }
+
+    std::string height_str(str, (size_t)(separator - str));
+
+    return stringToNumber(height_str.c_str(), height) && stringToNumber(separator + 1, width);
+}
+
+MessageText_t::MessageText_t() : text{'\0'}, length(0) {}
+
+MessageText_t &MessageText_t::append(const char *str) {
+    while (*str != '\0' && length < MORIA_MESSAGE_SIZE - 1) {
+        text[length++] = *str++;
+    }
+    text[length] = '\0';
+
+    return *this;
+}
+
+// Appends printf style formatted text
+MessageText_t &MessageText_t::format(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(&text[length], (size_t)(MORIA_MESSAGE_SIZE - length), fmt, args);
+    va_end(args);
+
+    if (written > 0) {
+        length = std::min(length + written, MORIA_MESSAGE_SIZE - 1);
+    }
+
+    return *this;
+}
+
+const char *MessageText_t::c_str() const {
+    return text;
+}
+
+// Goes through the replay log, the clock being an input of the game
 uint32_t getCurrentUnixTime() {
-    return static_cast<uint32_t>(time(nullptr));
+    return replayClock(static_cast<uint32_t>(time(nullptr)));
 }
 
 void humanDateString(char *day) {
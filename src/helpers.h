@@ -10,10 +10,30 @@
 
 #pragma once
 
+// Text built in a fixed size buffer held inline, so formatting a message
+// (e.g. in combat) never allocates. As with the vtype_t buffers, text which
+// doesn't fit is cut short.
+typedef struct MessageText_t {
+    vtype_t text;
+    int length;
+
+    MessageText_t();
+
+    MessageText_t &append(const char *str);
+    MessageText_t &format(const char *fmt, ...);
+    const char *c_str() const;
+} MessageText_t;
+
+int bitCountTrailingZeros(uint32_t value);
+int bitCountTrailingZeros(uint64_t value);
+int bitHighestSet(uint32_t value);
+int bitPopCount(uint32_t value);
 int getAndClearFirstBit(uint32_t &flag);
+int getAndClearFirstBit(uint64_t &flag);
 void insertNumberIntoString(char *to_string, const char *from_string, int32_t number, bool show_sign);
 void insertStringIntoString(char *to_string, const char *from_string, const char *str_to_insert);
 bool isVowel(char ch);
 bool stringToNumber(const char *str, int &number);
+bool stringToDimensions(const char *str, int &height, int &width);
 uint32_t getCurrentUnixTime();
 void humanDateString(char *day);
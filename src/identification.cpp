@@ -8,10 +8,28 @@
 
 #include "headers.h"
 
-char magic_item_titles[MAX_TITLES][10];
+// The names of the unknown potions, scrolls, etc. of a game, which only
+// depend on its magic seed. The scroll titles are kept back to back in
+// `titles_text`, and item descriptions point straight into the table.
+typedef struct {
+    bool valid;
+    uint32_t magic_seed;
+
+    const char *colors[MAX_COLORS];
+    const char *mushrooms[MAX_MUSHROOMS];
+    const char *woods[MAX_WOODS];
+    const char *metals[MAX_METALS];
+    const char *rocks[MAX_ROCKS];
+    const char *amulets[MAX_AMULETS];
+    const char *titles[MAX_TITLES];
+
+    char titles_text[MAX_TITLES * 10];
+} MagicItemNames_t;
+
+static thread_local MagicItemNames_t magic_item_names;
 
 // Identified objects flags
-uint8_t objects_identified[OBJECT_IDENT_SIZE];
+thread_local uint8_t objects_identified[OBJECT_IDENT_SIZE];
 
 static const char *objectDescription(char command) {
     // every printing ASCII character is listed here, in the
@@ -227,60 +245,49 @@ void identifyGameObject() {
 }
 
 // Initialize all Potions, wands, staves, scrolls, etc.
-void magicInitializeItemNames() {
-    int id;
-
-    seedSet(game.magic_seed);
-
-    // The first 3 entries for colors are fixed, (slime & apple juice, water)
-    for (int i = 3; i < MAX_COLORS; i++) {
-        id = randomNumber(MAX_COLORS - 3) + 2;
-        const char *color = colors[i];
-        colors[i] = colors[id];
-        colors[id] = color;
+// Shuffles the names of `list` into `names`, swapping each of them in turn
+// from the `first` one with one of those from `offset` onwards.
+template <size_t N>
+static void magicShuffleNames(const char *(&names)[N], const char *const (&list)[N], int first, int offset) {
+    for (size_t i = 0; i < N; i++) {
+        names[i] = list[i];
     }
 
-    for (auto &w : woods) {
-        id = randomNumber(MAX_WOODS) - 1;
-        const char *wood = w;
-        w = woods[id];
-        woods[id] = wood;
+    for (int i = first; i < (int) N; i++) {
+        int id = randomNumber((int) N - offset) + offset - 1;
+        const char *name = names[i];
+        names[i] = names[id];
+        names[id] = name;
     }
+}
 
-    for (auto &m : metals) {
-        id = randomNumber(MAX_METALS) - 1;
-        const char *metal = m;
-        m = metals[id];
-        metals[id] = metal;
-    }
+// The names are only worked out again when the magic seed changes, as when
+// a new game is started, not for the game just loaded or created again.
+void magicInitializeItemNames() {
+    MagicItemNames_t &names = magic_item_names;
 
-    for (auto &r : rocks) {
-        id = randomNumber(MAX_ROCKS) - 1;
-        const char *rock = r;
-        r = rocks[id];
-        rocks[id] = rock;
+    if (names.valid && names.magic_seed == game.magic_seed) {
+        return;
     }
 
-    for (auto &a : amulets) {
-        id = randomNumber(MAX_AMULETS) - 1;
-        const char *amulet = a;
-        a = amulets[id];
-        amulets[id] = amulet;
-    }
+    seedSet(game.magic_seed, RNG_STREAM_MAGIC_NAMES);
 
-    for (auto &m : mushrooms) {
-        id = randomNumber(MAX_MUSHROOMS) - 1;
-        const char *mushroom = m;
-        m = mushrooms[id];
-        mushrooms[id] = mushroom;
-    }
+    // The names of unknown items are about to be shuffled
+    itemDescriptionCacheInvalidate();
+
+    // The first 3 entries for colors are fixed, (slime & apple juice, water)
+    magicShuffleNames(names.colors, colors, 3, 3);
+    magicShuffleNames(names.woods, woods, 0, 0);
+    magicShuffleNames(names.metals, metals, 0, 0);
+    magicShuffleNames(names.rocks, rocks, 0, 0);
+    magicShuffleNames(names.amulets, amulets, 0, 0);
+    magicShuffleNames(names.mushrooms, mushrooms, 0, 0);
 
-    int k;
-    vtype_t title = {'\0'};
+    char *text = names.titles_text;
 
-    for (auto &item_title : magic_item_titles) {
-        title[0] = '\0';
-        k = randomNumber(2) + 1;
+    for (auto &item_title : names.titles) {
+        vtype_t title = {'\0'};
+        int k = randomNumber(2) + 1;
 
         for (int i = 0; i < k; i++) {
             for (int s = randomNumber(2); s > 0; s--) {
@@ -297,10 +304,14 @@ void magicInitializeItemNames() {
             title[9] = '\0';
         }
 
-        (void) strcpy(item_title, title);
+        item_title = strcpy(text, title);
+        text += strlen(title) + 1;
     }
 
     seedResetToOldSeed();
+
+    names.magic_seed = game.magic_seed;
+    names.valid = true;
 }
 
 int16_t objectPositionOffset(int category_id, int sub_category_id) {
@@ -331,10 +342,12 @@ int16_t objectPositionOffset(int category_id, int sub_category_id) {
 
 static void clearObjectTriedFlag(int16_t id) {
     objects_identified[id] &= ~config::identification::OD_TRIED;
+    itemDescriptionCacheInvalidate();
 }
 
 static void setObjectTriedFlag(int16_t id) {
     objects_identified[id] |= config::identification::OD_TRIED;
+    itemDescriptionCacheInvalidate();
 }
 
 static bool isObjectKnown(int16_t id) {
@@ -353,6 +366,7 @@ void itemSetAsIdentified(int category_id, int sub_category_id) {
     id += (uint8_t)(sub_category_id & (ITEM_SINGLE_STACK_MIN - 1));
 
     objects_identified[id] |= config::identification::OD_KNOWN1;
+    itemDescriptionCacheInvalidate();
 
     // clear the tried flag, since it is now known
     clearObjectTriedFlag(id);
@@ -448,6 +462,8 @@ void itemIdentify(Inventory_t &item, int &item_id) {
 
     itemSetAsIdentified(item.category_id, item.sub_category_id);
 
+    TELEMETRY_EVENT(Identify, item.id, item.items_count);
+
     // no merging possible
     if (!inventoryItemSingleStackable(item)) {
         return;
@@ -473,13 +489,7 @@ void itemIdentify(Inventory_t &item, int &item_id) {
             printMessage("You combine similar objects from the shop and dungeon.");
 
             py.inventory[item_id].items_count += py.inventory[i].items_count;
-            py.pack.unique_items--;
-
-            for (j = i; j < py.pack.unique_items; j++) {
-                py.inventory[j] = py.inventory[j + 1];
-            }
-
-            inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, py.inventory[j]);
+            inventoryRemoveSlot(i);
         }
     }
 }
@@ -517,7 +527,7 @@ enum class ItemMiscUse {
 // The `add_prefix` param indicates that an article must be added.
 // Note that since out_val can easily exceed 80 characters, itemDescription
 // must always be called with a obj_desc_t as the first parameter.
-void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_prefix) {
+static void itemDescriptionBuild(obj_desc_t description, Inventory_t const &item, bool add_prefix) {
     int indexx = item.sub_category_id & (ITEM_SINGLE_STACK_MIN - 1);
 
     // base name, modifier string
@@ -569,7 +579,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
         case TV_AMULET:
             if (modify) {
                 basenm = "& %s Amulet";
-                modstr = amulets[indexx];
+                modstr = magic_item_names.amulets[indexx];
             } else {
                 basenm = "& Amulet";
                 append_name = true;
@@ -579,7 +589,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
         case TV_RING:
             if (modify) {
                 basenm = "& %s Ring";
-                modstr = rocks[indexx];
+                modstr = magic_item_names.rocks[indexx];
             } else {
                 basenm = "& Ring";
                 append_name = true;
@@ -589,7 +599,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
         case TV_STAFF:
             if (modify) {
                 basenm = "& %s Staff";
-                modstr = woods[indexx];
+                modstr = magic_item_names.woods[indexx];
             } else {
                 basenm = "& Staff";
                 append_name = true;
@@ -599,7 +609,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
         case TV_WAND:
             if (modify) {
                 basenm = "& %s Wand";
-                modstr = metals[indexx];
+                modstr = magic_item_names.metals[indexx];
             } else {
                 basenm = "& Wand";
                 append_name = true;
@@ -610,7 +620,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
         case TV_SCROLL2:
             if (modify) {
                 basenm = "& Scroll~ titled \"%s\"";
-                modstr = magic_item_titles[indexx];
+                modstr = magic_item_names.titles[indexx];
             } else {
                 basenm = "& Scroll~";
                 append_name = true;
@@ -620,7 +630,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
         case TV_POTION2:
             if (modify) {
                 basenm = "& %s Potion~";
-                modstr = colors[indexx];
+                modstr = magic_item_names.colors[indexx];
             } else {
                 basenm = "& Potion~";
                 append_name = true;
@@ -636,7 +646,7 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
                     basenm = "& Hairy %s Mold~";
                 }
                 if (indexx <= 20) {
-                    modstr = mushrooms[indexx];
+                    modstr = magic_item_names.mushrooms[indexx];
                 }
             } else {
                 append_name = true;
@@ -858,6 +868,56 @@ void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_p
     (void) strcat(description, ".");
 }
 
+// The inventory, equipment and store screens describe the same items on
+// every redraw, so recent descriptions are kept. An entry is only used
+// for an identical item, while nothing has been learnt about objects.
+constexpr int ITEM_DESCRIPTION_CACHE_SIZE = 128;
+
+typedef struct {
+    uint32_t generation; // `0` for an unused entry
+    bool add_prefix;
+    Inventory_t item;
+    obj_desc_t description;
+} ItemDescriptionCacheEntry_t;
+
+static thread_local ItemDescriptionCacheEntry_t item_description_cache[ITEM_DESCRIPTION_CACHE_SIZE];
+static thread_local uint32_t item_description_generation = 1;
+
+// To be called whenever `objects_identified` or the names of unknown items change
+void itemDescriptionCacheInvalidate() {
+    item_description_generation++;
+    if (item_description_generation == 0) {
+        item_description_generation = 1;
+        for (auto &entry : item_description_cache) {
+            entry.generation = 0;
+        }
+    }
+}
+
+static uint32_t itemDescriptionCacheSlot(Inventory_t const &item, bool add_prefix) {
+    auto bytes = (uint8_t const *) &item;
+
+    uint32_t hash = add_prefix ? 2166136261u : 2166136262u;
+    for (size_t i = 0; i < sizeof(Inventory_t); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+
+    return hash % ITEM_DESCRIPTION_CACHE_SIZE;
+}
+
+void itemDescription(obj_desc_t description, Inventory_t const &item, bool add_prefix) {
+    ItemDescriptionCacheEntry_t &entry = item_description_cache[itemDescriptionCacheSlot(item, add_prefix)];
+
+    if (entry.generation != item_description_generation || entry.add_prefix != add_prefix || memcmp(&entry.item, &item, sizeof(Inventory_t)) != 0) {
+        itemDescriptionBuild(entry.description, item, add_prefix);
+        entry.generation = item_description_generation;
+        entry.add_prefix = add_prefix;
+        (void) memcpy(&entry.item, &item, sizeof(Inventory_t));
+    }
+
+    (void) strcpy(description, entry.description);
+}
+
 // Describe number of remaining charges. -RAK-
 void itemChargesRemainingDescription(int item_id) {
     if (!spellItemIdentified(py.inventory[item_id])) {
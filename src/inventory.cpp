@@ -7,14 +7,15 @@
 
 #include "headers.h"
 
-uint32_t inventoryCollectAllItemFlags() {
-    uint32_t flags = 0;
+// Takes the item out of its pack slot, moving the items after it up in one
+// block, and clears the slot left free at the end of the pack.
+void inventoryRemoveSlot(int item_id) {
+    Inventory_t *end = py.inventory + py.pack.unique_items;
 
-    for (int i = PlayerEquipment::Wield; i < PlayerEquipment::Light; i++) {
-        flags |= py.inventory[i].flags;
-    }
+    std::move(py.inventory + item_id + 1, end, py.inventory + item_id);
+    py.pack.unique_items--;
 
-    return flags;
+    inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, py.inventory[py.pack.unique_items]);
 }
 
 // Destroy an item in the inventory -RAK-
@@ -26,13 +27,7 @@ void inventoryDestroyItem(int item_id) {
         py.pack.weight -= item.weight;
     } else {
         py.pack.weight -= item.weight * item.items_count;
-
-        for (int i = item_id; i < py.pack.unique_items - 1; i++) {
-            py.inventory[i] = py.inventory[i + 1];
-        }
-
-        inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, py.inventory[py.pack.unique_items - 1]);
-        py.pack.unique_items--;
+        inventoryRemoveSlot(item_id);
     }
 
     py.flags.status |= config::player::status::PY_STR_WGT;
@@ -59,21 +54,14 @@ void inventoryDropItem(int item_id, bool drop_all) {
     Inventory_t &item = py.inventory[item_id];
     game.treasure.list[treasure_id] = item;
 
-    dg.floor[py.pos.y][py.pos.x].treasure_id = (uint8_t) treasure_id;
+    dungeonSetTreasureId(py.pos, treasure_id);
 
     if (item_id >= PlayerEquipment::Wield) {
         playerTakeOff(item_id, -1);
     } else {
         if (drop_all || item.items_count == 1) {
             py.pack.weight -= item.weight * item.items_count;
-            py.pack.unique_items--;
-
-            while (item_id < py.pack.unique_items) {
-                py.inventory[item_id] = py.inventory[item_id + 1];
-                item_id++;
-            }
-
-            inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, py.inventory[py.pack.unique_items]);
+            inventoryRemoveSlot(item_id);
         } else {
             game.treasure.list[treasure_id].items_count = 1;
             py.pack.weight -= item.weight;
@@ -288,9 +276,7 @@ int inventoryCarryItem(Inventory_t &new_item) {
         if ((is_same_category && new_item.sub_category_id < item.sub_category_id && is_always_known) || new_item.category_id > item.category_id) {
             // For items which are always `is_known`, i.e. never have a 'color',
             // insert them into the inventory in sorted order.
-            for (int i = py.pack.unique_items - 1; i >= slot_id; i--) {
-                py.inventory[i + 1] = py.inventory[i];
-            }
+            std::move_backward(py.inventory + slot_id, py.inventory + py.pack.unique_items, py.inventory + py.pack.unique_items + 1);
             py.inventory[slot_id] = new_item;
             py.pack.unique_items++;
             break;
@@ -343,7 +329,7 @@ void inventoryItemCopyTo(int from_item_id, Inventory_t &to_item) {
     to_item.category_id = from.category_id;
     to_item.sprite = from.sprite;
     to_item.misc_use = from.misc_use;
-    to_item.cost = from.cost;
+    to_item.cost = storeAdjustedCost(from.cost);
     to_item.sub_category_id = from.sub_category_id;
     to_item.items_count = from.items_count;
     to_item.weight = from.weight;
@@ -74,8 +74,7 @@ enum PlayerEquipment {
     Auxiliary,
 };
 
-uint32_t inventoryCollectAllItemFlags();
-
+void inventoryRemoveSlot(int item_id);
 void inventoryDestroyItem(int item_id);
 void inventoryTakeOneItem(Inventory_t *to_item, Inventory_t *from_item);
 void inventoryDropItem(int item_id, bool drop_all);
@@ -0,0 +1,233 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Level sweep: generates the levels of many seeds in parallel without a terminal
+
+#include "headers.h"
+
+#include <atomic>
+#include <chrono>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-levels [OPTIONS]
+
+Generates one dungeon level per seed, with no game played, and prints one
+CSV record of statistics per level. A seed gives the same level as it does
+for the -p option of the game.
+
+Options:
+    -s NUMBER    First level seed (default: 1)
+    -c NUMBER    Number of levels, using consecutive seeds (default: 1000)
+    -d NUMBER    Dungeon depth of the levels, 0 for the town (default: 1)
+    -j NUMBER    Number of worker threads (default: all cores)
+    -l HxW       Dungeon level size in tiles (default: 66x198)
+    -o           Pick objects and monsters from tables instead of the classic rolls
+    -r           Use the counter based RNG instead of the classic Lehmer RNG
+    -t           Dig tunnels with the directed tunneler instead of the classic one
+    -R NUMBER    Build the rooms of each level on NUMBER threads, each room
+                 from an RNG stream of its own
+
+    -h           Display this message
+)";
+
+// Statistics of a single generated level
+typedef struct {
+    uint32_t seed;
+    DungeonGenerationStats_t generation;
+    int objects;
+    int monsters;
+    int stairs;
+    int unreachable_stairs; // Stairs the player can not walk to, even through doors and rubble
+    int64_t ns;
+} LevelOutcome_t;
+
+// Options of the generated levels
+static int16_t levels_depth = 1;
+static bool levels_counter_rng = false;
+static bool levels_directed_tunnels = false;
+static bool levels_selection_tables = false;
+static int levels_room_threads = 0;
+static int levels_height = MAX_HEIGHT;
+static int levels_width = MAX_WIDTH;
+
+// Character creation, as for umoria-sim, then an escape for any other prompt
+static const char *character_creation_keys = "am\033aLevels\r ";
+static thread_local const char *pending_keys = nullptr;
+
+static int levelsKeySource() {
+    if (pending_keys != nullptr && *pending_keys != '\0') {
+        return *pending_keys++;
+    }
+    return ESCAPE;
+}
+
+// Counts the stairs and, with a flood fill from the player over every tile
+// which isn't a wall, those which can not be reached.
+static void levelCountStairs(LevelOutcome_t &outcome) {
+    std::vector<bool> seen((size_t) dg.height * dg.width, false);
+    std::vector<Coord_t> pending;
+
+    pending.push_back(py.pos);
+    seen[py.pos.y * dg.width + py.pos.x] = true;
+
+    int reachable = 0;
+
+    while (!pending.empty()) {
+        Coord_t coord = pending.back();
+        pending.pop_back();
+
+        uint8_t treasure_id = dg.floor[coord.y][coord.x].treasure_id;
+        if (treasure_id != 0) {
+            uint8_t category_id = game.treasure.list[treasure_id].category_id;
+            if (category_id == TV_UP_STAIR || category_id == TV_DOWN_STAIR) {
+                reachable++;
+            }
+        }
+
+        for (int y = coord.y - 1; y <= coord.y + 1; y++) {
+            for (int x = coord.x - 1; x <= coord.x + 1; x++) {
+                if (!coordInBounds(Coord_t{y, x}) || seen[y * dg.width + x] || dg.floor[y][x].feature_id > MAX_CAVE_FLOOR) {
+                    continue;
+                }
+                seen[y * dg.width + x] = true;
+                pending.push_back(Coord_t{y, x});
+            }
+        }
+    }
+
+    outcome.stairs = 0;
+    for (int id = config::treasure::MIN_TREASURE_LIST_ID; id < game.treasure.current_id; id++) {
+        uint8_t category_id = game.treasure.list[id].category_id;
+        if (category_id == TV_UP_STAIR || category_id == TV_DOWN_STAIR) {
+            outcome.stairs++;
+        }
+    }
+    outcome.unreachable_stairs = outcome.stairs - reachable;
+}
+
+static void generateLevel(uint32_t seed, LevelOutcome_t &outcome) {
+    dg.current_level = levels_depth;
+    if (levels_depth == 0) {
+        game.town_seed = seed;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    generateCaveFromSeed(seed);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    outcome.seed = seed;
+    outcome.generation = generation_stats;
+    outcome.objects = game.treasure.current_id - config::treasure::MIN_TREASURE_LIST_ID;
+    outcome.monsters = next_free_monster_id - config::monsters::MON_MIN_INDEX_ID;
+    outcome.ns = (int64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    levelCountStairs(outcome);
+}
+
+int main(int argc, char *argv[]) {
+    int first_seed = 1;
+    int level_count = 1000;
+    int depth = 1;
+    int thread_count = toolThreadCount();
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 'r':
+                levels_counter_rng = true;
+                break;
+            case 't':
+                levels_directed_tunnels = true;
+                break;
+            case 'o':
+                levels_selection_tables = true;
+                break;
+            case 's':
+                ok = toolOptionNumber(options, first_seed);
+                break;
+            case 'c':
+                ok = toolOptionNumber(options, level_count);
+                break;
+            case 'd':
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToNumber(value, depth) && depth >= 0 && depth <= SHRT_MAX;
+                break;
+            case 'j':
+                ok = toolOptionNumber(options, thread_count);
+                break;
+            case 'R':
+                ok = toolOptionNumber(options, levels_room_threads);
+                break;
+            case 'l':
+                // Validated here, as each worker thread sets its own size
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToDimensions(value, levels_height, levels_width) && dungeonSetSize(levels_height, levels_width);
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    levels_depth = (int16_t) depth;
+
+    std::vector<LevelOutcome_t> outcomes((size_t) level_count);
+    std::atomic<int> next_level{0};
+
+    // Each worker is a game of its own, set up once: generating a level
+    // from its seed doesn't depend on anything that came before it.
+    auto worker = [&](int) {
+        pending_keys = character_creation_keys;
+        (void) terminalInitializeHeadless(levelsKeySource);
+
+        if (levels_counter_rng) {
+            setRandomMode(RandomMode::Counter);
+        }
+        if (levels_directed_tunnels) {
+            setTunnelMode(TunnelMode::Directed);
+        }
+        if (levels_selection_tables) {
+            setSelectionMode(SelectionMode::Tables);
+        }
+        setRoomBuildThreads(levels_room_threads);
+
+        (void) dungeonSetSize(levels_height, levels_width);
+
+        setupSimulatedGame((uint32_t) first_seed);
+
+        int id;
+        while ((id = next_level++) < level_count) {
+            generateLevel((uint32_t)(first_seed + id), outcomes[id]);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    toolRunWorkers(thread_count, worker);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("seed,depth,rooms,unusual_rooms,vaults,tunnels,tunnel_length,tunnel_steps,max_tunnel_steps,tunnels_out_of_steps,objects,monsters,stairs,unreachable_stairs,ns\n");
+    for (auto const &outcome : outcomes) {
+        DungeonGenerationStats_t const &generation = outcome.generation;
+
+        printf("%u,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%lld\n", outcome.seed, levels_depth, generation.rooms, generation.unusual_rooms, generation.vaults, generation.tunnels, generation.tunnel_length, generation.tunnel_steps,
+               generation.max_tunnel_steps, generation.tunnels_out_of_steps, outcome.objects, outcome.monsters, outcome.stairs, outcome.unreachable_stairs, (long long) outcome.ns);
+    }
+
+    fprintf(stderr, "%d levels in %lld ms\n", level_count, (long long) elapsed);
+
+    return 0;
+}
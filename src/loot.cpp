@@ -0,0 +1,202 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Loot sampler: rolls many random objects of a dungeon level, in parallel
+// without a terminal, for the distribution of the treasure found there.
+
+#include "headers.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <tuple>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-loot [OPTIONS]
+
+Rolls random objects as they are made for a dungeon level, as the wizard's
+"produce objects" command does, and prints one CSV record for each outcome
+rolled: the object, its special (ego) name and all its bonuses, and how many
+times it came up. The same seed gives the same counts, whatever the number
+of threads.
+
+Options:
+    -d NUMBER    Dungeon level the objects are made for (default: 1)
+    -n NUMBER    Number of objects (default: 1000000)
+    -s NUMBER    Seed (default: 1)
+    -j NUMBER    Number of worker threads (default: all cores)
+    -m           Small objects only, as found in chests
+    -o           Pick objects from tables instead of the classic rolls
+
+    -h           Display this message
+)";
+
+// The samples are rolled in chunks, each from an RNG stream of its own, so
+// the counts don't depend on which thread rolled them.
+constexpr int LOOT_CHUNK_SAMPLES = 4096;
+
+// An outcome of a roll, all that tells two objects of a level apart
+typedef struct {
+    uint16_t object_id;
+    uint8_t special_name_id;
+    int16_t misc_use;
+    int16_t to_hit;
+    int16_t to_damage;
+    int16_t to_ac;
+    bool cursed;
+} LootOutcome_t;
+
+static bool operator<(LootOutcome_t const &a, LootOutcome_t const &b) {
+    return std::tie(a.object_id, a.special_name_id, a.misc_use, a.to_hit, a.to_damage, a.to_ac, a.cursed) < std::tie(b.object_id, b.special_name_id, b.misc_use, b.to_hit, b.to_damage, b.to_ac, b.cursed);
+}
+
+typedef std::map<LootOutcome_t, uint64_t> LootCounts_t;
+
+// Options of the rolls
+static int loot_depth = 1;
+static bool loot_small_objects = false;
+static bool loot_selection_tables = false;
+
+// Character creation, as for umoria-sim, then an escape for any other prompt
+static const char *character_creation_keys = "am\033aLoot\r ";
+static thread_local const char *pending_keys = nullptr;
+
+static int lootKeySource() {
+    if (pending_keys != nullptr && *pending_keys != '\0') {
+        return *pending_keys++;
+    }
+    return ESCAPE;
+}
+
+// Rolls `count` objects into `treasure_id`, from the RNG stream set up
+static void lootRollObjects(int treasure_id, int count, LootCounts_t &counts) {
+    Inventory_t &item = game.treasure.list[treasure_id];
+
+    for (int i = 0; i < count; i++) {
+        int object_id = sorted_objects[itemGetRandomObjectId(loot_depth, loot_small_objects)];
+
+        inventoryItemCopyTo(object_id, item);
+
+        // Missiles are numbered as made, to stack apart, which is no part
+        // of the loot: starting the count over keeps their `misc_use` same.
+        missiles_counter = 0;
+        magicTreasureMagicalAbility(treasure_id, loot_depth);
+
+        LootOutcome_t outcome{};
+        outcome.object_id = item.id;
+        outcome.special_name_id = item.special_name_id;
+        outcome.misc_use = item.misc_use;
+        outcome.to_hit = item.to_hit;
+        outcome.to_damage = item.to_damage;
+        outcome.to_ac = item.to_ac;
+        outcome.cursed = inventoryItemIsCursed(item);
+
+        counts[outcome]++;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int sample_count = 1000000;
+    int seed = 1;
+    int thread_count = toolThreadCount();
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 'm':
+                loot_small_objects = true;
+                break;
+            case 'o':
+                loot_selection_tables = true;
+                break;
+            case 'd':
+                // The limits of the wizard's command
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToNumber(value, loot_depth) && loot_depth >= 0 && loot_depth <= 1200;
+                break;
+            case 'n':
+                ok = toolOptionNumber(options, sample_count);
+                break;
+            case 's':
+                ok = toolOptionNumber(options, seed);
+                break;
+            case 'j':
+                ok = toolOptionNumber(options, thread_count);
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    int chunk_count = (sample_count + LOOT_CHUNK_SAMPLES - 1) / LOOT_CHUNK_SAMPLES;
+    std::atomic<int> next_chunk{0};
+
+    RandomStream_t loot_stream = randomStreamCreate((uint64_t) seed, RNG_STREAM_LOOT);
+
+    // Each worker is a game of its own, keeping its own counts
+    std::vector<LootCounts_t> worker_counts((size_t) thread_count);
+
+    auto worker = [&](int worker_id) {
+        LootCounts_t &counts = worker_counts[worker_id];
+
+        pending_keys = character_creation_keys;
+        (void) terminalInitializeHeadless(lootKeySource);
+
+        if (loot_selection_tables) {
+            setSelectionMode(SelectionMode::Tables);
+        }
+
+        setupSimulatedGame((uint32_t) seed);
+        setRandomMode(RandomMode::Counter);
+
+        int treasure_id = popt();
+
+        int chunk;
+        while ((chunk = next_chunk++) < chunk_count) {
+            RandomStream_t parent = loot_stream;
+            parent.counter = (uint64_t) chunk;
+            setRandomStream(randomStreamSplit(parent));
+
+            lootRollObjects(treasure_id, std::min(LOOT_CHUNK_SAMPLES, sample_count - chunk * LOOT_CHUNK_SAMPLES), counts);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    toolRunWorkers(thread_count, worker);
+
+    LootCounts_t counts;
+    for (auto const &worker_count : worker_counts) {
+        for (auto const &outcome : worker_count) {
+            counts[outcome.first] += outcome.second;
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("depth,object_id,category_id,sub_category_id,special_name_id,misc_use,to_hit,to_damage,to_ac,cursed,count,name\n");
+    for (auto const &entry : counts) {
+        LootOutcome_t const &outcome = entry.first;
+        DungeonObject_t const &object = game_objects[outcome.object_id];
+
+        printf("%d,%u,%u,%u,%u,%d,%d,%d,%d,%d,%llu,\"%s\"\n", loot_depth, outcome.object_id, object.category_id, object.sub_category_id, outcome.special_name_id, outcome.misc_use, outcome.to_hit, outcome.to_damage, outcome.to_ac, outcome.cursed ? 1 : 0,
+               (unsigned long long) entry.second, object.name);
+    }
+
+    fprintf(stderr, "%d objects (%zu outcomes) in %lld ms\n", sample_count, counts.size(), (long long) elapsed);
+
+    return 0;
+}
@@ -231,7 +231,9 @@ void getAndCastMagicSpell() {
 
     Spell_t const &magic_spell = magic_spells[py.misc.class_id - 1][choice];
 
-    if (randomNumber(100) < chance) {
+    bool failed = randomNumber(100) < chance;
+
+    if (failed) {
         printMessage("You failed to get the spell off!");
     } else {
         castSpell(choice + 1);
@@ -248,6 +250,8 @@ void getAndCastMagicSpell() {
         return;
     }
 
+    TELEMETRY_EVENT(SpellCast, choice, failed ? 0 : 1, "mage");
+
     if (magic_spell.mana_required > py.misc.current_mana) {
         printMessage("You faint from the effort!");
 
@@ -9,6 +9,8 @@
 #include "version.h"
 
 static bool parseGameSeed(const char *argv, uint32_t &seed);
+static int readKeyFromStdin();
+static void writeMessageToStderr(const char *msg);
 
 static const char *usage_instructions = R"(
 Usage:
@@ -20,6 +22,29 @@ Options:
     -n           Force start of new game
     -d           Display high scores and exit
     -s NUMBER    Game Seed, as a decimal number (max: 2147483647)
+    -b           Batch mode: no display, key presses are read from stdin
+    -m           In batch mode, write every game message to stderr
+    -a NUMBER    Autosave every NUMBER game turns, for crash recovery
+    -l HxW       Dungeon level size in tiles (default: 66x198), must be
+                 multiples of the 22x66 screen size
+    -e           Move the unseen monsters off the screen only every few turns,
+                 all moves at once (a seed then gives a different game)
+    -f           Monsters find their way around walls to the player, along
+                 the shortest path (a seed then gives a different game)
+    -o           Pick objects and monsters with a single draw from tables
+                 of their odds (a seed then gives different levels)
+    -p           Build the levels next to the current one in the background,
+                 each from its own seed (a seed then gives different levels)
+    -t           Dig tunnels with the directed tunneler, which never wanders
+                 far (a seed then gives different levels)
+    -u           Restock the stores only once they are entered (or saved),
+                 each restock from its own seed
+    -r FILE      Record a new game to the replay log FILE: its seed, options,
+                 every key press and clock reading
+    -y FILE      Play the replay log FILE back in batch mode, at full speed,
+                 with its seed and options (SAVEGAME default: FILE.sav)
+    -x FILE      In batch mode, write hashes of the game state to FILE after
+                 every game turn, to find where two runs first differ
 
     -v           Print version info and exit
     -h           Display this message
@@ -29,36 +54,46 @@ Options:
 int main(int argc, char *argv[]) {
     uint32_t seed = 0;
     bool new_game = false;
+    bool headless = false;
+    bool message_tap = false;
+    bool display_scores = false;
+    const char *record_filename = nullptr;
+    const char *replay_filename = nullptr;
+    const char *hash_filename = nullptr;
 
-    // call this routine to grab a file pointer to the high score file
-    // and prepare things to relinquish setuid privileges
-    if (!initializeScoreFile()) {
-        std::cerr << "Can't open score file '" << config::files::scores << "'\n";
-        return 1;
-    }
+    {
+        PROFILE_SCOPE(OpenScoreFile);
 
-    // Make sure we have access to all files -MRC-
-    if (!checkFilePermissions()) {
-        return 1;
-    }
+        // call this routine to grab a file pointer to the high score file
+        // and prepare things to relinquish setuid privileges
+        if (!initializeScoreFile()) {
+            std::cerr << "Can't open score file '" << config::files::scores << "'\n";
+            return 1;
+        }
 
-    if (!terminalInitialize()) {
-        return 1;
+        // Make sure we have access to all files -MRC-
+        if (!checkFilePermissions()) {
+            return 1;
+        }
     }
 
     // check for user interface option
     for (--argc, ++argv; argc > 0 && argv[0][0] == '-'; --argc, ++argv) {
         switch (argv[0][1]) {
             case 'v':
-                terminalRestore();
                 printf("%d.%d.%d\n", CURRENT_VERSION_MAJOR, CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH);
                 return 0;
             case 'n':
                 new_game = true;
                 break;
             case 'd':
-                showScoresScreen();
-                exitProgram();
+                display_scores = true;
+                break;
+            case 'b':
+                headless = true;
+                break;
+            case 'm':
+                message_tap = true;
                 break;
             case 's':
                 // No NUMBER provided?
@@ -71,18 +106,79 @@ int main(int argc, char *argv[]) {
                 ++argv;
 
                 if (!parseGameSeed(argv[0], seed)) {
-                    terminalRestore();
                     printf("Game seed must be a decimal number between 1 and 2147483647\n");
                     return -1;
                 }
 
+                break;
+            case 'a':
+                if (argv[1] == nullptr || !stringToNumber(argv[1], game.autosave_turns) || game.autosave_turns <= 0) {
+                    printf("Autosave turns must be a decimal number greater than 0\n");
+                    return -1;
+                }
+
+                // Move onto the next option
+                --argc;
+                ++argv;
+
+                break;
+            case 'l': {
+                int height = 0;
+                int width = 0;
+
+                if (argv[1] == nullptr || !stringToDimensions(argv[1], height, width) || !dungeonSetSize(height, width)) {
+                    printf("Level size must be HEIGHTxWIDTH, multiples of 22x66, from 66x198 up to %dx%d\n", LEVEL_MAX_HEIGHT, LEVEL_MAX_WIDTH);
+                    return -1;
+                }
+
+                // Move onto the next option
+                --argc;
+                ++argv;
+
+                break;
+            }
+            case 'e':
+                game.coarse_distant_monsters = true;
+                break;
+            case 'f':
+                setPathingMode(PathingMode::Flow);
+                break;
+            case 'o':
+                setSelectionMode(SelectionMode::Tables);
+                break;
+            case 'p':
+                game.pregenerate_levels = true;
+                break;
+            case 't':
+                setTunnelMode(TunnelMode::Directed);
+                break;
+            case 'u':
+                game.lazy_store_maintenance = true;
                 break;
             case 'w':
                 game.to_be_wizard = true;
                 break;
-            default:
-                terminalRestore();
+            case 'r':
+            case 'y':
+            case 'x':
+                if (argv[1] == nullptr) {
+                    printf("Filename missing for option -%c\n", argv[0][1]);
+                    return -1;
+                }
+                if (argv[0][1] == 'r') {
+                    record_filename = argv[1];
+                } else if (argv[0][1] == 'y') {
+                    replay_filename = argv[1];
+                } else {
+                    hash_filename = argv[1];
+                }
+
+                // Move onto the next option
+                --argc;
+                ++argv;
 
+                break;
+            default:
                 printf("Robert A. Koeneke's classic dungeon crawler.\n");
                 printf("Umoria %d.%d.%d is released under a GPL-3.0-or-later license.\n", CURRENT_VERSION_MAJOR,
                        CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH);
@@ -91,6 +187,61 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    // A replay is a new game, its options and seed are those it was
+    // recorded with, whatever the command line says.
+    if (replay_filename != nullptr) {
+        if (record_filename != nullptr) {
+            printf("A game can't be recorded while a replay log is played\n");
+            return -1;
+        }
+        if (!replayPlayStart(replay_filename, seed)) {
+            printf("Can't play the replay log '%s'\n", replay_filename);
+            return -1;
+        }
+        new_game = true;
+        headless = true;
+        config::files::save_game = std::string(replay_filename) + ".sav";
+    }
+
+    if (record_filename != nullptr) {
+        if (!replayRecordStart(record_filename, seed)) {
+            printf("Can't write the replay log '%s'\n", record_filename);
+            return -1;
+        }
+        new_game = true;
+    }
+
+    if (hash_filename != nullptr && !headless) {
+        printf("The state hashes are only written in batch mode\n");
+        return -1;
+    }
+
+    // The terminal is only set up once the options are known, as batch
+    // mode must never touch curses (there may not even be a terminal).
+    if (headless) {
+        (void) terminalInitializeBatch(replay_filename != nullptr ? replayReadKey : readKeyFromStdin);
+        if (message_tap) {
+            messageSetTap(writeMessageToStderr);
+        }
+        if (hash_filename != nullptr) {
+            FILE *hash_file = fopen(hash_filename, "w");
+            if (hash_file == nullptr) {
+                printf("Can't write the state hashes to '%s'\n", hash_filename);
+                return -1;
+            }
+            gameHashSetTurnOutput(hash_file);
+        }
+    } else if (!terminalInitialize()) {
+        return 1;
+    } else {
+        hangupSaveOnSignal();
+    }
+
+    if (display_scores) {
+        showScoresScreen();
+        exitProgram();
+    }
+
     // Auto-restart of saved file
     if (argv[0] != CNIL) {
         // (void) strcpy(config::files::save_game, argv[0]);
@@ -116,3 +267,14 @@ static bool parseGameSeed(const char *argv, uint32_t &seed) {
 
     return true;
 }
+
+// Key source for batch mode, stdio buffering means a block of
+// key presses is fetched per read() rather than one per key.
+static int readKeyFromStdin() {
+    return getchar();
+}
+
+// Message tap of batch mode: one message per line
+static void writeMessageToStderr(const char *msg) {
+    fprintf(stderr, "%s\n", msg);
+}
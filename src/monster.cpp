@@ -9,10 +9,20 @@
 
 // A horrible hack, needed because compactMonsters() is called from deep
 // within updateMonsters() via monsterPlaceNew() and monsterSummon().
-int hack_monptr = -1;
+thread_local int hack_monptr = -1;
 
 static bool executeAttackOnPlayer(uint8_t creature_level, int16_t &monster_hp, int monster_id, int attack_type, int damage, vtype_t death_description, bool noticed);
 
+static thread_local PathingMode pathing_mode = PathingMode::Classic;
+
+PathingMode getPathingMode() {
+    return pathing_mode;
+}
+
+void setPathingMode(PathingMode mode) {
+    pathing_mode = mode;
+}
+
 static bool monsterIsVisible(Monster_t const &monster) {
     bool visible = false;
 
@@ -36,8 +46,16 @@ static bool monsterIsVisible(Monster_t const &monster) {
     return visible;
 }
 
+// On a level larger than the classic dungeon the distance may not fit
+// in distance_from_player, such monsters are simply as far away as can be.
+uint8_t monsterDistanceToPlayer(Coord_t const &coord) {
+    return (uint8_t) std::min(coordDistanceBetween(py.pos, coord), (int) UINT8_MAX);
+}
+
 // Updates screen when monsters move about -RAK-
 void monsterUpdateVisibility(int monster_id) {
+    monster_changes++;
+
     bool visible = false;
     Monster_t &monster = monsters[monster_id];
 
@@ -46,7 +64,7 @@ void monsterUpdateVisibility(int monster_id) {
         if (game.wizard_mode) {
             // Wizard sight.
             visible = true;
-        } else if (los(py.pos, monster.pos)) {
+        } else if (losFromPlayer(monster.pos)) {
             visible = monsterIsVisible(monster);
         }
     }
@@ -74,7 +92,7 @@ void monsterUpdateVisibility(int monster_id) {
 // Given speed, returns number of moves this turn. -RAK-
 // NOTE: Player must always move at least once per iteration,
 // a slowed player is handled by moving monsters faster
-static int monsterMovementRate(int16_t speed) {
+int monsterMovementRate(int16_t speed, int32_t turn) {
     if (speed > 0) {
         if (py.flags.rest != 0) {
             return 1;
@@ -84,13 +102,32 @@ static int monsterMovementRate(int16_t speed) {
 
     // speed must be negative here
     int rate = 0;
-    if ((dg.game_turn % (2 - speed)) == 0) {
+    if ((turn % (2 - speed)) == 0) {
         rate = 1;
     }
 
     return rate;
 }
 
+// With coarse distant monsters, a monster which isn't lit and is out of
+// sight, or off the screen, moves only once every MON_DISTANT_BATCH_TURNS
+// turns, but then makes the moves of all the turns since its last one.
+// Which turn of the batch it moves on is offset by its ID, so that the
+// monsters don't all move at once.
+int monsterDistantMovementRate(int monster_id, int16_t speed, int32_t turn) {
+    int batch = config::monsters::MON_DISTANT_BATCH_TURNS;
+
+    if ((turn + monster_id) % batch != 0) {
+        return 0;
+    }
+
+    int moves = 0;
+    for (int32_t batch_turn = turn - batch + 1; batch_turn <= turn; batch_turn++) {
+        moves += monsterMovementRate(speed, batch_turn);
+    }
+    return moves;
+}
+
 // Makes sure a new creature gets lit up. -CJS-
 static bool monsterMakeVisible(Coord_t coord) {
     int monster_id = dg.floor[coord.y][coord.x].creature_id;
@@ -102,154 +139,207 @@ static bool monsterMakeVisible(Coord_t coord) {
     return monsters[monster_id].lit;
 }
 
+// The directions to try for each octant of the player's position relative to
+// the monster, as worked out by monsterDirectionsTowards() below. The second
+// index tells apart the two orders of each octant: for the diagonals whether
+// ay > ax, for the east/west ones whether y < 0 and for the north/south ones
+// whether x < 0. Octants 3, 7, 11 and 15 can not happen.
+static constexpr uint8_t monster_move_directions[16][2][5] = {
+    {{9, 6, 8, 3, 7}, {9, 8, 6, 7, 3}}, // 0
+    {{6, 9, 3, 8, 2}, {6, 3, 9, 2, 8}}, // 1
+    {{8, 7, 9, 4, 6}, {8, 9, 7, 6, 4}}, // 2
+    {{0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}}, // 3
+    {{7, 4, 8, 1, 9}, {7, 8, 4, 9, 1}}, // 4
+    {{4, 7, 1, 8, 2}, {4, 1, 7, 2, 8}}, // 5
+    {{8, 7, 9, 4, 6}, {8, 9, 7, 6, 4}}, // 6
+    {{0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}}, // 7
+    {{3, 6, 2, 9, 1}, {3, 2, 6, 1, 9}}, // 8
+    {{6, 9, 3, 8, 2}, {6, 3, 9, 2, 8}}, // 9
+    {{2, 1, 3, 4, 6}, {2, 3, 1, 6, 4}}, // 10
+    {{0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}}, // 11
+    {{1, 4, 2, 7, 3}, {1, 2, 4, 3, 7}}, // 12
+    {{4, 7, 1, 8, 2}, {4, 1, 7, 2, 8}}, // 13
+    {{2, 1, 3, 4, 6}, {2, 3, 1, 6, 4}}, // 14
+    {{0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}}, // 15
+};
+
+// Fills in the five directions, best first, for a monster at (y, x)
+// relative to the player to move towards the player.
+void monsterDirectionsTowards(int y, int x, int *directions) {
+    int ay = std::abs(y);
+    int ax = std::abs(x);
+
+    // this has the advantage of preventing the diamond maneuver, also faster.
+    // Both of the last two can not be true at once.
+    int movement = ((int) (y < 0) << 3) | ((int) (x > 0) << 2) | ((int) (ay > (ax << 1)) << 1) | (int) (ax > (ay << 1));
+
+    int orders[4] = {(int) (ay > ax), (int) (y < 0), (int) (x < 0), 0};
+
+    uint8_t const *order = monster_move_directions[movement][orders[movement & 3]];
+    for (int i = 0; i < 5; i++) {
+        directions[i] = order[i];
+    }
+}
+
 // Choose correct directions for monster movement -RAK-
 static void monsterGetMoveDirection(int monster_id, int *directions) {
-    int ay, ax, movement;
-
-    int y = monsters[monster_id].pos.y - py.pos.y;
-    int x = monsters[monster_id].pos.x - py.pos.x;
+    monsterDirectionsTowards(monsters[monster_id].pos.y - py.pos.y, monsters[monster_id].pos.x - py.pos.x, directions);
+}
 
-    if (y < 0) {
-        movement = 8;
-        ay = -y;
-    } else {
-        movement = 0;
-        ay = y;
+// Steps to the player of the tiles around, shared by all the monsters and
+// built again, the first time a monster asks for it, once the player has
+// moved or the feature of a tile has changed (a door opened, a wall dug).
+// A tile only holds a distance if its stamp is the one of the latest build,
+// so the field is never cleared.
+constexpr uint16_t FLOW_MAX_DISTANCE = 40;
+
+typedef struct {
+    std::vector<uint16_t> distances;
+    std::vector<uint32_t> stamps;
+    std::vector<uint32_t> pending;
+    uint32_t stamp;
+    uint32_t feature_changes;
+    int16_t level;
+    Coord_t origin;
+} FlowField_t;
+
+static thread_local FlowField_t flow_field;
+
+// Can a monster walk, or open a door, onto this tile?
+static bool flowTilePassable(uint8_t feature_id, uint8_t treasure_id) {
+    if (feature_id <= MAX_OPEN_SPACE) {
+        return true;
     }
-    if (x > 0) {
-        movement += 4;
-        ax = x;
-    } else {
-        ax = -x;
+    if (treasure_id == 0) {
+        return false;
     }
 
-    // this has the advantage of preventing the diamond maneuver, also faster
-    if (ay > (ax << 1)) {
-        movement += 2;
-    } else if (ax > (ay << 1)) {
-        movement++;
+    uint8_t category_id = game.treasure.list[treasure_id].category_id;
+    return category_id == TV_CLOSED_DOOR || category_id == TV_SECRET_DOOR;
+}
+
+static void flowFieldBuild() {
+    FlowField_t &flow = flow_field;
+
+    // The floor may be larger than the level (in the town), its rows are
+    // floor.columns apart.
+    int height = dg.height;
+    int width = dg.width;
+    int stride = dg.floor.columns;
+
+    size_t tiles = dg.floor.size();
+    if (flow.stamps.size() != tiles || flow.stamp == UINT32_MAX) {
+        flow.distances.assign(tiles, 0);
+        flow.stamps.assign(tiles, 0);
+        flow.stamp = 0;
     }
 
-    switch (movement) {
-        case 0:
-            directions[0] = 9;
-            if (ay > ax) {
-                directions[1] = 8;
-                directions[2] = 6;
-                directions[3] = 7;
-                directions[4] = 3;
-            } else {
-                directions[1] = 6;
-                directions[2] = 8;
-                directions[3] = 3;
-                directions[4] = 7;
-            }
-            break;
-        case 1:
-        case 9:
-            directions[0] = 6;
-            if (y < 0) {
-                directions[1] = 3;
+    uint32_t stamp = ++flow.stamp;
+    flow.feature_changes = tile_feature_changes;
+    flow.level = dg.current_level;
+    flow.origin = py.pos;
 
-                directions[2] = 9;
-                directions[3] = 2;
-                directions[4] = 8;
-            } else {
-                directions[1] = 9;
-                directions[2] = 3;
-                directions[3] = 8;
-                directions[4] = 2;
-            }
-            break;
-        case 2:
-        case 6:
-            directions[0] = 8;
-            if (x < 0) {
-                directions[1] = 9;
-                directions[2] = 7;
-                directions[3] = 6;
-                directions[4] = 4;
-            } else {
-                directions[1] = 7;
-                directions[2] = 9;
-                directions[3] = 4;
-                directions[4] = 6;
-            }
-            break;
-        case 4:
-            directions[0] = 7;
-            if (ay > ax) {
-                directions[1] = 8;
-                directions[2] = 4;
-                directions[3] = 9;
-                directions[4] = 1;
-            } else {
-                directions[1] = 4;
-                directions[2] = 8;
-                directions[3] = 1;
-                directions[4] = 9;
-            }
-            break;
-        case 5:
-        case 13:
-            directions[0] = 4;
-            if (y < 0) {
-                directions[1] = 1;
-                directions[2] = 7;
-                directions[3] = 2;
-                directions[4] = 8;
-            } else {
-                directions[1] = 7;
-                directions[2] = 1;
-                directions[3] = 8;
-                directions[4] = 2;
-            }
-            break;
-        case 8:
-            directions[0] = 3;
-            if (ay > ax) {
-                directions[1] = 2;
-                directions[2] = 6;
-                directions[3] = 1;
-                directions[4] = 9;
-            } else {
-                directions[1] = 6;
-                directions[2] = 2;
-                directions[3] = 9;
-                directions[4] = 1;
-            }
-            break;
-        case 10:
-        case 14:
-            directions[0] = 2;
-            if (x < 0) {
-                directions[1] = 3;
-                directions[2] = 1;
-                directions[3] = 6;
-                directions[4] = 4;
-            } else {
-                directions[1] = 1;
-                directions[2] = 3;
-                directions[3] = 4;
-                directions[4] = 6;
-            }
-            break;
-        case 12:
-            directions[0] = 1;
-            if (ay > ax) {
-                directions[1] = 2;
-                directions[2] = 4;
-                directions[3] = 3;
-                directions[4] = 7;
-            } else {
-                directions[1] = 4;
-                directions[2] = 2;
-                directions[3] = 7;
-                directions[4] = 3;
+    uint8_t const *features = dg.floor.features.data();
+    uint8_t const *treasures = dg.floor.treasures.data();
+    uint16_t *distances = flow.distances.data();
+    uint32_t *stamps = flow.stamps.data();
+
+    int const neighbours[8] = {-stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1};
+
+    auto origin_id = (uint32_t)(py.pos.y * stride + py.pos.x);
+    distances[origin_id] = 0;
+    stamps[origin_id] = stamp;
+
+    flow.pending.clear();
+    flow.pending.push_back(origin_id);
+
+    // Breadth first, so every tile is first reached by a shortest path
+    for (size_t next = 0; next < flow.pending.size(); next++) {
+        uint32_t tile_id = flow.pending[next];
+        uint16_t distance = distances[tile_id];
+
+        // The edges of a level are walls, so are never passed through
+        int y = (int) tile_id / stride;
+        int x = (int) tile_id % stride;
+        if (distance == FLOW_MAX_DISTANCE || y < 1 || y >= height - 1 || x < 1 || x >= width - 1) {
+            continue;
+        }
+
+        for (int offset : neighbours) {
+            uint32_t id = tile_id + offset;
+            if (stamps[id] == stamp || !flowTilePassable(features[id], treasures[id])) {
+                continue;
             }
-            break;
-        default:
-            break;
+
+            distances[id] = (uint16_t)(distance + 1);
+            stamps[id] = stamp;
+            flow.pending.push_back(id);
+        }
+    }
+}
+
+// Steps from the tile to the player, false when the tile is out of reach
+static bool flowFieldDistance(Coord_t const &coord, uint16_t &distance) {
+    FlowField_t &flow = flow_field;
+
+    if (flow.stamp == 0 || flow.feature_changes != tile_feature_changes || flow.level != dg.current_level || flow.origin.y != py.pos.y || flow.origin.x != py.pos.x) {
+        flowFieldBuild();
+    }
+
+    size_t tile_id = (size_t) coord.y * dg.floor.columns + coord.x;
+    if (flow.stamps[tile_id] != flow.stamp) {
+        return false;
+    }
+
+    distance = flow.distances[tile_id];
+    return true;
+}
+
+// As monsterGetMoveDirection(), but in flow pathing mode the directions which
+// take the monster a step nearer along the shortest path come first, in the
+// order of preference of the straight line ones.
+static void monsterGetPathDirection(int monster_id, int *directions) {
+    monsterGetMoveDirection(monster_id, directions);
+
+    Monster_t const &monster = monsters[monster_id];
+
+    uint16_t distance;
+    if (pathing_mode != PathingMode::Flow || (creatures_list[monster.creature_id].movement & config::monsters::move::CM_PHASE) != 0u || !flowFieldDistance(monster.pos, distance)) {
+        return;
+    }
+
+    // The straight line directions first, then the three others
+    int candidates[8];
+    int candidate_count = 0;
+    for (int i = 0; i < 5; i++) {
+        candidates[candidate_count++] = directions[i];
+    }
+    for (int direction = 1; direction <= 9; direction++) {
+        if (direction != 5 && std::find(candidates, candidates + candidate_count, direction) == candidates + candidate_count) {
+            candidates[candidate_count++] = direction;
+        }
+    }
+
+    // Any tile next to this one is at most one step further from the player
+    // than it, so those which are nearer are all on a shortest path.
+    int chosen = 0;
+    bool taken[8] = {false};
+    for (int i = 0; i < candidate_count && chosen < 5; i++) {
+        Coord_t coord = monster.pos;
+        (void) playerMovePosition(candidates[i], coord);
+
+        uint16_t next_distance;
+        if (flowFieldDistance(coord, next_distance) && next_distance < distance) {
+            directions[chosen++] = candidates[i];
+            taken[i] = true;
+        }
+    }
+
+    // Then the straight line ones left, as before
+    for (int i = 0; i < 5 && chosen < 5; i++) {
+        if (!taken[i]) {
+            directions[chosen++] = candidates[i];
+        }
     }
 }
 
@@ -614,7 +704,7 @@ static void monsterAllowedToMove(Monster_t &monster, uint32_t move_bits, bool &d
 
     monster.pos.y = coord.y;
     monster.pos.x = coord.x;
-    monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, coord);
+    monster.distance_from_player = monsterDistanceToPlayer(coord);
 
     do_turn = true;
 }
@@ -636,7 +726,7 @@ static void makeMove(int monster_id, int *directions, uint32_t &rcmove) {
 
         (void) playerMovePosition(directions[i], coord);
 
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
         if (tile.feature_id == TILE_BOUNDARY_WALL) {
             continue;
@@ -678,14 +768,38 @@ static bool monsterCanCastSpells(Monster_t const &monster, uint32_t spells) {
     }
 
     // Must be within certain range
-    bool within_range = monster.distance_from_player <= config::monsters::MON_MAX_SPELL_CAST_DISTANCE;
+    if (monster.distance_from_player > config::monsters::MON_MAX_SPELL_CAST_DISTANCE) {
+        return false;
+    }
 
     // Must have unobstructed Line-Of-Sight
-    bool unobstructed = los(py.pos, monster.pos);
+    return losFromPlayer(monster.pos);
+}
 
-    return within_range && unobstructed;
+// The spells each creature can cast, listed once from its spell flags in
+// the order getAndClearFirstBit() would give them, so that picking one is
+// a single draw.
+typedef struct {
+    uint8_t count[MON_MAX_CREATURES];
+    uint8_t spell_ids[MON_MAX_CREATURES][32];
+} CreatureSpellLists_t;
+
+static CreatureSpellLists_t creatureSpellListsBuild() {
+    CreatureSpellLists_t lists{};
+
+    for (int id = 0; id < MON_MAX_CREATURES; id++) {
+        auto spell_flags = (uint32_t)(creatures_list[id].spells & ~config::monsters::spells::CS_FREQ);
+
+        while (spell_flags != 0) {
+            lists.spell_ids[id][lists.count[id]++] = (uint8_t) getAndClearFirstBit(spell_flags);
+        }
+    }
+
+    return lists;
 }
 
+static const CreatureSpellLists_t creature_spell_lists = creatureSpellListsBuild();
+
 void monsterExecuteCastingOfSpell(Monster_t &monster, int monster_id, int spell_id, uint8_t level, vtype_t monster_name, vtype_t death_description) {
     Coord_t coord = py.pos; //  only used for cases 14 and 15.
 
@@ -874,18 +988,8 @@ static bool monsterCastSpell(int monster_id) {
     vtype_t death_description = {'\0'};
     playerDiedFromString(&death_description, creature.name, creature.movement);
 
-    // Extract all possible spells into spell_choice
-    int spell_choice[30];
-    auto spell_flags = (uint32_t)(creature.spells & ~config::monsters::spells::CS_FREQ);
-
-    int id = 0;
-    while (spell_flags != 0) {
-        spell_choice[id] = getAndClearFirstBit(spell_flags);
-        id++;
-    }
-
     // Choose a spell to cast
-    int thrown_spell = spell_choice[randomNumber(id) - 1];
+    int thrown_spell = creature_spell_lists.spell_ids[monster.creature_id][randomNumber(creature_spell_lists.count[monster.creature_id]) - 1];
     thrown_spell++;
 
     // all except spellTeleportAwayMonster() and drain mana spells always disturb
@@ -926,26 +1030,29 @@ bool monsterMultiply(Coord_t coord, int creature_id, int monster_id) {
         // don't create a new creature on top of the old one, that
         // causes invincible/invisible creatures to appear.
         if (coordInBounds(position) && (position.y != coord.y || position.x != coord.x)) {
-            Tile_t const &tile = dg.floor[position.y][position.x];
+            // Most tries land on a wall or another monster, so the planes
+            // are read directly rather than through a Tile_t.
+            size_t tile_id = (size_t) position.y * dg.floor.columns + position.x;
+            uint8_t creature_id_there = dg.floor.creatures[tile_id];
 
-            if (tile.feature_id <= MAX_OPEN_SPACE && tile.treasure_id == 0 && tile.creature_id != 1) {
+            if (dg.floor.features[tile_id] <= MAX_OPEN_SPACE && dg.floor.treasures[tile_id] == 0 && creature_id_there != 1) {
                 // Creature there already?
-                if (tile.creature_id > 1) {
+                if (creature_id_there > 1) {
                     // Some critters are cannibalistic!
                     bool cannibalistic = (creatures_list[creature_id].movement & config::monsters::move::CM_EATS_OTHER) != 0;
 
                     // Check the experience level -CJS-
-                    bool experienced = creatures_list[creature_id].kill_exp_value >= creatures_list[monsters[tile.creature_id].creature_id].kill_exp_value;
+                    bool experienced = creatures_list[creature_id].kill_exp_value >= creatures_list[monsters[creature_id_there].creature_id].kill_exp_value;
 
                     if (cannibalistic && experienced) {
                         // It ate an already processed monster. Handle * normally.
-                        if (monster_id < tile.creature_id) {
-                            dungeonDeleteMonster((int) tile.creature_id);
+                        if (monster_id < creature_id_there) {
+                            dungeonDeleteMonster((int) creature_id_there);
                         } else {
                             // If it eats this monster, an already processed
                             // monster will take its place, causing all kinds
                             // of havoc. Delay the kill a bit.
-                            dungeonRemoveMonsterFromLevel((int) tile.creature_id);
+                            dungeonRemoveMonsterFromLevel((int) creature_id_there);
                         }
 
                         // in case compact_monster() is called, it needs monster_id.
@@ -985,13 +1092,17 @@ bool monsterMultiply(Coord_t coord, int creature_id, int monster_id) {
 static void monsterMultiplyCritter(Monster_t const &monster, int monster_id, uint32_t &rcmove) {
     int counter = 0;
 
-    Coord_t coord = Coord_t{0, 0};
-
-    for (coord.y = monster.pos.y - 1; coord.y <= monster.pos.y + 1; coord.y++) {
-        for (coord.x = monster.pos.x - 1; coord.x <= monster.pos.x + 1; coord.x++) {
-            if (coordInBounds(coord) && (dg.floor[coord.y][coord.x].creature_id > 1)) {
-                counter++;
-            }
+    // The monsters on the tiles in bounds around (and on) this one, read
+    // straight from the creatures plane, a row at a time.
+    int y_min = std::max(monster.pos.y - 1, 1);
+    int y_max = std::min(monster.pos.y + 1, dg.height - 2);
+    int x_min = std::max(monster.pos.x - 1, 1);
+    int x_max = std::min(monster.pos.x + 1, dg.width - 2);
+
+    for (int y = y_min; y <= y_max; y++) {
+        uint8_t const *row = &dg.floor.creatures[(size_t) y * dg.floor.columns];
+        for (int x = x_min; x <= x_max; x++) {
+            counter += (int) (row[x] > 1);
         }
     }
 
@@ -1098,26 +1209,6 @@ static void monsterMoveConfused(Creature_t const &creature, int monster_id, uint
     }
 }
 
-static bool monsterDoMove(int monster_id, uint32_t &rcmove, Monster_t &monster, Creature_t const &creature) {
-    // Creature is confused or undead turned?
-    if (monster.confused_amount != 0u) {
-        if ((creature.defenses & config::monsters::defense::CD_UNDEAD) != 0) {
-            monsterMoveUndead(creature, monster_id, rcmove);
-        } else {
-            monsterMoveConfused(creature, monster_id, rcmove);
-        }
-        monster.confused_amount--;
-        return true;
-    }
-
-    // Creature may cast a spell
-    if ((creature.spells & config::monsters::spells::CS_FREQ) != 0u) {
-        return monsterCastSpell(monster_id);
-    }
-
-    return false;
-}
-
 static void monsterMoveRandomly(int monster_id, uint32_t &rcmove, int randomness) {
     int directions[9];
 
@@ -1142,7 +1233,7 @@ static void monsterMoveNormally(int monster_id, uint32_t &rcmove) {
         directions[3] = randomNumber(9);
         directions[4] = randomNumber(9);
     } else {
-        monsterGetMoveDirection(monster_id, directions);
+        monsterGetPathDirection(monster_id, directions);
     }
 
     rcmove |= config::monsters::move::CM_MOVE_NORMAL;
@@ -1164,45 +1255,66 @@ static void monsterAttackWithoutMoving(int monster_id, uint32_t &rcmove, uint8_t
 }
 
 // Move the critters about the dungeon -RAK-
-static void monsterMove(int monster_id, uint32_t &rcmove) {
+//
+// Each kind of mover gets a copy of its own, with the tests of the flags
+// its creatures can't have left out: `Multiplies` and `Phases` for the
+// CM_MULTIPLY and CM_PHASE movement flags, `Casts` for spell casters and
+// `MovesRandomly` for any of the random movement flags.
+template <bool Multiplies, bool Phases, bool Casts, bool MovesRandomly>
+static void monsterMoveAs(int monster_id, uint32_t &rcmove) {
     Monster_t &monster = monsters[monster_id];
     Creature_t const &creature = creatures_list[monster.creature_id];
 
     // Does the critter multiply?
     // rest could be negative, to be safe, only use mod with positive values.
-    auto abs_rest_period = (int) std::abs((std::intmax_t) py.flags.rest);
-    if (((creature.movement & config::monsters::move::CM_MULTIPLY) != 0u) && config::monsters::MON_MAX_MULTIPLY_PER_LEVEL >= monster_multiply_total &&
-        (abs_rest_period % config::monsters::MON_MULTIPLY_ADJUST) == 0) {
-        monsterMultiplyCritter(monster, monster_id, rcmove);
+    if (Multiplies) {
+        auto abs_rest_period = (int) std::abs((std::intmax_t) py.flags.rest);
+        if (config::monsters::MON_MAX_MULTIPLY_PER_LEVEL >= monster_multiply_total && (abs_rest_period % config::monsters::MON_MULTIPLY_ADJUST) == 0) {
+            monsterMultiplyCritter(monster, monster_id, rcmove);
+        }
     }
 
     // if in wall, must immediately escape to a clear area
     // then monster movement finished
-    if (((creature.movement & config::monsters::move::CM_PHASE) == 0u) && dg.floor[monster.pos.y][monster.pos.x].feature_id >= MIN_CAVE_WALL) {
+    if (!Phases && dg.floor.features[(size_t) monster.pos.y * dg.floor.columns + monster.pos.x] >= MIN_CAVE_WALL) {
         monsterMoveOutOfWall(monster, monster_id, rcmove);
         return;
     }
 
-    if (monsterDoMove(monster_id, rcmove, monster, creature)) {
+    // Creature is confused or undead turned?
+    if (monster.confused_amount != 0u) {
+        if ((creature.defenses & config::monsters::defense::CD_UNDEAD) != 0) {
+            monsterMoveUndead(creature, monster_id, rcmove);
+        } else {
+            monsterMoveConfused(creature, monster_id, rcmove);
+        }
+        monster.confused_amount--;
         return;
     }
 
-    // 75% random movement
-    if (((creature.movement & config::monsters::move::CM_75_RANDOM) != 0u) && randomNumber(100) < 75) {
-        monsterMoveRandomly(monster_id, rcmove, config::monsters::move::CM_75_RANDOM);
+    // Creature may cast a spell
+    if (Casts && monsterCastSpell(monster_id)) {
         return;
     }
 
-    // 40% random movement
-    if (((creature.movement & config::monsters::move::CM_40_RANDOM) != 0u) && randomNumber(100) < 40) {
-        monsterMoveRandomly(monster_id, rcmove, config::monsters::move::CM_40_RANDOM);
-        return;
-    }
+    if (MovesRandomly) {
+        // 75% random movement
+        if (((creature.movement & config::monsters::move::CM_75_RANDOM) != 0u) && randomNumber(100) < 75) {
+            monsterMoveRandomly(monster_id, rcmove, config::monsters::move::CM_75_RANDOM);
+            return;
+        }
 
-    // 20% random movement
-    if (((creature.movement & config::monsters::move::CM_20_RANDOM) != 0u) && randomNumber(100) < 20) {
-        monsterMoveRandomly(monster_id, rcmove, config::monsters::move::CM_20_RANDOM);
-        return;
+        // 40% random movement
+        if (((creature.movement & config::monsters::move::CM_40_RANDOM) != 0u) && randomNumber(100) < 40) {
+            monsterMoveRandomly(monster_id, rcmove, config::monsters::move::CM_40_RANDOM);
+            return;
+        }
+
+        // 20% random movement
+        if (((creature.movement & config::monsters::move::CM_20_RANDOM) != 0u) && randomNumber(100) < 20) {
+            monsterMoveRandomly(monster_id, rcmove, config::monsters::move::CM_20_RANDOM);
+            return;
+        }
     }
 
     // Normal movement
@@ -1232,6 +1344,58 @@ static void monsterMove(int monster_id, uint32_t &rcmove) {
     }
 }
 
+typedef void (*MonsterMover_t)(int monster_id, uint32_t &rcmove);
+
+// The kinds of mover, by their template arguments as the bits of the index
+template <int Kind>
+static void monsterMoveAsKind(int monster_id, uint32_t &rcmove) {
+    monsterMoveAs<(Kind & 1) != 0, (Kind & 2) != 0, (Kind & 4) != 0, (Kind & 8) != 0>(monster_id, rcmove);
+}
+
+static constexpr MonsterMover_t monster_mover_kinds[16] = {
+    monsterMoveAsKind<0>,  monsterMoveAsKind<1>,  monsterMoveAsKind<2>,  monsterMoveAsKind<3>,
+    monsterMoveAsKind<4>,  monsterMoveAsKind<5>,  monsterMoveAsKind<6>,  monsterMoveAsKind<7>,
+    monsterMoveAsKind<8>,  monsterMoveAsKind<9>,  monsterMoveAsKind<10>, monsterMoveAsKind<11>,
+    monsterMoveAsKind<12>, monsterMoveAsKind<13>, monsterMoveAsKind<14>, monsterMoveAsKind<15>,
+};
+
+// The mover of each creature, picked once from its flags
+typedef struct {
+    MonsterMover_t move[MON_MAX_CREATURES];
+} MonsterMovers_t;
+
+static MonsterMovers_t monsterMoversBuild() {
+    MonsterMovers_t movers{};
+
+    for (int id = 0; id < MON_MAX_CREATURES; id++) {
+        Creature_t const &creature = creatures_list[id];
+
+        int kind = 0;
+        if ((creature.movement & config::monsters::move::CM_MULTIPLY) != 0u) {
+            kind |= 1;
+        }
+        if ((creature.movement & config::monsters::move::CM_PHASE) != 0u) {
+            kind |= 2;
+        }
+        if ((creature.spells & config::monsters::spells::CS_FREQ) != 0u) {
+            kind |= 4;
+        }
+        if ((creature.movement & config::monsters::move::CM_RANDOM_MOVE) != 0u) {
+            kind |= 8;
+        }
+
+        movers.move[id] = monster_mover_kinds[kind];
+    }
+
+    return movers;
+}
+
+static const MonsterMovers_t monster_movers = monsterMoversBuild();
+
+static void monsterMove(int monster_id, uint32_t &rcmove) {
+    monster_movers.move[monsters[monster_id].creature_id](monster_id, rcmove);
+}
+
 static void memoryUpdateRecall(Monster_t const &monster, bool wake, bool ignore, uint32_t rcmove) {
     if (!monster.lit) {
         return;
@@ -1309,8 +1473,59 @@ static void monsterAttackingUpdate(Monster_t &monster, int monster_id, int moves
     }
 }
 
+// Refresh distance_from_player for every monster in one tight pass,
+// with coordDistanceBetween() inlined the compiler can keep it in
+// registers (and vectorize it).
+static void monsterUpdateDistances(Coord_t origin) {
+    for (int id = config::monsters::MON_MIN_INDEX_ID; id < next_free_monster_id; id++) {
+        Monster_t &monster = monsters[id];
+
+        monster.distance_from_player = (uint8_t) std::min(coordDistanceBetween(origin, monster.pos), (int) UINT8_MAX);
+    }
+}
+
+// A monster which isn't lit, is out of sight and too far away to notice the
+// player does nothing at all on its turn: it is neither given a move nor
+// does its visibility change, so it can be passed over.
+static bool monsterIsIdle(Monster_t const &monster, bool attack) {
+    if (monster.lit || monster.distance_from_player <= config::monsters::MON_MAX_SIGHT) {
+        return false;
+    }
+    if (!attack) {
+        return true;
+    }
+
+    Creature_t const &creature = creatures_list[monster.creature_id];
+    if (monster.distance_from_player <= creature.area_affect_radius) {
+        return false;
+    }
+
+    // Monsters trapped in rock are always given their turn
+    return (creature.movement & config::monsters::move::CM_PHASE) != 0u || dg.floor[monster.pos.y][monster.pos.x].feature_id < MIN_CAVE_WALL;
+}
+
+// The last turn on which every monster was idle, and what they were idle
+// for: while none of it changes they all stay idle.
+static thread_local struct {
+    bool valid;
+    int32_t game_turn;
+    Coord_t player;
+    uint32_t monster_changes;
+    uint32_t feature_changes;
+} monsters_idle;
+
 // Creatures movement and attacking are done from here -RAK-
 void updateMonsters(bool attack) {
+    PROFILE_SCOPE(UpdateMonsters);
+
+    // Monsters keep their own distance up to date whenever they move or
+    // are placed, so only the player moving (teleport) during this turn
+    // requires the distance to be calculated again.
+    Coord_t origin = py.pos;
+    monsterUpdateDistances(origin);
+
+    bool all_idle = attack;
+
     // Process the monsters
     for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID && !game.character_is_dead; id--) {
         Monster_t &monster = monsters[id];
@@ -1320,18 +1535,37 @@ void updateMonsters(bool attack) {
         // monsters while scanning the monsters here.
         if (monster.hp < 0) {
             dungeonDeleteMonsterRecord(id);
+            all_idle = false;
             continue;
         }
 
-        monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, Coord_t{monster.pos.y, monster.pos.x});
+        if (py.pos.y != origin.y || py.pos.x != origin.x) {
+            monster.distance_from_player = monsterDistanceToPlayer(Coord_t{monster.pos.y, monster.pos.x});
+        }
+
+        if (monsterIsIdle(monster, attack)) {
+            continue;
+        }
+        all_idle = false;
 
         // Attack is argument passed to CREATURE
         if (attack) {
-            int moves = monsterMovementRate(monster.speed);
+            int moves;
+            if (game.coarse_distant_monsters && !monster.lit && (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !coordInsidePanel(monster.pos))) {
+                // Nor is their visibility updated in between, as being
+                // out of sight it can't change.
+                moves = monsterDistantMovementRate(id, monster.speed, dg.game_turn);
+                if (moves <= 0) {
+                    continue;
+                }
+            } else {
+                moves = monsterMovementRate(monster.speed, dg.game_turn);
+            }
 
             if (moves <= 0) {
                 monsterUpdateVisibility(id);
             } else {
+                PROFILE_COUNT(MonsterMoves);
                 monsterAttackingUpdate(monster, id, moves);
             }
         } else {
@@ -1346,6 +1580,33 @@ void updateMonsters(bool attack) {
             continue;
         }
     }
+
+    monsters_idle.valid = all_idle && !game.character_is_dead;
+    monsters_idle.game_turn = dg.game_turn;
+    monsters_idle.player = py.pos;
+    monsters_idle.monster_changes = monster_changes;
+    monsters_idle.feature_changes = tile_feature_changes;
+}
+
+// The monsters' turn on a turn the player ran no command (resting, or
+// paralysed), or only dug. If every monster was idle on the last turn, it
+// is only the monsters, the player's position and the walls and doors, that
+// could have made any of them stop being idle. When none of those has
+// changed, they are all idle again and there is nothing to do.
+void updateMonstersAfterIdleTurn() {
+    bool unchanged = monsters_idle.valid &&                              //
+                     monsters_idle.game_turn + 1 == dg.game_turn &&      //
+                     monsters_idle.player.y == py.pos.y &&               //
+                     monsters_idle.player.x == py.pos.x &&               //
+                     monsters_idle.monster_changes == monster_changes && //
+                     monsters_idle.feature_changes == tile_feature_changes;
+
+    if (unchanged) {
+        monsters_idle.game_turn = dg.game_turn;
+        return;
+    }
+
+    updateMonsters(true);
 }
 
 uint16_t* getMemoryKills(uint16_t creature_id) {
@@ -1469,6 +1730,8 @@ uint32_t monsterDeath(Coord_t coord, uint32_t flags) {
 
         printMessage("*** CONGRATULATIONS *** You have won the game.");
         printMessage("You cannot save this game, but you may retire when ready.");
+
+        TELEMETRY_EVENT(Won, py.misc.level, py.misc.exp);
     }
 
     if (dropped_item_id == 0) {
@@ -1495,23 +1758,25 @@ uint32_t monsterDeath(Coord_t coord, uint32_t flags) {
     return return_flags | number_of_items;
 }
 
-void printMonsterActionText(const std::string &name, const std::string &action) {
-    printMessage((name + " " + action).c_str());
+void printMonsterActionText(MessageText_t const &name, const char *action) {
+    MessageText_t msg;
+    printMessage(msg.format("%s %s", name.c_str(), action).c_str());
 }
 
-std::string monsterNameDescription(const std::string &real_name, bool is_lit) {
+MessageText_t monsterNameDescription(const char *real_name, bool is_lit) {
+    MessageText_t name;
     if (is_lit) {
-        return "The " + real_name;
+        return name.format("The %s", real_name);
     }
-    return "It";
+    return name.append("It");
 }
 
 // Sleep creatures adjacent to player -RAK-
 bool monsterSleep(Coord_t coord) {
     bool asleep = false;
 
-    for (int y = coord.y - 1; y <= coord.y + 1 && y < MAX_HEIGHT; y++) {
-        for (int x = coord.x - 1; x <= coord.x + 1 && x < MAX_WIDTH; x++) {
+    for (int y = coord.y - 1; y <= coord.y + 1 && y < dg.height; y++) {
+        for (int x = coord.x - 1; x <= coord.x + 1 && x < dg.width; x++) {
             uint8_t monster_id = dg.floor[y][x].creature_id;
 
             if (monster_id <= 1) {
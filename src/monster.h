@@ -12,7 +12,7 @@ struct Monster_t {
     int16_t speed;        // Movement speed
     uint16_t creature_id; // Pointer into creature
 
-    // Note: fy, fx, and cdis constrain dungeon size to less than 256 by 256
+    // Note: cdis is at most 255, even on the larger than classic levels
     Coord_t pos;                  // (y,x) Pointer into map
     uint8_t distance_from_player; // Current distance from player
 
@@ -58,28 +58,58 @@ constexpr uint8_t MON_TOTAL_ALLOCATIONS = 125; // Max that can be allocated
 constexpr uint8_t MON_MAX_LEVELS = 40;         // Maximum level of creatures
 constexpr uint8_t MON_MAX_ATTACKS = 4;         // Max num attacks (used in mons memory) -CJS-
 
-extern int hack_monptr;
-extern Creature_t creatures_list[MON_MAX_CREATURES];
-extern Monster_t monsters[MON_TOTAL_ALLOCATIONS];
-extern int16_t monster_levels[MON_MAX_LEVELS + 1];
-extern MonsterAttack_t monster_attacks[MON_ATTACK_TYPES];
+extern thread_local int hack_monptr;
+extern const Creature_t creatures_list[MON_MAX_CREATURES];
+extern thread_local Monster_t monsters[MON_TOTAL_ALLOCATIONS];
+extern const int16_t (&monster_levels)[MON_MAX_LEVELS + 1]; // Built from creatures_list at compile time
+extern const MonsterAttack_t monster_attacks[MON_ATTACK_TYPES];
 extern Monster_t blank_monster;
-extern int16_t next_free_monster_id;
-extern int16_t monster_multiply_total;
+extern thread_local int16_t next_free_monster_id;
+extern thread_local int16_t monster_multiply_total;
 
+// Bumped whenever a monster is added, removed, moved or could change its
+// visibility, so that a past look at the monsters can be known to still hold.
+extern thread_local uint32_t monster_changes;
+
+// How monsters moving normally find their way to the player. Classic
+// monsters head straight for the player and get stuck behind walls,
+// flow monsters follow the shortest path out to 40 steps, over the
+// tiles they can walk through and the doors. Classic remains the
+// default, as the monsters move differently from the same seed.
+enum class PathingMode {
+    Classic,
+    Flow,
+};
+
+PathingMode getPathingMode();
+void setPathingMode(PathingMode mode);
+
+uint8_t monsterDistanceToPlayer(Coord_t const &coord);
+int monsterMovementRate(int16_t speed, int32_t turn);
+int monsterDistantMovementRate(int monster_id, int16_t speed, int32_t turn);
 void monsterUpdateVisibility(int monster_id);
+void monsterDirectionsTowards(int y, int x, int *directions);
 bool monsterMultiply(Coord_t coord, int creature_id, int monster_id);
 void updateMonsters(bool attack);
+void updateMonstersAfterIdleTurn();
 uint32_t monsterDeath(Coord_t coord, uint32_t flags);
 int monsterTakeHit(int monster_id, int damage);
-void printMonsterActionText(const std::string &name, const std::string &action);
-std::string monsterNameDescription(const std::string &real_name, bool is_lit);
+void printMonsterActionText(MessageText_t const &name, const char *action);
+MessageText_t monsterNameDescription(const char *real_name, bool is_lit);
 bool monsterSleep(Coord_t coord);
 
 // monster management
 bool compactMonsters();
+void monsterIndexReset();
+void monsterIndexAdd(int monster_id);
+void monsterIndexRemove(int monster_id);
+void monsterIndexMove(int monster_id, Coord_t const &from, Coord_t const &to);
+int monstersWithinArea(Coord_t const &top_left, Coord_t const &bottom_right, uint8_t *ids);
+int16_t monsterRollHitPoints(int creature_id);
 bool monsterPlaceNew(Coord_t coord, int creature_id, bool sleeping);
+bool monsterPlaceCopy(Monster_t const &monster);
 void monsterPlaceWinning();
 void monsterPlaceNewWithinDistance(int number, int distance_from_source, bool sleeping);
+void monsterBuildSelectionTables();
 bool monsterSummon(Coord_t &coord, bool sleeping);
 bool monsterSummonUndead(Coord_t &coord);
@@ -7,14 +7,16 @@
 
 #include "headers.h"
 
-Monster_t monsters[MON_TOTAL_ALLOCATIONS];
-int16_t monster_levels[MON_MAX_LEVELS + 1];
+#include <mutex>
+
+thread_local Monster_t monsters[MON_TOTAL_ALLOCATIONS];
 
 // Values for a blank monster
 Monster_t blank_monster = {0, 0, 0, 0, Coord_t{0, 0}, 0, false, 0, 0};
 
-int16_t next_free_monster_id;   // ID for the next available monster ptr
-int16_t monster_multiply_total; // Total number of reproduction's of creatures
+thread_local int16_t next_free_monster_id;   // ID for the next available monster ptr
+thread_local int16_t monster_multiply_total; // Total number of reproduction's of creatures
+thread_local uint32_t monster_changes = 0;
 
 // Returns a pointer to next free space -RAK-
 // Returns -1 if could not allocate a monster.
@@ -27,6 +29,32 @@ static int popm() {
     return next_free_monster_id++;
 }
 
+// Places a copy of a monster made elsewhere, e.g. on a worker thread, at its position
+bool monsterPlaceCopy(Monster_t const &monster) {
+    int monster_id = popm();
+
+    if (monster_id == -1) {
+        return false;
+    }
+
+    monsters[monster_id] = monster;
+
+    dg.floor[monster.pos.y][monster.pos.x].creature_id = (uint8_t) monster_id;
+    monsterIndexAdd(monster_id);
+
+    return true;
+}
+
+// The hit points of a new creature of `creature_id`, rolled off its hit dice
+int16_t monsterRollHitPoints(int creature_id) {
+    Creature_t const &creature = creatures_list[creature_id];
+
+    if ((creature.defenses & config::monsters::defense::CD_MAX_HP) != 0) {
+        return (int16_t) maxDiceRoll(creature.hit_die);
+    }
+    return (int16_t) diceRoll(creature.hit_die);
+}
+
 // Places a monster at given location -RAK-
 bool monsterPlaceNew(Coord_t coord, int creature_id, bool sleeping) {
     int monster_id = popm();
@@ -42,19 +70,17 @@ bool monsterPlaceNew(Coord_t coord, int creature_id, bool sleeping) {
     monster.pos.x = coord.x;
     monster.creature_id = (uint16_t) creature_id;
 
-    if ((creatures_list[creature_id].defenses & config::monsters::defense::CD_MAX_HP) != 0) {
-        monster.hp = (int16_t) maxDiceRoll(creatures_list[creature_id].hit_die);
-    } else {
-        monster.hp = (int16_t) diceRoll(creatures_list[creature_id].hit_die);
-    }
+    monster.hp = monsterRollHitPoints(creature_id);
 
     // the creatures_list[] speed value is 10 greater, so that it can be a uint8_t
     monster.speed = (int16_t)(creatures_list[creature_id].speed - 10 + py.flags.speed);
     monster.stunned_amount = 0;
-    monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, coord);
+    monster.distance_from_player = monsterDistanceToPlayer(coord);
     monster.lit = false;
 
     dg.floor[coord.y][coord.x].creature_id = (uint8_t) monster_id;
+    monsterIndexAdd(monster_id);
+    PROFILE_COUNT(MonstersPlaced);
 
     if (sleeping) {
         if (creatures_list[creature_id].sleep_counter == 0) {
@@ -107,22 +133,47 @@ void monsterPlaceWinning() {
     monster.pos.x = coord.x;
     monster.creature_id = (uint16_t) creature_id;
 
-    if ((creatures_list[creature_id].defenses & config::monsters::defense::CD_MAX_HP) != 0) {
-        monster.hp = (int16_t) maxDiceRoll(creatures_list[creature_id].hit_die);
-    } else {
-        monster.hp = (int16_t) diceRoll(creatures_list[creature_id].hit_die);
-    }
+    monster.hp = monsterRollHitPoints(creature_id);
 
     // the creatures_list speed value is 10 greater, so that it can be a uint8_t
     monster.speed = (int16_t)(creatures_list[creature_id].speed - 10 + py.flags.speed);
     monster.stunned_amount = 0;
-    monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, coord);
+    monster.distance_from_player = monsterDistanceToPlayer(coord);
 
     dg.floor[coord.y][coord.x].creature_id = (uint8_t) monster_id;
+    monsterIndexAdd(monster_id);
 
     monster.sleep_count = 0;
 }
 
+// The odds of the level picked by monsterGetOneSuitableForLevel(), when
+// not a nasty one. `monster_levels` is the same on every thread, so the
+// tables are shared and only built once.
+static AliasTable_t monster_selection_tables[MON_MAX_LEVELS + 1];
+
+void monsterBuildSelectionTables() {
+    static std::once_flag tables_built;
+
+    std::call_once(tables_built, [] {
+        for (int level = 1; level <= MON_MAX_LEVELS; level++) {
+            std::vector<int16_t> values;
+            std::vector<double> weights(MON_MAX_LEVELS + 1, 0);
+
+            for (int i = 0; i <= MON_MAX_LEVELS; i++) {
+                values.push_back((int16_t) i);
+            }
+
+            // Chance of the higher of two monsters being each one
+            int num = monster_levels[level] - monster_levels[0];
+            for (int i = 0; i < num; i++) {
+                weights[creatures_list[i + monster_levels[0]].level] += (double) (i + 1) * (i + 1) - (double) i * i;
+            }
+
+            aliasTableBuild(monster_selection_tables[level], values, weights);
+        }
+    });
+}
+
 // Return a monster suitable to be placed at a given level. This
 // makes high level monsters (up to the given level) slightly more
 // common than low level monsters at any given level. -CJS-
@@ -141,6 +192,8 @@ static int monsterGetOneSuitableForLevel(int level) {
         if (level > MON_MAX_LEVELS) {
             level = MON_MAX_LEVELS;
         }
+    } else if (getSelectionMode() == SelectionMode::Tables) {
+        level = aliasTableDraw(monster_selection_tables[level]);
     } else {
         // This code has been added to make it slightly more likely to get
         // the higher level monsters. Originally a uniform distribution over
@@ -283,3 +336,116 @@ bool compactMonsters() {
 
     return true;
 }
+
+// Spatial index of the monsters on the level. The dungeon is split into
+// buckets the size of half a screen panel, each holding a bit set of the
+// monster ids standing in it, so area queries only look at the monsters
+// in the buckets overlapping the area instead of the whole monsters[] list.
+constexpr int MONSTER_BUCKET_HEIGHT = SCREEN_HEIGHT / 2;
+constexpr int MONSTER_BUCKET_WIDTH = SCREEN_WIDTH / 2;
+constexpr int MONSTER_BUCKET_WORDS = (MON_TOTAL_ALLOCATIONS + 63) / 64;
+
+static thread_local std::vector<uint64_t> monster_buckets;
+static thread_local int monster_bucket_rows = 0;
+static thread_local int monster_bucket_cols = 0;
+
+static uint64_t *monsterBucketAt(int row, int col) {
+    return &monster_buckets[((size_t) row * monster_bucket_cols + col) * MONSTER_BUCKET_WORDS];
+}
+
+static uint64_t *monsterIndexBucket(Coord_t const &coord) {
+    if (coord.y < 0 || coord.y >= monster_bucket_rows * MONSTER_BUCKET_HEIGHT || coord.x < 0 || coord.x >= monster_bucket_cols * MONSTER_BUCKET_WIDTH) {
+        return nullptr;
+    }
+
+    return monsterBucketAt(coord.y / MONSTER_BUCKET_HEIGHT, coord.x / MONSTER_BUCKET_WIDTH);
+}
+
+// Empties the index, sizing it for the current floor.
+void monsterIndexReset() {
+    monster_changes++;
+
+    monster_bucket_rows = (dg.floor.rows + MONSTER_BUCKET_HEIGHT - 1) / MONSTER_BUCKET_HEIGHT;
+    monster_bucket_cols = (dg.floor.columns + MONSTER_BUCKET_WIDTH - 1) / MONSTER_BUCKET_WIDTH;
+    monster_buckets.assign((size_t) monster_bucket_rows * monster_bucket_cols * MONSTER_BUCKET_WORDS, 0);
+}
+
+// Must be called whenever a monster gets a position on the level.
+void monsterIndexAdd(int monster_id) {
+    monster_changes++;
+
+    uint64_t *bucket = monsterIndexBucket(monsters[monster_id].pos);
+
+    if (bucket != nullptr) {
+        bucket[monster_id / 64] |= (uint64_t) 1 << (monster_id % 64);
+    }
+}
+
+// Must be called before the monster is removed from the monsters[] list.
+void monsterIndexRemove(int monster_id) {
+    monster_changes++;
+
+    uint64_t *bucket = monsterIndexBucket(monsters[monster_id].pos);
+
+    if (bucket != nullptr) {
+        bucket[monster_id / 64] &= ~((uint64_t) 1 << (monster_id % 64));
+    }
+}
+
+void monsterIndexMove(int monster_id, Coord_t const &from, Coord_t const &to) {
+    monster_changes++;
+
+    uint64_t *old_bucket = monsterIndexBucket(from);
+    uint64_t *new_bucket = monsterIndexBucket(to);
+
+    if (old_bucket == new_bucket) {
+        return;
+    }
+
+    uint64_t bit = (uint64_t) 1 << (monster_id % 64);
+
+    if (old_bucket != nullptr) {
+        old_bucket[monster_id / 64] &= ~bit;
+    }
+    if (new_bucket != nullptr) {
+        new_bucket[monster_id / 64] |= bit;
+    }
+}
+
+// Fills `ids` with the monsters that may be inside the given area, the
+// caller still has to check each monster's position. The ids are given
+// highest first, the same order the monsters[] list is normally scanned in,
+// so that callers deleting or adding monsters behave exactly as before.
+int monstersWithinArea(Coord_t const &top_left, Coord_t const &bottom_right, uint8_t *ids) {
+    int top = std::max(top_left.y, 0) / MONSTER_BUCKET_HEIGHT;
+    int left = std::max(top_left.x, 0) / MONSTER_BUCKET_WIDTH;
+    int bottom = std::min(bottom_right.y / MONSTER_BUCKET_HEIGHT, monster_bucket_rows - 1);
+    int right = std::min(bottom_right.x / MONSTER_BUCKET_WIDTH, monster_bucket_cols - 1);
+
+    uint64_t found[MONSTER_BUCKET_WORDS] = {0};
+
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            uint64_t const *bucket = monsterBucketAt(y, x);
+
+            for (int word = 0; word < MONSTER_BUCKET_WORDS; word++) {
+                found[word] |= bucket[word];
+            }
+        }
+    }
+
+    int count = 0;
+
+    for (int word = MONSTER_BUCKET_WORDS - 1; word >= 0; word--) {
+        for (int bit = 63; found[word] != 0; bit--) {
+            uint64_t mask = (uint64_t) 1 << bit;
+
+            if ((found[word] & mask) != 0u) {
+                found[word] &= ~mask;
+                ids[count++] = (uint8_t) (word * 64 + bit);
+            }
+        }
+    }
+
+    return count;
+}
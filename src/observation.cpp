@@ -0,0 +1,174 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Observations of the game for bots, and the commands they give back
+
+#include "headers.h"
+
+// Whoever gives this thread's player commands, if not the keyboard
+static thread_local bool (*command_source)(ObservationCommand_t &command) = nullptr;
+
+// The message lines printed as of the last observation
+static thread_local uint32_t last_observed_messages = 0;
+
+static void observePlayer(ObservedPlayer_t &player) {
+    player.game_turn = dg.game_turn;
+    player.dungeon_level = dg.current_level;
+    player.y = (int16_t) py.pos.y;
+    player.x = (int16_t) py.pos.x;
+    player.race_id = py.misc.race_id;
+    player.class_id = py.misc.class_id;
+    player.level = py.misc.level;
+    player.exp = py.misc.exp;
+    player.max_exp = py.misc.max_exp;
+    player.au = py.misc.au;
+    player.current_hp = py.misc.current_hp;
+    player.max_hp = py.misc.max_hp;
+    player.current_mana = py.misc.current_mana;
+    player.mana = py.misc.mana;
+    player.ac = (int16_t) (py.misc.display_ac + py.misc.display_to_ac);
+
+    for (int i = 0; i < 6; i++) {
+        player.stats[i] = py.stats.used[i];
+    }
+
+    player.status = py.flags.status;
+    player.food = py.flags.food;
+    player.speed = py.flags.speed;
+    player.blind = py.flags.blind;
+    player.confused = py.flags.confused;
+    player.afraid = py.flags.afraid;
+    player.poisoned = py.flags.poisoned;
+    player.paralysis = py.flags.paralysis;
+    player.image = py.flags.image;
+    player.equipment_count = (uint8_t) py.equipment_count;
+    player.inventory_count = (uint8_t) py.pack.unique_items;
+}
+
+// Only what the player could read off the item's description
+static void observeItem(Inventory_t const &item, ObservedItem_t &observed) {
+    if (item.category_id == TV_NOTHING) {
+        return;
+    }
+
+    observed.category_id = item.category_id;
+    observed.items_count = item.items_count;
+    observed.weight = item.weight;
+    observed.kind_known = itemSetColorlessAsIdentified(item.category_id, item.sub_category_id, item.identification);
+    observed.identified = spellItemIdentified(item);
+
+    if (observed.kind_known) {
+        observed.object_id = item.id;
+        observed.sub_category_id = item.sub_category_id;
+        observed.ac = item.ac;
+        observed.damage_dice = item.damage.dice;
+        observed.damage_sides = item.damage.sides;
+    }
+
+    if (observed.identified) {
+        observed.misc_use = item.misc_use;
+        observed.to_hit = item.to_hit;
+        observed.to_damage = item.to_damage;
+        observed.to_ac = item.to_ac;
+    }
+}
+
+// The monsters in sight, the nearest first
+static void observeMonsters(ObservationHeader_t &header) {
+    std::vector<Monster_t const *> seen;
+
+    for (int id = config::monsters::MON_MIN_INDEX_ID; id < next_free_monster_id; id++) {
+        if (monsters[id].lit && monsters[id].creature_id != 0) {
+            seen.push_back(&monsters[id]);
+        }
+    }
+
+    std::stable_sort(seen.begin(), seen.end(), [](Monster_t const *a, Monster_t const *b) { return a->distance_from_player < b->distance_from_player; });
+
+    header.monster_count = (uint16_t) std::min((int) seen.size(), OBSERVATION_MONSTERS);
+
+    for (int i = 0; i < header.monster_count; i++) {
+        ObservedMonster_t &observed = header.monsters[i];
+        observed.creature_id = seen[i]->creature_id;
+        observed.y = (int16_t) seen[i]->pos.y;
+        observed.x = (int16_t) seen[i]->pos.x;
+        observed.distance = seen[i]->distance_from_player;
+    }
+}
+
+static void observeMessages(ObservationHeader_t &header) {
+    uint32_t new_lines = message_lines_printed - last_observed_messages;
+    last_observed_messages = message_lines_printed;
+
+    header.new_messages = (uint16_t) std::min(new_lines, (uint32_t) OBSERVATION_MESSAGES);
+
+    int id = last_message_id;
+    for (auto &message : header.messages) {
+        (void) strncpy(message, messages[id], MORIA_MESSAGE_SIZE - 1);
+
+        id = id == 0 ? MESSAGE_HISTORY_SIZE - 1 : id - 1;
+    }
+}
+
+// Fills `buffer` with what the player can see of the game as it
+// is now, a header and the map, see observation.h for the layout.
+void observationBuild(std::vector<uint8_t> &buffer) {
+    // Zeroed as a whole, padding and all, so equal observations are equal bytes
+    std::vector<uint8_t> header_bytes(sizeof(ObservationHeader_t), 0);
+    auto &header = *reinterpret_cast<ObservationHeader_t *>(header_bytes.data());
+
+    observePlayer(header.player);
+
+    for (int i = 0; i < PLAYER_INVENTORY_SIZE; i++) {
+        observeItem(py.inventory[i], header.inventory[i]);
+    }
+
+    observeMonsters(header);
+    observeMessages(header);
+
+    header.map_rows = (int16_t) dg.height;
+    header.map_columns = (int16_t) dg.width;
+
+    size_t map_size = (size_t) dg.height * dg.width;
+    header.size = (uint32_t) (sizeof(ObservationHeader_t) + map_size);
+
+    buffer.resize(header.size);
+    memcpy(buffer.data(), header_bytes.data(), sizeof(ObservationHeader_t));
+
+    uint8_t *map = buffer.data() + sizeof(ObservationHeader_t);
+    for (int y = 0; y < dg.height; y++) {
+        for (int x = 0; x < dg.width; x++) {
+            *map++ = (uint8_t) caveGetSteadyTileSymbol(Coord_t{y, x});
+        }
+    }
+}
+
+// Has the player's commands taken from `source` rather than the keyboard,
+// for as long as it returns true, nullptr giving them back to the keyboard.
+void observationSetCommandSource(bool (*source)(ObservationCommand_t &command)) {
+    command_source = source;
+}
+
+// The next command of the command source, if it has one
+bool observationNextCommand(ObservationCommand_t &command) {
+    if (command_source == nullptr) {
+        return false;
+    }
+
+    command = ObservationCommand_t{};
+    if (!command_source(command)) {
+        return false;
+    }
+
+    // Saving (^X) exits the program, ending every game of a batch at once,
+    // so a game sharing its process takes it as doing nothing instead.
+    // Quitting (Q) ends only this game, as the character dies.
+    if (command.command == CTRL_KEY('X') && !terminalMayExitProgram()) {
+        command = ObservationCommand_t{};
+        command.command = ' ';
+    }
+
+    return true;
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+// Observations: what the player can see of the game, as flat binary data
+// for bots, rather than text to scrape off the screen. Commands can be given
+// the same way, with observationSetCommandSource().
+//
+// An observation is an ObservationHeader_t, then the map of the level,
+// `map_rows` by `map_columns` symbols row by row, as the screen would draw
+// them, with ' ' where nothing is known. Everything is in the byte order
+// of the machine, and within an observation, padding bytes are zero.
+
+constexpr int OBSERVATION_MONSTERS = 64; // At most, the nearest are kept
+constexpr int OBSERVATION_MESSAGES = MESSAGE_HISTORY_SIZE;
+constexpr int OBSERVATION_COMMAND_ARGUMENTS = 16;
+
+typedef struct {
+    int32_t game_turn;
+    int16_t dungeon_level;
+    int16_t y;
+    int16_t x;
+    uint8_t race_id;
+    uint8_t class_id;
+    uint16_t level;
+    int32_t exp;
+    int32_t max_exp;
+    int32_t au;
+    int16_t current_hp;
+    int16_t max_hp;
+    int16_t current_mana;
+    int16_t mana;
+    int16_t ac;          // As shown, the magical bonus included
+    uint8_t stats[6];    // In use, STR INT WIS DEX CON CHR
+    uint32_t status;     // config::player::status flags
+    int16_t food;
+    int16_t speed;       // Below zero is faster
+    int16_t blind;       // The timed effects, turns left
+    int16_t confused;
+    int16_t afraid;
+    int16_t poisoned;
+    int16_t paralysis;
+    int16_t image;       // Hallucinating, which the map does not show
+    uint8_t equipment_count;
+    uint8_t inventory_count;
+} ObservedPlayer_t;
+
+// An item of the pack or equipment. What the player doesn't know yet reads
+// zero: the object and sub category until its kind is known, the bonuses
+// until the item is identified.
+typedef struct {
+    uint16_t object_id;    // Into game_objects, 0 for nothing
+    uint8_t category_id;
+    uint8_t sub_category_id;
+    uint8_t items_count;
+    bool kind_known;
+    bool identified;
+    uint16_t weight;
+    int16_t misc_use;
+    int16_t to_hit;
+    int16_t to_damage;
+    int16_t ac;
+    int16_t to_ac;
+    uint8_t damage_dice;
+    uint8_t damage_sides;
+} ObservedItem_t;
+
+// A monster the player can see
+typedef struct {
+    uint16_t creature_id; // Into creatures_list
+    int16_t y;
+    int16_t x;
+    uint8_t distance;
+} ObservedMonster_t;
+
+typedef struct {
+    uint32_t size; // Of the whole observation, the map included
+    ObservedPlayer_t player;
+    ObservedItem_t inventory[PLAYER_INVENTORY_SIZE]; // As py.inventory, the equipment from PlayerEquipment::Wield
+    uint16_t monster_count;
+    ObservedMonster_t monsters[OBSERVATION_MONSTERS];
+    uint16_t new_messages; // Message lines printed since the last observation
+    char messages[OBSERVATION_MESSAGES][MORIA_MESSAGE_SIZE]; // The newest first
+    int16_t map_rows;
+    int16_t map_columns;
+} ObservationHeader_t;
+
+void observationBuild(std::vector<uint8_t> &buffer);
+
+// A command for the player, as a bot gives it: `command` is a key of the
+// roguelike keyset (as doCommand() takes them, whatever the keyset in use),
+// repeated `count` times (0 for once), and `arguments` are the keys read by
+// its prompts, e.g. a direction or an item letter.
+typedef struct {
+    char command;
+    int16_t count;
+    char arguments[OBSERVATION_COMMAND_ARGUMENTS]; // '\0' ended, when shorter
+} ObservationCommand_t;
+
+void observationSetCommandSource(bool (*source)(ObservationCommand_t &command));
+bool observationNextCommand(ObservationCommand_t &command);
+
+// A batch of games for bots to play in lockstep, each on its own thread, as
+// all the game state is thread_local. Every step, each game still being
+// played takes its command, plays until it next asks for one, and leaves
+// its observation. Games are played with the options `setup` (when given)
+// sets, on the game's own thread.
+class ObservationBatch_t;
+
+ObservationBatch_t *observationBatchStart(int count, uint32_t first_seed, void (*setup)());
+void observationBatchStep(ObservationBatch_t &batch, ObservationCommand_t const *commands);
+int observationBatchSize(ObservationBatch_t const &batch);
+std::vector<uint8_t> const &observationBatchObservation(ObservationBatch_t const &batch, int game);
+bool observationBatchGameOver(ObservationBatch_t const &batch, int game);
+bool observationBatchRestart(ObservationBatch_t &batch, int game, uint32_t seed);
+void observationBatchEnd(ObservationBatch_t *batch);
@@ -0,0 +1,220 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Batches of games, stepped in lockstep by bots
+
+#include "headers.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef struct {
+    uint32_t seed;
+    std::thread thread;
+    std::vector<uint8_t> observation;
+    ObservationCommand_t command;
+    uint64_t step; // Of the batch, when the game last took a command
+    bool game_over;
+} BatchGame_t;
+
+class ObservationBatch_t {
+  public:
+    explicit ObservationBatch_t(int count) : games((size_t) count) {}
+
+    // The games are played on threads of their own, holding pointers
+    // to them, so the vector is never resized.
+    std::vector<BatchGame_t> games;
+    void (*setup)() = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable commands_given;
+    std::condition_variable observations_left;
+
+    uint64_t step = 0;
+    int games_stepping = 0;          // Those yet to leave their observation
+    std::atomic<bool> ending{false}; // Also read by the key sources
+};
+
+// Character creation: Human, male, accept stats, a class chosen by the
+// seed, name, then continue past the "press any key" prompt.
+static const char *character_creation_keys = "am\033?Bot\r ";
+constexpr int CLASS_KEY_POSITION = 3;
+
+// A prompt reading more keys than the command came with is escaped out of,
+// unless it keeps asking, e.g. stuck in a prompt loop, when the game ends.
+constexpr int MAX_KEYS_WITHOUT_COMMAND = 1000;
+
+// Per game state, on the game's thread
+static thread_local ObservationBatch_t *this_batch = nullptr;
+static thread_local BatchGame_t *this_game = nullptr;
+static thread_local char creation_keys[32];
+static thread_local const char *pending_keys = nullptr;
+static thread_local int keys_without_command = 0;
+
+// Leaves this game's step done, waking the stepping thread once all are
+static void batchGameStepped(ObservationBatch_t &batch) {
+    if (--batch.games_stepping == 0) {
+        batch.observations_left.notify_all();
+    }
+}
+
+static int batchKeySource() {
+    if (*pending_keys != '\0') {
+        return *pending_keys++;
+    }
+
+    if (this_batch->ending || ++keys_without_command > MAX_KEYS_WITHOUT_COMMAND) {
+        return EOF;
+    }
+    return ESCAPE;
+}
+
+// Leaves the observation, then waits for the next step's command. When the
+// batch ends instead, the key source ends the game.
+static bool batchCommandSource(ObservationCommand_t &command) {
+    observationBuild(this_game->observation);
+
+    ObservationBatch_t &batch = *this_batch;
+    std::unique_lock<std::mutex> lock(batch.mutex);
+
+    batchGameStepped(batch);
+    batch.commands_given.wait(lock, [&batch]() { return batch.ending || batch.step != this_game->step; });
+
+    if (batch.ending) {
+        return false;
+    }
+
+    this_game->step = batch.step;
+    command = this_game->command;
+    keys_without_command = 0;
+
+    return true;
+}
+
+static void batchPlayGame(ObservationBatch_t *batch, BatchGame_t *slot) {
+    this_batch = batch;
+    this_game = slot;
+
+    (void) strcpy(creation_keys, character_creation_keys);
+    creation_keys[CLASS_KEY_POSITION] = (char) ('a' + slot->seed % PLAYER_MAX_CLASSES);
+    pending_keys = creation_keys;
+
+    (void) terminalInitializeHeadless(batchKeySource);
+    observationSetCommandSource(batchCommandSource);
+
+    if (batch->setup != nullptr) {
+        batch->setup();
+    }
+
+    simulateMoria(slot->seed);
+
+    observationBuild(slot->observation);
+
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    slot->game_over = true;
+    batchGameStepped(*batch);
+}
+
+// Starts a game from `seed` in the batch's slot `id`, the batch locked
+static void batchGameStart(ObservationBatch_t &batch, int id, uint32_t seed) {
+    BatchGame_t &slot = batch.games[id];
+
+    slot.seed = seed;
+    slot.observation.clear();
+    slot.command = ObservationCommand_t{};
+    slot.step = batch.step;
+    slot.game_over = false;
+
+    batch.games_stepping++;
+    slot.thread = std::thread(batchPlayGame, &batch, &slot);
+}
+
+// Starts `count` games, from consecutive seeds, returning once
+// each has its first observation, ready to be stepped.
+ObservationBatch_t *observationBatchStart(int count, uint32_t first_seed, void (*setup)()) {
+    auto *batch = new ObservationBatch_t(count);
+    batch->setup = setup;
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+
+    for (int id = 0; id < count; id++) {
+        batchGameStart(*batch, id, first_seed + id);
+    }
+    batch->observations_left.wait(lock, [batch]() { return batch->games_stepping == 0; });
+
+    return batch;
+}
+
+// Gives each game not yet over its command of `commands`, one per
+// game, returning once all of them have left their next observation.
+void observationBatchStep(ObservationBatch_t &batch, ObservationCommand_t const *commands) {
+    std::unique_lock<std::mutex> lock(batch.mutex);
+
+    for (size_t id = 0; id < batch.games.size(); id++) {
+        if (!batch.games[id].game_over) {
+            batch.games[id].command = commands[id];
+            batch.games_stepping++;
+        }
+    }
+
+    if (batch.games_stepping == 0) {
+        return;
+    }
+
+    batch.step++;
+    batch.commands_given.notify_all();
+
+    batch.observations_left.wait(lock, [&batch]() { return batch.games_stepping == 0; });
+}
+
+int observationBatchSize(ObservationBatch_t const &batch) {
+    return (int) batch.games.size();
+}
+
+// The game's latest observation, see observationBuild()
+std::vector<uint8_t> const &observationBatchObservation(ObservationBatch_t const &batch, int game) {
+    return batch.games[game].observation;
+}
+
+// Whether the character died or the game gave up, its observation being the last
+bool observationBatchGameOver(ObservationBatch_t const &batch, int game) {
+    return batch.games[game].game_over;
+}
+
+// Starts a new game from `seed` in place of one that is over, returning
+// once it has its first observation. Games still being played are left be.
+bool observationBatchRestart(ObservationBatch_t &batch, int game, uint32_t seed) {
+    if (!batch.games[game].game_over) {
+        return false;
+    }
+
+    batch.games[game].thread.join();
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+
+    batchGameStart(batch, game, seed);
+    batch.observations_left.wait(lock, [&batch]() { return batch.games_stepping == 0; });
+
+    return true;
+}
+
+// Ends the games still being played, and frees the batch
+void observationBatchEnd(ObservationBatch_t *batch) {
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        batch->ending = true;
+    }
+    batch->commands_given.notify_all();
+
+    for (auto &slot : batch->games) {
+        if (slot.thread.joinable()) {
+            slot.thread.join();
+        }
+    }
+
+    delete batch;
+}
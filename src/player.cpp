@@ -7,8 +7,10 @@
 
 #include "headers.h"
 
+#include <mutex>
+
 // Player record for most player related info
-Player_t py = Player_t{};
+thread_local Player_t py = Player_t{};
 
 static void playerResetFlags() {
     py.flags.see_invisible = false;
@@ -259,78 +261,79 @@ void playerDiedFromString(vtype_t *description, const char *monster_name, uint32
     }
 }
 
-bool playerTestAttackHits(int attack_id, uint8_t level) {
+// Whether a creature's attack of `attack_id` hits, rolled with `test`
+static bool playerAttackHits(int attack_id, uint8_t level, bool (*test)(int base_to_hit, int level, int plus_to_hit, int armor_class, int attack_type_id)) {
     bool success = false;
 
     switch (attack_id) {
         case 1: // Normal attack
-            if (playerTestBeingHit(60, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(60, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 2: // Lose Strength
-            if (playerTestBeingHit(-3, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(-3, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 3: // Confusion attack
         case 4: // Fear attack
         case 5: // Fire attack
-            if (playerTestBeingHit(10, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(10, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 6: // Acid attack
-            if (playerTestBeingHit(0, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(0, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 7: // Cold attack
         case 8: // Lightning attack
-            if (playerTestBeingHit(10, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(10, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 9: // Corrosion attack
-            if (playerTestBeingHit(0, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(0, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 10: // Blindness attack
         case 11: // Paralysis attack
-            if (playerTestBeingHit(2, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(2, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 12: // Steal Money
-            if (playerTestBeingHit(5, (int) level, 0, (int) py.misc.level, CLASS_MISC_HIT) && py.misc.au > 0) {
+            if (test(5, (int) level, 0, (int) py.misc.level, CLASS_MISC_HIT) && py.misc.au > 0) {
                 success = true;
             }
             break;
         case 13: // Steal Object
-            if (playerTestBeingHit(2, (int) level, 0, (int) py.misc.level, CLASS_MISC_HIT) && py.pack.unique_items > 0) {
+            if (test(2, (int) level, 0, (int) py.misc.level, CLASS_MISC_HIT) && py.pack.unique_items > 0) {
                 success = true;
             }
             break;
         case 14: // Poison
-            if (playerTestBeingHit(5, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(5, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 15: // Lose dexterity
         case 16: // Lose constitution
-            if (playerTestBeingHit(0, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(0, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 17: // Lose intelligence
         case 18: // Lose wisdom
-            if (playerTestBeingHit(2, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(2, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 19: // Lose experience
-            if (playerTestBeingHit(5, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(5, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
@@ -338,19 +341,19 @@ bool playerTestAttackHits(int attack_id, uint8_t level) {
             success = true;
             break;
         case 21: // Disenchant
-            if (playerTestBeingHit(20, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(20, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 22: // Eat food
         case 23: // Eat light
-            if (playerTestBeingHit(5, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
+            if (test(5, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT)) {
                 success = true;
             }
             break;
         case 24: // Eat charges
             // check to make sure an object exists
-            if (playerTestBeingHit(15, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT) && py.pack.unique_items > 0) {
+            if (test(15, (int) level, 0, py.misc.ac + py.misc.magical_ac, CLASS_MISC_HIT) && py.pack.unique_items > 0) {
                 success = true;
             }
             break;
@@ -364,6 +367,15 @@ bool playerTestAttackHits(int attack_id, uint8_t level) {
     return success;
 }
 
+bool playerTestAttackHits(int attack_id, uint8_t level) {
+    return playerAttackHits(attack_id, level, playerTestBeingHit);
+}
+
+// As playerTestAttackHits(), without disturbing the player
+bool playerRollAttackHits(int attack_id, uint8_t level) {
+    return playerAttackHits(attack_id, level, playerRollToHit);
+}
+
 // Changes speed of monsters relative to player -RAK-
 // Note: When the player is sped up or slowed down, I simply change
 // the speed of all the monsters. This greatly simplified the logic.
@@ -421,67 +433,61 @@ void playerAdjustBonusesForItem(Inventory_t const &item, int factor) {
     }
 }
 
-static void playerRecalculateBonusesFromInventory() {
+// What the worn and wielded items add up to
+typedef struct {
+    int plusses_to_hit;
+    int plusses_to_damage;
+    int magical_ac;
+    int ac;
+    int display_to_hit;
+    int display_to_damage;
+    int display_to_ac;
+    int display_ac;
+    uint32_t flags;           // All the item flags, OR'ed together
+    uint8_t sustained_stats;  // Bit misc_use - 1 of each sustain item: str, int, wis, con, dex, chr
+} EquipmentBonuses_t;
+
+// Gathers the bonuses, flags and sustains of the equipment in a single pass
+static void playerEquipmentBonuses(EquipmentBonuses_t &bonuses) {
+    bonuses = EquipmentBonuses_t{};
+
     for (int i = PlayerEquipment::Wield; i < PlayerEquipment::Light; i++) {
         Inventory_t const &item = py.inventory[i];
 
-        if (item.category_id != TV_NOTHING) {
-            py.misc.plusses_to_hit += item.to_hit;
-
-            // Bows can't damage. -CJS-
-            if (item.category_id != TV_BOW) {
-                py.misc.plusses_to_damage += item.to_damage;
-            }
+        bonuses.flags |= item.flags;
 
-            py.misc.magical_ac += item.to_ac;
-            py.misc.ac += item.ac;
+        if ((item.flags & config::treasure::flags::TR_SUST_STAT) != 0u && item.misc_use >= 1 && item.misc_use <= 6) {
+            bonuses.sustained_stats |= (uint8_t)(1 << (item.misc_use - 1));
+        }
 
-            if (spellItemIdentified(item)) {
-                py.misc.display_to_hit += item.to_hit;
+        if (item.category_id == TV_NOTHING) {
+            continue;
+        }
 
-                // Bows can't damage. -CJS-
-                if (item.category_id != TV_BOW) {
-                    py.misc.display_to_damage += item.to_damage;
-                }
+        bonuses.plusses_to_hit += item.to_hit;
 
-                py.misc.display_to_ac += item.to_ac;
-                py.misc.display_ac += item.ac;
-            } else if (!inventoryItemIsCursed(item)) {
-                // Base AC values should always be visible,
-                // as long as the item is not cursed.
-                py.misc.display_ac += item.ac;
-            }
+        // Bows can't damage. -CJS-
+        if (item.category_id != TV_BOW) {
+            bonuses.plusses_to_damage += item.to_damage;
         }
-    }
-}
 
-static void playerRecalculateSustainStatsFromInventory() {
-    for (int i = PlayerEquipment::Wield; i < PlayerEquipment::Light; i++) {
-        if ((py.inventory[i].flags & config::treasure::flags::TR_SUST_STAT) == 0u) {
-            continue;
-        }
+        bonuses.magical_ac += item.to_ac;
+        bonuses.ac += item.ac;
+
+        if (spellItemIdentified(item)) {
+            bonuses.display_to_hit += item.to_hit;
+
+            // Bows can't damage. -CJS-
+            if (item.category_id != TV_BOW) {
+                bonuses.display_to_damage += item.to_damage;
+            }
 
-        switch (py.inventory[i].misc_use) {
-            case 1:
-                py.flags.sustain_str = true;
-                break;
-            case 2:
-                py.flags.sustain_int = true;
-                break;
-            case 3:
-                py.flags.sustain_wis = true;
-                break;
-            case 4:
-                py.flags.sustain_con = true;
-                break;
-            case 5:
-                py.flags.sustain_dex = true;
-                break;
-            case 6:
-                py.flags.sustain_chr = true;
-                break;
-            default:
-                break;
+            bonuses.display_to_ac += item.to_ac;
+            bonuses.display_ac += item.ac;
+        } else if (!inventoryItemIsCursed(item)) {
+            // Base AC values should always be visible,
+            // as long as the item is not cursed.
+            bonuses.display_ac += item.ac;
         }
     }
 }
@@ -498,6 +504,9 @@ void playerRecalculateBonuses() {
 
     int saved_display_ac = py.misc.display_ac;
 
+    EquipmentBonuses_t bonuses;
+    playerEquipmentBonuses(bonuses);
+
     playerResetFlags();
 
     // Real values
@@ -512,7 +521,15 @@ void playerRecalculateBonuses() {
     py.misc.display_ac = 0;
     py.misc.display_to_ac = py.misc.magical_ac;
 
-    playerRecalculateBonusesFromInventory();
+    py.misc.plusses_to_hit += bonuses.plusses_to_hit;
+    py.misc.plusses_to_damage += bonuses.plusses_to_damage;
+    py.misc.magical_ac += bonuses.magical_ac;
+    py.misc.ac += bonuses.ac;
+
+    py.misc.display_to_hit += bonuses.display_to_hit;
+    py.misc.display_to_damage += bonuses.display_to_damage;
+    py.misc.display_to_ac += bonuses.display_to_ac;
+    py.misc.display_ac += bonuses.display_ac;
 
     py.misc.display_ac += py.misc.display_to_ac;
 
@@ -540,7 +557,7 @@ void playerRecalculateBonuses() {
         py.flags.status |= config::player::status::PY_ARMOR;
     }
 
-    uint32_t item_flags = inventoryCollectAllItemFlags();
+    uint32_t item_flags = bonuses.flags;
 
     if ((item_flags & config::treasure::flags::TR_SLOW_DIGEST) != 0u) {
         py.flags.slow_digest = true;
@@ -576,7 +593,12 @@ void playerRecalculateBonuses() {
         py.flags.free_fall = true;
     }
 
-    playerRecalculateSustainStatsFromInventory();
+    py.flags.sustain_str = (bonuses.sustained_stats & 0x01) != 0;
+    py.flags.sustain_int = (bonuses.sustained_stats & 0x02) != 0;
+    py.flags.sustain_wis = (bonuses.sustained_stats & 0x04) != 0;
+    py.flags.sustain_con = (bonuses.sustained_stats & 0x08) != 0;
+    py.flags.sustain_dex = (bonuses.sustained_stats & 0x10) != 0;
+    py.flags.sustain_chr = (bonuses.sustained_stats & 0x20) != 0;
 
     // Reset food_digested values
     if (py.flags.slow_digest) {
@@ -628,6 +650,11 @@ void playerTakeOff(int item_id, int pack_position_id) {
 bool playerTestBeingHit(int base_to_hit, int level, int plus_to_hit, int armor_class, int attack_type_id) {
     playerDisturb(1, 0);
 
+    return playerRollToHit(base_to_hit, level, plus_to_hit, armor_class, attack_type_id);
+}
+
+// The roll of playerTestBeingHit(), with nothing else done
+bool playerRollToHit(int base_to_hit, int level, int plus_to_hit, int armor_class, int attack_type_id) {
     // `plus_to_hit` could be less than 0 if player wielding weapon too heavy for them
     int hit_chance = base_to_hit + plus_to_hit * BTH_PER_PLUS_TO_HIT_ADJUST + (level * class_level_adj[py.misc.class_id][attack_type_id]);
 
@@ -656,6 +683,8 @@ void playerTakesHit(int damage, const char *creature_name_label) {
         (void) strcpy(game.character_died_from, creature_name_label);
 
         game.total_winner = false;
+
+        TELEMETRY_EVENT(Death, damage, 0, creature_name_label);
     }
 
     dg.generate_new_level = true;
@@ -847,9 +876,6 @@ void playerGainSpells() {
     int new_spells = py.flags.new_spells_to_learn;
     int diff_spells = 0;
 
-    // TODO(cook) move access to `magic_spells[]` directly to the for loop it's used in, below?
-    Spell_t *spells = &magic_spells[py.misc.class_id - 1][0];
-
     int stat, offset;
 
     // Priests don't need light because they get spells from their god, so only
@@ -887,21 +913,15 @@ void playerGainSpells() {
         spell_flag = 0x7FFFFFFF;
     }
 
-    // clear bits for spells already learned
-    spell_flag &= ~py.flags.spells_learnt;
+    // clear bits for spells already learned, and those of a higher level
+    spell_flag &= ~py.flags.spells_learnt & playerSpellsUpToLevel(py.misc.level);
 
     int spell_id = 0;
     int spell_bank[31];
-    uint32_t mask = 0x1;
-
-    for (int i = 0; spell_flag != 0u; mask <<= 1, i++) {
-        if ((spell_flag & mask) != 0u) {
-            spell_flag &= ~mask;
-            if (spells[i].level_required <= py.misc.level) {
-                spell_bank[spell_id] = i;
-                spell_id++;
-            }
-        }
+
+    while (spell_flag != 0u) {
+        spell_bank[spell_id] = getAndClearFirstBit(spell_flag);
+        spell_id++;
     }
 
     if (new_spells > spell_id) {
@@ -1037,9 +1057,39 @@ void playerGainMana(int stat) {
     }
 }
 
+static void playerPrintCriticalBlow(int multiplier) {
+    switch (multiplier) {
+        case 2:
+            printMessage("It was a good hit! (x2 damage)");
+            break;
+        case 3:
+            printMessage("It was an excellent hit! (x3 damage)");
+            break;
+        case 4:
+            printMessage("It was a superb hit! (x4 damage)");
+            break;
+        case 5:
+            printMessage("It was a *GREAT* hit! (x5 damage)");
+            break;
+        default:
+            break;
+    }
+}
+
 // Critical hits, Nasty way to die. -RAK-
 int playerWeaponCriticalBlow(int weapon_weight, int plus_to_hit, int damage, int attack_type_id) {
-    int critical = damage;
+    int multiplier;
+    damage = playerRollCriticalBlow(weapon_weight, plus_to_hit, damage, attack_type_id, multiplier);
+
+    playerPrintCriticalBlow(multiplier);
+
+    return damage;
+}
+
+// The roll of playerWeaponCriticalBlow(), with no message printed: the damage,
+// and in `multiplier` that of the critical hit, 1 when the blow wasn't one.
+int playerRollCriticalBlow(int weapon_weight, int plus_to_hit, int damage, int attack_type_id, int &multiplier) {
+    multiplier = 1;
 
     // Weight of weapon, plusses to hit, and character level all
     // contribute to the chance of a critical
@@ -1047,21 +1097,18 @@ int playerWeaponCriticalBlow(int weapon_weight, int plus_to_hit, int damage, int
         weapon_weight += randomNumber(650);
 
         if (weapon_weight < 400) {
-            critical = 2 * damage + 5;
-            printMessage("It was a good hit! (x2 damage)");
+            multiplier = 2;
         } else if (weapon_weight < 700) {
-            critical = 3 * damage + 10;
-            printMessage("It was an excellent hit! (x3 damage)");
+            multiplier = 3;
         } else if (weapon_weight < 900) {
-            critical = 4 * damage + 15;
-            printMessage("It was a superb hit! (x4 damage)");
+            multiplier = 4;
         } else {
-            critical = 5 * damage + 20;
-            printMessage("It was a *GREAT* hit! (x5 damage)");
+            multiplier = 5;
         }
     }
 
-    return critical;
+    // x2 + 5, x3 + 10, x4 + 15 and x5 + 20
+    return multiplier == 1 ? damage : multiplier * damage + 5 * (multiplier - 1);
 }
 
 // Saving throws for player character. -RAK-
@@ -1091,9 +1138,11 @@ void playerGainKillExperience(Creature_t const &creature) {
     }
 
     py.misc.exp += quotient;
+
+    TELEMETRY_EVENT(Kill, (int32_t) (&creature - creatures_list), quotient);
 }
 
-static void playerCalculateToHitBlows(int weapon_id, int weapon_weight, int &blows, int &total_to_hit) {
+void playerCalculateToHitBlows(int weapon_id, int weapon_weight, int &blows, int &total_to_hit) {
     if (weapon_id != TV_NOTHING) {
         // Proper weapon
         blows = playerAttackBlows(weapon_weight, total_to_hit);
@@ -1111,7 +1160,7 @@ static void playerCalculateToHitBlows(int weapon_id, int weapon_weight, int &blo
     total_to_hit += py.misc.plusses_to_hit;
 }
 
-static int playerCalculateBaseToHit(bool creature_lit, int tot_tohit) {
+int playerCalculateBaseToHit(bool creature_lit, int tot_tohit) {
     if (creature_lit) {
         return py.misc.bth;
     }
@@ -1126,6 +1175,29 @@ static int playerCalculateBaseToHit(bool creature_lit, int tot_tohit) {
     return bth;
 }
 
+// The damage of a blow of the player's which hits the creature, with the
+// multiplier of any critical hit left in `critical`, see playerRollCriticalBlow().
+int playerRollBlowDamage(Inventory_t const &item, int total_to_hit, int creature_id, int &critical) {
+    int damage;
+
+    if (item.category_id != TV_NOTHING) {
+        damage = diceRoll(item.damage);
+        damage = itemMagicAbilityDamage(item, damage, creature_id);
+        damage = playerRollCriticalBlow((int) item.weight, total_to_hit, damage, PlayerClassLevelAdj::BTH, critical);
+    } else {
+        // Bare hands!?
+        damage = diceRoll(Dice_t{1, 1});
+        damage = playerRollCriticalBlow(1, 0, damage, PlayerClassLevelAdj::BTH, critical);
+    }
+
+    damage += py.misc.plusses_to_damage;
+    if (damage < 0) {
+        damage = 0;
+    }
+
+    return damage;
+}
+
 // Player attacks a (poor, defenseless) creature -RAK-
 static void playerAttackMonster(Coord_t coord) {
     int creature_id = dg.floor[coord.y][coord.x].creature_id;
@@ -1164,20 +1236,9 @@ static void playerAttackMonster(Coord_t coord) {
         (void) sprintf(msg, "You hit %s.", name);
         printMessage(msg);
 
-        if (item.category_id != TV_NOTHING) {
-            damage = diceRoll(item.damage);
-            damage = itemMagicAbilityDamage(item, damage, monster.creature_id);
-            damage = playerWeaponCriticalBlow((int) item.weight, total_to_hit, damage, PlayerClassLevelAdj::BTH);
-        } else {
-            // Bare hands!?
-            damage = diceRoll(Dice_t{1, 1});
-            damage = playerWeaponCriticalBlow(1, 0, damage, PlayerClassLevelAdj::BTH);
-        }
-
-        damage += py.misc.plusses_to_damage;
-        if (damage < 0) {
-            damage = 0;
-        }
+        int critical;
+        damage = playerRollBlowDamage(item, total_to_hit, monster.creature_id, critical);
+        playerPrintCriticalBlow(critical);
 
         if (py.flags.confuse_monster) {
             py.flags.confuse_monster = false;
@@ -1238,7 +1299,7 @@ static int16_t playerLockPickingSkill() {
 }
 
 static void openClosedDoor(Coord_t coord) {
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
     Inventory_t &item = game.treasure.list[tile.treasure_id];
 
     if (item.misc_use > 0) {
@@ -1364,7 +1425,7 @@ void playerCloseDoor() {
     Coord_t coord = py.pos;
     (void) playerMovePosition(dir, coord);
 
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
     Inventory_t &item = game.treasure.list[tile.treasure_id];
 
     bool no_object = false;
@@ -1402,15 +1463,15 @@ bool playerTunnelWall(Coord_t coord, int digging_ability, int digging_chance) {
         return false;
     }
 
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     if (tile.perma_lit_room) {
         // Should become a room space, check to see whether
         // it should be TILE_LIGHT_FLOOR or TILE_DARK_FLOOR.
         bool found = false;
 
-        for (int y = coord.y - 1; y <= coord.y + 1 && y < MAX_HEIGHT; y++) {
-            for (int x = coord.x - 1; x <= coord.x + 1 && x < MAX_WIDTH; x++) {
+        for (int y = coord.y - 1; y <= coord.y + 1 && y < dg.height; y++) {
+            for (int x = coord.x - 1; x <= coord.x + 1 && x < dg.width; x++) {
                 if (dg.floor[y][x].feature_id <= MAX_CAVE_ROOM) {
                     tile.feature_id = dg.floor[y][x].feature_id;
                     tile.permanent_light = dg.floor[y][x].permanent_light;
@@ -1452,23 +1513,51 @@ void playerAttackPosition(Coord_t coord) {
     playerAttackMonster(coord);
 }
 
+// The spells of each class a character of each level can cast: bit i is set
+// when the level is at least the one required for spell i of the class.
+// magic_spells[] is the same on every thread, so they are only built once.
+static uint32_t spell_level_masks[PLAYER_MAX_CLASSES - 1][PLAYER_MAX_LEVEL + 1];
+
+// The spells of the player's class (which must use magic) that a character
+// of this level can cast
+uint32_t playerSpellsUpToLevel(int level) {
+    static std::once_flag masks_built;
+
+    std::call_once(masks_built, [] {
+        for (int class_id = 0; class_id < PLAYER_MAX_CLASSES - 1; class_id++) {
+            for (int spell_id = 0; spell_id < 31; spell_id++) {
+                for (int at_level = magic_spells[class_id][spell_id].level_required; at_level <= PLAYER_MAX_LEVEL; at_level++) {
+                    spell_level_masks[class_id][at_level] |= 1u << spell_id;
+                }
+            }
+        }
+    });
+
+    if (level < 0) {
+        return 0;
+    }
+    return spell_level_masks[py.misc.class_id - 1][std::min(level, (int) PLAYER_MAX_LEVEL)];
+}
+
 // check to see if know any spells greater than level, eliminate them
-static void eliminateKnownSpellsGreaterThanLevel(Spell_t *msp_ptr, const char *p, int offset) {
-    uint32_t mask = 0x80000000L;
+static void eliminateKnownSpellsGreaterThanLevel(const char *p, int offset) {
+    uint32_t castable = playerSpellsUpToLevel(py.misc.level);
 
-    for (int i = 31; mask != 0u; mask >>= 1, i--) {
-        if ((mask & py.flags.spells_learnt) != 0u) {
-            if (msp_ptr[i].level_required > py.misc.level) {
-                py.flags.spells_learnt &= ~mask;
-                py.flags.spells_forgotten |= mask;
+    // From the highest known spell down, stopping at the first one still castable
+    while (py.flags.spells_learnt != 0u) {
+        int i = bitHighestSet(py.flags.spells_learnt);
+        uint32_t mask = 1u << i;
 
-                vtype_t msg = {'\0'};
-                (void) sprintf(msg, "You have forgotten the %s of %s.", p, spell_names[i + offset]);
-                printMessage(msg);
-            } else {
-                break;
-            }
+        if ((castable & mask) != 0u) {
+            break;
         }
+
+        py.flags.spells_learnt &= ~mask;
+        py.flags.spells_forgotten |= mask;
+
+        vtype_t msg = {'\0'};
+        (void) sprintf(msg, "You have forgotten the %s of %s.", p, spell_names[i + offset]);
+        printMessage(msg);
     }
 }
 
@@ -1502,20 +1591,13 @@ static int numberOfSpellsAllowed(int stat) {
 }
 
 static int numberOfSpellsKnown() {
-    int known = 0;
-
-    for (uint32_t mask = 0x1; mask != 0u; mask <<= 1) {
-        if ((mask & py.flags.spells_learnt) != 0u) {
-            known++;
-        }
-    }
-
-    return known;
+    return bitPopCount(py.flags.spells_learnt);
 }
 
 // remember forgotten spells while forgotten spells exist of new_spells_to_learn positive,
 // remember the spells in the order that they were learned
-static int rememberForgottenSpells(Spell_t *msp_ptr, int allowed_spells, int new_spells, const char *p, int offset) {
+static int rememberForgottenSpells(int allowed_spells, int new_spells, const char *p, int offset) {
+    uint32_t castable = playerSpellsUpToLevel(py.misc.level);
     uint32_t mask;
 
     for (int n = 0; ((py.flags.spells_forgotten != 0u) && (new_spells != 0) && (n < allowed_spells) && (n < 32)); n++) {
@@ -1531,7 +1613,7 @@ static int rememberForgottenSpells(Spell_t *msp_ptr, int allowed_spells, int new
         }
 
         if ((mask & py.flags.spells_forgotten) != 0u) {
-            if (msp_ptr[order_id].level_required <= py.misc.level) {
+            if ((mask & castable) != 0u) {
                 new_spells--;
                 py.flags.spells_forgotten &= ~mask;
                 py.flags.spells_learnt |= mask;
@@ -1550,20 +1632,10 @@ static int rememberForgottenSpells(Spell_t *msp_ptr, int allowed_spells, int new
 
 // determine which spells player can learn must check all spells here,
 // in gain_spell() we actually check if the books are present
-static int learnableSpells(Spell_t *msp_ptr, int new_spells) {
+static int learnableSpells(int new_spells) {
     auto spell_flag = (uint32_t)(0x7FFFFFFFL & ~py.flags.spells_learnt);
 
-    int id = 0;
-    uint32_t mask = 0x1;
-
-    for (int i = 0; spell_flag != 0u; mask <<= 1, i++) {
-        if ((spell_flag & mask) != 0u) {
-            spell_flag &= ~mask;
-            if (msp_ptr[i].level_required <= py.misc.level) {
-                id++;
-            }
-        }
-    }
+    int id = bitPopCount(spell_flag & playerSpellsUpToLevel(py.misc.level));
 
     if (new_spells > id) {
         new_spells = id;
@@ -1605,8 +1677,6 @@ static void forgetSpells(int new_spells, const char *p, int offset) {
 // calculate number of spells player should have, and
 // learn forget spells until that number is met -JEW-
 void playerCalculateAllowedSpellsCount(int stat) {
-    Spell_t &spell = magic_spells[py.misc.class_id - 1][0];
-
     const char *magic_type_str = nullptr;
     int offset;
 
@@ -1619,7 +1689,7 @@ void playerCalculateAllowedSpellsCount(int stat) {
     }
 
     // check to see if know any spells greater than level, eliminate them
-    eliminateKnownSpellsGreaterThanLevel(&spell, magic_type_str, offset);
+    eliminateKnownSpellsGreaterThanLevel(magic_type_str, offset);
 
     // calc number of spells allowed
     int num_allowed = numberOfSpellsAllowed(stat);
@@ -1627,11 +1697,11 @@ void playerCalculateAllowedSpellsCount(int stat) {
     int new_spells = num_allowed - num_known;
 
     if (new_spells > 0) {
-        new_spells = rememberForgottenSpells(&spell, num_allowed, new_spells, magic_type_str, offset);
+        new_spells = rememberForgottenSpells(num_allowed, new_spells, magic_type_str, offset);
 
         // If `new_spells_to_learn` is still greater than zero
         if (new_spells > 0) {
-            new_spells = learnableSpells(&spell, new_spells);
+            new_spells = learnableSpells(new_spells);
         }
     } else if (new_spells < 0) {
         forgetSpells(new_spells, magic_type_str, offset);
@@ -176,17 +176,17 @@ typedef struct Player_t {
     } misc{};
 } Player_t;
 
-extern Player_t py;
+extern thread_local Player_t py;
 
-extern ClassRankTitle_t class_rank_titles[PLAYER_MAX_CLASSES][PLAYER_MAX_LEVEL];
-extern Race_t character_races[PLAYER_MAX_RACES];
-extern Background_t character_backgrounds[PLAYER_MAX_BACKGROUNDS];
+extern const ClassRankTitle_t class_rank_titles[PLAYER_MAX_CLASSES][PLAYER_MAX_LEVEL];
+extern const Race_t character_races[PLAYER_MAX_RACES];
+extern const Background_t character_backgrounds[PLAYER_MAX_BACKGROUNDS];
 
-extern Class_t classes[PLAYER_MAX_CLASSES];
-extern int16_t class_level_adj[PLAYER_MAX_CLASSES][CLASS_MAX_LEVEL_ADJUST];
-extern uint16_t class_base_provisions[PLAYER_MAX_CLASSES][5];
+extern const Class_t classes[PLAYER_MAX_CLASSES];
+extern const int16_t class_level_adj[PLAYER_MAX_CLASSES][CLASS_MAX_LEVEL_ADJUST];
+extern const uint16_t class_base_provisions[PLAYER_MAX_CLASSES][5];
 
-extern uint8_t blows_table[7][6];
+extern const uint8_t blows_table[7][6];
 
 bool playerIsMale();
 void playerSetGender(bool is_male);
@@ -201,12 +201,14 @@ void playerRestOn();
 void playerRestOff();
 void playerDiedFromString(vtype_t *description, const char *monster_name, uint32_t move);
 bool playerTestAttackHits(int attack_id, uint8_t level);
+bool playerRollAttackHits(int attack_id, uint8_t level);
 
 void playerChangeSpeed(int speed);
 void playerAdjustBonusesForItem(Inventory_t const &item, int factor);
 void playerRecalculateBonuses();
 void playerTakeOff(int item_id, int pack_position_id);
 bool playerTestBeingHit(int base_to_hit, int level, int plus_to_hit, int armor_class, int attack_type_id);
+bool playerRollToHit(int base_to_hit, int level, int plus_to_hit, int armor_class, int attack_type_id);
 void playerTakesHit(int damage, const char *creature_name);
 
 void playerSearch(Coord_t coord, int chance);
@@ -223,6 +225,7 @@ void playerWornItemRemoveCurse(PlayerEquipment id);
 void playerGainSpells();
 void playerGainMana(int stat);
 int playerWeaponCriticalBlow(int weapon_weight, int plus_to_hit, int damage, int attack_type_id);
+int playerRollCriticalBlow(int weapon_weight, int plus_to_hit, int damage, int attack_type_id, int &multiplier);
 bool playerSavingThrow();
 
 void playerGainKillExperience(Creature_t const &creature);
@@ -230,7 +233,11 @@ void playerOpenClosedObject();
 void playerCloseDoor();
 bool playerTunnelWall(Coord_t coord, int digging_ability, int digging_chance);
 void playerAttackPosition(Coord_t coord);
+void playerCalculateToHitBlows(int weapon_id, int weapon_weight, int &blows, int &total_to_hit);
+int playerCalculateBaseToHit(bool creature_lit, int tot_tohit);
+int playerRollBlowDamage(Inventory_t const &item, int total_to_hit, int creature_id, int &critical);
 void playerCalculateAllowedSpellsCount(int stat);
+uint32_t playerSpellsUpToLevel(int level);
 
 char *playerRankTitle();
 
@@ -259,6 +266,7 @@ void playerFindInitialize(int direction);
 void playerRunAndFind();
 void playerEndRunning();
 void playerAreaAffect(int direction, Coord_t coord);
+void playerTravel();
 
 // player_stats.cpp
 void playerInitializeBaseExperienceLevels();
@@ -286,6 +294,7 @@ void chestTrap(Coord_t coord);
 
 // player_tunnel.cpp
 void playerTunnel(int direction);
+bool playerTurnWasTunnelling();
 
 // player_quaff.cpp
 void quaff();
@@ -46,7 +46,7 @@ void playerBash() {
     Coord_t coord = py.pos;
     (void) playerMovePosition(dir, coord);
 
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     if (tile.creature_id > 1) {
         playerBashPosition(coord);
@@ -235,7 +235,9 @@ void pray() {
     // e.g. `spellCreateFood()`, so this check is required. -MRC-
     game.player_free_turn = false;
 
-    if (randomNumber(100) < chance) {
+    bool failed = randomNumber(100) < chance;
+
+    if (failed) {
         printMessage("You lost your concentration!");
     } else {
         playerRecitePrayer(choice);
@@ -253,6 +255,8 @@ void pray() {
         return;
     }
 
+    TELEMETRY_EVENT(SpellCast, choice, failed ? 0 : 1, "priest");
+
     if (spell.mana_required > py.misc.current_mana) {
         printMessage("You faint from fatigue!");
 
@@ -7,6 +7,8 @@
 
 #include "headers.h"
 
+#include <vector>
+
 // Overview: You keep moving until something interesting happens. If you are in
 // an enclosed space, you follow corners. This is the usual corridor scheme. If
 // you are in an open space, you go straight, but stop before entering enclosed
@@ -111,9 +113,19 @@
 
 static int cycle[] = {1, 2, 3, 6, 9, 8, 7, 4, 1, 2, 3, 6, 9, 8, 7, 4, 1};
 static int chome[] = {-1, 8, 9, 10, 7, -1, 11, 6, 5, 4};
-static bool find_openarea, find_breakright, find_breakleft;
-static int find_prevdir;
-static int find_direction; // Keep a record of which way we are going.
+static thread_local bool find_openarea, find_breakright, find_breakleft;
+static thread_local int find_prevdir;
+static thread_local int find_direction; // Keep a record of which way we are going.
+
+// Travel is a run along a path, over the tiles the player knows, to the
+// nearest known staircase of the kind asked for. The path is only looked
+// for again when a tile feature changes, e.g. a door closes on it.
+static thread_local bool find_travelling = false;
+static thread_local uint8_t travel_stairs;            // Category of the staircase travelled to
+static thread_local std::vector<Coord_t> travel_path; // Tiles still to be stepped on, the next one last
+static thread_local uint32_t travel_feature_changes;  // Value of `tile_feature_changes` for the path
+
+static void playerTravelStep();
 
 // Do we see a wall? Used in running. -CJS-
 static bool playerCanSeeDungeonWall(int dir, Coord_t coord) {
@@ -186,6 +198,8 @@ static void findRunningBreak(int dir, Coord_t coord) {
 void playerFindInitialize(int direction) {
     Coord_t coord = py.pos;
 
+    find_travelling = false;
+
     if (!playerMovePosition(direction, coord)) {
         py.running_tracker = 0;
     } else {
@@ -220,6 +234,11 @@ void playerFindInitialize(int direction) {
 }
 
 void playerRunAndFind() {
+    if (find_travelling) {
+        playerTravelStep();
+        return;
+    }
+
     uint8_t tracker = py.running_tracker;
 
     py.running_tracker++;
@@ -246,14 +265,18 @@ void playerEndRunning() {
 }
 
 static bool areaAffectStopLookingAtSquares(int i, int dir, int new_dir, Coord_t coord, int &check_dir, int &dir_a, int &dir_b) {
-    Tile_t const &tile = dg.floor[coord.y][coord.x];
+    DungeonFloor_t const &floor = dg.floor;
+    size_t tile = (size_t) coord.y * floor.columns + coord.x;
+    size_t word = floor.wordIndex(coord.y, coord.x);
+    uint8_t treasure_id = floor.treasures[tile];
+    uint8_t creature_id = floor.creatures[tile];
 
     // Default: Square unseen. Treat as open.
     bool invisible = true;
 
-    if (py.carrying_light || tile.temporary_light || tile.permanent_light || tile.field_mark) {
-        if (tile.treasure_id != 0) {
-            int tile_id = game.treasure.list[tile.treasure_id].category_id;
+    if (py.carrying_light || ((floor.temporary_lights[word] | floor.permanent_lights[word] | floor.field_marks[word]) & DungeonFloor_t::bitMask(coord.x)) != 0) {
+        if (treasure_id != 0) {
+            int tile_id = game.treasure.list[treasure_id].category_id;
 
             if (tile_id != TV_INVIS_TRAP && tile_id != TV_SECRET_DOOR && (tile_id != TV_OPEN_DOOR || !config::options::run_ignore_doors)) {
                 playerEndRunning();
@@ -264,7 +287,7 @@ static bool areaAffectStopLookingAtSquares(int i, int dir, int new_dir, Coord_t
         // Also Creatures
         // The monster should be visible since monsterUpdateVisibility() checks
         // for the special case of being in find mode
-        if (tile.creature_id > 1 && monsters[tile.creature_id].lit) {
+        if (creature_id > 1 && monsters[creature_id].lit) {
             playerEndRunning();
             return true;
         }
@@ -272,7 +295,7 @@ static bool areaAffectStopLookingAtSquares(int i, int dir, int new_dir, Coord_t
         invisible = false;
     }
 
-    if (tile.feature_id <= MAX_OPEN_SPACE || invisible) {
+    if (floor.features[tile] <= MAX_OPEN_SPACE || invisible) {
         if (find_openarea) {
             // Have we found a break?
             if (i < 0) {
@@ -331,7 +354,8 @@ static bool areaAffectStopLookingAtSquares(int i, int dir, int new_dir, Coord_t
 
 // Determine the next direction for a run, or if we should stop. -CJS-
 void playerAreaAffect(int direction, Coord_t coord) {
-    if (py.flags.blind >= 1) {
+    // A travel keeps to its path, a monster coming into view still disturbs it
+    if (py.flags.blind >= 1 || find_travelling) {
         return;
     }
 
@@ -409,3 +433,156 @@ void playerAreaAffect(int direction, Coord_t coord) {
         find_prevdir = dir_b;
     }
 }
+
+// Whether the player knows that a tile can be walked on. Known traps,
+// and the store entrances of the town, are walked around.
+static bool travelTileKnownOpen(Coord_t const &coord) {
+    Tile_t const &tile = dg.floor[coord.y][coord.x];
+
+    if (tile.feature_id > MAX_OPEN_SPACE || !caveTileVisible(coord)) {
+        return false;
+    }
+    if (tile.treasure_id == 0) {
+        return true;
+    }
+
+    uint8_t category_id = game.treasure.list[tile.treasure_id].category_id;
+    return category_id != TV_VIS_TRAP && category_id != TV_STORE_DOOR;
+}
+
+// Finds the shortest path, over the tiles the player knows, to the nearest
+// known staircase of the kind travelled to, with a breadth first search.
+static bool travelFindPath() {
+    static thread_local std::vector<int> came_from;
+    static thread_local std::vector<int> pending;
+
+    int columns = dg.floor.columns;
+
+    came_from.assign(dg.floor.size(), -1);
+    pending.clear();
+
+    int start = py.pos.y * columns + py.pos.x;
+    came_from[start] = start;
+    pending.push_back(start);
+
+    travel_path.clear();
+    travel_feature_changes = tile_feature_changes;
+
+    for (size_t next = 0; next < pending.size(); next++) {
+        int id = pending[next];
+        Coord_t coord = Coord_t{id / columns, id % columns};
+
+        uint8_t treasure_id = dg.floor[coord.y][coord.x].treasure_id;
+        if (id != start && treasure_id != 0 && game.treasure.list[treasure_id].category_id == travel_stairs) {
+            for (; id != start; id = came_from[id]) {
+                travel_path.push_back(Coord_t{id / columns, id % columns});
+            }
+            return true;
+        }
+
+        for (int y = coord.y - 1; y <= coord.y + 1; y++) {
+            for (int x = coord.x - 1; x <= coord.x + 1; x++) {
+                Coord_t spot = Coord_t{y, x};
+
+                if (!coordInBounds(spot) || came_from[y * columns + x] >= 0 || !travelTileKnownOpen(spot)) {
+                    continue;
+                }
+
+                came_from[y * columns + x] = id;
+                pending.push_back(y * columns + x);
+            }
+        }
+    }
+
+    return false;
+}
+
+// Takes the next step of a travel, and stops it on arrival or when the way is blocked
+static void playerTravelStep() {
+    // No step is taken, so no turn goes by, when the travel can't go on
+    if (travel_feature_changes != tile_feature_changes && !travelFindPath()) {
+        printMessage("The way is blocked.");
+        game.player_free_turn = true;
+        playerEndRunning();
+        return;
+    }
+
+    Coord_t next = travel_path.back();
+
+    // Stop next to a monster in the way, rather than attack it
+    if (dg.floor[next.y][next.x].creature_id > 1) {
+        game.player_free_turn = true;
+        playerEndRunning();
+        return;
+    }
+
+    int dy = next.y - py.pos.y;
+    int dx = next.x - py.pos.x;
+
+    // The path has gone stale if its next step isn't beside the player
+    if (dy < -1 || dy > 1 || dx < -1 || dx > 1 || (dy == 0 && dx == 0)) {
+        game.player_free_turn = true;
+        playerEndRunning();
+        return;
+    }
+
+    static const int directions[3][3] = {{7, 8, 9}, {4, 5, 6}, {1, 2, 3}};
+
+    playerMove(directions[dy + 1][dx + 1], true);
+
+    // A confused step, or a trap, takes the player off the path
+    if (py.pos.y != next.y || py.pos.x != next.x) {
+        playerEndRunning();
+        return;
+    }
+
+    travel_path.pop_back();
+
+    if (travel_path.empty()) {
+        playerEndRunning();
+    }
+}
+
+// Travel to the nearest staircase the player knows of, up or down
+void playerTravel() {
+    game.player_free_turn = true;
+
+    if (py.flags.blind > 0) {
+        printMessage("You can't see the way!");
+        return;
+    }
+
+    char command;
+    if (!getCommand("Travel to the nearest staircase, up (<) or down (>)?", command)) {
+        return;
+    }
+
+    if (command == '<') {
+        travel_stairs = TV_UP_STAIR;
+    } else if (command == '>') {
+        travel_stairs = TV_DOWN_STAIR;
+    } else {
+        return;
+    }
+
+    if (!travelFindPath()) {
+        printMessage("You don't know the way to any such staircase.");
+        return;
+    }
+
+    game.player_free_turn = false;
+
+    py.running_tracker = 1;
+    find_travelling = true;
+
+    // As for a run, the player symbol has to be erased here
+    if (!py.temporary_light_only && !config::options::run_print_self) {
+        panelPutTile(caveGetTileSymbol(py.pos), py.pos);
+    }
+
+    playerTravelStep();
+
+    if (py.running_tracker == 0) {
+        game.command_count = 0;
+    }
+}
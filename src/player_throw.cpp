@@ -136,7 +136,7 @@ static void inventoryDropOrThrowItem(Coord_t coord, Inventory_t *item) {
 
     if (flag) {
         int cur_pos = popt();
-        dg.floor[position.y][position.x].treasure_id = (uint8_t) cur_pos;
+        dungeonSetTreasureId(position, cur_pos);
         game.treasure.list[cur_pos] = *item;
         dungeonLiteSpot(position);
     } else {
@@ -185,92 +185,89 @@ void playerThrowItem() {
 
     char tile_char = thrown_item.sprite;
     bool visible;
-    int current_distance = 0;
 
-    Coord_t coord = py.pos;
-    Coord_t old_coord = py.pos;
+    ProjectilePath_t path;
+    projectilePathTrace(py.pos, dir, tdis, path);
 
-    bool flag = false;
+    // The object flies until it hits a wall or a monster, or runs out of range
+    int end = std::min(path.blocked, path.creature);
 
-    while (!flag) {
-        (void) playerMovePosition(dir, coord);
-        current_distance++;
-        dungeonLiteSpot(old_coord);
+    // show object moving, all of its flight at once
+    if (py.flags.blind < 1) {
+        for (int distance = 1; distance < end; distance++) {
+            Coord_t coord = path.tiles[distance];
+            Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (current_distance > tdis) {
-            flag = true;
+            // do not test tile.field_mark here
+            if (coordInsidePanel(coord) && (tile.temporary_light || tile.permanent_light)) {
+                panelPutTile(tile_char, coord);
+            }
         }
+        putQIO();
+    }
 
-        Tile_t const &tile = dg.floor[coord.y][coord.x];
+    for (int distance = 0; distance < end; distance++) {
+        dungeonLiteSpot(path.tiles[distance]);
+    }
 
-        if (tile.feature_id <= MAX_OPEN_SPACE && !flag) {
-            if (tile.creature_id > 1) {
-                flag = true;
+    // Where the object drops, when it doesn't hit
+    Coord_t old_coord = path.tiles[end - 1];
 
-                Monster_t const &m_ptr = monsters[tile.creature_id];
+    if (path.creature >= path.blocked) {
+        inventoryDropOrThrowItem(old_coord, &thrown_item);
+        return;
+    }
 
-                tbth -= current_distance;
+    int current_distance = path.creature;
+    Tile_t const &tile = dg.floor[path.tiles[current_distance].y][path.tiles[current_distance].x];
+    Monster_t const &m_ptr = monsters[tile.creature_id];
 
-                // if monster not lit, make it much more difficult to hit, subtract
-                // off most bonuses, and reduce bth_with_bows depending on distance.
-                if (!m_ptr.lit) {
-                    tbth /= current_distance + 2;
-                    tbth -= py.misc.level * class_level_adj[py.misc.class_id][PlayerClassLevelAdj::BTHB] / 2;
-                    tbth -= tpth * (BTH_PER_PLUS_TO_HIT_ADJUST - 1);
-                }
+    tbth -= current_distance;
 
-                if (playerTestBeingHit(tbth, (int) py.misc.level, tpth, (int) creatures_list[m_ptr.creature_id].ac, PlayerClassLevelAdj::BTHB)) {
-                    int damage = m_ptr.creature_id;
-
-                    obj_desc_t description = {'\0'};
-                    obj_desc_t msg = {'\0'};
-                    itemDescription(description, thrown_item, false);
-
-                    // Does the player know what they're fighting?
-                    if (!m_ptr.lit) {
-                        (void) sprintf(msg, "You hear a cry as the %s finds a mark.", description);
-                        visible = false;
-                    } else {
-                        (void) sprintf(msg, "The %s hits the %s.", description, creatures_list[damage].name);
-                        visible = true;
-                    }
-                    printMessage(msg);
-
-                    tdam = itemMagicAbilityDamage(thrown_item, tdam, damage);
-                    tdam = playerWeaponCriticalBlow((int) thrown_item.weight, tpth, tdam, PlayerClassLevelAdj::BTHB);
-
-                    if (tdam < 0) {
-                        tdam = 0;
-                    }
-
-                    damage = monsterTakeHit((int) tile.creature_id, tdam);
-
-                    if (damage >= 0) {
-                        if (!visible) {
-                            printMessage("You have killed something!");
-                        } else {
-                            (void) sprintf(msg, "You have killed the %s.", creatures_list[damage].name);
-                            printMessage(msg);
-                        }
-                        displayCharacterExperience();
-                    }
-                } else {
-                    inventoryDropOrThrowItem(old_coord, &thrown_item);
-                }
-            } else {
-                // do not test tile.field_mark here
+    // if monster not lit, make it much more difficult to hit, subtract
+    // off most bonuses, and reduce bth_with_bows depending on distance.
+    if (!m_ptr.lit) {
+        tbth /= current_distance + 2;
+        tbth -= py.misc.level * class_level_adj[py.misc.class_id][PlayerClassLevelAdj::BTHB] / 2;
+        tbth -= tpth * (BTH_PER_PLUS_TO_HIT_ADJUST - 1);
+    }
 
-                if (coordInsidePanel(coord) && py.flags.blind < 1 && (tile.temporary_light || tile.permanent_light)) {
-                    panelPutTile(tile_char, coord);
-                    putQIO(); // show object moving
-                }
-            }
+    if (playerTestBeingHit(tbth, (int) py.misc.level, tpth, (int) creatures_list[m_ptr.creature_id].ac, PlayerClassLevelAdj::BTHB)) {
+        int damage = m_ptr.creature_id;
+
+        obj_desc_t description = {'\0'};
+        obj_desc_t msg = {'\0'};
+        itemDescription(description, thrown_item, false);
+
+        // Does the player know what they're fighting?
+        if (!m_ptr.lit) {
+            (void) sprintf(msg, "You hear a cry as the %s finds a mark.", description);
+            visible = false;
         } else {
-            flag = true;
-            inventoryDropOrThrowItem(old_coord, &thrown_item);
+            (void) sprintf(msg, "The %s hits the %s.", description, creatures_list[damage].name);
+            visible = true;
+        }
+        printMessage(msg);
+
+        tdam = itemMagicAbilityDamage(thrown_item, tdam, damage);
+        tdam = playerWeaponCriticalBlow((int) thrown_item.weight, tpth, tdam, PlayerClassLevelAdj::BTHB);
+
+        if (tdam < 0) {
+            tdam = 0;
         }
 
-        old_coord.y = coord.y;
-        old_coord.x = coord.x;
+        damage = monsterTakeHit((int) tile.creature_id, tdam);
+
+        if (damage >= 0) {
+            if (!visible) {
+                printMessage("You have killed something!");
+            } else {
+                (void) sprintf(msg, "You have killed the %s.", creatures_list[damage].name);
+                printMessage(msg);
+            }
+            displayCharacterExperience();
+        }
+    } else {
+        inventoryDropOrThrowItem(old_coord, &thrown_item);
     }
 }
@@ -7,6 +7,18 @@
 
 #include "headers.h"
 
+// Whether the player dug (or tried to), at a wall, rubble or a secret door
+static thread_local bool player_tunnelled = false;
+
+// Whether the player's command was some digging, which can change nothing
+// but the tile dug at, the RNG and the messages. Asking clears it, for the
+// next command.
+bool playerTurnWasTunnelling() {
+    bool tunnelled = player_tunnelled;
+    player_tunnelled = false;
+    return tunnelled;
+}
+
 // Don't let the player tunnel somewhere illegal, this is necessary to
 // prevent the player from getting a free attack by trying to tunnel
 // somewhere where it has no effect.
@@ -150,6 +162,8 @@ void playerTunnel(int direction) {
     }
 
     if (item.category_id != TV_NOTHING) {
+        player_tunnelled = true;
+
         int digging_ability = playerDiggingAbility(item);
 
         if (!dungeonDigAtLocation(coord, tile.feature_id, digging_ability)) {
@@ -0,0 +1,170 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Timing of the game turn stages, see profile.h
+
+#include "headers.h"
+
+#ifdef UMORIA_PROFILE
+
+#include <mutex>
+
+// Durations are counted in powers of two of nanoseconds, the last
+// bucket also holding everything slower.
+constexpr int PROFILE_HISTOGRAM_BUCKETS = 40;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[PROFILE_HISTOGRAM_BUCKETS]; // [n] counts [2^n, 2^(n+1)) ns
+} ProfileStageTimes_t;
+
+typedef struct {
+    ProfileStageTimes_t stages[(int) ProfileStage::Count];
+    uint64_t counters[(int) ProfileCounter::Count];
+} Profile_t;
+
+static const char *profile_stage_names[(int) ProfileStage::Count] = {
+    "turn", "storeMaintenance", "spawnMonsters", "playerStatus", "playerCommands", "updateMonsters", "generateCave", "saveGame", "autosave", "hangupImage",
+    "openScoreFile", "initializeGame", "loadGame", "readTextFile", "los",
+};
+
+static const char *profile_counter_names[(int) ProfileCounter::Count] = {
+    "monsterMoves",
+    "monstersPlaced",
+};
+
+static void profileAdd(Profile_t &to, Profile_t const &from) {
+    for (int i = 0; i < (int) ProfileStage::Count; i++) {
+        ProfileStageTimes_t &stage = to.stages[i];
+        ProfileStageTimes_t const &other = from.stages[i];
+
+        stage.calls += other.calls;
+        stage.total_ns += other.total_ns;
+        stage.max_ns = std::max(stage.max_ns, other.max_ns);
+
+        for (int bucket = 0; bucket < PROFILE_HISTOGRAM_BUCKETS; bucket++) {
+            stage.histogram[bucket] += other.histogram[bucket];
+        }
+    }
+
+    for (int i = 0; i < (int) ProfileCounter::Count; i++) {
+        to.counters[i] += from.counters[i];
+    }
+}
+
+static void profileWrite(Profile_t const &profile) {
+    const char *filename = getenv("UMORIA_PROFILE_FILE");
+    if (filename == nullptr || filename[0] == '\0') {
+        filename = "umoria-profile.csv";
+    }
+
+    FILE *file = fileOpenOutput(filename);
+    if (file == nullptr) {
+        fprintf(stderr, "Can't write the profile to '%s'\n", filename);
+        return;
+    }
+
+    // One record per stage, then one per counter with only the calls set
+    fprintf(file, "name,calls,total_ns,mean_ns,max_ns");
+    for (int bucket = 0; bucket < PROFILE_HISTOGRAM_BUCKETS; bucket++) {
+        fprintf(file, ",lt_%llu_ns", 2ull << bucket);
+    }
+    fprintf(file, "\n");
+
+    for (int i = 0; i < (int) ProfileStage::Count; i++) {
+        ProfileStageTimes_t const &stage = profile.stages[i];
+
+        fprintf(file, "%s,%llu,%llu,%.1f,%llu", profile_stage_names[i], (unsigned long long) stage.calls, (unsigned long long) stage.total_ns,
+                stage.calls > 0 ? (double) stage.total_ns / (double) stage.calls : 0.0, (unsigned long long) stage.max_ns);
+        for (auto count : stage.histogram) {
+            fprintf(file, ",%llu", (unsigned long long) count);
+        }
+        fprintf(file, "\n");
+    }
+
+    for (int i = 0; i < (int) ProfileCounter::Count; i++) {
+        fprintf(file, "%s,%llu,0,0,0", profile_counter_names[i], (unsigned long long) profile.counters[i]);
+        for (int bucket = 0; bucket < PROFILE_HISTOGRAM_BUCKETS; bucket++) {
+            fprintf(file, ",0");
+        }
+        fprintf(file, "\n");
+    }
+
+    (void) fclose(file);
+}
+
+// The figures of all the game threads that have ended, written out once
+// the program exits, after the thread_local figures have been added in.
+static struct ProfileTotals {
+    std::mutex mutex;
+    Profile_t profile{};
+    bool recorded = false;
+
+    ~ProfileTotals() {
+        if (recorded) {
+            profileWrite(profile);
+        }
+    }
+} profile_totals;
+
+// The figures of this thread, added to the totals when the thread ends
+static thread_local struct ProfileThread {
+    Profile_t profile{};
+    bool recorded = false;
+
+    ~ProfileThread() {
+        if (!recorded) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(profile_totals.mutex);
+        profileAdd(profile_totals.profile, profile);
+        profile_totals.recorded = true;
+    }
+} profile_thread;
+
+// Takes the timings in place of the figures, on every thread
+static void (*profile_observer)(ProfileStage stage, uint64_t ns) = nullptr;
+
+// Has each timed run of a stage, on any thread, passed to `observer` as it
+// ends, rather than added to the figures written at exit. Counted events are
+// then dropped. It must be set before the game threads are started.
+void profileSetObserver(void (*observer)(ProfileStage stage, uint64_t ns)) {
+    profile_observer = observer;
+}
+
+ProfileScope::~ProfileScope() {
+    auto ns = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (profile_observer != nullptr) {
+        profile_observer(stage, ns);
+        return;
+    }
+
+    ProfileStageTimes_t &times = profile_thread.profile.stages[(int) stage];
+    times.calls++;
+    times.total_ns += ns;
+    times.max_ns = std::max(times.max_ns, ns);
+
+    int bucket = 0;
+    while (bucket < PROFILE_HISTOGRAM_BUCKETS - 1 && (ns >> (bucket + 1)) != 0) {
+        bucket++;
+    }
+    times.histogram[bucket]++;
+
+    profile_thread.recorded = true;
+}
+
+void profileCount(ProfileCounter counter) {
+    if (profile_observer != nullptr) {
+        return;
+    }
+    profile_thread.profile.counters[(int) counter]++;
+    profile_thread.recorded = true;
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+// Timing of the stages of a game turn, and of the other slow spots of the
+// game. It is only built in with the UMORIA_PROFILE CMake option, otherwise
+// PROFILE_SCOPE() and PROFILE_COUNT() compile to nothing at all.
+//
+// Each game thread keeps its own figures, which are added together when the
+// thread ends. At exit they are written as CSV to the file named by the
+// UMORIA_PROFILE_FILE environment variable (default: umoria-profile.csv),
+// which may also be a listening Unix socket.
+//
+// A program may take the timings itself instead, with profileSetObserver().
+
+// The timed parts of the game
+enum class ProfileStage {
+    Turn, // The whole of a game turn, all the stages below included
+    StoreMaintenance,
+    SpawnMonsters,
+    PlayerStatus,
+    PlayerCommands,
+    UpdateMonsters,
+    GenerateCave,
+    SaveGame,
+    Autosave,
+    HangupImage,
+    // Startup, up to the first level
+    OpenScoreFile,
+    InitializeGame,
+    LoadGame,
+    ReadTextFile, // Reading the splash, help or death screen, only the first time
+    Los,          // Every line of sight check, mostly very short
+    Count,
+};
+
+// Events counted, rather than timed
+enum class ProfileCounter {
+    MonsterMoves,   // Monsters given one or more moves
+    MonstersPlaced, // Monsters added to a level, as it is built or played
+    Count,
+};
+
+#ifdef UMORIA_PROFILE
+
+#include <chrono>
+
+// Times the rest of the enclosing scope as one run of a stage
+class ProfileScope {
+  public:
+    explicit ProfileScope(ProfileStage stage) : stage(stage), start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope();
+
+    ProfileScope(ProfileScope const &) = delete;
+    ProfileScope &operator=(ProfileScope const &) = delete;
+
+  private:
+    ProfileStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+void profileCount(ProfileCounter counter);
+void profileSetObserver(void (*observer)(ProfileStage stage, uint64_t ns));
+
+#define PROFILE_JOIN_NAME(name, line) name##line
+#define PROFILE_SCOPE_NAME(line) PROFILE_JOIN_NAME(profile_scope_, line)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(ProfileStage::stage)
+#define PROFILE_COUNT(counter) profileCount(ProfileCounter::counter)
+
+#else
+
+#define PROFILE_SCOPE(stage)
+#define PROFILE_COUNT(counter)
+
+#endif
@@ -8,11 +8,22 @@
 #include "headers.h"
 
 // Monster memories
-Recall_t creature_recall[MON_MAX_CREATURES];
+thread_local Recall_t creature_recall[MON_MAX_CREATURES];
 
-static vtype_t roff_buffer = {'\0'};        // Line buffer.
-static char *roff_buffer_pointer = nullptr; // Pointer into line buffer.
-static int roff_print_line;                 // Place to print line now being loaded.
+// The recall text of a monster, as last rendered, kept until what is
+// known about the monster (or the level of the player) changes.
+typedef struct {
+    bool valid;
+    Recall_t memory;
+    uint16_t player_level;
+    std::vector<std::string> lines;
+} RecallText_t;
+
+static thread_local RecallText_t recall_texts[MON_MAX_CREATURES];
+
+static thread_local vtype_t roff_buffer = {'\0'};                 // Line buffer.
+static thread_local char *roff_buffer_pointer = nullptr;          // Pointer into line buffer.
+static thread_local std::vector<std::string> *roff_lines = nullptr; // Lines loaded so far.
 
 #define plural(c, ss, sp) ((c) == 1 ? (ss) : (sp))
 
@@ -34,8 +45,7 @@ static void memoryPrint(const char *p) {
                 }
             }
             *q = 0;
-            putStringClearToEOL(roff_buffer, Coord_t{roff_print_line, 0});
-            roff_print_line++;
+            roff_lines->emplace_back(roff_buffer);
 
             char *r = roff_buffer;
 
@@ -584,19 +594,9 @@ static void memoryAttackNumberAndDamage(Recall_t const &memory, Creature_t const
     }
 }
 
-// Print out what we have discovered about this monster.
-int memoryRecall(int monster_id) {
-    Recall_t &memory = creature_recall[monster_id];
-    Creature_t const &creature = creatures_list[monster_id];
-
-    Recall_t saved_memory{};
-
-    if (game.wizard_mode) {
-        saved_memory = memory;
-        memoryWizardModeInit(memory, creature);
-    }
-
-    roff_print_line = 0;
+// Builds the lines of text describing what we have discovered about this monster.
+static void memoryRecallRender(Recall_t const &memory, Creature_t const &creature, std::vector<std::string> &lines) {
+    roff_lines = &lines;
     roff_buffer_pointer = roff_buffer;
 
     auto spells = (uint32_t)(memory.spells & creature.spells & ~config::monsters::spells::CS_FREQ);
@@ -663,12 +663,47 @@ int memoryRecall(int monster_id) {
     }
 
     memoryPrint("\n");
-    putStringClearToEOL("--pause--", Coord_t{roff_print_line, 0});
+}
+
+static bool memoryRecallMatches(Recall_t const &a, Recall_t const &b) {
+    return a.movement == b.movement && a.spells == b.spells && a.deaths == b.deaths && a.defenses == b.defenses && a.wake == b.wake && a.ignore == b.ignore && a.kills == b.kills &&
+           std::equal(a.attacks, a.attacks + MON_MAX_ATTACKS, b.attacks);
+}
+
+// Print out what we have discovered about this monster.
+int memoryRecall(int monster_id) {
+    Recall_t &memory = creature_recall[monster_id];
+    Creature_t const &creature = creatures_list[monster_id];
+
+    Recall_t saved_memory{};
+
+    if (game.wizard_mode) {
+        saved_memory = memory;
+        memoryWizardModeInit(memory, creature);
+    }
+
+    RecallText_t &text = recall_texts[monster_id];
+
+    if (!text.valid || text.player_level != py.misc.level || !memoryRecallMatches(text.memory, memory)) {
+        text.lines.clear();
+        memoryRecallRender(memory, creature, text.lines);
+
+        text.valid = true;
+        text.memory = memory;
+        text.player_level = py.misc.level;
+    }
 
     if (game.wizard_mode) {
         memory = saved_memory;
     }
 
+    int line = 0;
+    for (auto const &text_line : text.lines) {
+        putStringClearToEOL(text_line.c_str(), Coord_t{line, 0});
+        line++;
+    }
+    putStringClearToEOL("--pause--", Coord_t{line, 0});
+
     return getKeyInput();
 }
 
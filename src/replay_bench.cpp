@@ -0,0 +1,296 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Replay benchmark: times recorded games played back without a terminal
+
+#include "headers.h"
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#ifndef UMORIA_PROFILE
+#error "umoria-replay-bench takes its timings from the profile stages, build it with UMORIA_PROFILE"
+#endif
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-replay-bench [OPTIONS] LOG...
+
+Plays each replay log (recorded with `umoria -r`) through the headless game
+and prints one CSV record per log, then one for them all: game turns, turns
+per second, the median and 99th percentile turn times, the milliseconds
+spent in updateMonsters(), generateCave() and los(), and the hashes of the
+player and dungeon the game ended with.
+
+A replay stops where the game was saved (^X) or quit (^K), or the player died.
+Logs which end before the character is made are skipped, as errors.
+
+Options:
+    -n NUMBER    Play each log NUMBER times, its runs must all end the same (default: 1)
+    -j NUMBER    Number of worker threads (default: 1, for steady timings)
+    -c FILE      Check the end hashes against those of an earlier run, saved
+                 to FILE, exiting with status 1 when any of them differ
+
+    -h           Display this message
+)";
+
+// One play of a log
+typedef struct {
+    bool played;
+    bool truncated; // The log ran out before the character was made
+    int32_t turns;
+    uint64_t total_ns;
+    std::vector<uint32_t> turn_ns;
+    uint64_t stage_ns[(int) ProfileStage::Count];
+    uint64_t player_hash;
+    uint64_t dungeon_hash;
+} ReplayRun_t;
+
+typedef struct {
+    std::string name;
+    std::vector<uint8_t> log;
+} ReplayCorpusLog_t;
+
+// The run of this game thread, others (the level workers) go untimed
+static thread_local ReplayRun_t *current_run = nullptr;
+static thread_local bool log_truncated = false;
+
+static void replayBenchObserver(ProfileStage stage, uint64_t ns) {
+    if (current_run == nullptr) {
+        return;
+    }
+
+    current_run->stage_ns[(int) stage] += ns;
+
+    if (stage == ProfileStage::Turn) {
+        current_run->turn_ns.push_back((uint32_t) std::min(ns, (uint64_t) UINT32_MAX));
+    }
+}
+
+// Saving or quitting would end the process, so the replay ends there instead
+static int replayBenchKeySource() {
+    int key = replayReadKey();
+
+    if (key == EOF && !game.character_generated) {
+        log_truncated = true;
+    }
+
+    if (key == CTRL_KEY('X') || key == CTRL_KEY('K')) {
+        return EOF;
+    }
+    return key;
+}
+
+// Plays one log, on a new thread of its own
+static void replayBenchGame(ReplayCorpusLog_t const &corpus_log, ReplayRun_t &run) {
+    run = ReplayRun_t{};
+
+    (void) terminalInitializeHeadless(replayBenchKeySource);
+
+    uint32_t seed = 0;
+    if (!replayPlayLog(corpus_log.log, seed)) {
+        return;
+    }
+
+    // Nothing is written, and saves only read the clock for the save file
+    game.autosave_turns = 0;
+
+    current_run = &run;
+    auto start = std::chrono::steady_clock::now();
+
+    replayMoria(seed);
+
+    run.total_ns = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    current_run = nullptr;
+
+    if (log_truncated) {
+        run.truncated = true;
+        return;
+    }
+
+    run.played = true;
+    run.turns = dg.game_turn;
+    run.player_hash = gameHashPlayer();
+    run.dungeon_hash = gameHashDungeon();
+}
+
+static uint32_t percentileOf(std::vector<uint32_t> &values, int percent) {
+    if (values.empty()) {
+        return 0;
+    }
+
+    size_t index = std::min(values.size() - 1, values.size() * percent / 100);
+    std::nth_element(values.begin(), values.begin() + (long) index, values.end());
+    return values[index];
+}
+
+// Adds up the runs of a log, or of all the logs
+static void replayRunAdd(ReplayRun_t &total, ReplayRun_t const &run) {
+    total.turns += run.turns;
+    total.total_ns += run.total_ns;
+    total.turn_ns.insert(total.turn_ns.end(), run.turn_ns.begin(), run.turn_ns.end());
+
+    for (int i = 0; i < (int) ProfileStage::Count; i++) {
+        total.stage_ns[i] += run.stage_ns[i];
+    }
+}
+
+static void printReplayRecord(const char *name, ReplayRun_t &run, bool with_hashes) {
+    double seconds = (double) run.total_ns / 1e9;
+
+    printf("%s,%d,%.3f,%.0f,%u,%u,%.1f,%.1f,%.1f,", name, run.turns, seconds, seconds > 0 ? run.turns / seconds : 0.0, percentileOf(run.turn_ns, 50), percentileOf(run.turn_ns, 99),
+           (double) run.stage_ns[(int) ProfileStage::UpdateMonsters] / 1e6, (double) run.stage_ns[(int) ProfileStage::GenerateCave] / 1e6, (double) run.stage_ns[(int) ProfileStage::Los] / 1e6);
+
+    if (with_hashes) {
+        printf("%016llx,%016llx\n", (unsigned long long) run.player_hash, (unsigned long long) run.dungeon_hash);
+    } else {
+        printf(",\n");
+    }
+}
+
+// The end hashes of an earlier run, by log name
+static bool readExpectedHashes(const char *filename, std::map<std::string, std::string> &hashes) {
+    FILE *file = fopen(filename, "r");
+    if (file == nullptr) {
+        return false;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        std::string record(line);
+        while (!record.empty() && (record.back() == '\n' || record.back() == '\r')) {
+            record.pop_back();
+        }
+
+        // name,...,player_hash,dungeon_hash, hashes are left empty on the total
+        size_t name_end = record.find(',');
+        size_t hashes_start = record.rfind(',', record.rfind(',') - 1);
+        if (name_end == std::string::npos || hashes_start == std::string::npos || hashes_start + 2 >= record.size()) {
+            continue;
+        }
+
+        hashes[record.substr(0, name_end)] = record.substr(hashes_start + 1);
+    }
+    (void) fclose(file);
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int repeats = 1;
+    int thread_count = 1;
+    const char *expected_filename = nullptr;
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        bool ok = true;
+
+        switch (options.option) {
+            case 'n':
+                ok = toolOptionNumber(options, repeats);
+                break;
+            case 'j':
+                ok = toolOptionNumber(options, thread_count);
+                break;
+            case 'c':
+                expected_filename = toolOptionValue(options);
+                ok = expected_filename != nullptr;
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    // The replay logs
+    argc = options.argc;
+    argv = options.argv;
+
+    if (argc == 0) {
+        printf("%s", usage_instructions);
+        return 0;
+    }
+
+    std::vector<ReplayCorpusLog_t> corpus((size_t) argc);
+    for (int i = 0; i < argc; i++) {
+        corpus[i].name = argv[i];
+        if (!replayReadLog(argv[i], corpus[i].log)) {
+            fprintf(stderr, "Can't read the replay log '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::map<std::string, std::string> expected_hashes;
+    if (expected_filename != nullptr && !readExpectedHashes(expected_filename, expected_hashes)) {
+        fprintf(stderr, "Can't read the hashes in '%s'\n", expected_filename);
+        return 1;
+    }
+
+    profileSetObserver(replayBenchObserver);
+
+    int job_count = (int) corpus.size() * repeats;
+    std::vector<ReplayRun_t> runs((size_t) job_count);
+
+    // Each log is played `repeats` times in a row, by whichever worker is free
+    toolPlayGames(job_count, thread_count, [&](int id) {
+        replayBenchGame(corpus[id / repeats], runs[id]);
+    });
+
+    bool all_same = true;
+    ReplayRun_t total{};
+
+    printf("log,turns,seconds,turns_per_second,p50_turn_ns,p99_turn_ns,update_monsters_ms,generate_cave_ms,los_ms,player_hash,dungeon_hash\n");
+
+    for (size_t i = 0; i < corpus.size(); i++) {
+        const char *name = corpus[i].name.c_str();
+        ReplayRun_t const &first = runs[i * repeats];
+
+        if (!first.played) {
+            fprintf(stderr, first.truncated ? "%s: the replay log ends before the character is made\n" : "%s: not a replay log\n", name);
+            all_same = false;
+            continue;
+        }
+
+        ReplayRun_t log_total{};
+        for (int r = 0; r < repeats; r++) {
+            ReplayRun_t const &run = runs[i * repeats + r];
+            if (run.player_hash != first.player_hash || run.dungeon_hash != first.dungeon_hash) {
+                fprintf(stderr, "%s: the runs of the log ended differently\n", name);
+                all_same = false;
+            }
+            replayRunAdd(log_total, run);
+        }
+        log_total.player_hash = first.player_hash;
+        log_total.dungeon_hash = first.dungeon_hash;
+
+        replayRunAdd(total, log_total);
+        printReplayRecord(name, log_total, true);
+
+        if (expected_filename != nullptr) {
+            char hashes[40];
+            (void) sprintf(hashes, "%016llx,%016llx", (unsigned long long) first.player_hash, (unsigned long long) first.dungeon_hash);
+
+            auto expected = expected_hashes.find(corpus[i].name);
+            if (expected == expected_hashes.end()) {
+                fprintf(stderr, "%s: no end hashes in '%s'\n", name, expected_filename);
+                all_same = false;
+            } else if (expected->second != hashes) {
+                fprintf(stderr, "%s: the game ended differently from '%s'\n", name, expected_filename);
+                all_same = false;
+            }
+        }
+    }
+
+    printReplayRecord("total", total, false);
+
+    return all_same ? 0 : 1;
+}
@@ -63,7 +63,11 @@ constexpr int32_t RNG_Q = RNG_M / RNG_A; // m div a 127773L
 constexpr int32_t RNG_R = RNG_M % RNG_A; // m mod a 2836L
 
 // 32 bit seed
-static uint32_t rnd_seed;
+static thread_local uint32_t rnd_seed;
+
+// Alternatively, the counter based generator and its stream used by rnd()
+static thread_local RandomMode rnd_mode = RandomMode::Lehmer;
+static thread_local RandomStream_t rnd_stream = RandomStream_t{0, 0};
 
 uint32_t getRandomSeed() {
     return rnd_seed;
@@ -72,10 +76,43 @@ uint32_t getRandomSeed() {
 void setRandomSeed(uint32_t seed) {
     // set seed to value between 1 and m-1
     rnd_seed = (uint32_t)((seed % (RNG_M - 1)) + 1);
+
+    rnd_stream = randomStreamCreate(seed, RNG_STREAM_MAIN);
+}
+
+RandomMode getRandomMode() {
+    return rnd_mode;
+}
+
+void setRandomMode(RandomMode mode) {
+    rnd_mode = mode;
+}
+
+// The full state of the rnd() counter stream, a 32 bit seed is not
+// enough to save and restore it, see seedSet() and seedResetToOldSeed().
+RandomStream_t getRandomStream() {
+    return rnd_stream;
+}
+
+void setRandomStream(RandomStream_t const &stream) {
+    rnd_stream = stream;
+}
+
+RandomState_t getRandomState() {
+    return RandomState_t{rnd_seed, rnd_stream};
+}
+
+void setRandomState(RandomState_t const &state) {
+    rnd_seed = state.seed;
+    rnd_stream = state.stream;
 }
 
 // returns a pseudo-random number from set 1, 2, ..., RNG_M - 1
 int32_t rnd() {
+    if (rnd_mode == RandomMode::Counter) {
+        return (int32_t)(randomStreamNext(rnd_stream) % (RNG_M - 1)) + 1;
+    }
+
     auto high = (int32_t)(rnd_seed / RNG_Q);
     auto low = (int32_t)(rnd_seed % RNG_Q);
     auto test = (int32_t)(RNG_A * low - RNG_R * high);
@@ -88,6 +125,55 @@ int32_t rnd() {
     return rnd_seed;
 }
 
+// The counter based generator is SplitMix64: the stream key and counter are
+// combined with the golden ratio increment, then scrambled by the SplitMix64
+// finalizer. Unlike the Lehmer generator there is no serial dependency
+// between values, so any value of any stream can be computed directly.
+//
+// Guy L. Steele, Doug Lea and Christine H. Flood, "Fast Splittable
+//      Pseudorandom Number Generators", OOPSLA 2014.
+
+constexpr uint64_t RNG_GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t splitMix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint32_t counterValue(uint64_t key, uint64_t counter) {
+    return (uint32_t)(splitMix64(key + counter * RNG_GOLDEN_GAMMA) >> 32);
+}
+
+// Streams with the same seed but different IDs are independent of each other
+RandomStream_t randomStreamCreate(uint64_t seed, uint64_t stream_id) {
+    return RandomStream_t{splitMix64(splitMix64(seed) ^ (stream_id * RNG_GOLDEN_GAMMA)), 0};
+}
+
+// Derives a new independent stream, advancing the parent by one value
+RandomStream_t randomStreamSplit(RandomStream_t &parent) {
+    uint64_t key = splitMix64(parent.key ^ splitMix64(parent.counter++));
+    return RandomStream_t{key, 0};
+}
+
+uint32_t randomStreamNext(RandomStream_t &stream) {
+    return counterValue(stream.key, stream.counter++);
+}
+
+// Fills `values` with the next `count` values of the stream, exactly as if
+// randomStreamNext() had been called `count` times.
+void fillRandom(RandomStream_t &stream, uint32_t *values, int count) {
+    uint64_t const key = stream.key;
+    uint64_t const counter = stream.counter;
+
+    // No loop carried state, so the compiler is free to vectorize this.
+    for (int i = 0; i < count; i++) {
+        values[i] = counterValue(key, counter + (uint64_t) i);
+    }
+
+    stream.counter += (uint64_t) count;
+}
+
 #ifdef TEST_RNG
 
 main() {
@@ -5,7 +5,54 @@
 
 #pragma once
 
+// Which generator rnd() draws its numbers from. Lehmer is the classic
+// Moria generator, and remains the default so games play out as before.
+enum class RandomMode {
+    Lehmer,
+    Counter,
+};
+
+// RandomStream_t is one stream of the counter based generator. Each value is a
+// pure function of (key, counter), so streams are cheap to create, never
+// affect each other, and can be drawn from in any order or on any thread.
+typedef struct {
+    uint64_t key;
+    uint64_t counter;
+} RandomStream_t;
+
+// Well known stream IDs, so each subsystem can draw from its own stream.
+enum RandomStreamId : uint64_t {
+    RNG_STREAM_MAIN = 0,
+    RNG_STREAM_TOWN,
+    RNG_STREAM_MAGIC_NAMES,
+    RNG_STREAM_MONSTERS,
+    RNG_STREAM_LOOT,
+    RNG_STREAM_LEVELS,
+    RNG_STREAM_ROOMS,
+    RNG_STREAM_STORES,
+};
+
 // rng.cpp
 uint32_t getRandomSeed();
 void setRandomSeed(uint32_t seed);
 int32_t rnd();
+
+RandomMode getRandomMode();
+void setRandomMode(RandomMode mode);
+RandomStream_t getRandomStream();
+void setRandomStream(RandomStream_t const &stream);
+
+// The exact state of rnd(), whichever the generator, for a subsystem which
+// draws from a stream of its own without moving the game's RNG at all.
+typedef struct {
+    uint32_t seed;
+    RandomStream_t stream;
+} RandomState_t;
+
+RandomState_t getRandomState();
+void setRandomState(RandomState_t const &state);
+
+RandomStream_t randomStreamCreate(uint64_t seed, uint64_t stream_id);
+RandomStream_t randomStreamSplit(RandomStream_t &parent);
+uint32_t randomStreamNext(RandomStream_t &stream);
+void fillRandom(RandomStream_t &stream, uint32_t *values, int count);
@@ -8,8 +8,12 @@
 #include "headers.h"
 #include "version.h"
 
+#ifndef _WIN32
+#include <sys/file.h>
+#endif
+
 // High score file pointer
-FILE *highscore_fp;
+thread_local FILE *highscore_fp;
 
 static uint8_t highScoreGenderLabel() {
     if (playerIsMale()) {
@@ -18,6 +22,82 @@ static uint8_t highScoreGenderLabel() {
     return 'F';
 }
 
+// Reads the whole score file in one go, `data` is left empty for a new
+// score file. Returns false if the file is from a version of umoria
+// which can't be read.
+static bool readScoreFile(FILE *file, std::vector<uint8_t> &data) {
+    data.clear();
+
+    (void) fseek(file, 0L, SEEK_END);
+    long size = ftell(file);
+    (void) fseek(file, 0L, SEEK_SET);
+
+    if (size > 0) {
+        data.resize((size_t) size);
+        data.resize(fread(data.data(), 1, (size_t) size, file));
+    }
+
+    // If this is a new score file, it should be empty.
+    if (data.size() < HIGH_SCORE_HEADER_SIZE) {
+        data.clear();
+        return true;
+    }
+
+    // Ignore a partial entry at the end, as the old code did.
+    data.resize(data.size() - (data.size() - HIGH_SCORE_HEADER_SIZE) % HIGH_SCORE_RECORD_SIZE);
+
+    return validGameVersion(data[0], data[1], data[2]);
+}
+
+// Waits until no other player is updating the score file
+static void lockScoreFile(int fd) {
+#ifndef _WIN32
+    while (flock(fd, LOCK_EX) < 0 && errno == EINTR) {
+        // interrupted by a signal, try again
+    }
+#else
+    (void) fd; // single user, there is nobody else to wait for
+#endif
+}
+
+// Closing the files releases the lock
+static void closeScoreFile(int lock_fd) {
+    (void) fclose(highscore_fp);
+    if (lock_fd >= 0) {
+        (void) close(lock_fd);
+    }
+}
+
+static uint8_t *scoreRecord(std::vector<uint8_t> &data, int index) {
+    return data.data() + HIGH_SCORE_HEADER_SIZE + (size_t) index * HIGH_SCORE_RECORD_SIZE;
+}
+
+// Binary search for the first entry with no more points than `points`
+static int highScoreInsertPosition(std::vector<uint8_t> &data, int entries, int32_t points) {
+    HighScore_t entry{};
+
+    int low = 0;
+    int high = entries;
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+        decodeHighScore(scoreRecord(data, middle), entry);
+        if (points >= entry.points) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
+
+static bool isSameCharacter(HighScore_t const &new_entry, HighScore_t const &old_entry) {
+    return ((new_entry.uid != 0 && new_entry.uid == old_entry.uid) ||
+            (new_entry.uid == 0 && (strcmp(old_entry.died_from, "(saved)") == 0) && new_entry.birth_date == old_entry.birth_date)) &&
+           new_entry.gender == old_entry.gender && new_entry.race == old_entry.race && new_entry.character_class == old_entry.character_class;
+}
+
 // Enters a players name on the top twenty list -JWT-
 void recordNewHighScore() {
     clearScreen();
@@ -56,118 +136,110 @@ void recordNewHighScore() {
     }
     (void) strcpy(new_entry.died_from, tmp);
 
+    // Only one player may update the scores at a time. Normally the update
+    // is written to a new file which replaces the old, so showScoresScreen()
+    // never needs a lock. If the lock file can't be made, the directory isn't
+    // writable, so fall back to locking, and updating, the score file itself.
+    std::string lock_filename = config::files::scores + ".lock";
+    int lock_fd = open(lock_filename.c_str(), O_RDWR | O_CREAT, 0664);
+    bool replace_file = lock_fd >= 0;
+
+    if (replace_file) {
+        lockScoreFile(lock_fd);
+    }
+
+    // Opened once locked, as the previous update may have replaced the file
     if ((highscore_fp = fopen(config::files::scores.c_str(), "rb+")) == nullptr) {
+        if (lock_fd >= 0) {
+            (void) close(lock_fd);
+        }
         printMessage(("Error opening score file '" + config::files::scores + "'.").c_str());
         printMessage(CNIL);
         return;
     }
 
-    // Search file to find where to insert this character, if uid != 0 and
-    // find same uid/gender/race/class combo then exit without saving this score.
-    // Seek to the beginning of the file just to be safe.
-    (void) fseek(highscore_fp, (long) 0, SEEK_SET);
-
-    // Read version numbers from the score file, and check for validity.
-    auto version_maj = (uint8_t) getc(highscore_fp);
-    auto version_min = (uint8_t) getc(highscore_fp);
-    auto patch_level = (uint8_t) getc(highscore_fp);
+    if (!replace_file) {
+        lockScoreFile(fileno(highscore_fp));
+    }
 
-    // If this is a new score file, it should be empty.
-    // Write the current version numbers to the score file.
-    if (feof(highscore_fp) != 0) {
-        // Seek to the beginning of the file just to be safe.
-        (void) fseek(highscore_fp, (long) 0, SEEK_SET);
-
-        (void) putc(CURRENT_VERSION_MAJOR, highscore_fp);
-        (void) putc(CURRENT_VERSION_MINOR, highscore_fp);
-        (void) putc(CURRENT_VERSION_PATCH, highscore_fp);
-
-        // must fseek() before can change read/write mode
-        (void) fseek(highscore_fp, (long) 0, SEEK_CUR);
-    } else if (!validGameVersion(version_maj, version_min, patch_level)) {
+    std::vector<uint8_t> data;
+    if (!readScoreFile(highscore_fp, data)) {
         // No need to print a message, a subsequent call to
         // showScoresScreen() will print a message.
-        (void) fclose(highscore_fp);
+        closeScoreFile(lock_fd);
         return;
     }
 
-    // set the static fileptr in save.c to the high score file pointer
-    setFileptr(highscore_fp);
+    // Write the current version numbers to a new score file.
+    bool new_file = data.empty();
+    if (new_file) {
+        data = {CURRENT_VERSION_MAJOR, CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH};
+    }
 
-    HighScore_t old_entry{};
-    HighScore_t entry{};
+    int entries = (int) ((data.size() - HIGH_SCORE_HEADER_SIZE) / HIGH_SCORE_RECORD_SIZE);
 
-    int i = 0;
-    off_t curpos = ftell(highscore_fp);
-    readHighScore(old_entry);
+    // The entries are sorted by points, so a binary search finds
+    // where the new one goes: before the first with no more points.
+    int position = highScoreInsertPosition(data, entries, new_entry.points);
 
-    while (feof(highscore_fp) == 0) {
-        if (new_entry.points >= old_entry.points) {
-            break;
-        }
+    // only allow one thousand scores in the score file
+    if (position >= MAX_HIGH_SCORE_ENTRIES) {
+        closeScoreFile(lock_fd);
+        return;
+    }
 
-        // under unix, only allow one gender/race/class combo per person,
-        // on single user system, allow any number of entries, but try to
-        // prevent multiple entries per character by checking for case when
-        // birthdate/gender/race/class are the same, and game.character_died_from
-        // of score file entry is "(saved)"
-        if (((new_entry.uid != 0 && new_entry.uid == old_entry.uid) ||
-             (new_entry.uid == 0 && (strcmp(old_entry.died_from, "(saved)") == 0) && new_entry.birth_date == old_entry.birth_date)) &&
-            new_entry.gender == old_entry.gender && new_entry.race == old_entry.race && new_entry.character_class == old_entry.character_class) {
-            (void) fclose(highscore_fp);
-            return;
-        }
+    HighScore_t old_entry{};
 
-        // only allow one thousand scores in the score file
-        i++;
-        if (i >= MAX_HIGH_SCORE_ENTRIES) {
-            (void) fclose(highscore_fp);
-            return;
+    // under unix, only allow one gender/race/class combo per person,
+    // on single user system, allow any number of entries, but try to
+    // prevent multiple entries per character by checking for case when
+    // birthdate/gender/race/class are the same, and game.character_died_from
+    // of score file entry is "(saved)".
+    // A better score of the same character means this one is not recorded,
+    // a worse one is replaced by it.
+    int replaced = entries;
+    for (int i = 0; i < entries; i++) {
+        decodeHighScore(scoreRecord(data, i), old_entry);
+        if (isSameCharacter(new_entry, old_entry)) {
+            if (i < position) {
+                closeScoreFile(lock_fd);
+                return;
+            }
+            replaced = i;
+            break;
         }
-
-        curpos = ftell(highscore_fp);
-        readHighScore(old_entry);
     }
 
-    if (feof(highscore_fp) != 0) {
-        // write out new_entry at end of file
-        (void) fseek(highscore_fp, curpos, SEEK_SET);
-
-        saveHighScore(new_entry);
-    } else {
-        entry = new_entry;
-
-        while (feof(highscore_fp) == 0) {
-            (void) fseek(highscore_fp, -(long) sizeof(HighScore_t) - (long) sizeof(char), SEEK_CUR);
-
-            saveHighScore(entry);
+    // Shift the entries between the new one and the one it replaces (or the
+    // end of the file) down one place, and write that range back in one go.
+    if (replaced == entries) {
+        data.resize(data.size() + HIGH_SCORE_RECORD_SIZE);
+    }
+    (void) memmove(scoreRecord(data, position + 1), scoreRecord(data, position), (size_t) (replaced - position) * HIGH_SCORE_RECORD_SIZE);
+    encodeHighScore(new_entry, scoreRecord(data, position));
+
+    auto offset = (long) (HIGH_SCORE_HEADER_SIZE + (size_t) position * HIGH_SCORE_RECORD_SIZE);
+    auto length = (size_t) (replaced - position + 1) * HIGH_SCORE_RECORD_SIZE;
+    if (new_file) {
+        offset = 0;
+        length = data.size();
+    }
 
-            // under unix, only allow one gender/race/class combo per person,
-            // on single user system, allow any number of entries, but try to
-            // prevent multiple entries per character by checking for case when
-            // birth_date/gender/race/class are the same, and game.character_died_from
-            // of score file entry is "(saved)"
-            if (((new_entry.uid != 0 && new_entry.uid == old_entry.uid) ||
-                 (new_entry.uid == 0 && (strcmp(old_entry.died_from, "(saved)") == 0) && new_entry.birth_date == old_entry.birth_date)) &&
-                new_entry.gender == old_entry.gender && new_entry.race == old_entry.race && new_entry.character_class == old_entry.character_class) {
-                break;
-            }
-            entry = old_entry;
+    bool replaced_file = false;
 
-            // must fseek() before can change read/write mode
-            (void) fseek(highscore_fp, (long) 0, SEEK_CUR);
+    if (replace_file) {
+        struct stat file_info {};
+        int mode = fstat(fileno(highscore_fp), &file_info) == 0 ? (int) (file_info.st_mode & 07777) : 0644;
 
-            curpos = ftell(highscore_fp);
-            readHighScore(old_entry);
-        }
-        if (feof(highscore_fp) != 0) {
-            (void) fseek(highscore_fp, curpos, SEEK_SET);
+        replaced_file = fileReplace(config::files::scores, data, mode);
+    }
 
-            saveHighScore(entry);
-        }
+    if (!replaced_file) {
+        (void) fseek(highscore_fp, offset, SEEK_SET);
+        (void) fwrite(data.data() + offset, 1, length, highscore_fp);
     }
 
-    (void) fclose(highscore_fp);
+    closeScoreFile(lock_fd);
 }
 
 void showScoresScreen() {
@@ -177,37 +249,30 @@ void showScoresScreen() {
         return;
     }
 
-    (void) fseek(highscore_fp, (off_t) 0, SEEK_SET);
-
-    // Read version numbers from the score file, and check for validity.
-    auto version_maj = (uint8_t) getc(highscore_fp);
-    auto version_min = (uint8_t) getc(highscore_fp);
-    auto patch_level = (uint8_t) getc(highscore_fp);
-
-    // If score data present, check if a valid game version
-    if (feof(highscore_fp) == 0 && !validGameVersion(version_maj, version_min, patch_level)) {
+    std::vector<uint8_t> data;
+    if (!readScoreFile(highscore_fp, data)) {
         printMessage("Sorry. This score file is from a different version of umoria.");
         printMessage(CNIL);
         (void) fclose(highscore_fp);
         return;
     }
+    (void) fclose(highscore_fp);
 
-    // set the static fileptr in save.c to the high score file pointer
-    setFileptr(highscore_fp);
+    int entries = data.empty() ? 0 : (int) ((data.size() - HIGH_SCORE_HEADER_SIZE) / HIGH_SCORE_RECORD_SIZE);
 
     HighScore_t score{};
-    readHighScore(score);
 
     char msg[100];
 
     int i = 0;
     int rank = 1;
 
-    while (feof(highscore_fp) == 0) {
+    while (rank <= entries) {
         i = 1;
         clearScreen();
         // Put twenty scores on each page, on lines 2 through 21.
-        while ((feof(highscore_fp) == 0) && i < 21) {
+        while (rank <= entries && i < 21) {
+            decodeHighScore(scoreRecord(data, rank - 1), score);
             (void) sprintf(msg,                                               //
                            "%-4d%8d %-19.19s %c %-10.10s %-7.7s%3d %-22.22s", //
                            rank,                                              //
@@ -222,7 +287,6 @@ void showScoresScreen() {
             i++;
             putStringClearToEOL(msg, Coord_t{i, 0});
             rank++;
-            readHighScore(score);
         }
         putStringClearToEOL("Rank  Points Name              Sex Race       Class  Lvl Killed By", Coord_t{0, 0});
         eraseLine(Coord_t{1, 0});
@@ -231,8 +295,6 @@ void showScoresScreen() {
             break;
         }
     }
-
-    (void) fclose(highscore_fp);
 }
 
 // Calculates the total number of points earned -JWT-
@@ -28,11 +28,16 @@ typedef struct {
 // Number of entries allowed in the score file.
 constexpr uint16_t MAX_HIGH_SCORE_ENTRIES = 1000;
 
-extern FILE *highscore_fp;
+extern thread_local FILE *highscore_fp;
+
+// Size of a score entry in the score file, including its encryption byte.
+// The file holds the 3 version bytes, then the entries sorted by points.
+constexpr size_t HIGH_SCORE_RECORD_SIZE = 1 + 4 + 4 + 2 + 2 + 2 + 6 + PLAYER_NAME_SIZE + 25;
+constexpr size_t HIGH_SCORE_HEADER_SIZE = 3;
 
 // TODO: these are implemented in `game_save.cpp` so need moving.
-void saveHighScore(HighScore_t const &score);
-void readHighScore(HighScore_t &score);
+void encodeHighScore(HighScore_t const &score, uint8_t *record);
+void decodeHighScore(uint8_t const *record, HighScore_t &score);
 
 void recordNewHighScore();
 void showScoresScreen();
@@ -0,0 +1,669 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Game server: hosts many players in one process, over telnet connections
+
+#include "headers.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <map>
+#include <thread>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-server [OPTIONS]
+
+Hosts a game for every player connecting with telnet (or any client giving
+raw key presses to an 80x24 ANSI terminal). Players log in with a name,
+which picks their save file, so a saved character is played on at the next
+login. One thread reads all the connections, and each game is played on a
+thread of its own, waiting there for its player's keys.
+
+Spectators connect to the spectator port and give the login name of the
+player they want to watch. Each screen update is encoded once, and sent on
+to every spectator of the game, with a keyframe of the whole screen now and
+then, which a spectator joining (or falling behind) is started from.
+
+Options:
+    -p NUMBER    TCP port to listen on (default: 4000)
+    -w NUMBER    TCP port spectators connect to (default: 4001)
+    -d DIR       Directory of the save files, made if missing (default: saves)
+    -c NUMBER    Most players at once (default: 1000)
+    -a           Encode and write each player's screen updates on a thread
+                 of its own, so a slow connection never holds up the game,
+                 only has updates it fell behind on dropped for newer ones
+
+    -h           Display this message
+)";
+
+constexpr int LOGIN_NAME_SIZE = 16;
+constexpr size_t SESSION_MAX_QUEUED_KEYS = 4096;
+
+// A spectator with more than this much output waiting is started over,
+// from the last keyframe, rather than holding more and more of it.
+constexpr size_t SPECTATOR_MAX_QUEUED_OUTPUT = 64 * 1024;
+
+// Telnet, only as far as needed for a character at a time terminal
+constexpr uint8_t TELNET_IAC = 255;
+constexpr uint8_t TELNET_SB = 250;
+constexpr uint8_t TELNET_SE = 240;
+constexpr uint8_t TELNET_WILL = 251;
+constexpr uint8_t TELNET_DONT = 254;
+constexpr uint8_t TELNET_ECHO = 1;
+constexpr uint8_t TELNET_SUPPRESS_GO_AHEAD = 3;
+
+enum class TelnetState {
+    Data,
+    Command,    // After IAC
+    Option,     // After IAC WILL, WONT, DO or DONT
+    Suboption,  // Between IAC SB and IAC SE
+    SubCommand, // After IAC, in a suboption
+    Return,     // After CR, which may be followed by LF or NUL
+};
+
+class ServerSpectator_t;
+
+// A player's connection, shared by the connection thread
+// and the thread playing the player's game.
+class ServerSession_t {
+  public:
+    explicit ServerSession_t(int socket) : fd(socket) {}
+    ~ServerSession_t() { (void) close(fd); }
+
+    int fd;
+    TelnetState telnet = TelnetState::Data; // Only seen by the connection thread
+
+    std::mutex mutex;
+    std::condition_variable keys_ready;
+    std::deque<uint8_t> keys;
+    bool hung_up = false;
+
+    // The broadcast of the game's screen: the last keyframe, the deltas
+    // since, and the spectators they are queued for.
+    std::mutex broadcast_mutex;
+    std::string keyframe;
+    std::string deltas;
+    std::vector<ServerSpectator_t *> spectators;
+};
+
+// A spectator's connection, only seen by the connection thread,
+// but for `output`, which the game being watched queues.
+class ServerSpectator_t {
+  public:
+    explicit ServerSpectator_t(int socket) : fd(socket) {}
+    ~ServerSpectator_t() { (void) close(fd); }
+
+    int fd;
+    TelnetState telnet = TelnetState::Data;
+    std::string name;
+
+    std::shared_ptr<ServerSession_t> watching;
+    std::string output; // Locked by the broadcast mutex of `watching`
+    bool closing = false; // Closed once its output is sent
+};
+
+// Options of the game sessions
+static std::string server_save_directory = "saves";
+static bool server_asynchronous_output = false;
+
+// Written to wake the connection thread, when there is output for spectators
+static int wake_fd = -1;
+
+// The login names being played, a player can only be logged in once
+static std::mutex logins_mutex;
+static std::map<std::string, std::weak_ptr<ServerSession_t>> logins;
+
+static thread_local ServerSession_t *this_session = nullptr;
+
+// Queues a screen update of this session's game for its spectators
+static void sessionBroadcast(const char *data, size_t length, bool keyframe) {
+    ServerSession_t &session = *this_session;
+    std::lock_guard<std::mutex> lock(session.broadcast_mutex);
+
+    if (keyframe) {
+        session.keyframe.assign(data, length);
+        session.deltas.clear();
+    } else {
+        session.deltas.append(data, length);
+    }
+
+    for (auto *spectator : session.spectators) {
+        if (spectator->output.size() > SPECTATOR_MAX_QUEUED_OUTPUT) {
+            spectator->output = session.keyframe + session.deltas;
+        } else {
+            spectator->output.append(data, length);
+        }
+    }
+
+    if (!session.spectators.empty()) {
+        (void) !write(wake_fd, "", 1);
+    }
+}
+
+// Has the calling thread write to the session `owner`, as its game's does
+static void sessionWriterSetup(void *owner) {
+    this_session = static_cast<ServerSession_t *>(owner);
+}
+
+static void sessionWrite(const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(this_session->fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return;
+        }
+
+        data += sent;
+        length -= (size_t) sent;
+    }
+}
+
+static int sessionReadKey() {
+    ServerSession_t &session = *this_session;
+    std::unique_lock<std::mutex> lock(session.mutex);
+
+    session.keys_ready.wait(lock, [&session]() { return !session.keys.empty() || session.hung_up; });
+
+    if (session.keys.empty()) {
+        return EOF;
+    }
+
+    int key = session.keys.front();
+    session.keys.pop_front();
+    return key;
+}
+
+static bool sessionCheckKey() {
+    ServerSession_t &session = *this_session;
+    std::lock_guard<std::mutex> lock(session.mutex);
+
+    if (session.keys.empty()) {
+        return false;
+    }
+
+    session.keys.pop_front();
+    return true;
+}
+
+// Reads the name the player logs in with, only letters and digits are kept
+static bool sessionReadLoginName(std::string &name) {
+    const char *prompt = "\033[H\033[2JUmoria login: ";
+    sessionWrite(prompt, strlen(prompt));
+
+    name.clear();
+
+    while (true) {
+        int key = sessionReadKey();
+
+        if (key == EOF || key == CTRL_KEY('D')) {
+            return false;
+        }
+
+        if (key == '\r' && !name.empty()) {
+            sessionWrite("\r\n", 2);
+            return true;
+        }
+
+        if ((key == DELETE || key == CTRL_KEY('H')) && !name.empty()) {
+            name.pop_back();
+            sessionWrite("\b \b", 3);
+        } else if (isalnum(key) != 0 && name.size() < LOGIN_NAME_SIZE - 1) {
+            name += (char) key;
+            auto ch = (char) key;
+            sessionWrite(&ch, 1);
+        }
+    }
+}
+
+// Plays the game of one session, its thread being the game's own
+static void serverPlaySession(std::shared_ptr<ServerSession_t> session, uint32_t seed) {
+    this_session = session.get();
+
+    std::string name;
+    if (sessionReadLoginName(name)) {
+        bool logged_in;
+        {
+            std::lock_guard<std::mutex> lock(logins_mutex);
+            logged_in = logins.emplace(name, session).second;
+        }
+
+        if (!logged_in) {
+            const char *message = "That character is already being played.\r\n";
+            sessionWrite(message, strlen(message));
+        } else {
+            config::files::save_game = server_save_directory + "/" + name + ".sav";
+
+            RemoteTerminal_t io{sessionReadKey, sessionCheckKey, sessionWrite, sessionBroadcast, nullptr, nullptr};
+            if (server_asynchronous_output) {
+                io.writer_setup = sessionWriterSetup;
+                io.owner = session.get();
+            }
+            (void) terminalInitializeRemote(io);
+
+            // The game ends the session where it would exit the program
+            try {
+                startMoria((int) seed, false);
+            } catch (RemoteSessionEnded_t const &) {
+            }
+
+            std::lock_guard<std::mutex> lock(logins_mutex);
+            logins.erase(name);
+        }
+    }
+
+    // The connection thread sees the connection closed, and lets it go
+    (void) shutdown(session->fd, SHUT_RDWR);
+}
+
+// The key presses in `data`, with the telnet commands taken out
+static void telnetKeys(TelnetState &state, uint8_t const *data, size_t length, std::string &keys) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+
+        switch (state) {
+            case TelnetState::Return:
+                state = TelnetState::Data;
+                if (byte == '\n' || byte == '\0') {
+                    break;
+                }
+                // fall through
+            case TelnetState::Data:
+                if (byte == TELNET_IAC) {
+                    state = TelnetState::Command;
+                } else {
+                    keys += (char) byte;
+                    if (byte == '\r') {
+                        state = TelnetState::Return;
+                    }
+                }
+                break;
+            case TelnetState::Command:
+                if (byte == TELNET_IAC) {
+                    keys += (char) byte;
+                    state = TelnetState::Data;
+                } else if (byte == TELNET_SB) {
+                    state = TelnetState::Suboption;
+                } else if (byte >= TELNET_WILL && byte <= TELNET_DONT) {
+                    state = TelnetState::Option;
+                } else {
+                    state = TelnetState::Data;
+                }
+                break;
+            case TelnetState::Option:
+                state = TelnetState::Data;
+                break;
+            case TelnetState::Suboption:
+                if (byte == TELNET_IAC) {
+                    state = TelnetState::SubCommand;
+                }
+                break;
+            case TelnetState::SubCommand:
+                state = byte == TELNET_SE ? TelnetState::Data : TelnetState::Suboption;
+                break;
+        }
+    }
+}
+
+// Queues the player's key presses
+static void sessionReceive(ServerSession_t &session, uint8_t const *data, size_t length) {
+    std::string keys;
+    telnetKeys(session.telnet, data, length, keys);
+
+    std::lock_guard<std::mutex> lock(session.mutex);
+
+    for (auto key : keys) {
+        if (session.keys.size() < SESSION_MAX_QUEUED_KEYS) {
+            session.keys.push_back((uint8_t) key);
+        }
+    }
+
+    session.keys_ready.notify_one();
+}
+
+static void sessionHangUp(ServerSession_t &session) {
+    std::lock_guard<std::mutex> lock(session.mutex);
+    session.hung_up = true;
+    session.keys_ready.notify_one();
+}
+
+// Sends what it can of the spectator's output, without waiting
+static void spectatorSend(ServerSpectator_t &spectator) {
+    std::lock_guard<std::mutex> lock(spectator.watching->broadcast_mutex);
+
+    ssize_t sent = send(spectator.fd, spectator.output.data(), spectator.output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent > 0) {
+        spectator.output.erase(0, (size_t) sent);
+    }
+}
+
+static bool spectatorHasOutput(ServerSpectator_t &spectator) {
+    if (spectator.watching == nullptr) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(spectator.watching->broadcast_mutex);
+    return !spectator.output.empty();
+}
+
+// Stops the spectator's output, with a last message, and has it closed
+static void spectatorStop(ServerSpectator_t &spectator, const char *message) {
+    spectator.closing = true;
+
+    if (spectator.watching == nullptr) {
+        return;
+    }
+
+    ServerSession_t &session = *spectator.watching;
+    std::lock_guard<std::mutex> lock(session.broadcast_mutex);
+
+    auto &spectators = session.spectators;
+    spectators.erase(std::remove(spectators.begin(), spectators.end(), &spectator), spectators.end());
+    spectator.output += message;
+}
+
+// Starts the spectator on the game of the player logged in as `name`, from
+// its last keyframe and the deltas since.
+static bool spectatorWatch(ServerSpectator_t &spectator, std::string const &name) {
+    std::shared_ptr<ServerSession_t> session;
+    {
+        std::lock_guard<std::mutex> lock(logins_mutex);
+        auto login = logins.find(name);
+        if (login != logins.end()) {
+            session = login->second.lock();
+        }
+    }
+
+    if (session == nullptr) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(session->broadcast_mutex);
+    spectator.output = session->keyframe + session->deltas;
+    session->spectators.push_back(&spectator);
+    spectator.watching = session;
+
+    return true;
+}
+
+// Reads the name of the player to watch, then only 'q' to stop watching
+static void spectatorReceive(ServerSpectator_t &spectator, uint8_t const *data, size_t length) {
+    std::string keys;
+    telnetKeys(spectator.telnet, data, length, keys);
+
+    for (auto key : keys) {
+        if (spectator.closing) {
+            return;
+        }
+
+        if (spectator.watching != nullptr) {
+            if (key == 'q' || key == CTRL_KEY('D')) {
+                spectatorStop(spectator, "\033[24;1H\r\n");
+            }
+            continue;
+        }
+
+        std::string echo;
+        if (key == '\r' && !spectator.name.empty()) {
+            if (spectatorWatch(spectator, spectator.name)) {
+                continue;
+            }
+            echo = "\r\nNo one is playing as " + spectator.name + ".\r\nWatch whom? ";
+            spectator.name.clear();
+        } else if ((key == DELETE || key == CTRL_KEY('H')) && !spectator.name.empty()) {
+            spectator.name.pop_back();
+            echo = "\b \b";
+        } else if (key == CTRL_KEY('D')) {
+            spectator.closing = true;
+        } else if (isalnum(key) != 0 && spectator.name.size() < LOGIN_NAME_SIZE - 1) {
+            spectator.name += key;
+            echo = key;
+        }
+
+        (void) send(spectator.fd, echo.data(), echo.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+}
+
+static int openListeningSocket(int port) {
+    int fd = socket(AF_INET6, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int on = 1;
+    int off = 0;
+    (void) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    (void) setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+    sockaddr_in6 address{};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons((uint16_t) port);
+
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(fd, 64) < 0) {
+        (void) close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int main(int argc, char *argv[]) {
+    int port = 4000;
+    int spectator_port = 4001;
+    int max_sessions = 1000;
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 'a':
+                server_asynchronous_output = true;
+                break;
+            case 'p':
+                ok = toolOptionNumber(options, port) && port < 65536;
+                break;
+            case 'w':
+                ok = toolOptionNumber(options, spectator_port) && spectator_port < 65536;
+                break;
+            case 'd':
+                value = toolOptionValue(options);
+                ok = value != nullptr;
+                if (ok) {
+                    server_save_directory = value;
+                }
+                break;
+            case 'c':
+                ok = toolOptionNumber(options, max_sessions);
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    if (!initializeScoreFile()) {
+        fprintf(stderr, "Can't open score file '%s'\n", config::files::scores.c_str());
+        return 1;
+    }
+    if (!checkFilePermissions()) {
+        return 1;
+    }
+
+    if (mkdir(server_save_directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        fprintf(stderr, "Can't make the save directory '%s'\n", server_save_directory.c_str());
+        return 1;
+    }
+
+    int listen_fd = openListeningSocket(port);
+    if (listen_fd < 0) {
+        fprintf(stderr, "Can't listen on port %d\n", port);
+        return 1;
+    }
+
+    int spectator_listen_fd = openListeningSocket(spectator_port);
+    if (spectator_listen_fd < 0) {
+        fprintf(stderr, "Can't listen on port %d\n", spectator_port);
+        return 1;
+    }
+
+    int wake_fds[2];
+    if (pipe2(wake_fds, O_NONBLOCK) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    wake_fd = wake_fds[1];
+
+    (void) signal(SIGPIPE, SIG_IGN);
+
+    std::random_device random_seeds;
+    std::uniform_int_distribution<uint32_t> seeds(1, INT_MAX);
+
+    // Telnet clients are asked to send each key press as it is typed, and
+    // not to echo them, which the game does where it wants them shown.
+    const uint8_t negotiation[] = {TELNET_IAC, TELNET_WILL, TELNET_ECHO, TELNET_IAC, TELNET_WILL, TELNET_SUPPRESS_GO_AHEAD};
+
+    std::vector<std::shared_ptr<ServerSession_t>> sessions;
+    std::vector<std::unique_ptr<ServerSpectator_t>> spectators;
+    std::vector<pollfd> polled;
+
+    while (true) {
+        polled.clear();
+        polled.push_back(pollfd{listen_fd, POLLIN, 0});
+        polled.push_back(pollfd{spectator_listen_fd, POLLIN, 0});
+        polled.push_back(pollfd{wake_fds[0], POLLIN, 0});
+        for (auto const &session : sessions) {
+            polled.push_back(pollfd{session->fd, POLLIN, 0});
+        }
+        for (auto const &spectator : spectators) {
+            polled.push_back(pollfd{spectator->fd, (short) (spectatorHasOutput(*spectator) ? POLLIN | POLLOUT : POLLIN), 0});
+        }
+
+        if (poll(polled.data(), (nfds_t) polled.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            return 1;
+        }
+
+        if ((polled[2].revents & POLLIN) != 0) {
+            uint8_t drained[64];
+            while (read(wake_fds[0], drained, sizeof(drained)) > 0) {
+            }
+        }
+
+        // Connections are only let go, from the last, once they are seen
+        // to, so the entries of `polled` below still match them.
+        size_t polled_sessions = sessions.size();
+
+        for (size_t i = spectators.size(); i-- > 0;) {
+            ServerSpectator_t &spectator = *spectators[i];
+            short revents = polled[3 + polled_sessions + i].revents;
+
+            if ((revents & POLLOUT) != 0) {
+                spectatorSend(spectator);
+            }
+
+            if ((revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                uint8_t buffer[512];
+                ssize_t count = read(spectator.fd, buffer, sizeof(buffer));
+
+                if (count > 0) {
+                    spectatorReceive(spectator, buffer, (size_t) count);
+                } else if (count == 0 || errno != EINTR) {
+                    spectatorStop(spectator, "");
+                    spectator.output.clear();
+                }
+            }
+
+            if (spectator.closing && !spectatorHasOutput(spectator)) {
+                spectatorStop(spectator, "");
+                spectators.erase(spectators.begin() + (long) i);
+            }
+        }
+
+        for (size_t i = polled_sessions; i-- > 0;) {
+            if (polled[3 + i].revents == 0) {
+                continue;
+            }
+
+            uint8_t buffer[512];
+            ssize_t count = read(sessions[i]->fd, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (count > 0) {
+                sessionReceive(*sessions[i], buffer, (size_t) count);
+            } else {
+                // Its game notices at its next key press, and is saved
+                sessionHangUp(*sessions[i]);
+
+                for (auto &spectator : spectators) {
+                    if (spectator->watching == sessions[i]) {
+                        spectatorStop(*spectator, "\033[24;1H\r\nThe game has ended.\r\n");
+                    }
+                }
+                sessions.erase(sessions.begin() + (long) i);
+            }
+        }
+
+        if ((polled[0].revents & POLLIN) != 0) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+
+            if ((int) sessions.size() >= max_sessions) {
+                const char *message = "The server is full, try again later.\r\n";
+                (void) send(fd, message, strlen(message), MSG_NOSIGNAL);
+                (void) close(fd);
+                continue;
+            }
+
+            int on = 1;
+            (void) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            (void) send(fd, negotiation, sizeof(negotiation), MSG_NOSIGNAL);
+
+            auto session = std::make_shared<ServerSession_t>(fd);
+            sessions.push_back(session);
+            std::thread(serverPlaySession, session, seeds(random_seeds)).detach();
+        }
+
+        if ((polled[1].revents & POLLIN) != 0) {
+            int fd = accept(spectator_listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+
+            const char *prompt = "\033[H\033[2JWatch whom? ";
+            (void) send(fd, negotiation, sizeof(negotiation), MSG_NOSIGNAL);
+            (void) send(fd, prompt, strlen(prompt), MSG_NOSIGNAL);
+
+            spectators.push_back(std::unique_ptr<ServerSpectator_t>(new ServerSpectator_t(fd)));
+        }
+    }
+}
@@ -0,0 +1,254 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Batch simulator: plays many seeded games in parallel without a terminal
+
+#include "headers.h"
+
+#include <vector>
+
+static const char *usage_instructions = R"(
+Usage:
+    umoria-sim [OPTIONS]
+
+Plays complete games headless and prints one CSV outcome record per game.
+
+Options:
+    -s NUMBER    First game seed (default: 1)
+    -c NUMBER    Number of games, using consecutive seeds (default: 100)
+    -j NUMBER    Number of worker threads (default: all cores)
+    -t NUMBER    Maximum game turns per game (default: 10000)
+    -k FILE      Replay the key presses in FILE, instead of a random agent
+    -l HxW       Dungeon level size in tiles (default: 66x198)
+    -r           Use the counter based RNG instead of the classic Lehmer RNG
+    -p           Build the levels next to the current one in the background
+    -e           Move the unseen monsters off the screen only every few turns
+    -f           Monsters follow the shortest path to the player
+    -o           Pick objects and monsters from tables instead of the classic rolls
+    -u           Restock the stores only once they are entered
+
+    -h           Display this message
+)";
+
+// Outcome of a single simulated game
+typedef struct {
+    uint32_t seed;
+    int32_t turns;
+    int16_t dungeon_depth;
+    uint16_t max_dungeon_depth;
+    uint16_t level;
+    int32_t experience;
+    int32_t gold;
+    bool character_is_dead;
+    vtype_t died_from;
+} SimOutcome_t;
+
+// Options of the simulated games
+static int32_t sim_max_turns = 10000;
+static std::string sim_key_script;
+static bool sim_counter_rng = false;
+static bool sim_pregenerate_levels = false;
+static bool sim_selection_tables = false;
+static bool sim_flow_pathing = false;
+static bool sim_coarse_distant_monsters = false;
+static bool sim_lazy_store_maintenance = false;
+static int sim_level_height = MAX_HEIGHT;
+static int sim_level_width = MAX_WIDTH;
+
+// Random agent key macros; only commands which can not end the
+// process (no save/exit, no shell, no character file) are used.
+static const char *agent_macros[] = {
+    "1", "2", "3", "4", "6", "7", "8", "9",
+    ".1", ".2", ".3", ".4", ".6", ".7", ".8", ".9",
+    "R&\r", "s", "<", ">", " ", "\033",
+    "Ea\033", "qa\033", "ra\033",
+};
+constexpr int AGENT_MACRO_COUNT = sizeof(agent_macros) / sizeof(agent_macros[0]);
+
+// Character creation: Human, male, accept stats, a class chosen by the
+// seed, name, then continue past the "press any key" prompt.
+static const char *character_creation_keys = "am\033?Simulation\r ";
+constexpr int CLASS_KEY_POSITION = 3;
+
+// Per game key source state
+static thread_local char creation_keys[32];
+static thread_local const char *pending_keys = nullptr;
+static thread_local size_t script_position = 0;
+static thread_local uint32_t agent_state = 0;
+static thread_local int32_t keys_without_turn = 0;
+static thread_local int32_t last_seen_turn = 0;
+
+// xorshift32, kept apart from the game RNG so the agent does not perturb it
+static uint32_t agentRandom() {
+    agent_state ^= agent_state << 13;
+    agent_state ^= agent_state >> 17;
+    agent_state ^= agent_state << 5;
+    return agent_state;
+}
+
+// Give up on a game which stops advancing, e.g. stuck in a prompt loop
+constexpr int32_t MAX_KEYS_WITHOUT_TURN = 5000;
+
+static int simulationKeySource() {
+    if (pending_keys != nullptr && *pending_keys != '\0') {
+        return *pending_keys++;
+    }
+
+    if (!game.character_generated) {
+        // A character creation prompt that wasn't expected, accept the default.
+        return ESCAPE;
+    }
+
+    if (dg.game_turn != last_seen_turn) {
+        last_seen_turn = dg.game_turn;
+        keys_without_turn = 0;
+    }
+
+    if (dg.game_turn >= sim_max_turns || ++keys_without_turn > MAX_KEYS_WITHOUT_TURN) {
+        return EOF;
+    }
+
+    if (!sim_key_script.empty()) {
+        if (script_position >= sim_key_script.size()) {
+            return EOF;
+        }
+        return sim_key_script[script_position++];
+    }
+
+    pending_keys = agent_macros[agentRandom() % AGENT_MACRO_COUNT];
+
+    return *pending_keys++;
+}
+
+// Plays one game, on a new thread of its own
+static void simulateGame(uint32_t seed, SimOutcome_t &outcome) {
+    (void) strcpy(creation_keys, character_creation_keys);
+    creation_keys[CLASS_KEY_POSITION] = (char) ('a' + seed % PLAYER_MAX_CLASSES);
+
+    pending_keys = creation_keys;
+    script_position = 0;
+    agent_state = seed * 2654435761u + 1;
+
+    (void) terminalInitializeHeadless(simulationKeySource);
+
+    if (sim_counter_rng) {
+        setRandomMode(RandomMode::Counter);
+    }
+    if (sim_selection_tables) {
+        setSelectionMode(SelectionMode::Tables);
+    }
+    if (sim_flow_pathing) {
+        setPathingMode(PathingMode::Flow);
+    }
+
+    (void) dungeonSetSize(sim_level_height, sim_level_width);
+    game.pregenerate_levels = sim_pregenerate_levels;
+    game.lazy_store_maintenance = sim_lazy_store_maintenance;
+    game.coarse_distant_monsters = sim_coarse_distant_monsters;
+
+    simulateMoria(seed);
+
+    outcome.seed = seed;
+    outcome.turns = dg.game_turn;
+    outcome.dungeon_depth = dg.current_level;
+    outcome.max_dungeon_depth = py.misc.max_dungeon_depth;
+    outcome.level = py.misc.level;
+    outcome.experience = py.misc.exp;
+    outcome.gold = py.misc.au;
+    outcome.character_is_dead = game.character_is_dead;
+    (void) strcpy(outcome.died_from, game.character_is_dead ? game.character_died_from : "");
+}
+
+static bool readKeyScript(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    int ch;
+    while ((ch = getc(file)) != EOF) {
+        sim_key_script += (char) ch;
+    }
+    (void) fclose(file);
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int first_seed = 1;
+    int game_count = 100;
+    int thread_count = toolThreadCount();
+
+    ToolOptions_t options;
+    toolOptionsStart(options, argc, argv);
+
+    while (toolOptionsNext(options)) {
+        const char *value;
+        bool ok = true;
+
+        switch (options.option) {
+            case 'r':
+                sim_counter_rng = true;
+                break;
+            case 'p':
+                sim_pregenerate_levels = true;
+                break;
+            case 'o':
+                sim_selection_tables = true;
+                break;
+            case 'f':
+                sim_flow_pathing = true;
+                break;
+            case 'e':
+                sim_coarse_distant_monsters = true;
+                break;
+            case 'u':
+                sim_lazy_store_maintenance = true;
+                break;
+            case 's':
+                ok = toolOptionNumber(options, first_seed);
+                break;
+            case 'c':
+                ok = toolOptionNumber(options, game_count);
+                break;
+            case 'j':
+                ok = toolOptionNumber(options, thread_count);
+                break;
+            case 't':
+                ok = toolOptionNumber(options, sim_max_turns);
+                break;
+            case 'k':
+                value = toolOptionValue(options);
+                ok = value != nullptr && readKeyScript(value);
+                break;
+            case 'l':
+                // Validated here, as each game thread sets its own size
+                value = toolOptionValue(options);
+                ok = value != nullptr && stringToDimensions(value, sim_level_height, sim_level_width) && dungeonSetSize(sim_level_height, sim_level_width);
+                break;
+            default:
+                printf("%s", usage_instructions);
+                return 0;
+        }
+
+        if (!ok) {
+            return toolOptionInvalid(options);
+        }
+    }
+
+    std::vector<SimOutcome_t> outcomes((size_t) game_count);
+
+    toolPlayGames(game_count, thread_count, [&](int id) {
+        simulateGame((uint32_t)(first_seed + id), outcomes[id]);
+    });
+
+    printf("seed,turns,depth,max_depth,level,experience,gold,dead,died_from\n");
+    for (auto const &outcome : outcomes) {
+        printf("%u,%d,%d,%u,%u,%d,%d,%d,\"%s\"\n", outcome.seed, outcome.turns, outcome.dungeon_depth, outcome.max_dungeon_depth, outcome.level, outcome.experience, outcome.gold, outcome.character_is_dead ? 1 : 0,
+               outcome.died_from);
+    }
+
+    return 0;
+}
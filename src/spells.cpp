@@ -106,22 +106,16 @@ int castSpellGetId(const char *prompt, int item_id, int &spell_id, int &spell_ch
     uint32_t flags = py.inventory[item_id].flags;
     int first_spell = getAndClearFirstBit(flags);
 
-    // Get flags again since getAndClearFirstBit modified variable.
-    flags = py.inventory[item_id].flags & py.flags.spells_learnt;
-
-    // TODO(cook) move access to `magic_spells[]` directly to the for loop it's used in, below?
-    Spell_t *spells = magic_spells[py.misc.class_id - 1];
+    // Get flags again since getAndClearFirstBit modified variable,
+    // keeping the known spells of the book the player can cast.
+    flags = py.inventory[item_id].flags & py.flags.spells_learnt & playerSpellsUpToLevel(py.misc.level);
 
     int spell_count = 0;
     int spell_list[31];
 
     while (flags != 0u) {
-        int pos = getAndClearFirstBit(flags);
-
-        if (spells[pos].level_required <= py.misc.level) {
-            spell_list[spell_count] = pos;
-            spell_count++;
-        }
+        spell_list[spell_count] = getAndClearFirstBit(flags);
+        spell_count++;
     }
 
     if (spell_count == 0) {
@@ -157,7 +151,7 @@ bool spellDetectTreasureWithinVicinity() {
 
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id == TV_GOLD && !caveTileVisible(coord)) {
                 tile.field_mark = true;
@@ -178,7 +172,7 @@ bool spellDetectObjectsWithinVicinity() {
 
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id < TV_MAX_OBJECT && !caveTileVisible(coord)) {
                 tile.field_mark = true;
@@ -195,24 +189,20 @@ bool spellDetectObjectsWithinVicinity() {
 bool spellDetectTrapsWithinVicinity() {
     bool detected = false;
 
-    Coord_t coord = Coord_t{0, 0};
-
-    for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
-        for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+    Coord_t coords[LEVEL_MAX_OBJECTS];
+    int count = treasuresWithinArea(Coord_t{dg.panel.top, dg.panel.left}, Coord_t{dg.panel.bottom, dg.panel.right}, coords);
 
-            if (tile.treasure_id == 0) {
-                continue;
-            }
+    for (int i = 0; i < count; i++) {
+        Coord_t const &coord = coords[i];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
-            if (game.treasure.list[tile.treasure_id].category_id == TV_INVIS_TRAP) {
-                tile.field_mark = true;
-                trapChangeVisibility(coord);
-                detected = true;
-            } else if (game.treasure.list[tile.treasure_id].category_id == TV_CHEST) {
-                Inventory_t &item = game.treasure.list[tile.treasure_id];
-                spellItemIdentifyAndRemoveRandomInscription(item);
-            }
+        if (game.treasure.list[tile.treasure_id].category_id == TV_INVIS_TRAP) {
+            tile.field_mark = true;
+            trapChangeVisibility(coord);
+            detected = true;
+        } else if (game.treasure.list[tile.treasure_id].category_id == TV_CHEST) {
+            Inventory_t &item = game.treasure.list[tile.treasure_id];
+            spellItemIdentifyAndRemoveRandomInscription(item);
         }
     }
 
@@ -223,29 +213,25 @@ bool spellDetectTrapsWithinVicinity() {
 bool spellDetectSecretDoorssWithinVicinity() {
     bool detected = false;
 
-    Coord_t coord = Coord_t{0, 0};
-
-    for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
-        for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+    Coord_t coords[LEVEL_MAX_OBJECTS];
+    int count = treasuresWithinArea(Coord_t{dg.panel.top, dg.panel.left}, Coord_t{dg.panel.bottom, dg.panel.right}, coords);
 
-            if (tile.treasure_id == 0) {
-                continue;
-            }
+    for (int i = 0; i < count; i++) {
+        Coord_t const &coord = coords[i];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
-            if (game.treasure.list[tile.treasure_id].category_id == TV_SECRET_DOOR) {
-                // Secret doors
+        if (game.treasure.list[tile.treasure_id].category_id == TV_SECRET_DOOR) {
+            // Secret doors
 
-                tile.field_mark = true;
-                trapChangeVisibility(coord);
-                detected = true;
-            } else if ((game.treasure.list[tile.treasure_id].category_id == TV_UP_STAIR || game.treasure.list[tile.treasure_id].category_id == TV_DOWN_STAIR) && !tile.field_mark) {
-                // Staircases
+            tile.field_mark = true;
+            trapChangeVisibility(coord);
+            detected = true;
+        } else if ((game.treasure.list[tile.treasure_id].category_id == TV_UP_STAIR || game.treasure.list[tile.treasure_id].category_id == TV_DOWN_STAIR) && !tile.field_mark) {
+            // Staircases
 
-                tile.field_mark = true;
-                dungeonLiteSpot(coord);
-                detected = true;
-            }
+            tile.field_mark = true;
+            dungeonLiteSpot(coord);
+            detected = true;
         }
     }
 
@@ -256,8 +242,11 @@ bool spellDetectSecretDoorssWithinVicinity() {
 bool spellDetectInvisibleCreaturesWithinVicinity() {
     bool detected = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
-        Monster_t &monster = monsters[id];
+    uint8_t ids[MON_TOTAL_ALLOCATIONS];
+    int count = monstersWithinArea(Coord_t{dg.panel.top, dg.panel.left}, Coord_t{dg.panel.bottom, dg.panel.right}, ids);
+
+    for (int i = 0; i < count; i++) {
+        Monster_t &monster = monsters[ids[i]];
 
         if (coordInsidePanel(Coord_t{monster.pos.y, monster.pos.x}) && ((creatures_list[monster.creature_id].movement & config::monsters::move::CM_INVISIBLE) != 0u)) {
             monster.lit = true;
@@ -324,7 +313,7 @@ bool spellDarkenArea(Coord_t coord) {
 
         for (spot.y = start_row; spot.y <= end_row; spot.y++) {
             for (spot.x = start_col; spot.x <= end_col; spot.x++) {
-                Tile_t &tile = dg.floor[spot.y][spot.x];
+                Tile_t tile = dg.floor[spot.y][spot.x];
 
                 if (tile.perma_lit_room && tile.feature_id <= MAX_CAVE_FLOOR) {
                     tile.permanent_light = false;
@@ -341,7 +330,7 @@ bool spellDarkenArea(Coord_t coord) {
     } else {
         for (spot.y = coord.y - 1; spot.y <= coord.y + 1; spot.y++) {
             for (spot.x = coord.x - 1; spot.x <= coord.x + 1; spot.x++) {
-                Tile_t &tile = dg.floor[spot.y][spot.x];
+                Tile_t tile = dg.floor[spot.y][spot.x];
 
                 if (tile.feature_id == TILE_CORR_FLOOR && tile.permanent_light) {
                     // permanent_light could have been set by star-lite wand, etc
@@ -359,18 +348,52 @@ bool spellDarkenArea(Coord_t coord) {
     return darkened;
 }
 
-static void dungeonLightAreaAroundFloorTile(Coord_t coord) {
-    Coord_t spot = Coord_t{0, 0};
+// Lights the walls, and marks the visible objects, next to each floor tile in
+// the area. The floor tiles of every row are gathered into a bit mask, so the
+// walls around them are lit a word at a time.
+static void dungeonLightAreaAroundFloorTiles(int row_min, int row_max, int col_min, int col_max) {
+    DungeonFloor_t &floor = dg.floor;
+    int words = floor.row_words;
 
-    for (spot.y = coord.y - 1; spot.y <= coord.y + 1; spot.y++) {
-        for (spot.x = coord.x - 1; spot.x <= coord.x + 1; spot.x++) {
-            Tile_t &tile = dg.floor[spot.y][spot.x];
+    // Floor masks for the area rows, with two empty rows above and below
+    std::vector<uint64_t> floor_masks((size_t)(row_max - row_min + 5) * words, 0);
 
-            if (tile.feature_id >= MIN_CAVE_WALL) {
-                tile.permanent_light = true;
-            } else if (tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id >= TV_MIN_VISIBLE &&
-                       game.treasure.list[tile.treasure_id].category_id <= TV_MAX_VISIBLE) {
-                tile.field_mark = true;
+    for (int y = row_min; y <= row_max; y++) {
+        uint64_t *mask = &floor_masks[(size_t)(y - row_min + 2) * words];
+        uint8_t const *features = &floor.features[(size_t) y * floor.columns];
+
+        for (int x = col_min; x <= col_max; x++) {
+            if (features[x] <= MAX_CAVE_FLOOR) {
+                mask[x >> 6] |= DungeonFloor_t::bitMask(x);
+            }
+        }
+    }
+
+    for (int y = row_min - 1; y <= row_max + 1; y++) {
+        uint64_t const *above = &floor_masks[(size_t)(y - row_min + 1) * words];
+        uint64_t const *row = above + words;
+        uint64_t const *below = row + words;
+
+        for (int w = 0; w < words; w++) {
+            uint64_t near = above[w] | row[w] | below[w];
+            uint64_t previous = w > 0 ? above[w - 1] | row[w - 1] | below[w - 1] : 0;
+            uint64_t next = w + 1 < words ? above[w + 1] | row[w + 1] | below[w + 1] : 0;
+
+            // Tiles with a floor tile in the 3x3 square around them
+            uint64_t area = near | (near << 1) | (previous >> 63) | (near >> 1) | (next << 63);
+
+            size_t word = floor.wordIndex(y, w << 6);
+            floor.permanent_lights[word] |= area & floor.walls[word];
+
+            uint64_t open = area & ~floor.walls[word];
+            int bit;
+            while ((bit = getAndClearFirstBit(open)) >= 0) {
+                int x = (w << 6) + bit;
+                uint8_t treasure_id = floor.treasures[(size_t) y * floor.columns + x];
+
+                if (treasure_id != 0 && game.treasure.list[treasure_id].category_id >= TV_MIN_VISIBLE && game.treasure.list[treasure_id].category_id <= TV_MAX_VISIBLE) {
+                    floor.field_marks[word] |= DungeonFloor_t::bitMask(x);
+                }
             }
         }
     }
@@ -383,15 +406,13 @@ void spellMapCurrentArea() {
     int col_min = dg.panel.left - randomNumber(20);
     int col_max = dg.panel.right + randomNumber(20);
 
-    Coord_t coord = Coord_t{0, 0};
+    // Only the floor tiles inside the boundary walls light up the area
+    row_min = std::max(row_min, 1);
+    row_max = std::min(row_max, dg.height - 2);
+    col_min = std::max(col_min, 1);
+    col_max = std::min(col_max, dg.width - 2);
 
-    for (coord.y = row_min; coord.y <= row_max; coord.y++) {
-        for (coord.x = col_min; coord.x <= col_max; coord.x++) {
-            if (coordInBounds(coord) && dg.floor[coord.y][coord.x].feature_id <= MAX_CAVE_FLOOR) {
-                dungeonLightAreaAroundFloorTile(coord);
-            }
-        }
-    }
+    dungeonLightAreaAroundFloorTiles(row_min, row_max, col_min, col_max);
 
     drawDungeonPanel();
 }
@@ -493,7 +514,7 @@ bool spellSurroundPlayerWithDoors() {
                 continue;
             }
 
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.feature_id <= MAX_CAVE_FLOOR) {
                 if (tile.treasure_id != 0) {
@@ -502,7 +523,7 @@ bool spellSurroundPlayerWithDoors() {
 
                 int free_id = popt();
                 tile.feature_id = TILE_BLOCKED_FLOOR;
-                tile.treasure_id = (uint8_t) free_id;
+                dungeonSetTreasureId(coord, free_id);
 
                 inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[free_id]);
                 dungeonLiteSpot(coord);
@@ -555,8 +576,11 @@ bool spellDestroyAdjacentDoorsTraps() {
 bool spellDetectMonsters() {
     bool detected = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
-        Monster_t &monster = monsters[id];
+    uint8_t ids[MON_TOTAL_ALLOCATIONS];
+    int count = monstersWithinArea(Coord_t{dg.panel.top, dg.panel.left}, Coord_t{dg.panel.bottom, dg.panel.right}, ids);
+
+    for (int i = 0; i < count; i++) {
+        Monster_t &monster = monsters[ids[i]];
 
         if (coordInsidePanel(Coord_t{monster.pos.y, monster.pos.x}) && (creatures_list[monster.creature_id].movement & config::monsters::move::CM_INVISIBLE) == 0) {
             monster.lit = true;
@@ -604,34 +628,23 @@ static void spellLightLineTouchesMonster(int monster_id) {
 
 // Leave a line of light in given dir, blue light can sometimes hurt creatures. -RAK-
 void spellLightLine(Coord_t coord, int direction) {
-    int distance = 0;
-    bool finished = false;
+    ProjectilePath_t path;
+    projectilePathTrace(coord, direction, config::treasure::OBJECT_BOLTS_MAX_RANGE, path);
 
-    Coord_t tmp_coord = Coord_t{0, 0};
-
-    while (!finished) {
-        Tile_t &tile = dg.floor[coord.y][coord.x];
-
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
-            (void) playerMovePosition(direction, coord);
-            finished = true;
-            continue; // we're done here, break out of the loop
-        }
+    for (int distance = 0; distance < path.blocked; distance++) {
+        Coord_t spot = path.tiles[distance];
+        Tile_t tile = dg.floor[spot.y][spot.x];
 
         if (!tile.permanent_light && !tile.temporary_light) {
             // set permanent_light so that dungeonLiteSpot will work
             tile.permanent_light = true;
 
-            // coord y/x need to be maintained, so copy them
-            tmp_coord.y = coord.y;
-            tmp_coord.x = coord.x;
-
             if (tile.feature_id == TILE_LIGHT_FLOOR) {
-                if (coordInsidePanel(tmp_coord)) {
-                    dungeonLightRoom(tmp_coord);
+                if (coordInsidePanel(spot)) {
+                    dungeonLightRoom(spot);
                 }
             } else {
-                dungeonLiteSpot(tmp_coord);
+                dungeonLiteSpot(spot);
             }
         }
 
@@ -641,10 +654,6 @@ void spellLightLine(Coord_t coord, int direction) {
         if (tile.creature_id > 1) {
             spellLightLineTouchesMonster((int) tile.creature_id);
         }
-
-        // move must be at end because want to light up current tmp_coord
-        (void) playerMovePosition(direction, coord);
-        distance++;
     }
 }
 
@@ -663,29 +672,32 @@ void spellStarlite(Coord_t coord) {
 
 // Disarms all traps/chests in a given direction -RAK-
 bool spellDisarmAllInDirection(Coord_t coord, int direction) {
-    int distance = 0;
     bool disarmed = false;
 
-    Tile_t *tile = nullptr;
+    ProjectilePath_t path;
+    projectilePathTrace(coord, direction, config::treasure::OBJECT_BOLTS_MAX_RANGE, path);
 
-    do {
-        tile = &dg.floor[coord.y][coord.x];
+    // note, must continue up to and including the first non open space,
+    // because secret doors have feature_id greater than MAX_OPEN_SPACE
+    int last = std::min(path.blocked, path.length);
+
+    for (int distance = 0; distance <= last; distance++) {
+        Coord_t spot = path.tiles[distance];
+        Tile_t tile = dg.floor[spot.y][spot.x];
 
-        // note, must continue up to and including the first non open space,
-        // because secret doors have feature_id greater than MAX_OPEN_SPACE
-        if (tile->treasure_id != 0) {
-            Inventory_t &item = game.treasure.list[tile->treasure_id];
+        if (tile.treasure_id != 0) {
+            Inventory_t &item = game.treasure.list[tile.treasure_id];
 
             if (item.category_id == TV_INVIS_TRAP || item.category_id == TV_VIS_TRAP) {
-                if (dungeonDeleteObject(coord)) {
+                if (dungeonDeleteObject(spot)) {
                     disarmed = true;
                 }
             } else if (item.category_id == TV_CLOSED_DOOR) {
                 // Locked or jammed doors become merely closed.
                 item.misc_use = 0;
             } else if (item.category_id == TV_SECRET_DOOR) {
-                tile->field_mark = true;
-                trapChangeVisibility(coord);
+                tile.field_mark = true;
+                trapChangeVisibility(spot);
                 disarmed = true;
             } else if (item.category_id == TV_CHEST && item.flags != 0) {
                 disarmed = true;
@@ -697,12 +709,7 @@ bool spellDisarmAllInDirection(Coord_t coord, int direction) {
                 spellItemIdentifyAndRemoveRandomInscription(item);
             }
         }
-
-        // move must be at end because want to light up current spot
-        (void) playerMovePosition(direction, coord);
-
-        distance++;
-    } while (distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE && tile->feature_id <= MAX_OPEN_SPACE);
+    }
 
     return disarmed;
 }
@@ -750,19 +757,18 @@ static void spellGetAreaAffectFlags(int spell_type, uint32_t &weapon_type, int &
     }
 }
 
-static void printBoltStrikesMonsterMessage(Creature_t const &creature, const std::string &bolt_name, bool is_lit) {
-    std::string monster_name;
+static void printBoltStrikesMonsterMessage(Creature_t const &creature, const char *bolt_name, bool is_lit) {
+    MessageText_t msg;
     if (is_lit) {
-        monster_name = "the " + std::string(creature.name);
+        msg.format("The %s strikes the %s.", bolt_name, creature.name);
     } else {
-        monster_name = "it";
+        msg.format("The %s strikes it.", bolt_name);
     }
-    std::string msg = "The " + bolt_name + " strikes " + monster_name + ".";
     printMessage(msg.c_str());
 }
 
 // Light up, draw, and check for monster damage when Fire Bolt touches it.
-static void spellFireBoltTouchesMonster(Tile_t &tile, int damage, int harm_type, uint32_t weapon_id, const std::string &bolt_name) {
+static void spellFireBoltTouchesMonster(Tile_t &tile, int damage, int harm_type, uint32_t weapon_id, const char *bolt_name) {
     Monster_t const &monster = monsters[tile.creature_id];
     Creature_t const &creature = creatures_list[monster.creature_id];
 
@@ -801,50 +807,131 @@ static void spellFireBoltTouchesMonster(Tile_t &tile, int damage, int harm_type,
 }
 
 // Shoot a bolt in a given direction -RAK-
-void spellFireBolt(Coord_t coord, int direction, int damage_hp, int spell_type, const std::string &spell_name) {
+void spellFireBolt(Coord_t coord, int direction, int damage_hp, int spell_type, const char *spell_name) {
     bool (*dummy)(Inventory_t *);
     int harm_type = 0;
     uint32_t weapon_type;
     spellGetAreaAffectFlags(spell_type, weapon_type, harm_type, &dummy);
 
-    Coord_t old_coord = Coord_t{0, 0};
+    ProjectilePath_t path;
+    projectilePathTrace(coord, direction, config::treasure::OBJECT_BOLTS_MAX_RANGE, path);
 
-    int distance = 0;
-    bool finished = false;
+    // The bolt flies until it hits a wall or a monster, or runs out of range
+    int end = std::min(path.blocked, path.creature);
 
-    while (!finished) {
-        old_coord.y = coord.y;
-        old_coord.x = coord.x;
-        (void) playerMovePosition(direction, coord);
+    // show the bolt, all of its flight at once
+    if (py.flags.blind < 1) {
+        for (int distance = 1; distance < end; distance++) {
+            if (coordInsidePanel(path.tiles[distance])) {
+                panelPutTile('*', path.tiles[distance]);
+            }
+        }
+        putQIO();
+    }
 
-        distance++;
+    for (int distance = 0; distance < end; distance++) {
+        dungeonLiteSpot(path.tiles[distance]);
+    }
 
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+    if (path.creature < path.blocked) {
+        Tile_t tile = dg.floor[path.tiles[end].y][path.tiles[end].x];
+        spellFireBoltTouchesMonster(tile, damage_hp, harm_type, weapon_type, spell_name);
+    }
+}
 
-        dungeonLiteSpot(old_coord);
+// Balls and breaths explode over the tiles within 2 of their centre, by
+// coordDistanceBetween(), which leaves out the corners of the 5x5 square.
+constexpr int AREA_AFFECT_RADIUS = 2;
+constexpr int AREA_AFFECT_MAX_TILES = (2 * AREA_AFFECT_RADIUS + 1) * (2 * AREA_AFFECT_RADIUS + 1);
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
-            finished = true;
-            continue; // we're done here, break out of the loop
+typedef struct {
+    int8_t y;
+    int8_t x;
+    int8_t distance;
+} AreaAffectOffset_t;
+
+typedef struct {
+    AreaAffectOffset_t offsets[AREA_AFFECT_MAX_TILES];
+    int count;
+} AreaAffectStencil_t;
+
+static constexpr AreaAffectStencil_t areaAffectStencil() {
+    AreaAffectStencil_t stencil{};
+
+    for (int y = -AREA_AFFECT_RADIUS; y <= AREA_AFFECT_RADIUS; y++) {
+        for (int x = -AREA_AFFECT_RADIUS; x <= AREA_AFFECT_RADIUS; x++) {
+            int dy = y < 0 ? -y : y;
+            int dx = x < 0 ? -x : x;
+            int distance = (((dy + dx) << 1) - (dy > dx ? dx : dy)) >> 1;
+
+            if (distance <= AREA_AFFECT_RADIUS) {
+                stencil.offsets[stencil.count] = AreaAffectOffset_t{(int8_t) y, (int8_t) x, (int8_t) distance};
+                stencil.count++;
+            }
         }
+    }
 
-        if (tile.creature_id > 1) {
-            finished = true;
-            spellFireBoltTouchesMonster(tile, damage_hp, harm_type, weapon_type, spell_name);
-        } else if (coordInsidePanel(coord) && py.flags.blind < 1) {
-            panelPutTile('*', coord);
+    return stencil;
+}
 
-            // show the bolt
-            putQIO();
+static constexpr AreaAffectStencil_t area_affect_stencil = areaAffectStencil();
+
+// A tile of an explosion, and whether it was in sight of the centre
+typedef struct {
+    Coord_t coord;
+    int distance;
+    bool in_sight;
+} AreaAffectTile_t;
+
+// The tiles of an explosion, row by row
+typedef struct {
+    Coord_t centre;
+    AreaAffectTile_t tiles[AREA_AFFECT_MAX_TILES];
+    int count;
+    uint32_t feature_changes; // Value of `tile_feature_changes` for the `in_sight` flags
+} AreaAffect_t;
+
+// Finds the tiles of an explosion at `centre`, and which of them are in
+// sight of it, once before its effects.
+static void spellAreaAffectTiles(Coord_t const &centre, AreaAffect_t &area) {
+    area.centre = centre;
+    area.count = 0;
+    area.feature_changes = tile_feature_changes;
+
+    for (int i = 0; i < area_affect_stencil.count; i++) {
+        AreaAffectOffset_t const &offset = area_affect_stencil.offsets[i];
+        Coord_t spot = Coord_t{centre.y + offset.y, centre.x + offset.x};
+
+        if (coordInBounds(spot)) {
+            area.tiles[area.count] = AreaAffectTile_t{spot, offset.distance, los(centre, spot)};
+            area.count++;
+        }
+    }
+}
+
+// Whether the explosion reaches one of its tiles. Only the walls, doors and
+// rubble block the sight; if the explosion burnt a door down on the way,
+// the sight of the tiles after it is looked at again.
+static bool spellAreaAffectReaches(AreaAffect_t const &area, int i) {
+    if (area.feature_changes != tile_feature_changes) {
+        return los(area.centre, area.tiles[i].coord);
+    }
+    return area.tiles[i].in_sight;
+}
+
+// Draws the tiles of an explosion again, once it is over
+static void spellAreaAffectRedraw(AreaAffect_t const &area) {
+    for (int i = 0; i < area.count; i++) {
+        if (coordInsidePanel(area.tiles[i].coord)) {
+            dungeonLiteSpot(area.tiles[i].coord);
         }
     }
 }
 
 // Shoot a ball in a given direction.  Note that balls have an area affect. -RAK-
-void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type, const std::string &spell_name) {
+void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type, const char *spell_name) {
     int total_hits = 0;
     int total_kills = 0;
-    int max_distance = 2;
 
     bool (*destroy)(Inventory_t *);
     int harm_type;
@@ -852,7 +939,6 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
     spellGetAreaAffectFlags(spell_type, weapon_type, harm_type, &destroy);
 
     Coord_t old_coord = Coord_t{0, 0};
-    Coord_t spot = Coord_t{0, 0};
 
     int distance = 0;
     bool finished = false;
@@ -871,12 +957,12 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
             continue;
         }
 
-        Tile_t *tile = &dg.floor[coord.y][coord.x];
+        Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (tile->feature_id >= MIN_CLOSED_SPACE || tile->creature_id > 1) {
+        if (tile.feature_id >= MIN_CLOSED_SPACE || tile.creature_id > 1) {
             finished = true;
 
-            if (tile->feature_id >= MIN_CLOSED_SPACE) {
+            if (tile.feature_id >= MIN_CLOSED_SPACE) {
                 coord.y = old_coord.y;
                 coord.x = old_coord.x;
             }
@@ -884,52 +970,52 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
             // The ball hits and explodes.
 
             // The explosion.
-            for (int row = coord.y - max_distance; row <= coord.y + max_distance; row++) {
-                for (int col = coord.x - max_distance; col <= coord.x + max_distance; col++) {
-                    spot.y = row;
-                    spot.x = col;
+            AreaAffect_t area;
+            spellAreaAffectTiles(coord, area);
 
-                    if (coordInBounds(spot) && coordDistanceBetween(coord, spot) <= max_distance && los(coord, spot)) {
-                        tile = &dg.floor[spot.y][spot.x];
+            for (int i = 0; i < area.count; i++) {
+                Coord_t const &spot = area.tiles[i].coord;
 
-                        if (tile->treasure_id != 0 && (*destroy)(&game.treasure.list[tile->treasure_id])) {
-                            (void) dungeonDeleteObject(spot);
-                        }
+                if (spellAreaAffectReaches(area, i)) {
+                    Tile_t spot_tile = dg.floor[spot.y][spot.x];
 
-                        if (tile->feature_id <= MAX_OPEN_SPACE) {
-                            if (tile->creature_id > 1) {
-                                Monster_t const &monster = monsters[tile->creature_id];
-                                Creature_t const &creature = creatures_list[monster.creature_id];
-
-                                // lite up creature if visible, temp set permanent_light so that monsterUpdateVisibility works
-                                bool saved_lit_status = tile->permanent_light;
-                                tile->permanent_light = true;
-                                monsterUpdateVisibility((int) tile->creature_id);
-
-                                total_hits++;
-                                int damage = damage_hp;
-
-                                if ((harm_type & creature.defenses) != 0) {
-                                    damage = damage * 2;
-                                    if (monster.lit) {
-                                        creature_recall[monster.creature_id].defenses |= harm_type;
-                                    }
-                                } else if ((weapon_type & creature.spells) != 0u) {
-                                    damage = damage / 4;
-                                    if (monster.lit) {
-                                        creature_recall[monster.creature_id].spells |= weapon_type;
-                                    }
-                                }
+                    if (spot_tile.treasure_id != 0 && (*destroy)(&game.treasure.list[spot_tile.treasure_id])) {
+                        (void) dungeonDeleteObject(spot);
+                    }
+
+                    if (spot_tile.feature_id <= MAX_OPEN_SPACE) {
+                        if (spot_tile.creature_id > 1) {
+                            Monster_t const &monster = monsters[spot_tile.creature_id];
+                            Creature_t const &creature = creatures_list[monster.creature_id];
 
-                                damage = (damage / (coordDistanceBetween(spot, coord) + 1));
+                            // lite up creature if visible, temp set permanent_light so that monsterUpdateVisibility works
+                            bool saved_lit_status = spot_tile.permanent_light;
+                            spot_tile.permanent_light = true;
+                            monsterUpdateVisibility((int) spot_tile.creature_id);
 
-                                if (monsterTakeHit((int) tile->creature_id, damage) >= 0) {
-                                    total_kills++;
+                            total_hits++;
+                            int damage = damage_hp;
+
+                            if ((harm_type & creature.defenses) != 0) {
+                                damage = damage * 2;
+                                if (monster.lit) {
+                                    creature_recall[monster.creature_id].defenses |= harm_type;
+                                }
+                            } else if ((weapon_type & creature.spells) != 0u) {
+                                damage = damage / 4;
+                                if (monster.lit) {
+                                    creature_recall[monster.creature_id].spells |= weapon_type;
                                 }
-                                tile->permanent_light = saved_lit_status;
-                            } else if (coordInsidePanel(spot) && py.flags.blind < 1) {
-                                panelPutTile('*', spot);
                             }
+
+                            damage = (damage / (area.tiles[i].distance + 1));
+
+                            if (monsterTakeHit((int) spot_tile.creature_id, damage) >= 0) {
+                                total_kills++;
+                            }
+                            spot_tile.permanent_light = saved_lit_status;
+                        } else if (coordInsidePanel(spot) && py.flags.blind < 1) {
+                            panelPutTile('*', spot);
                         }
                     }
                 }
@@ -938,22 +1024,14 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
             // show ball of whatever
             putQIO();
 
-            for (int row = (coord.y - 2); row <= (coord.y + 2); row++) {
-                for (int col = (coord.x - 2); col <= (coord.x + 2); col++) {
-                    spot.y = row;
-                    spot.x = col;
-
-                    if (coordInBounds(spot) && coordInsidePanel(spot) && coordDistanceBetween(coord, spot) <= max_distance) {
-                        dungeonLiteSpot(spot);
-                    }
-                }
-            }
+            spellAreaAffectRedraw(area);
             // End explosion.
 
+            MessageText_t msg;
             if (total_hits == 1) {
-                printMessage(("The " + spell_name + " envelops a creature!").c_str());
+                printMessage(msg.format("The %s envelops a creature!", spell_name).c_str());
             } else if (total_hits > 1) {
-                printMessage(("The " + spell_name + " envelops several creatures!").c_str());
+                printMessage(msg.format("The %s envelops several creatures!", spell_name).c_str());
             }
 
             if (total_kills == 1) {
@@ -977,102 +1055,101 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
 
 // Breath weapon works like a spellFireBall(), but affects the player.
 // Note the area affect. -RAK-
-void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, const std::string &spell_name) {
-    int max_distance = 2;
-
+void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, const char *spell_name) {
     bool (*destroy)(Inventory_t *);
     int harm_type;
     uint32_t weapon_type;
     spellGetAreaAffectFlags(spell_type, weapon_type, harm_type, &destroy);
 
-    Coord_t location = Coord_t{0, 0};
+    AreaAffect_t area;
+    spellAreaAffectTiles(coord, area);
 
-    for (location.y = coord.y - 2; location.y <= coord.y + 2; location.y++) {
-        for (location.x = coord.x - 2; location.x <= coord.x + 2; location.x++) {
-            if (coordInBounds(location) && coordDistanceBetween(coord, location) <= max_distance && los(coord, location)) {
-                Tile_t const &tile = dg.floor[location.y][location.x];
+    for (int i = 0; i < area.count; i++) {
+        Coord_t const &location = area.tiles[i].coord;
 
-                if (tile.treasure_id != 0 && (*destroy)(&game.treasure.list[tile.treasure_id])) {
-                    (void) dungeonDeleteObject(location);
-                }
+        if (spellAreaAffectReaches(area, i)) {
+            Tile_t const &tile = dg.floor[location.y][location.x];
 
-                if (tile.feature_id <= MAX_OPEN_SPACE) {
-                    // must test status bit, not py.flags.blind here, flag could have
-                    // been set by a previous monster, but the breath should still
-                    // be visible until the blindness takes effect
-                    if (coordInsidePanel(location) && ((py.flags.status & config::player::status::PY_BLIND) == 0u)) {
-                        panelPutTile('*', location);
-                    }
+            if (tile.treasure_id != 0 && (*destroy)(&game.treasure.list[tile.treasure_id])) {
+                (void) dungeonDeleteObject(location);
+            }
 
-                    if (tile.creature_id > 1) {
-                        Monster_t &monster = monsters[tile.creature_id];
-                        Creature_t const &creature = creatures_list[monster.creature_id];
+            if (tile.feature_id <= MAX_OPEN_SPACE) {
+                // must test status bit, not py.flags.blind here, flag could have
+                // been set by a previous monster, but the breath should still
+                // be visible until the blindness takes effect
+                if (coordInsidePanel(location) && ((py.flags.status & config::player::status::PY_BLIND) == 0u)) {
+                    panelPutTile('*', location);
+                }
 
-                        int damage = damage_hp;
+                if (tile.creature_id > 1) {
+                    Monster_t &monster = monsters[tile.creature_id];
+                    Creature_t const &creature = creatures_list[monster.creature_id];
 
-                        if ((harm_type & creature.defenses) != 0) {
-                            damage = damage * 2;
-                        } else if ((weapon_type & creature.spells) != 0u) {
-                            damage = (damage / 4);
-                        }
+                    int damage = damage_hp;
 
-                        damage = (damage / (coordDistanceBetween(location, coord) + 1));
+                    if ((harm_type & creature.defenses) != 0) {
+                        damage = damage * 2;
+                    } else if ((weapon_type & creature.spells) != 0u) {
+                        damage = (damage / 4);
+                    }
 
-                        // can not call monsterTakeHit here, since player does not
-                        // get experience for kill
-                        monster.hp = (int16_t)(monster.hp - damage);
-                        monster.sleep_count = 0;
+                    damage = (damage / (area.tiles[i].distance + 1));
 
-                        if (monster.hp < 0) {
-                            uint32_t treasure_id = monsterDeath(Coord_t{monster.pos.y, monster.pos.x}, creature.movement);
+                    // can not call monsterTakeHit here, since player does not
+                    // get experience for kill
+                    monster.hp = (int16_t)(monster.hp - damage);
+                    monster.sleep_count = 0;
 
-                            if (monster.lit) {
-                                auto tmp = (uint32_t)((creature_recall[monster.creature_id].movement & config::monsters::move::CM_TREASURE) >> config::monsters::move::CM_TR_SHIFT);
-                                if (tmp > ((treasure_id & config::monsters::move::CM_TREASURE) >> config::monsters::move::CM_TR_SHIFT)) {
-                                    treasure_id = (uint32_t)((treasure_id & ~config::monsters::move::CM_TREASURE) | (tmp << config::monsters::move::CM_TR_SHIFT));
-                                }
-                                creature_recall[monster.creature_id].movement =
-                                    (uint32_t)(treasure_id | (creature_recall[monster.creature_id].movement & ~config::monsters::move::CM_TREASURE));
-                            }
+                    if (monster.hp < 0) {
+                        uint32_t treasure_id = monsterDeath(Coord_t{monster.pos.y, monster.pos.x}, creature.movement);
 
-                            // It ate an already processed monster. Handle normally.
-                            if (monster_id < tile.creature_id) {
-                                dungeonDeleteMonster((int) tile.creature_id);
-                            } else {
-                                // If it eats this monster, an already processed monster
-                                // will take its place, causing all kinds of havoc.
-                                // Delay the kill a bit.
-                                dungeonRemoveMonsterFromLevel((int) tile.creature_id);
+                        if (monster.lit) {
+                            auto tmp = (uint32_t)((creature_recall[monster.creature_id].movement & config::monsters::move::CM_TREASURE) >> config::monsters::move::CM_TR_SHIFT);
+                            if (tmp > ((treasure_id & config::monsters::move::CM_TREASURE) >> config::monsters::move::CM_TR_SHIFT)) {
+                                treasure_id = (uint32_t)((treasure_id & ~config::monsters::move::CM_TREASURE) | (tmp << config::monsters::move::CM_TR_SHIFT));
                             }
+                            creature_recall[monster.creature_id].movement =
+                                (uint32_t)(treasure_id | (creature_recall[monster.creature_id].movement & ~config::monsters::move::CM_TREASURE));
                         }
-                    } else if (tile.creature_id == 1) {
-                        int damage = (damage_hp / (coordDistanceBetween(location, coord) + 1));
 
-                        // let's do at least one point of damage
-                        // prevents randomNumber(0) problem with damagePoisonedGas, also
-                        if (damage == 0) {
-                            damage = 1;
+                        // It ate an already processed monster. Handle normally.
+                        if (monster_id < tile.creature_id) {
+                            dungeonDeleteMonster((int) tile.creature_id);
+                        } else {
+                            // If it eats this monster, an already processed monster
+                            // will take its place, causing all kinds of havoc.
+                            // Delay the kill a bit.
+                            dungeonRemoveMonsterFromLevel((int) tile.creature_id);
                         }
+                    }
+                } else if (tile.creature_id == 1) {
+                    int damage = (damage_hp / (area.tiles[i].distance + 1));
 
-                        switch (spell_type) {
-                            case MagicSpellFlags::Lightning:
-                                damageLightningBolt(damage, spell_name.c_str());
-                                break;
-                            case MagicSpellFlags::PoisonGas:
-                                damagePoisonedGas(damage, spell_name.c_str());
-                                break;
-                            case MagicSpellFlags::Acid:
-                                damageAcid(damage, spell_name.c_str());
-                                break;
-                            case MagicSpellFlags::Frost:
-                                damageCold(damage, spell_name.c_str());
-                                break;
-                            case MagicSpellFlags::Fire:
-                                damageFire(damage, spell_name.c_str());
-                                break;
-                            default:
-                                break;
-                        }
+                    // let's do at least one point of damage
+                    // prevents randomNumber(0) problem with damagePoisonedGas, also
+                    if (damage == 0) {
+                        damage = 1;
+                    }
+
+                    switch (spell_type) {
+                        case MagicSpellFlags::Lightning:
+                            damageLightningBolt(damage, spell_name);
+                            break;
+                        case MagicSpellFlags::PoisonGas:
+                            damagePoisonedGas(damage, spell_name);
+                            break;
+                        case MagicSpellFlags::Acid:
+                            damageAcid(damage, spell_name);
+                            break;
+                        case MagicSpellFlags::Frost:
+                            damageCold(damage, spell_name);
+                            break;
+                        case MagicSpellFlags::Fire:
+                            damageFire(damage, spell_name);
+                            break;
+                        default:
+                            break;
                     }
                 }
             }
@@ -1082,14 +1159,7 @@ void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, c
     // show the ball of gas
     putQIO();
 
-    Coord_t spot = Coord_t{0, 0};
-    for (spot.y = (coord.y - 2); spot.y <= (coord.y + 2); spot.y++) {
-        for (spot.x = (coord.x - 2); spot.x <= (coord.x + 2); spot.x++) {
-            if (coordInBounds(spot) && coordInsidePanel(spot) && coordDistanceBetween(coord, spot) <= max_distance) {
-                dungeonLiteSpot(spot);
-            }
-        }
-    }
+    spellAreaAffectRedraw(area);
 }
 
 // Recharge a wand, staff, or rod.  Sometimes the item breaks. -RAK-
@@ -1373,20 +1443,18 @@ bool spellSleepMonster(Coord_t coord, int direction) {
 
 // Turn stone to mud, delete wall. -RAK-
 bool spellWallToMud(Coord_t coord, int direction) {
-    int distance = 0;
     bool turned = false;
     bool finished = false;
 
-    while (!finished) {
-        (void) playerMovePosition(direction, coord);
-        distance++;
+    // note, this ray can move through walls as it turns them to mud, so
+    // the tiles are only read as it reaches them
+    ProjectilePath_t path;
+    projectilePathTrace(coord, direction, config::treasure::OBJECT_BOLTS_MAX_RANGE, path);
 
-        Tile_t const &tile = dg.floor[coord.y][coord.x];
+    for (int distance = 1; distance <= path.length && !finished; distance++) {
+        coord = path.tiles[distance];
 
-        // note, this ray can move through walls as it turns them to mud
-        if (distance == config::treasure::OBJECT_BOLTS_MAX_RANGE) {
-            finished = true;
-        }
+        Tile_t const &tile = dg.floor[coord.y][coord.x];
 
         if (tile.feature_id >= MIN_CAVE_WALL && tile.feature_id != TILE_BOUNDARY_WALL) {
             finished = true;
@@ -1455,17 +1523,15 @@ bool spellDestroyDoorsTrapsInDirection(Coord_t coord, int direction) {
     bool destroyed = false;
     int distance = 0;
 
-    Tile_t *tile = nullptr;
-
     do {
         (void) playerMovePosition(direction, coord);
         distance++;
 
-        tile = &dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
         // must move into first closed spot, as it might be a secret door
-        if (tile->treasure_id != 0) {
-            Inventory_t &item = game.treasure.list[tile->treasure_id];
+        if (tile.treasure_id != 0) {
+            Inventory_t &item = game.treasure.list[tile.treasure_id];
 
             if (item.category_id == TV_INVIS_TRAP || item.category_id == TV_CLOSED_DOOR || item.category_id == TV_VIS_TRAP || item.category_id == TV_OPEN_DOOR ||
                 item.category_id == TV_SECRET_DOOR) {
@@ -1483,7 +1549,7 @@ bool spellDestroyDoorsTrapsInDirection(Coord_t coord, int direction) {
                 spellItemIdentifyAndRemoveRandomInscription(item);
             }
         }
-    } while ((distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE) || tile->feature_id <= MAX_OPEN_SPACE);
+    } while ((distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE) || dg.floor[coord.y][coord.x].feature_id <= MAX_OPEN_SPACE);
 
     return destroyed;
 }
@@ -1542,7 +1608,7 @@ bool spellBuildWall(Coord_t coord, int direction) {
         (void) playerMovePosition(direction, coord);
         distance++;
 
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
         if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
             finished = true;
@@ -1650,7 +1716,7 @@ void spellTeleportAwayMonster(int monster_id, int distance_from_player) {
     // this is necessary, because the creature is
     // not currently visible in its new position.
     monster.lit = false;
-    monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, coord);
+    monster.distance_from_player = monsterDistanceToPlayer(coord);
 
     monsterUpdateVisibility(monster_id);
 }
@@ -1695,20 +1761,15 @@ void spellTeleportPlayerTo(Coord_t coord) {
 
 // Teleport all creatures in a given direction away -RAK-
 bool spellTeleportAwayMonsterInDirection(Coord_t coord, int direction) {
-    int distance = 0;
     bool teleported = false;
-    bool finished = false;
 
-    while (!finished) {
-        (void) playerMovePosition(direction, coord);
-        distance++;
+    ProjectilePath_t path;
+    projectilePathTrace(coord, direction, config::treasure::OBJECT_BOLTS_MAX_RANGE, path);
 
-        Tile_t const &tile = dg.floor[coord.y][coord.x];
-
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
-            finished = true;
-            continue;
-        }
+    // A monster may be teleported onto a tile further along, the tiles are
+    // read as the ray reaches them.
+    for (int distance = 1; distance < path.blocked; distance++) {
+        Tile_t const &tile = dg.floor[path.tiles[distance].y][path.tiles[distance].x];
 
         if (tile.creature_id > 1) {
             // wake it up
@@ -1764,7 +1825,8 @@ bool spellGenocide() {
                 // genocide is a powerful spell, so we will let the player
                 // know the names of the creatures they did not destroy,
                 // this message makes no sense otherwise
-                printMessage(("The " + std::string(creature.name) + " is unaffected.").c_str());
+                MessageText_t msg;
+                printMessage(msg.format("The %s is unaffected.", creature.name).c_str());
             }
         }
     }
@@ -1783,7 +1845,7 @@ bool spellSpeedAllMonsters(int speed) {
 
         auto name = monsterNameDescription(creature.name, monster.lit);
 
-        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !los(py.pos, monster.pos)) {
+        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !losFromPlayer(monster.pos)) {
             continue; // do nothing
         }
 
@@ -1822,7 +1884,7 @@ bool spellSleepAllMonsters() {
 
         auto name = monsterNameDescription(creature.name, monster.lit);
 
-        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !los(py.pos, monster.pos)) {
+        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !losFromPlayer(monster.pos)) {
             continue; // do nothing
         }
 
@@ -1875,8 +1937,11 @@ bool spellMassPolymorph() {
 bool spellDetectEvil() {
     bool detected = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
-        Monster_t &monster = monsters[id];
+    uint8_t ids[MON_TOTAL_ALLOCATIONS];
+    int count = monstersWithinArea(Coord_t{dg.panel.top, dg.panel.left}, Coord_t{dg.panel.bottom, dg.panel.right}, ids);
+
+    for (int i = 0; i < count; i++) {
+        Monster_t &monster = monsters[ids[i]];
 
         if (coordInsidePanel(Coord_t{monster.pos.y, monster.pos.x}) && ((creatures_list[monster.creature_id].defenses & config::monsters::defense::CD_EVIL) != 0)) {
             monster.lit = true;
@@ -1968,7 +2033,7 @@ void spellEarthquake() {
     for (coord.y = py.pos.y - 8; coord.y <= py.pos.y + 8; coord.y++) {
         for (coord.x = py.pos.x - 8; coord.x <= py.pos.x + 8; coord.x++) {
             if ((coord.y != py.pos.y || coord.x != py.pos.x) && coordInBounds(coord) && randomNumber(8) == 1) {
-                Tile_t &tile = dg.floor[coord.y][coord.x];
+                Tile_t tile = dg.floor[coord.y][coord.x];
 
                 if (tile.treasure_id != 0) {
                     (void) dungeonDeleteObject(coord);
@@ -2030,7 +2095,7 @@ bool spellDispelCreature(int creature_defense, int damage) {
         Monster_t const &monster = monsters[id];
 
         if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT && ((creature_defense & creatures_list[monster.creature_id].defenses) != 0) &&
-            los(py.pos, monster.pos)) {
+            losFromPlayer(monster.pos)) {
             Creature_t const &creature = creatures_list[monster.creature_id];
 
             creature_recall[monster.creature_id].defenses |= creature_defense;
@@ -2065,7 +2130,7 @@ bool spellTurnUndead() {
         Monster_t &monster = monsters[id];
         Creature_t const &creature = creatures_list[monster.creature_id];
 
-        if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT && ((creature.defenses & config::monsters::defense::CD_UNDEAD) != 0) && los(py.pos, monster.pos)) {
+        if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT && ((creature.defenses & config::monsters::defense::CD_UNDEAD) != 0) && losFromPlayer(monster.pos)) {
             auto name = monsterNameDescription(creature.name, monster.lit);
 
             if (py.misc.level + 1 > creature.level || randomNumber(5) == 1) {
@@ -2091,7 +2156,7 @@ bool spellTurnUndead() {
 void spellWardingGlyph() {
     if (dg.floor[py.pos.y][py.pos.x].treasure_id == 0) {
         int free_id = popt();
-        dg.floor[py.pos.y][py.pos.x].treasure_id = (uint8_t) free_id;
+        dungeonSetTreasureId(py.pos, free_id);
         inventoryItemCopyTo(config::dungeon::objects::OBJ_SCARE_MON, game.treasure.list[free_id]);
     }
 }
@@ -2207,7 +2272,7 @@ bool spellSlowPoison() {
 }
 
 static void replaceSpot(Coord_t coord, int typ) {
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     switch (typ) {
         case 1:
@@ -26,8 +26,8 @@ typedef struct {
     uint8_t exp_gain_for_learning; // 1/4 of exp gained for learning spell
 } Spell_t;
 
-extern Spell_t magic_spells[PLAYER_MAX_CLASSES - 1][31];
-extern const char *spell_names[62];
+extern const Spell_t magic_spells[PLAYER_MAX_CLASSES - 1][31];
+extern const char *const spell_names[62];
 
 int castSpellGetId(const char *prompt, int item_id, int &spell_id, int &spell_chance);
 
@@ -48,9 +48,9 @@ bool spellDetectMonsters();
 void spellLightLine(Coord_t coord, int direction);
 void spellStarlite(Coord_t coord);
 bool spellDisarmAllInDirection(Coord_t coord, int direction);
-void spellFireBolt(Coord_t coord, int direction, int damage_hp, int spell_type, const std::string &spell_name);
-void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type, const std::string &spell_name);
-void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, const std::string &spell_name);
+void spellFireBolt(Coord_t coord, int direction, int damage_hp, int spell_type, const char *spell_name);
+void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type, const char *spell_name);
+void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, const char *spell_name);
 bool spellRechargeItem(int number_of_charges);
 bool spellChangeMonsterHitPoints(Coord_t coord, int direction, int damage_hp);
 bool spellDrainLifeFromMonster(Coord_t coord, int direction);
@@ -8,7 +8,7 @@
 #include "headers.h"
 
 // Save the store's last increment value.
-static int16_t store_last_increment;
+static thread_local int16_t store_last_increment;
 
 static bool storeNoNeedToBargain(Store_t const &store, int32_t min_price);
 static void storeUpdateBargainingSkills(Store_t &store, int32_t price, int32_t min_price);
@@ -26,6 +26,7 @@ void storeInitializeOwners() {
         store.unique_items_counter = 0;
         store.good_purchases = 0;
         store.bad_purchases = 0;
+        store.stock_version++;
 
         for (auto &item : store.inventory) {
             inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, item.item);
@@ -104,16 +105,59 @@ static void displayStoreHaggleCommands(int haggle_type) {
     eraseLine(Coord_t{23, 0}); // clear last line
 }
 
+// Items listed per page of a store's inventory
+constexpr int STORE_ITEMS_PER_PAGE = 12;
+
+// The asking prices shown for the stock of each store, as adjusted for the
+// player's charisma. They are kept until the stock (or the cost of an item)
+// changes, the store changes hands or the player's charisma adjustment does.
+typedef struct {
+    bool valid;
+    uint16_t stock_version;
+    uint8_t owner_id;
+    int charisma_adjustment;
+    int32_t asking_prices[STORE_MAX_DISCRETE_ITEMS];
+} StorePrices_t;
+
+static thread_local StorePrices_t store_prices[MAX_STORES];
+
+// Returns the asking price shown for an item, a fixed price if its cost is positive
+static int32_t storeAskingPrice(Store_t const &store, int item_id) {
+    StorePrices_t &prices = store_prices[&store - stores];
+    int charisma_adjustment = playerStatAdjustmentCharisma();
+
+    if (!prices.valid || prices.stock_version != store.stock_version || prices.owner_id != store.owner_id || prices.charisma_adjustment != charisma_adjustment) {
+        for (int i = 0; i < store.unique_items_counter; i++) {
+            int32_t cost = store.inventory[i].cost;
+
+            if (cost <= 0) {
+                cost = -cost * charisma_adjustment / 100;
+                if (cost <= 0) {
+                    cost = 1;
+                }
+            }
+            prices.asking_prices[i] = cost;
+        }
+
+        prices.valid = true;
+        prices.stock_version = store.stock_version;
+        prices.owner_id = store.owner_id;
+        prices.charisma_adjustment = charisma_adjustment;
+    }
+
+    return prices.asking_prices[item_id];
+}
+
 // Displays a store's inventory -RAK-
 static void displayStoreInventory(Store_t &store, int item_pos_start) {
-    int item_pos_end = ((item_pos_start / 12) + 1) * 12;
+    int item_pos_end = ((item_pos_start / STORE_ITEMS_PER_PAGE) + 1) * STORE_ITEMS_PER_PAGE;
     if (item_pos_end > store.unique_items_counter) {
         item_pos_end = store.unique_items_counter;
     }
 
     int item_line_num;
 
-    for (item_line_num = (item_pos_start % 12); item_pos_start < item_pos_end; item_line_num++) {
+    for (item_line_num = (item_pos_start % STORE_ITEMS_PER_PAGE); item_pos_start < item_pos_end; item_line_num++) {
         Inventory_t &item = store.inventory[item_pos_start].item;
 
         // Save the current number of items
@@ -133,31 +177,24 @@ static void displayStoreInventory(Store_t &store, int item_pos_start) {
         (void) sprintf(msg, "%c) %s", 'a' + item_line_num, description);
         putStringClearToEOL(msg, Coord_t{item_line_num + 5, 0});
 
-        current_item_count = store.inventory[item_pos_start].cost;
-
-        if (current_item_count <= 0) {
-            int32_t value = -current_item_count;
-            value = value * playerStatAdjustmentCharisma() / 100;
-            if (value <= 0) {
-                value = 1;
-            }
-            (void) sprintf(msg, "%9d", value);
+        if (store.inventory[item_pos_start].cost <= 0) {
+            (void) sprintf(msg, "%9d", storeAskingPrice(store, item_pos_start));
         } else {
-            (void) sprintf(msg, "%9d [Fixed]", current_item_count);
+            (void) sprintf(msg, "%9d [Fixed]", storeAskingPrice(store, item_pos_start));
         }
 
         putStringClearToEOL(msg, Coord_t{item_line_num + 5, 59});
         item_pos_start++;
     }
 
-    if (item_line_num < 12) {
-        for (int i = 0; i < (11 - item_line_num + 1); i++) {
+    if (item_line_num < STORE_ITEMS_PER_PAGE) {
+        for (int i = 0; i < (STORE_ITEMS_PER_PAGE - item_line_num); i++) {
             // clear remaining lines
             eraseLine(Coord_t{i + item_line_num + 5, 0});
         }
     }
 
-    if (store.unique_items_counter > 12) {
+    if (store.unique_items_counter > STORE_ITEMS_PER_PAGE) {
         putString("- cont. -", Coord_t{17, 60});
     } else {
         eraseLine(Coord_t{17, 60});
@@ -168,6 +205,8 @@ static void displayStoreInventory(Store_t &store, int item_pos_start) {
 static void displaySingleCost(int store_id, int item_id) {
     int cost = stores[store_id].inventory[item_id].cost;
 
+    // Not taken from the asking prices: unlike the inventory
+    // list, this has always shown prices below 1 as they are.
     vtype_t msg = {'\0'};
     if (cost < 0) {
         int32_t c = -cost;
@@ -176,7 +215,7 @@ static void displaySingleCost(int store_id, int item_id) {
     } else {
         (void) sprintf(msg, "%9d [Fixed]", cost);
     }
-    putStringClearToEOL(msg, Coord_t{(item_id % 12) + 5, 59});
+    putStringClearToEOL(msg, Coord_t{(item_id % STORE_ITEMS_PER_PAGE) + 5, 59});
 }
 
 // Displays players gold -RAK-
@@ -782,15 +821,7 @@ static BidState storeSellHaggle(int store_id, int32_t &price, Inventory_t const
 
 // Get the number of store items to display on the screen
 static int storeItemsToDisplay(int store_counter, int current_top_item_id) {
-    if (current_top_item_id == 12) {
-        return store_counter - 1 - 12;
-    }
-
-    if (store_counter > 11) {
-        return 11;
-    }
-
-    return store_counter - 1;
+    return std::min(store_counter - current_top_item_id, STORE_ITEMS_PER_PAGE) - 1;
 }
 
 // Buy an item from a store -RAK-
@@ -840,6 +871,8 @@ static bool storePurchaseAnItem(int store_id, int &current_top_item_id) {
             storeDecreaseInsults(store_id);
             py.misc.au -= price;
 
+            TELEMETRY_EVENT(StorePurchase, sell_item.id, price);
+
             int new_item_id = inventoryCarryItem(sell_item);
             int saved_store_counter = store.unique_items_counter;
 
@@ -863,6 +896,7 @@ static bool storePurchaseAnItem(int store_id, int &current_top_item_id) {
                 if (saved_store_counter == store.unique_items_counter) {
                     if (store_item.cost < 0) {
                         store_item.cost = price;
+                        store.stock_version++;
                         displaySingleCost(store_id, item_id);
                     }
                 } else {
@@ -1068,18 +1102,12 @@ static bool storeSellAnItem(int store_id, int &current_top_item_id) {
 
         playerStrength();
 
+        // Show the page of the item, redrawing from it when already shown
         if (item_pos_id >= 0) {
-            if (item_pos_id < 12) {
-                if (current_top_item_id < 12) {
-                    displayStoreInventory(stores[store_id], item_pos_id);
-                } else {
-                    current_top_item_id = 0;
-                    displayStoreInventory(stores[store_id], current_top_item_id);
-                }
-            } else if (current_top_item_id > 11) {
+            if (item_pos_id / STORE_ITEMS_PER_PAGE == current_top_item_id / STORE_ITEMS_PER_PAGE) {
                 displayStoreInventory(stores[store_id], item_pos_id);
             } else {
-                current_top_item_id = 12;
+                current_top_item_id = item_pos_id / STORE_ITEMS_PER_PAGE * STORE_ITEMS_PER_PAGE;
                 displayStoreInventory(stores[store_id], current_top_item_id);
             }
         }
@@ -1095,6 +1123,8 @@ static bool storeSellAnItem(int store_id, int &current_top_item_id) {
 
 // Entering a store -RAK-
 void storeEnter(int store_id) {
+    storeApplyPendingMaintenance();
+
     Store_t const &store = stores[store_id];
 
     if (store.turns_left_before_closing >= dg.game_turn) {
@@ -1118,15 +1148,14 @@ void storeEnter(int store_id) {
 
             switch (command) {
                 case 'b':
-                    if (current_top_item_id == 0) {
-                        if (store.unique_items_counter > 12) {
-                            current_top_item_id = 12;
-                            displayStoreInventory(stores[store_id], current_top_item_id);
-                        } else {
-                            printMessage("Entire inventory is shown.");
-                        }
+                    if (store.unique_items_counter <= STORE_ITEMS_PER_PAGE) {
+                        printMessage("Entire inventory is shown.");
                     } else {
-                        current_top_item_id = 0;
+                        // Next page, back to the first after the last
+                        current_top_item_id += STORE_ITEMS_PER_PAGE;
+                        if (current_top_item_id >= store.unique_items_counter) {
+                            current_top_item_id = 0;
+                        }
                         displayStoreInventory(stores[store_id], current_top_item_id);
                     }
                     break;
@@ -11,6 +11,12 @@ constexpr uint8_t STORE_MAX_DISCRETE_ITEMS = 24; // Max number of discrete objec
 constexpr uint8_t STORE_MAX_ITEM_TYPES = 26;     // Number of items to choose stock from
 constexpr uint8_t COST_ADJUSTMENT = 100;         // Adjust prices for buying and selling
 
+// Cost of an object of game_objects, adjusted by COST_ADJUSTMENT and
+// rounding half-way cases up, as game_objects itself is read only.
+constexpr int32_t storeAdjustedCost(int32_t cost) {
+    return ((cost * COST_ADJUSTMENT) + 50) / 100;
+}
+
 // InventoryRecord_t data for a store inventory item
 typedef struct {
     int32_t cost;
@@ -26,6 +32,7 @@ typedef struct {
     uint16_t good_purchases;
     uint16_t bad_purchases;
     InventoryRecord_t inventory[STORE_MAX_DISCRETE_ITEMS];
+    uint16_t stock_version; // Changes with every change to the stock or its costs, not saved
 } Store_t;
 
 // Owner_t holds data about a given store owner
@@ -39,21 +46,21 @@ typedef struct {
     uint8_t max_insults;
 } Owner_t;
 
-extern uint8_t race_gold_adjustments[PLAYER_MAX_RACES][PLAYER_MAX_RACES];
+extern const uint8_t race_gold_adjustments[PLAYER_MAX_RACES][PLAYER_MAX_RACES];
 
-extern Owner_t store_owners[MAX_OWNERS];
-extern Store_t stores[MAX_STORES];
-extern uint16_t store_choices[MAX_STORES][STORE_MAX_ITEM_TYPES];
+extern const Owner_t store_owners[MAX_OWNERS];
+extern thread_local Store_t stores[MAX_STORES];
+extern const uint16_t store_choices[MAX_STORES][STORE_MAX_ITEM_TYPES];
 extern bool (*store_buy[MAX_STORES])(uint8_t);
-extern const char *speech_sale_accepted[14];
-extern const char *speech_selling_haggle_final[3];
-extern const char *speech_selling_haggle[16];
-extern const char *speech_buying_haggle_final[3];
-extern const char *speech_buying_haggle[15];
-extern const char *speech_insulted_haggling_done[5];
-extern const char *speech_get_out_of_my_store[5];
-extern const char *speech_haggling_try_again[10];
-extern const char *speech_sorry[5];
+extern const char *const speech_sale_accepted[14];
+extern const char *const speech_selling_haggle_final[3];
+extern const char *const speech_selling_haggle[16];
+extern const char *const speech_buying_haggle_final[3];
+extern const char *const speech_buying_haggle[15];
+extern const char *const speech_insulted_haggling_done[5];
+extern const char *const speech_get_out_of_my_store[5];
+extern const char *const speech_haggling_try_again[10];
+extern const char *const speech_sorry[5];
 
 // store
 void storeInitializeOwners();
@@ -61,6 +68,8 @@ void storeEnter(int store_id);
 
 // store_inventory
 void storeMaintenance();
+void storeScheduleMaintenance();
+void storeApplyPendingMaintenance();
 int32_t storeItemValue(Inventory_t const &item);
 int32_t storeItemSellPrice(Store_t const &store, int32_t &min_price, int32_t &max_price, Inventory_t const &item);
 bool storeCheckPlayerItemsCount(Store_t const &store, Inventory_t const &item);
@@ -7,7 +7,7 @@
 
 #include "headers.h"
 
-Store_t stores[MAX_STORES];
+thread_local Store_t stores[MAX_STORES];
 
 static void storeItemInsert(int store_id, int pos, int32_t i_cost, Inventory_t *item);
 static void storeItemCreate(int store_id, int16_t max_cost);
@@ -55,6 +55,48 @@ void storeMaintenance() {
     }
 }
 
+// The turns of the maintenance ticks not yet applied to the stores, when
+// `game.lazy_store_maintenance` is on. The stores can't be seen from the
+// dungeon, so restocking them can wait until they are entered, or saved.
+static thread_local std::vector<int32_t> pending_store_maintenance;
+
+// Maintains the stores now, or once they are next looked at
+void storeScheduleMaintenance() {
+    if (!game.lazy_store_maintenance) {
+        storeMaintenance();
+        return;
+    }
+
+    pending_store_maintenance.push_back(dg.game_turn);
+}
+
+// Applies the ticks scheduled by storeScheduleMaintenance(). Each tick draws
+// from a stream of its own, seeded by its turn, and the game's RNG is left
+// exactly as it was: stocks are the same whenever the ticks are applied.
+//
+// The ticks are played one by one rather than folded into one: how many
+// items a tick sells off or buys in depends on the stock the tick before
+// it left, so there is no count of ticks to apply in a single step.
+void storeApplyPendingMaintenance() {
+    if (pending_store_maintenance.empty()) {
+        return;
+    }
+
+    RandomState_t state = getRandomState();
+
+    for (int32_t turn : pending_store_maintenance) {
+        uint32_t seed = game.town_seed + (uint32_t) turn * 2654435761u;
+
+        setRandomSeed(seed);
+        setRandomStream(randomStreamCreate(seed, RNG_STREAM_STORES));
+
+        storeMaintenance();
+    }
+    pending_store_maintenance.clear();
+
+    setRandomState(state);
+}
+
 // Returns the value for any given object -RAK-
 int32_t storeItemValue(Inventory_t const &item) {
     int32_t value;
@@ -91,7 +133,7 @@ int32_t storeItemValue(Inventory_t const &item) {
 
 static int32_t getWeaponArmorBuyPrice(Inventory_t const &item) {
     if (!spellItemIdentified(item)) {
-        return game_objects[item.id].cost;
+        return storeAdjustedCost(game_objects[item.id].cost);
     }
 
     if (item.category_id >= TV_BOW && item.category_id <= TV_SWORD) {
@@ -111,7 +153,7 @@ static int32_t getWeaponArmorBuyPrice(Inventory_t const &item) {
 
 static int32_t getAmmoBuyPrice(Inventory_t const &item) {
     if (!spellItemIdentified(item)) {
-        return game_objects[item.id].cost;
+        return storeAdjustedCost(game_objects[item.id].cost);
     }
 
     if (item.to_hit < 0 || item.to_damage < 0 || item.to_ac < 0) {
@@ -149,7 +191,7 @@ static int32_t getRingAmuletBuyPrice(Inventory_t const &item) {
     // is cursed or not, if refuse to buy cursed objects here, then
     // player can use this to 'identify' cursed objects
     if (!spellItemIdentified(item)) {
-        return game_objects[item.id].cost;
+        return storeAdjustedCost(game_objects[item.id].cost);
     }
 
     return item.cost;
@@ -173,7 +215,7 @@ static int32_t getWandStaffBuyPrice(Inventory_t const &item) {
 
 static int32_t getPickShovelBuyPrice(Inventory_t const &item) {
     if (!spellItemIdentified(item)) {
-        return game_objects[item.id].cost;
+        return storeAdjustedCost(game_objects[item.id].cost);
     }
 
     if (item.misc_use < 0) {
@@ -218,6 +260,22 @@ int32_t storeItemSellPrice(Store_t const &store, int32_t &min_price, int32_t &ma
     return price;
 }
 
+// A store's stock is kept sorted by category, the highest first, and within
+// a category in the order the items came in. Returns the first record of a
+// category and sets `end` to one past its last, so with binary searches
+// only the items of the same kind are ever looked at. When there are none
+// both are the position the category would be inserted at.
+static int storeCategoryRange(Store_t const &store, int category_id, int &end) {
+    InventoryRecord_t const *first = store.inventory;
+    InventoryRecord_t const *last = store.inventory + store.unique_items_counter;
+
+    auto lower = std::lower_bound(first, last, category_id, [](InventoryRecord_t const &record, int category) { return record.item.category_id > category; });
+    auto upper = std::upper_bound(lower, last, category_id, [](int category, InventoryRecord_t const &record) { return category > record.item.category_id; });
+
+    end = (int) (upper - first);
+    return (int) (lower - first);
+}
+
 // Check to see if they will be carrying too many objects -RAK-
 bool storeCheckPlayerItemsCount(Store_t const &store, Inventory_t const &item) {
     if (store.unique_items_counter < STORE_MAX_DISCRETE_ITEMS) {
@@ -230,7 +288,8 @@ bool storeCheckPlayerItemsCount(Store_t const &store, Inventory_t const &item) {
 
     bool store_check = false;
 
-    for (int i = 0; i < store.unique_items_counter; i++) {
+    int end;
+    for (int i = storeCategoryRange(store, item.category_id, end); i < end; i++) {
         Inventory_t const &store_item = store.inventory[i].item;
 
         // note: items with sub_category_id of gte ITEM_SINGLE_STACK_MAX only stack
@@ -248,13 +307,12 @@ bool storeCheckPlayerItemsCount(Store_t const &store, Inventory_t const &item) {
 static void storeItemInsert(int store_id, int pos, int32_t i_cost, Inventory_t *item) {
     Store_t &store = stores[store_id];
 
-    for (int i = store.unique_items_counter - 1; i >= pos; i--) {
-        store.inventory[i + 1] = store.inventory[i];
-    }
+    std::move_backward(store.inventory + pos, store.inventory + store.unique_items_counter, store.inventory + store.unique_items_counter + 1);
 
     store.inventory[pos].item = *item;
     store.inventory[pos].cost = -i_cost;
     store.unique_items_counter++;
+    store.stock_version++;
 }
 
 // Add the item in INVEN_MAX to stores inventory. -RAK-
@@ -268,47 +326,37 @@ void storeCarryItem(int store_id, int &index_id, Inventory_t &item) {
         return;
     }
 
-    int item_id = 0;
     int item_num = item.items_count;
-    int item_category = item.category_id;
     int item_sub_catagory = item.sub_category_id;
 
-    bool flag = false;
-    do {
+    int end;
+    for (int item_id = storeCategoryRange(store, item.category_id, end); item_id < end; item_id++) {
         Inventory_t &store_item = store.inventory[item_id].item;
 
-        if (item_category == store_item.category_id) {
-            if (item_sub_catagory == store_item.sub_category_id && // Adds to other item
-                item_sub_catagory >= ITEM_SINGLE_STACK_MIN && (item_sub_catagory < ITEM_GROUP_MIN || store_item.misc_use == item.misc_use)) {
-                index_id = item_id;
-                store_item.items_count += item_num;
-
-                // must set new cost for group items, do this only for items
-                // strictly greater than group_min, not for torches, this
-                // must be recalculated for entire group
-                if (item_sub_catagory > ITEM_GROUP_MIN) {
-                    (void) storeItemSellPrice(store, dummy, item_cost, store_item);
-                    store.inventory[item_id].cost = -item_cost;
-                } else if (store_item.items_count > 24) {
-                    // must let group objects (except torches) stack over 24
-                    // since there may be more than 24 in the group
-                    store_item.items_count = 24;
-                }
-                flag = true;
-            }
-        } else if (item_category > store_item.category_id) { // Insert into list
-            storeItemInsert(store_id, item_id, item_cost, &item);
-            flag = true;
+        if (item_sub_catagory == store_item.sub_category_id && // Adds to other item
+            item_sub_catagory >= ITEM_SINGLE_STACK_MIN && (item_sub_catagory < ITEM_GROUP_MIN || store_item.misc_use == item.misc_use)) {
             index_id = item_id;
+            store_item.items_count += item_num;
+
+            // must set new cost for group items, do this only for items
+            // strictly greater than group_min, not for torches, this
+            // must be recalculated for entire group
+            if (item_sub_catagory > ITEM_GROUP_MIN) {
+                (void) storeItemSellPrice(store, dummy, item_cost, store_item);
+                store.inventory[item_id].cost = -item_cost;
+                store.stock_version++;
+            } else if (store_item.items_count > 24) {
+                // must let group objects (except torches) stack over 24
+                // since there may be more than 24 in the group
+                store_item.items_count = 24;
+            }
+            return;
         }
-        item_id++;
-    } while (item_id < store.unique_items_counter && !flag);
-
-    // Becomes last item in list
-    if (!flag) {
-        storeItemInsert(store_id, (int) store.unique_items_counter, item_cost, &item);
-        index_id = store.unique_items_counter - 1;
     }
+
+    // Becomes the last item of its category
+    storeItemInsert(store_id, end, item_cost, &item);
+    index_id = end;
 }
 
 // Destroy an item in the stores inventory.  Note that if
@@ -335,12 +383,11 @@ void storeDestroyItem(int store_id, int item_id, bool only_one_of) {
     if (number != store_item.items_count) {
         store_item.items_count -= number;
     } else {
-        for (int i = item_id; i < store.unique_items_counter - 1; i++) {
-            store.inventory[i] = store.inventory[i + 1];
-        }
+        std::move(store.inventory + item_id + 1, store.inventory + store.unique_items_counter, store.inventory + item_id);
         inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, store.inventory[store.unique_items_counter - 1].item);
         store.inventory[store.unique_items_counter - 1].cost = 0;
         store.unique_items_counter--;
+        store.stock_version++;
     }
 }
 
@@ -0,0 +1,197 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Gameplay event stream, see telemetry.h
+
+#include "headers.h"
+
+#ifdef UMORIA_TELEMETRY
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Events a session can have waiting to be written, a power of two
+constexpr uint32_t TELEMETRY_RING_SIZE = 1024;
+
+// How often the background thread drains the rings
+constexpr auto TELEMETRY_DRAIN_INTERVAL = std::chrono::milliseconds(100);
+
+static const char *telemetry_event_names[(int) TelemetryEvent::Count] = {
+    "kill", "won", "death", "gameEnd", "level", "identify", "storePurchase", "spellCast",
+};
+
+// The events of one game thread. Only that thread moves `head`, putting
+// records in, and only the thread draining it moves `tail`, taking them out.
+typedef struct {
+    uint32_t id;
+    std::unique_ptr<TelemetryRecord_t[]> records;
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+} TelemetrySession_t;
+
+// The sessions being recorded, and where they are written to. Never destroyed,
+// as the drainer, and the sessions of game threads still running, use them
+// right up to the exit; the output is flushed by the exit, or telemetryEndGame().
+static struct TelemetryStreams {
+    std::mutex mutex; // Held by whoever drains the sessions, or writes the output
+    std::vector<TelemetrySession_t *> sessions;
+    uint32_t next_session_id = 1;
+    FILE *file = nullptr;
+    bool opened = false;
+    bool draining = false;
+} &telemetry_streams = *new TelemetryStreams;
+
+static void telemetryOpenOutput() {
+    telemetry_streams.opened = true;
+
+    const char *filename = getenv("UMORIA_TELEMETRY_FILE");
+    if (filename == nullptr || filename[0] == '\0') {
+        filename = "umoria-telemetry.csv";
+    }
+
+    telemetry_streams.file = fileOpenOutput(filename);
+    if (telemetry_streams.file == nullptr) {
+        fprintf(stderr, "Can't write the telemetry to '%s'\n", filename);
+        return;
+    }
+
+    fprintf(telemetry_streams.file, "session,turn,depth,event,value,amount,text\n");
+}
+
+// Writes the text of a record between quotes, any `"` or `\` in it (e.g. in
+// a character's name) escaped with a `\`, so it can't end the field early.
+static void telemetryWriteText(FILE *file, const char *text) {
+    (void) putc('"', file);
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            (void) putc('\\', file);
+        }
+        (void) putc(*c, file);
+    }
+    (void) putc('"', file);
+}
+
+// Writes out, with the streams lock held, the records waiting in the session
+static void telemetryDrainSession(TelemetrySession_t &session) {
+    FILE *file = telemetry_streams.file;
+
+    uint32_t tail = session.tail.load(std::memory_order_relaxed);
+    uint32_t head = session.head.load(std::memory_order_acquire);
+
+    for (; tail != head; tail++) {
+        TelemetryRecord_t const &record = session.records[tail & (TELEMETRY_RING_SIZE - 1)];
+
+        if (file != nullptr) {
+            fprintf(file, "%u,%d,%d,%s,%d,%d,", session.id, record.game_turn, record.depth, telemetry_event_names[(int) record.event], record.value, record.amount);
+            telemetryWriteText(file, record.text);
+            (void) putc('\n', file);
+        }
+    }
+
+    session.tail.store(tail, std::memory_order_release);
+}
+
+// Writes out, with the streams lock held, the records waiting in every session
+static void telemetryDrainAll() {
+    for (auto session : telemetry_streams.sessions) {
+        telemetryDrainSession(*session);
+    }
+    if (telemetry_streams.file != nullptr) {
+        (void) fflush(telemetry_streams.file);
+    }
+}
+
+// Runs detached until the program exits
+static void telemetryDrainLoop() {
+    while (true) {
+        std::this_thread::sleep_for(TELEMETRY_DRAIN_INTERVAL);
+
+        std::lock_guard<std::mutex> lock(telemetry_streams.mutex);
+        telemetryDrainAll();
+    }
+}
+
+// The session of this thread, started with its first event
+static thread_local struct TelemetryThread {
+    TelemetrySession_t session;
+    bool recording = false;
+
+    ~TelemetryThread() {
+        if (!recording) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(telemetry_streams.mutex);
+
+        telemetryDrainSession(session);
+
+        uint64_t dropped = session.dropped.load(std::memory_order_relaxed);
+        if (dropped > 0 && telemetry_streams.file != nullptr) {
+            fprintf(telemetry_streams.file, "%u,%d,%d,dropped,0,%llu,\"\"\n", session.id, dg.game_turn, dg.current_level, (unsigned long long) dropped);
+        }
+
+        auto &sessions = telemetry_streams.sessions;
+        sessions.erase(std::remove(sessions.begin(), sessions.end(), &session), sessions.end());
+    }
+} telemetry_thread;
+
+static void telemetryStartSession() {
+    TelemetrySession_t &session = telemetry_thread.session;
+    session.records.reset(new TelemetryRecord_t[TELEMETRY_RING_SIZE]);
+
+    std::lock_guard<std::mutex> lock(telemetry_streams.mutex);
+
+    if (!telemetry_streams.opened) {
+        telemetryOpenOutput();
+    }
+    if (!telemetry_streams.draining) {
+        std::thread(telemetryDrainLoop).detach();
+        telemetry_streams.draining = true;
+    }
+
+    session.id = telemetry_streams.next_session_id++;
+    telemetry_streams.sessions.push_back(&session);
+
+    telemetry_thread.recording = true;
+}
+
+void telemetryRecord(TelemetryEvent event, int32_t value, int32_t amount, const char *text) {
+    if (!telemetry_thread.recording) {
+        telemetryStartSession();
+    }
+
+    TelemetrySession_t &session = telemetry_thread.session;
+
+    uint32_t head = session.head.load(std::memory_order_relaxed);
+    if (head - session.tail.load(std::memory_order_acquire) == TELEMETRY_RING_SIZE) {
+        session.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TelemetryRecord_t &record = session.records[head & (TELEMETRY_RING_SIZE - 1)];
+    record.event = event;
+    record.game_turn = dg.game_turn;
+    record.depth = dg.current_level;
+    record.value = value;
+    record.amount = amount;
+    record.text[0] = '\0';
+    if (text != nullptr) {
+        (void) strncpy(record.text, text, TELEMETRY_TEXT_SIZE - 1);
+        record.text[TELEMETRY_TEXT_SIZE - 1] = '\0';
+    }
+
+    session.head.store(head + 1, std::memory_order_release);
+}
+
+void telemetryEndGame() {
+    std::lock_guard<std::mutex> lock(telemetry_streams.mutex);
+    telemetryDrainAll();
+}
+
+#endif
@@ -0,0 +1,60 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+// A stream of the events of a game (kills, deaths, levels entered and so on)
+// for gameplay analytics. It is only built in with the UMORIA_TELEMETRY CMake
+// option, otherwise TELEMETRY_EVENT() compiles to nothing at all, its values
+// not even worked out.
+//
+// Each game thread (a session) puts its events into a lock-free ring of its
+// own, so recording one never waits. A background thread drains the rings of
+// all the sessions, writing the events as CSV to the file named by the
+// UMORIA_TELEMETRY_FILE environment variable (default: umoria-telemetry.csv),
+// which may also be a listening Unix socket. The text of an event is quoted,
+// with any `"` or `\` in it escaped by a `\`. Should a ring fill up before it
+// is drained, further events are dropped, and counted, rather than waited on.
+
+// The events recorded, and what their `value` and `amount` hold
+enum class TelemetryEvent {
+    Kill,          // The creature killed, the experience gained
+    Won,           // The character level, its experience
+    Death,         // The damage taken, `text` what killed the character
+    GameEnd,       // The character level, its experience, `text` why it ended
+    Level,         // The dungeon level entered, the deepest reached before it
+    Identify,      // The object identified, the number of them
+    StorePurchase, // The object bought, its price
+    SpellCast,     // The spell cast, 1 when it worked, `text` "mage" or "priest"
+    Count,
+};
+
+constexpr int TELEMETRY_TEXT_SIZE = 40;
+
+typedef struct {
+    TelemetryEvent event;
+    int32_t game_turn;
+    int16_t depth;
+    int32_t value;
+    int32_t amount;
+    char text[TELEMETRY_TEXT_SIZE]; // Cut short when it doesn't fit
+} TelemetryRecord_t;
+
+#ifdef UMORIA_TELEMETRY
+
+void telemetryRecord(TelemetryEvent event, int32_t value, int32_t amount, const char *text = nullptr);
+
+// Writes out the events still waiting, as the game ends
+void telemetryEndGame();
+
+#define TELEMETRY_EVENT(event, ...) telemetryRecord(TelemetryEvent::event, __VA_ARGS__)
+#define TELEMETRY_END_GAME() telemetryEndGame()
+
+#else
+
+#define TELEMETRY_EVENT(event, ...)
+#define TELEMETRY_END_GAME()
+
+#endif
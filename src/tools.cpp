@@ -0,0 +1,94 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Shared by the command line tools, see tools.h
+
+#include "headers.h"
+
+#include <atomic>
+#include <thread>
+
+// Starts on the arguments after the program name
+void toolOptionsStart(ToolOptions_t &options, int argc, char *argv[]) {
+    options.argc = argc - 1;
+    options.argv = argv + 1;
+    options.option = '\0';
+    options.used = 0;
+}
+
+// Moves on to the next option, returns false once the next argument isn't one
+bool toolOptionsNext(ToolOptions_t &options) {
+    options.argc -= options.used;
+    options.argv += options.used;
+
+    if (options.argc <= 0 || options.argv[0][0] != '-') {
+        options.option = '\0';
+        options.used = 0;
+        return false;
+    }
+
+    options.option = options.argv[0][1];
+    options.used = 1;
+    return true;
+}
+
+// The value of the option, the argument after it: nullptr when there is none
+const char *toolOptionValue(ToolOptions_t &options) {
+    if (options.argc < 2) {
+        return nullptr;
+    }
+
+    options.used = 2;
+    return options.argv[1];
+}
+
+// The value of the option as a number, which must be above 0
+bool toolOptionNumber(ToolOptions_t &options, int &number) {
+    const char *value = toolOptionValue(options);
+    return value != nullptr && stringToNumber(value, number) && number > 0;
+}
+
+// Reports the option's value as missing or bad, returning the exit status
+int toolOptionInvalid(ToolOptions_t const &options) {
+    fprintf(stderr, "Invalid value for option -%c\n", options.option);
+    return 1;
+}
+
+// The number of cores, the default number of worker threads
+int toolThreadCount() {
+    return std::max((int) std::thread::hardware_concurrency(), 1);
+}
+
+// Runs `run` on a new thread, and waits for it to end
+void toolRunOnNewThread(std::function<void()> const &run) {
+    std::thread thread(run);
+    thread.join();
+}
+
+// Runs `work` on `thread_count` new threads at once, passing each its
+// number, and waits for them all to end
+void toolRunWorkers(int thread_count, std::function<void(int worker)> const &work) {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::max(thread_count, 1); i++) {
+        workers.emplace_back(work, i);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+// Plays the games 0 to `count` - 1 with `play`, each on a new thread of its
+// own, `thread_count` of them at a time. Workers take the next game as soon
+// as they are free, so long games on one core don't hold up the rest.
+void toolPlayGames(int count, int thread_count, std::function<void(int id)> const &play) {
+    std::atomic<int> next_game{0};
+
+    toolRunWorkers(thread_count, [&](int) {
+        int id;
+        while ((id = next_game++) < count) {
+            toolRunOnNewThread([&]() { play(id); });
+        }
+    });
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <functional>
+
+// What the command line tools (umoria-sim, umoria-bench and the rest) share:
+// reading their options, and playing their games on threads.
+//
+// All the game state is thread_local, so a game played on a new thread
+// starts out fresh, and games on different threads don't share anything.
+// A tool's options are set in globals before any game thread is started,
+// the game threads only reading them.
+
+// The options at the start of a command line, as `-x` flags or as `-x VALUE`
+typedef struct {
+    int argc;    // The arguments from the option being read on,
+    char **argv; // after the options: the ones they don't take
+    char option; // The letter of the option being read
+    int used;    // Arguments the option being read takes up, with its value
+} ToolOptions_t;
+
+void toolOptionsStart(ToolOptions_t &options, int argc, char *argv[]);
+bool toolOptionsNext(ToolOptions_t &options);
+const char *toolOptionValue(ToolOptions_t &options);
+bool toolOptionNumber(ToolOptions_t &options, int &number);
+int toolOptionInvalid(ToolOptions_t const &options);
+
+int toolThreadCount();
+void toolRunOnNewThread(std::function<void()> const &run);
+void toolRunWorkers(int thread_count, std::function<void(int worker)> const &work);
+void toolPlayGames(int count, int thread_count, std::function<void(int id)> const &play);
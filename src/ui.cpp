@@ -12,11 +12,12 @@ static const char *stat_names[] = {
 static char blank_string[] = "                        ";
 
 // Track screen changes for inventory commands
-bool screen_has_changed = false;
+thread_local bool screen_has_changed = false;
 
-bool message_ready_to_print;            // Set with first message
-vtype_t messages[MESSAGE_HISTORY_SIZE]; // Saved message history -CJS-
-int16_t last_message_id = 0;            // Index of last message held in saved messages array
+thread_local bool message_ready_to_print;            // Set with first message
+thread_local vtype_t messages[MESSAGE_HISTORY_SIZE]; // Saved message history -CJS-
+thread_local int16_t last_message_id = 0;            // Index of last message held in saved messages array
+thread_local uint32_t message_lines_printed = 0;     // Lines added to the history, ever, to tell the new ones
 
 // Calculates current boundaries -RAK-
 static void panelBounds() {
@@ -84,17 +85,15 @@ void drawDungeonPanel() {
 
     Coord_t coord = Coord_t{0, 0};
 
-    // Top to bottom
+    // Top to bottom, every tile is put (blanks too) as only the
+    // tiles which changed since the last frame are sent to curses.
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
-        eraseLine(Coord_t{line, 13});
+        eraseLine(Coord_t{line, 13 + SCREEN_WIDTH});
         line++;
 
         // Left to right
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            char ch = caveGetTileSymbol(coord);
-            if (ch != ' ') {
-                panelPutTile(ch, coord);
-            }
+            panelPutTile(caveGetTileSymbol(coord), coord);
         }
     }
 }
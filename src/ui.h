@@ -42,35 +42,65 @@ constexpr char DELETE = 0x7f;
 #undef ESCAPE
 constexpr char ESCAPE = '\033'; // ESCAPE character -CJS-
 
-extern bool screen_has_changed;
-extern bool message_ready_to_print;
-extern vtype_t messages[MESSAGE_HISTORY_SIZE];
-extern int16_t last_message_id;
+extern thread_local bool screen_has_changed;
+extern thread_local bool message_ready_to_print;
+extern thread_local vtype_t messages[MESSAGE_HISTORY_SIZE];
+extern thread_local int16_t last_message_id;
+extern thread_local uint32_t message_lines_printed;
 
-extern int eof_flag;
-extern bool panic_save;
+extern thread_local int eof_flag;
+extern thread_local bool panic_save;
+
+// The input and output of a remote terminal, see terminalInitializeRemote()
+typedef struct {
+    int (*read_key)();                              // Waits for a key press, EOF once the player is gone
+    bool (*check_key)();                            // Takes a key press, if one is waiting
+    void (*write)(const char *data, size_t length); // Sends output on to the player
+
+    // When set, also gets every screen update for spectators, as it is sent
+    // to the player, or now and then a keyframe of the whole screen instead.
+    void (*broadcast)(const char *data, size_t length, bool keyframe);
+
+    // When set, the output is written by a thread of its own, which first
+    // calls this with `owner`, to write where the game's thread would.
+    void (*writer_setup)(void *owner);
+    void *owner;
+} RemoteTerminal_t;
+
+// Thrown by terminalEndRemoteSession()
+struct RemoteSessionEnded_t {};
 
 // UI - IO
 bool terminalInitialize();
+bool terminalInitializeHeadless(int (*key_source)());
+bool terminalInitializeBatch(int (*key_source)());
+bool terminalIsHeadless();
+bool terminalMayExitProgram();
+bool terminalInitializeRemote(RemoteTerminal_t const &io);
+bool terminalIsRemote();
+[[noreturn]] void terminalEndRemoteSession();
+void terminalQueueKeys(const char *keys);
 void terminalRestore();
 void terminalSaveScreen();
 void terminalRestoreScreen();
 ssize_t terminalBellSound();
 void putQIO();
+void putQIOFrame();
 void flushInputBuffer();
 void clearScreen();
 void clearToBottom(int row);
 void moveCursor(Coord_t coord);
 void addChar(char ch, Coord_t coord);
 void putString(const char *out_str, Coord_t coord);
-void putStringClearToEOL(const std::string &str, Coord_t coord);
+void putStringClearToEOL(const char *str, Coord_t coord);
 void eraseLine(Coord_t coord);
 void panelMoveCursor(Coord_t coord);
 void panelPutTile(char ch, Coord_t coord);
-void messageLinePrintMessage(std::string message);
+void messageLinePrintMessage(const char *message);
 void messageLineClear();
 void printMessage(const char *msg);
-void printMessageNoCommandInterrupt(const std::string &msg);
+void messageSetTap(void (*tap)(const char *msg));
+void printMessageNoCommandInterrupt(const char *msg);
 char getKeyInput();
 bool getCommand(const std::string &prompt, char &command);
 bool getMenuItemId(const std::string &prompt, char &command);
@@ -79,7 +109,7 @@ bool getStringInput(char *in_str, Coord_t coord, int slen);
 bool getInputConfirmation(const std::string &prompt);
 int getInputConfirmationWithAbort(int column, const std::string &prompt);
 void waitForContinueKey(int line_number);
-bool checkForNonBlockingKeyPress(int microseconds);
+bool checkForNonBlockingKeyPress();
 void getDefaultPlayerName(char *buffer);
 bool checkFilePermissions();
 
@@ -137,4 +167,5 @@ int displayInventoryItems(int itemIdStart, int itemIdEnd, bool weighted, int col
 const char *playerItemWearingDescription(int body_location);
 int displayEquipment(bool showWeights, int column);
 void inventoryExecuteCommand(char command);
+int inventoryGetSlotToWearEquipment(int categoryId);
 bool inventoryGetInputForItemId(int &commandKeyId, const char *prompt, int itemIdStart, int itemIdEnd, char *mask, const char *message);
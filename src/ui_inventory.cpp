@@ -568,7 +568,7 @@ static int requestPutRingOnWhichHand() {
     return hand;
 }
 
-static int inventoryGetSlotToWearEquipment(int categoryId) {
+int inventoryGetSlotToWearEquipment(int categoryId) {
     int slot = -1;
 
     // Slot for equipment
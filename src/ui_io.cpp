@@ -5,7 +5,13 @@
 
 // Terminal I/O code, uses the curses package
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "headers.h"
 #include "curses.h"
 
@@ -15,8 +21,492 @@ static bool curses_on = false;
 // Spare window for saving the screen. -CJS-
 static WINDOW *save_screen;
 
-int eof_flag = 0;        // Is used to signal EOF/HANGUP condition
-bool panic_save = false; // True if playing from a panic save
+// Headless mode: no curses output at all, and keys come from `headless_key_source`.
+static thread_local bool headless_mode = false;
+static thread_local int (*headless_key_source)() = nullptr;
+static thread_local bool headless_owns_process = false; // Batch mode (-b), the one game of the process
+
+// Remote mode: the screen is kept in `remote_screen` rather than by curses,
+// and sent on as ANSI escape sequences to a player at the other end of a
+// connection, whose key presses come through `remote_io` (see umoria-server).
+static thread_local bool remote_mode = false;
+static thread_local RemoteTerminal_t remote_io;
+
+constexpr int REMOTE_ROWS = 24;
+constexpr int REMOTE_COLUMNS = 80;
+
+typedef struct {
+    char cells[REMOTE_ROWS][REMOTE_COLUMNS];
+    char saved[REMOTE_ROWS][REMOTE_COLUMNS];
+    Coord_t cursor;
+} RemoteScreen_t;
+
+static thread_local RemoteScreen_t remote_screen;
+
+// What the player's terminal has, kept by the thread encoding the updates
+typedef struct {
+    char shown[REMOTE_ROWS][REMOTE_COLUMNS]; // '\0' when not known
+    uint32_t frames;
+} RemoteEncoder_t;
+
+static thread_local RemoteEncoder_t remote_encoder;
+
+// A copy of the screen, handed over to the writer thread
+typedef struct {
+    char cells[REMOTE_ROWS][REMOTE_COLUMNS];
+    Coord_t cursor;
+    bool redraw; // From a cleared terminal, as ^R asks
+    int bells;
+} RemoteFrame_t;
+
+// The writer thread of a remote terminal with asynchronous output, which
+// encodes and writes the frames the game thread hands it. They are passed
+// through a triple buffer, without locks: the game thread fills its back
+// frame, then swaps it for the latest one. When the writer falls behind,
+// the frames it never took are dropped, and it goes on from the newest.
+class RemoteWriter_t {
+  public:
+    RemoteFrame_t frames[3];
+    std::atomic<int> latest{1}; // The index of the latest frame, with FRESH when not yet taken
+    int back = 0;               // Only seen by the game thread
+    int front = 2;              // Only seen by the writer thread
+
+    // Only for the writer to sleep on, when it has taken every frame
+    std::mutex mutex;
+    std::condition_variable frame_given;
+    std::atomic<bool> ending{false};
+
+    std::thread thread;
+};
+
+constexpr int REMOTE_FRAME_FRESH = 4;
+
+static thread_local std::unique_ptr<RemoteWriter_t> remote_writer;
+static thread_local bool remote_pending_redraw = false;
+static thread_local int remote_pending_bells = 0;
+
+// Keys to be read before any from the terminal, see terminalQueueKeys()
+static thread_local std::string queued_keys;
+static thread_local size_t queued_keys_read = 0;
+
+thread_local int eof_flag = 0;        // Is used to signal EOF/HANGUP condition
+thread_local bool panic_save = false; // True if playing from a panic save
+
+#ifndef _WIN32
+// Key presses are read from the terminal by a reader thread, into a single
+// producer, single consumer queue. Checking for a key press while running or
+// resting is then only a look at the queue, and never has to wait.
+constexpr uint32_t INPUT_QUEUE_SIZE = 256; // Must be a power of two
+
+static uint8_t input_queue[INPUT_QUEUE_SIZE];
+static std::atomic<uint32_t> input_head{0}; // Only written by the reader
+static std::atomic<uint32_t> input_tail{0}; // Only written by the game
+static std::atomic<bool> input_closed{false};
+
+// Only used to sleep while waiting for a key, the queue itself has no lock
+static std::mutex input_mutex;
+static std::condition_variable input_ready;
+
+static void terminalInputReader() {
+    uint8_t buffer[64];
+
+    while (true) {
+        ssize_t count = read(0, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+
+        for (ssize_t i = 0; i < count; i++) {
+            uint32_t head = input_head.load(std::memory_order_relaxed);
+            while (head - input_tail.load(std::memory_order_acquire) >= INPUT_QUEUE_SIZE) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            input_queue[head % INPUT_QUEUE_SIZE] = buffer[i];
+            input_head.store(head + 1, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(input_mutex);
+        input_ready.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(input_mutex);
+    input_closed = true;
+    input_ready.notify_one();
+}
+
+static bool terminalKeyAvailable() {
+    return input_head.load(std::memory_order_acquire) != input_tail.load(std::memory_order_relaxed);
+}
+
+// Returns the next key press, waiting for one if needed, or EOF when input is closed.
+static int terminalReadKey() {
+    if (!terminalKeyAvailable()) {
+        std::unique_lock<std::mutex> lock(input_mutex);
+        input_ready.wait(lock, [] { return terminalKeyAvailable() || input_closed.load(); });
+
+        if (!terminalKeyAvailable()) {
+            return EOF;
+        }
+    }
+
+    uint32_t tail = input_tail.load(std::memory_order_relaxed);
+    int ch = input_queue[tail % INPUT_QUEUE_SIZE];
+    input_tail.store(tail + 1, std::memory_order_release);
+
+    return ch;
+}
+#endif
+
+// The dungeon panel is drawn into `panel_frame`, and putQIO() only hands the
+// runs of cells that differ from `panel_shown` (what curses was last given)
+// on to curses. Other screen writes which cover the panel area update both,
+// so the two always agree on what curses holds.
+constexpr int PANEL_SCREEN_TOP = 1;
+constexpr int PANEL_SCREEN_LEFT = 13;
+
+static thread_local char panel_frame[SCREEN_HEIGHT][SCREEN_WIDTH];
+static thread_local char panel_shown[SCREEN_HEIGHT][SCREEN_WIDTH];
+static thread_local char panel_saved[SCREEN_HEIGHT][SCREEN_WIDTH]; // `panel_shown` for `save_screen`
+static thread_local bool panel_changed = false;
+
+// While running, resting or repeating a command putQIOFrame() refreshes the
+// screen at most once a frame, the final state is always shown by putQIO()
+// when waiting for the next key press.
+constexpr auto FRAME_BUDGET = std::chrono::milliseconds(50);
+static thread_local std::chrono::steady_clock::time_point last_refresh;
+
+// The cursor is left after the last panel tile when that was the last output
+static thread_local bool panel_cursor_pending = false;
+static thread_local Coord_t panel_cursor = Coord_t{0, 0};
+
+// The screen, whichever the terminal: curses, or the remote screen. Like the
+// curses calls they stand in for, writes go from the cursor, moving it on.
+
+static bool screenMove(Coord_t coord) {
+    if (!remote_mode) {
+        return move(coord.y, coord.x) != ERR;
+    }
+
+    if (coord.y < 0 || coord.y >= REMOTE_ROWS || coord.x < 0 || coord.x >= REMOTE_COLUMNS) {
+        return false;
+    }
+    remote_screen.cursor = coord;
+    return true;
+}
+
+static Coord_t currentCursorPosition() {
+    if (remote_mode) {
+        return remote_screen.cursor;
+    }
+
+    int y, x;
+    getscryx(y, x);
+    return Coord_t{y, x};
+}
+
+// Writes at most `length` characters of `str`, up to the end of the row
+static bool screenWrite(const char *str, int length) {
+    if (!remote_mode) {
+        return addnstr(str, length) != ERR;
+    }
+
+    Coord_t &cursor = remote_screen.cursor;
+    for (int i = 0; i < length && str[i] != '\0' && cursor.x < REMOTE_COLUMNS; i++) {
+        remote_screen.cells[cursor.y][cursor.x++] = str[i];
+    }
+    if (cursor.x >= REMOTE_COLUMNS) {
+        cursor.x = REMOTE_COLUMNS - 1;
+    }
+    return true;
+}
+
+static void screenClearToEndOfLine() {
+    if (!remote_mode) {
+        clrtoeol();
+        return;
+    }
+
+    Coord_t const &cursor = remote_screen.cursor;
+    (void) memset(&remote_screen.cells[cursor.y][cursor.x], ' ', (size_t) (REMOTE_COLUMNS - cursor.x));
+}
+
+static void screenClearToBottom() {
+    if (!remote_mode) {
+        clrtobot();
+        return;
+    }
+
+    screenClearToEndOfLine();
+    for (int y = remote_screen.cursor.y + 1; y < REMOTE_ROWS; y++) {
+        (void) memset(remote_screen.cells[y], ' ', REMOTE_COLUMNS);
+    }
+}
+
+static void screenClear() {
+    if (!remote_mode) {
+        (void) clear();
+        return;
+    }
+
+    (void) memset(remote_screen.cells, ' ', sizeof(remote_screen.cells));
+    remote_screen.cursor = Coord_t{0, 0};
+}
+
+// Every so many refreshes, spectators are also sent the whole screen, so
+// one joining late only needs the last keyframe and the deltas since.
+constexpr uint32_t REMOTE_KEYFRAME_INTERVAL = 64;
+
+// A run of unchanged cells this short is sent again, costing less than the
+// escape sequence which would move the cursor past it.
+constexpr int REMOTE_RUN_GAP = 4;
+
+static void remoteCursorEscape(std::string &output, Coord_t coord) {
+    char escape[16];
+    (void) sprintf(escape, "\033[%d;%dH", coord.y + 1, coord.x + 1);
+    output += escape;
+}
+
+// The runs of `cells` the player's terminal doesn't have yet, then the cursor
+static void remoteScreenDelta(char const (&screen)[REMOTE_ROWS][REMOTE_COLUMNS], Coord_t cursor, std::string &output) {
+    for (int row = 0; row < REMOTE_ROWS; row++) {
+        char const *cells = screen[row];
+        char *shown = remote_encoder.shown[row];
+
+        int col = 0;
+        while (col < REMOTE_COLUMNS) {
+            if (cells[col] == shown[col]) {
+                col++;
+                continue;
+            }
+
+            remoteCursorEscape(output, Coord_t{row, col});
+
+            // The run goes on over short gaps, up to the last changed cell
+            int end = col;
+            for (int gap = 0; end < REMOTE_COLUMNS && gap <= REMOTE_RUN_GAP; end++) {
+                gap = cells[end] == shown[end] ? gap + 1 : 0;
+            }
+            while (cells[end - 1] == shown[end - 1]) {
+                end--;
+            }
+
+            output.append(&cells[col], (size_t) (end - col));
+            (void) memcpy(&shown[col], &cells[col], (size_t) (end - col));
+            col = end;
+        }
+    }
+
+    remoteCursorEscape(output, cursor);
+}
+
+// The whole screen, for a terminal starting from nothing
+static void remoteScreenKeyframe(char const (&screen)[REMOTE_ROWS][REMOTE_COLUMNS], Coord_t cursor, std::string &output) {
+    output += "\033[H\033[2J";
+
+    for (int row = 0; row < REMOTE_ROWS; row++) {
+        int end = REMOTE_COLUMNS;
+        while (end > 0 && screen[row][end - 1] == ' ') {
+            end--;
+        }
+
+        if (end > 0) {
+            remoteCursorEscape(output, Coord_t{row, 0});
+            output.append(screen[row], (size_t) end);
+        }
+    }
+
+    remoteCursorEscape(output, cursor);
+}
+
+// Starts the encoding over, from the player's terminal being cleared
+static void remoteEncoderReset() {
+    (void) memset(remote_encoder.shown, ' ', sizeof(remote_encoder.shown));
+    remote_encoder.frames = 0;
+}
+
+// Sends the player the runs of cells their terminal doesn't have yet. The
+// same delta, encoded the once, goes to the broadcast for any spectators.
+static void remoteScreenSend(char const (&screen)[REMOTE_ROWS][REMOTE_COLUMNS], Coord_t cursor) {
+    std::string output;
+    remoteScreenDelta(screen, cursor, output);
+
+    remote_io.write(output.data(), output.size());
+
+    if (remote_io.broadcast == nullptr) {
+        return;
+    }
+
+    if (remote_encoder.frames++ % REMOTE_KEYFRAME_INTERVAL == 0) {
+        std::string keyframe;
+        remoteScreenKeyframe(screen, cursor, keyframe);
+        remote_io.broadcast(keyframe.data(), keyframe.size(), true);
+    } else {
+        remote_io.broadcast(output.data(), output.size(), false);
+    }
+}
+
+// Has the whole screen sent again, with the next update
+static void remoteScreenForget() {
+    remote_io.write("\033[2J", 4);
+    (void) memset(remote_encoder.shown, '\0', sizeof(remote_encoder.shown));
+}
+
+static void remoteWriterSend(RemoteFrame_t const &frame) {
+    if (frame.redraw) {
+        remoteScreenForget();
+    }
+
+    remoteScreenSend(frame.cells, frame.cursor);
+
+    for (int i = 0; i < frame.bells; i++) {
+        remote_io.write("\007", 1);
+    }
+}
+
+// Runs the writer thread: sends each newest frame, until the game is over
+static void remoteWriterRun(RemoteWriter_t *writer, RemoteTerminal_t io) {
+    remote_io = io;
+    remote_io.writer_setup(remote_io.owner);
+    remoteEncoderReset();
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(writer->mutex);
+            writer->frame_given.wait(lock, [writer]() { return (writer->latest & REMOTE_FRAME_FRESH) != 0 || writer->ending; });
+        }
+
+        if ((writer->latest & REMOTE_FRAME_FRESH) == 0) {
+            return;
+        }
+
+        writer->front = writer->latest.exchange(writer->front) & ~REMOTE_FRAME_FRESH;
+        remoteWriterSend(writer->frames[writer->front]);
+    }
+}
+
+// Hands the screen over to the writer thread, as its newest frame
+static void remoteWriterGive(RemoteWriter_t &writer) {
+    RemoteFrame_t &frame = writer.frames[writer.back];
+
+    (void) memcpy(frame.cells, remote_screen.cells, sizeof(frame.cells));
+    frame.cursor = remote_screen.cursor;
+    frame.redraw = remote_pending_redraw;
+    frame.bells = remote_pending_bells;
+
+    int replaced = writer.latest.exchange(writer.back | REMOTE_FRAME_FRESH);
+    writer.back = replaced & ~REMOTE_FRAME_FRESH;
+
+    // The redraw of a frame which was dropped goes with the next one, and
+    // any bells of it as one, rather than ringing on and on late.
+    if ((replaced & REMOTE_FRAME_FRESH) != 0) {
+        remote_pending_redraw = writer.frames[writer.back].redraw;
+        remote_pending_bells = std::min(writer.frames[writer.back].bells, 1);
+    } else {
+        remote_pending_redraw = false;
+        remote_pending_bells = 0;
+    }
+
+    // Taken, if only for a moment, so the writer can't miss being woken
+    { std::lock_guard<std::mutex> lock(writer.mutex); }
+    writer.frame_given.notify_one();
+}
+
+// Has the writer thread send the frames it was given, and end
+static void remoteWriterStop() {
+    if (remote_writer == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(remote_writer->mutex);
+        remote_writer->ending = true;
+    }
+    remote_writer->frame_given.notify_one();
+    remote_writer->thread.join();
+
+    remote_writer.reset();
+}
+
+static void remoteScreenRefresh() {
+    if (remote_writer != nullptr) {
+        remoteWriterGive(*remote_writer);
+    } else {
+        remoteScreenSend(remote_screen.cells, remote_screen.cursor);
+    }
+}
+
+static void screenRefresh() {
+    if (remote_mode) {
+        remoteScreenRefresh();
+    } else {
+        (void) refresh();
+    }
+}
+
+static bool panelScreenCell(Coord_t coord, int &row, int &col) {
+    row = coord.y - PANEL_SCREEN_TOP;
+    col = coord.x - PANEL_SCREEN_LEFT;
+
+    return row >= 0 && row < SCREEN_HEIGHT && col >= 0 && col < SCREEN_WIDTH;
+}
+
+// Records `length` characters of `str` (blanks when null) given to curses at `coord`.
+static void panelScreenWritten(Coord_t coord, const char *str, int length) {
+    panel_cursor_pending = false;
+
+    for (int i = 0; i < length; i++, coord.x++) {
+        int row, col;
+        if (panelScreenCell(coord, row, col)) {
+            panel_frame[row][col] = panel_shown[row][col] = str != nullptr ? str[i] : ' ';
+        }
+    }
+}
+
+// Records that curses cleared the screen from `coord` to the end of its row.
+static void panelScreenCleared(Coord_t coord) {
+    panelScreenWritten(coord, nullptr, 80 - coord.x);
+}
+
+static void panelScreenReset() {
+    (void) memset(panel_frame, ' ', sizeof(panel_frame));
+    (void) memset(panel_shown, ' ', sizeof(panel_shown));
+    panel_changed = false;
+    panel_cursor_pending = false;
+}
+
+// Hands the changed runs of panel cells on to curses.
+static void panelPresentFrame() {
+    if (!panel_changed) {
+        return;
+    }
+    panel_changed = false;
+
+    Coord_t cursor = currentCursorPosition();
+
+    for (int row = 0; row < SCREEN_HEIGHT; row++) {
+        for (int col = 0; col < SCREEN_WIDTH; col++) {
+            if (panel_frame[row][col] == panel_shown[row][col]) {
+                continue;
+            }
+
+            int start = col;
+            while (col < SCREEN_WIDTH && panel_frame[row][col] != panel_shown[row][col]) {
+                panel_shown[row][col] = panel_frame[row][col];
+                col++;
+            }
+
+            if (!screenMove(Coord_t{row + PANEL_SCREEN_TOP, start + PANEL_SCREEN_LEFT}) || !screenWrite(&panel_frame[row][start], col - start)) {
+                abort();
+            }
+        }
+    }
+
+    (void) screenMove(panel_cursor_pending ? panel_cursor : cursor);
+}
 
 // Set up the terminal into a suitable state -MRC-
 static void moriaTerminalInitialize() {
@@ -34,6 +524,22 @@ static void moriaTerminalInitialize() {
     curses_on = true;
 }
 
+// Has the whole screen drawn again, as ^R asks
+static void screenRedraw() {
+    if (!remote_mode) {
+        (void) wrefresh(curscr);
+        moriaTerminalInitialize();
+        return;
+    }
+
+    if (remote_writer != nullptr) {
+        remote_pending_redraw = true;
+    } else {
+        remoteScreenForget();
+    }
+    remoteScreenRefresh();
+}
+
 // initializes the terminal / curses routines
 bool terminalInitialize() {
     initscr();
@@ -54,12 +560,115 @@ bool terminalInitialize() {
 
     (void) clear();
     (void) refresh();
+    panelScreenReset();
+
+#ifndef _WIN32
+    std::thread(terminalInputReader).detach();
+#endif
+
+    return true;
+}
+
+// Sets up a null terminal for automated play: nothing is drawn, and all
+// key presses are read from `key_source`, which returns EOF when it has
+// run dry. No curses calls or system calls are made on behalf of the UI.
+bool terminalInitializeHeadless(int (*key_source)()) {
+    if (key_source == nullptr) {
+        return false;
+    }
+
+    headless_mode = true;
+    headless_key_source = key_source;
+
+    return true;
+}
+
+// As terminalInitializeHeadless(), for the game of batch mode (-b), which
+// is the only one of its process: it may exit, as a game on a terminal does.
+bool terminalInitializeBatch(int (*key_source)()) {
+    if (!terminalInitializeHeadless(key_source)) {
+        return false;
+    }
+
+    headless_owns_process = true;
 
     return true;
 }
 
+bool terminalIsHeadless() {
+    return headless_mode;
+}
+
+// Whether the game may call exitProgram(). Headless games, other than that
+// of batch mode, share their process with others, so must return instead.
+bool terminalMayExitProgram() {
+    return !headless_mode || headless_owns_process;
+}
+
+// Sets up a terminal for a player at the other end of a connection, on the
+// thread that plays their game: the screen is kept here, and every refresh
+// sends `io.write` the ANSI escape sequences updating the player's 80x24
+// terminal. No curses calls are made, so many such terminals can be played
+// at once, each on its own thread.
+//
+// With `io.writer_setup` given, the output is asynchronous: refreshes only
+// hand a copy of the screen to a writer thread, set up by it, which does the
+// encoding and the writes, and drops the frames a slow player has yet to be
+// sent for newer ones. The game is then never held up by its connection.
+bool terminalInitializeRemote(RemoteTerminal_t const &io) {
+    if (io.read_key == nullptr || io.check_key == nullptr || io.write == nullptr) {
+        return false;
+    }
+
+    remote_mode = true;
+    remote_io = io;
+
+    (void) memset(remote_screen.cells, ' ', sizeof(remote_screen.cells));
+    remote_screen.cursor = Coord_t{0, 0};
+    remoteEncoderReset();
+    panelScreenReset();
+
+    remote_io.write("\033[H\033[2J", 7);
+
+    if (io.writer_setup != nullptr) {
+        remote_pending_redraw = false;
+        remote_pending_bells = 0;
+
+        remote_writer.reset(new RemoteWriter_t);
+        remote_writer->thread = std::thread(remoteWriterRun, remote_writer.get(), io);
+    }
+
+    return true;
+}
+
+bool terminalIsRemote() {
+    return remote_mode;
+}
+
+// Ends the remote player's session, by unwinding their game's thread back to
+// where it was started, which catches RemoteSessionEnded_t. Where the game
+// would exit the program, a remote game can only end its own session.
+void terminalEndRemoteSession() {
+    remoteWriterStop();
+    throw RemoteSessionEnded_t{};
+}
+
+// Makes `keys` the next key presses read, ahead of the terminal's or the
+// key source's, replacing any still queued. An empty string drops them.
+void terminalQueueKeys(const char *keys) {
+    queued_keys = keys;
+    queued_keys_read = 0;
+}
+
 // Put the terminal in the original mode. -CJS-
 void terminalRestore() {
+    if (remote_mode) {
+        putQIO();
+        remoteWriterStop();
+        remote_io.write("\033[24;1H\r\n", 11);
+        return;
+    }
+
     if (!curses_on) {
         return;
     }
@@ -81,19 +690,48 @@ void terminalRestore() {
 }
 
 void terminalSaveScreen() {
-    overwrite(stdscr, save_screen);
+    if (headless_mode) {
+        return;
+    }
+    panelPresentFrame();
+    if (remote_mode) {
+        (void) memcpy(remote_screen.saved, remote_screen.cells, sizeof(remote_screen.saved));
+    } else {
+        overwrite(stdscr, save_screen);
+    }
+    (void) memcpy(panel_saved, panel_shown, sizeof(panel_saved));
 }
 
 void terminalRestoreScreen() {
-    overwrite(save_screen, stdscr);
-    touchwin(stdscr);
+    if (headless_mode) {
+        return;
+    }
+    if (remote_mode) {
+        (void) memcpy(remote_screen.cells, remote_screen.saved, sizeof(remote_screen.cells));
+    } else {
+        overwrite(save_screen, stdscr);
+        touchwin(stdscr);
+    }
+    (void) memcpy(panel_shown, panel_saved, sizeof(panel_shown));
+    (void) memcpy(panel_frame, panel_saved, sizeof(panel_frame));
+    panel_changed = false;
+    panel_cursor_pending = false;
 }
 
 ssize_t terminalBellSound() {
     putQIO();
 
     // The player can turn off beeps if they find them annoying.
-    if (config::options::error_beep_sound) {
+    if (config::options::error_beep_sound && remote_mode) {
+        if (remote_writer != nullptr) {
+            remote_pending_bells++;
+            remoteScreenRefresh();
+        } else {
+            remote_io.write("\007", 1);
+        }
+        return 1;
+    }
+    if (config::options::error_beep_sound && !headless_mode) {
         return write(1, "\007", 1);
     }
 
@@ -105,7 +743,23 @@ void putQIO() {
     // Let inventoryExecuteCommand() know something has changed.
     screen_has_changed = true;
 
-    (void) refresh();
+    if (headless_mode) {
+        return;
+    }
+
+    panelPresentFrame();
+    screenRefresh();
+    last_refresh = std::chrono::steady_clock::now();
+}
+
+// Dump the IO buffer to terminal, unless it was already done this frame
+void putQIOFrame() {
+    if (!headless_mode && std::chrono::steady_clock::now() - last_refresh < FRAME_BUDGET) {
+        screen_has_changed = true;
+        return;
+    }
+
+    putQIO();
 }
 
 // Flush the buffer -RAK-
@@ -114,7 +768,7 @@ void flushInputBuffer() {
         return;
     }
 
-    while (checkForNonBlockingKeyPress(0))
+    while (checkForNonBlockingKeyPress())
         ;
 }
 
@@ -123,27 +777,50 @@ void clearScreen() {
     if (message_ready_to_print) {
         printMessage(CNIL);
     }
-    (void) clear();
+    if (headless_mode) {
+        return;
+    }
+    screenClear();
+    panelScreenReset();
 }
 
 void clearToBottom(int row) {
-    (void) move(row, 0);
-    clrtobot();
+    if (headless_mode) {
+        return;
+    }
+    (void) screenMove(Coord_t{row, 0});
+    screenClearToBottom();
+
+    for (int y = row; y < PANEL_SCREEN_TOP + SCREEN_HEIGHT; y++) {
+        panelScreenCleared(Coord_t{y, 0});
+    }
 }
 
 // move cursor to a given y, x position
 void moveCursor(Coord_t coord) {
-    (void) move(coord.y, coord.x);
+    if (headless_mode) {
+        return;
+    }
+    panel_cursor_pending = false;
+    (void) screenMove(coord);
 }
 
 void addChar(char ch, Coord_t coord) {
-    if (mvaddch(coord.y, coord.x, ch) == ERR) {
+    if (headless_mode) {
+        return;
+    }
+    if (!screenMove(coord) || !screenWrite(&ch, 1)) {
         abort();
     }
+    panelScreenWritten(coord, &ch, 1);
 }
 
 // Dump IO to buffer -RAK-
 void putString(const char *out_str, Coord_t coord) {
+    if (headless_mode) {
+        return;
+    }
+
     // truncate the string, to make sure that it won't go past right edge of screen.
     if (coord.x > 79) {
         coord.x = 79;
@@ -153,20 +830,25 @@ void putString(const char *out_str, Coord_t coord) {
     (void) strncpy(str, out_str, (size_t)(79 - coord.x));
     str[79 - coord.x] = '\0';
 
-    if (mvaddstr(coord.y, coord.x, str) == ERR) {
+    if (!screenMove(coord) || !screenWrite(str, (int) strlen(str))) {
         abort();
     }
+    panelScreenWritten(coord, str, (int) strlen(str));
 }
 
 // Outputs a line to a given y, x position -RAK-
-void putStringClearToEOL(const std::string &str, Coord_t coord) {
+void putStringClearToEOL(const char *str, Coord_t coord) {
     if (coord.y == MSG_LINE && message_ready_to_print) {
         printMessage(CNIL);
     }
+    if (headless_mode) {
+        return;
+    }
 
-    (void) move(coord.y, coord.x);
-    clrtoeol();
-    putString(str.c_str(), coord);
+    (void) screenMove(coord);
+    screenClearToEndOfLine();
+    panelScreenCleared(coord);
+    putString(str, coord);
 }
 
 // Clears given line of text -RAK-
@@ -174,18 +856,27 @@ void eraseLine(Coord_t coord) {
     if (coord.y == MSG_LINE && message_ready_to_print) {
         printMessage(CNIL);
     }
+    if (headless_mode) {
+        return;
+    }
 
-    (void) move(coord.y, coord.x);
-    clrtoeol();
+    (void) screenMove(coord);
+    screenClearToEndOfLine();
+    panelScreenCleared(coord);
 }
 
 // Moves the cursor to a given interpolated y, x position -RAK-
 void panelMoveCursor(Coord_t coord) {
+    if (headless_mode) {
+        return;
+    }
+
     // Real coords convert to screen positions
     coord.y -= dg.panel.row_prt;
     coord.x -= dg.panel.col_prt;
 
-    if (move(coord.y, coord.x) == ERR) {
+    panel_cursor_pending = false;
+    if (!screenMove(coord)) {
         abort();
     }
 }
@@ -193,52 +884,73 @@ void panelMoveCursor(Coord_t coord) {
 // Outputs a char to a given interpolated y, x position -RAK-
 // sign bit of a character used to indicate standout mode. -CJS
 void panelPutTile(char ch, Coord_t coord) {
+    if (headless_mode) {
+        return;
+    }
+
     // Real coords convert to screen positions
     coord.y -= dg.panel.row_prt;
     coord.x -= dg.panel.col_prt;
 
-    if (mvaddch(coord.y, coord.x, ch) == ERR) {
-        abort();
+    int row, col;
+    if (!panelScreenCell(coord, row, col)) {
+        addChar(ch, coord);
+        return;
     }
-}
 
-static Coord_t currentCursorPosition() {
-    int y, x;
-    getscryx(y, x);
-    return Coord_t{y, x};
+    panel_frame[row][col] = ch;
+    panel_changed |= ch != panel_shown[row][col];
+
+    panel_cursor_pending = true;
+    panel_cursor = Coord_t{coord.y, coord.x + 1};
 }
 
 // messageLinePrintMessage will print a line of text to the message line (0,0).
 // first clearing the line of any text!
-void messageLinePrintMessage(std::string message) {
+void messageLinePrintMessage(const char *message) {
+    if (headless_mode) {
+        return;
+    }
+
     // save current cursor position
     Coord_t coord = currentCursorPosition();
 
     // move to beginning of message line, and clear it
-    move(0, 0);
-    clrtoeol();
+    (void) screenMove(Coord_t{0, 0});
+    screenClearToEndOfLine();
 
     // truncate message if it's too long!
-    message.resize(79);
-
-    addstr(message.c_str());
+    (void) screenWrite(message, 79);
 
     // restore cursor to old position
-    move(coord.y, coord.x);
+    (void) screenMove(coord);
 }
 
 // deleteMessageLine will delete all text from the message line (0,0).
 // The current cursor position will be maintained.
 void messageLineClear() {
+    if (headless_mode) {
+        return;
+    }
+
     // save current cursor position
     Coord_t coord = currentCursorPosition();
 
     // move to beginning of message line, and clear it
-    move(0, 0);
-    clrtoeol();
+    (void) screenMove(Coord_t{0, 0});
+    screenClearToEndOfLine();
 
     // restore cursor to old position
-    move(coord.y, coord.x);
+    (void) screenMove(coord);
+}
+
+// Called with every message as it is printed, so a program driving
+// the game (e.g. in batch mode) can follow it without reading the screen.
+static thread_local void (*message_tap)(const char *msg) = nullptr;
+
+// Sets the message tap, `nullptr` for none
+void messageSetTap(void (*tap)(const char *msg)) {
+    message_tap = tap;
 }
 
 // Outputs message to top line of screen
@@ -278,9 +990,9 @@ void printMessage(const char *msg) {
         }
     }
 
-    if (!combine_messages) {
-        (void) move(MSG_LINE, 0);
-        clrtoeol();
+    if (!combine_messages && !headless_mode) {
+        (void) screenMove(Coord_t{MSG_LINE, 0});
+        screenClearToEndOfLine();
     }
 
     // Make the null string a special case. -CJS-
@@ -293,6 +1005,10 @@ void printMessage(const char *msg) {
     game.command_count = 0;
     message_ready_to_print = true;
 
+    if (message_tap != nullptr) {
+        message_tap(msg);
+    }
+
     // If the new message and the old message are short enough,
     // display them on the same line.
 
@@ -303,6 +1019,7 @@ void printMessage(const char *msg) {
     } else {
         messageLinePrintMessage(msg);
         last_message_id++;
+        message_lines_printed++;
 
         if (last_message_id >= MESSAGE_HISTORY_SIZE) {
             last_message_id = 0;
@@ -314,11 +1031,11 @@ void printMessage(const char *msg) {
 }
 
 // Print a message so as not to interrupt a counted command. -CJS-
-void printMessageNoCommandInterrupt(const std::string &msg) {
+void printMessageNoCommandInterrupt(const char *msg) {
     // Save command count value
     int i = game.command_count;
 
-    printMessage(msg.c_str());
+    printMessage(msg);
 
     // Restore count value
     game.command_count = i;
@@ -333,8 +1050,23 @@ char getKeyInput() {
     putQIO();               // Dump IO buffer
     game.command_count = 0; // Just to be safe -CJS-
 
+    if (queued_keys_read < queued_keys.size()) {
+        return queued_keys[queued_keys_read++];
+    }
+
     while (true) {
-        int ch = getch();
+        int ch;
+        if (headless_mode) {
+            ch = headless_key_source();
+        } else if (remote_mode) {
+            ch = remote_io.read_key();
+        } else {
+#ifdef _WIN32
+            ch = getch();
+#else
+            ch = terminalReadKey();
+#endif
+        }
 
         // some machines may not sign extend.
         if (ch == EOF) {
@@ -343,7 +1075,17 @@ char getKeyInput() {
 
             eof_flag++;
 
-            (void) refresh();
+            if (!headless_mode) {
+                panelPresentFrame();
+                screenRefresh();
+            }
+
+            // A game sharing the process with others must not end it, its
+            // loops stop on `eof_flag` and return instead.
+            if (!terminalMayExitProgram()) {
+                playerDisturb(1, 0);
+                return ESCAPE;
+            }
 
             if (!game.character_generated || game.character_saved) {
                 endGame();
@@ -366,11 +1108,15 @@ char getKeyInput() {
         }
 
         if (ch != CTRL_KEY('R')) {
+            replayRecordKey((char) ch);
             return (char) ch;
         }
 
-        (void) wrefresh(curscr);
-        moriaTerminalInitialize();
+        if (headless_mode) {
+            continue;
+        }
+
+        screenRedraw();
     }
 }
 
@@ -378,7 +1124,7 @@ char getKeyInput() {
 // Function returns false if <ESCAPE> is input
 bool getCommand(const std::string &prompt, char &command) {
     if (!prompt.empty()) {
-        putStringClearToEOL(prompt, Coord_t{0, 0});
+        putStringClearToEOL(prompt.c_str(), Coord_t{0, 0});
     }
     command = getKeyInput();
 
@@ -399,13 +1145,16 @@ bool getMenuItemId(const std::string &prompt, char &command) {
 // Gets a string terminated by <RETURN>
 // Function returns false if <ESCAPE> is input
 bool getStringInput(char *in_str, Coord_t coord, int slen) {
-    (void) move(coord.y, coord.x);
+    if (!headless_mode) {
+        (void) screenMove(coord);
 
-    for (int i = slen; i > 0; i--) {
-        (void) addch(' ');
-    }
+        for (int i = slen; i > 0; i--) {
+            (void) screenWrite(" ", 1);
+        }
+        panelScreenWritten(coord, nullptr, slen);
 
-    (void) move(coord.y, coord.x);
+        (void) screenMove(coord);
+    }
 
     int start_col = coord.x;
     int end_col = coord.x + slen - 1;
@@ -442,7 +1191,12 @@ bool getStringInput(char *in_str, Coord_t coord, int slen) {
                 if ((isprint(key) == 0) || coord.x > end_col) {
                     terminalBellSound();
                 } else {
-                    mvaddch(coord.y, coord.x, (char) key);
+                    if (!headless_mode) {
+                        char ch = (char) key;
+                        (void) screenMove(coord);
+                        (void) screenWrite(&ch, 1);
+                        panelScreenWritten(coord, &ch, 1);
+                    }
                     *p++ = (char) key;
                     coord.x++;
                 }
@@ -472,19 +1226,16 @@ bool getInputConfirmation(const std::string &prompt) {
 // Used to verify a choice, with the option of aborting (useful for "drop all items")
 // and with the option of setting the column for displaying the prompt.
 int getInputConfirmationWithAbort(int column, const std::string &prompt) {
-    putStringClearToEOL(prompt, Coord_t{0, column});
+    putStringClearToEOL(prompt.c_str(), Coord_t{0, column});
 
-    int y, x;
-    getscryx(y, x);
+    if (!headless_mode) {
+        if (currentCursorPosition().x > 73) {
+            (void) screenMove(Coord_t{0, 73});
+        }
 
-    if (x > 73) {
-        (void) move(0, 73);
-    } else if (y != 0) {
-        // use `y` to prevent compiler warning.
+        (void) screenWrite(" [y/n]", 6);
     }
 
-    (void) addstr(" [y/n]");
-
     char key = ' ';
     while (key == ' ') {
         key = getKeyInput();
@@ -508,50 +1259,42 @@ void waitForContinueKey(int line_number) {
     eraseLine(Coord_t{line_number, 0});
 }
 
-// Provides for a timeout on input. Does a non-blocking read, consuming the data if
-// any, and then returns 1 if data was read, zero otherwise.
-//
-// Porting:
+// Checks for a key press without waiting, consuming the key if there
+// is one, and then returns true if a key was read, false otherwise.
 //
-// In systems without the select call, but with a sleep for fractional numbers of
-// seconds, one could sleep for the time and then check for input.
+// On Windows this does a short curses read. Elsewhere key presses are
+// queued by the input reader thread, so this is just a look at the queue.
 //
-// In systems which can only sleep for whole number of seconds, you might sleep by
-// writing a lot of nulls to the terminal, and waiting for them to drain, or you
-// might hack a static accumulation of times to wait. When the accumulation reaches
-// a certain point, sleep for a second. There would need to be a way of resetting
-// the count, with a call made for commands like run or rest.
-bool checkForNonBlockingKeyPress(int microseconds) {
-#ifdef _WIN32
-    (void) microseconds;
+// In headless mode there is no one to interrupt a run or rest, so this
+// returns immediately without polling anything, save for the key presses a
+// replay log has at this point.
+bool checkForNonBlockingKeyPress() {
+    if (headless_mode) {
+        return replayKeyCheck(false);
+    }
+    if (remote_mode) {
+        return replayKeyCheck(remote_io.check_key());
+    }
 
+#ifdef _WIN32
     // Ugly non-blocking read...Ugh! -MRC-
     timeout(8);
     int result = getch();
     timeout(-1);
 
-    return result > 0;
+    return replayKeyCheck(result > 0);
 #else
-    struct timeval tbuf {};
-    int ch;
-    int smask;
-
-    // Return true if a read on descriptor 1 will not block.
-    tbuf.tv_sec = 0;
-    tbuf.tv_usec = microseconds;
-
-    smask = 1; // i.e. (1 << 0)
-    if (select(1, (fd_set *) &smask, (fd_set *) nullptr, (fd_set *) nullptr, &tbuf) == 1) {
-        ch = getch();
-        // check for EOF errors here, select sometimes works even when EOF
-        if (ch == -1) {
+    if (!terminalKeyAvailable()) {
+        // check for EOF here, a closed input never has keys for us
+        if (input_closed.load()) {
             eof_flag++;
-            return false;
         }
-        return true;
+        return false;
     }
 
-    return false;
+    (void) terminalReadKey();
+
+    return replayKeyCheck(true);
 #endif
 }
 
@@ -357,7 +357,7 @@ static bool wizardRequestObjectId(int &id, const std::string &label, int start_i
     id_str << start_id << "-" << end_id;
 
     std::string msg = label + " ID (" + id_str.str() + "): ";
-    putStringClearToEOL(msg, Coord_t{0, 0});
+    putStringClearToEOL(msg.c_str(), Coord_t{0, 0});
 
     vtype_t input = {0};
     if (!getStringInput(input, Coord_t{0, (int) msg.length()}, 3)) {
@@ -370,7 +370,7 @@ static bool wizardRequestObjectId(int &id, const std::string &label, int start_i
     }
 
     if (given_id < start_id || given_id > end_id) {
-        putStringClearToEOL("Invalid ID. Must be " + id_str.str(), Coord_t{0, 0});
+        putStringClearToEOL(("Invalid ID. Must be " + id_str.str()).c_str(), Coord_t{0, 0});
         return false;
     }
     id = given_id;
@@ -399,7 +399,7 @@ void wizardGenerateObject() {
 
             // place the object
             int free_treasure_id = popt();
-            dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+            dungeonSetTreasureId(coord, free_treasure_id);
             inventoryItemCopyTo(id, game.treasure.list[free_treasure_id]);
             magicTreasureMagicalAbility(free_treasure_id, dg.current_level);
 
@@ -553,7 +553,7 @@ void wizardCreateObjects() {
 
     if (getInputConfirmation("Allocate?")) {
         // delete object first if any, before call popt()
-        Tile_t &tile = dg.floor[py.pos.y][py.pos.x];
+        Tile_t tile = dg.floor[py.pos.y][py.pos.x];
 
         if (tile.treasure_id != 0) {
             (void) dungeonDeleteObject(py.pos);
@@ -562,7 +562,7 @@ void wizardCreateObjects() {
         number = popt();
 
         game.treasure.list[number] = forge;
-        tile.treasure_id = (uint8_t) number;
+        dungeonSetTreasureId(py.pos, number);
 
         printMessage("Allocated.");
     } else {